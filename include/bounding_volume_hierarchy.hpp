@@ -6,26 +6,104 @@
 #include <utility> //std::pair
 #include <numeric> //std::iota
 #include <functional> //std::function
+#include <limits> //std::numeric_limits
+#include <memory> //std::shared_ptr
+#include <span> //std::span
 #include <sstream> //std::stringstream
+#include <type_traits> //std::is_trivially_copyable_v
 
+#include <glm/gtc/constants.hpp> //glm::pi
+
+#include "geometric_primitives/aabb.hpp"
+#include "geometric_primitives/intersections.hpp"
 #include "geometric_primitives/intersects.hpp"
 #include "geometric_primitives/sphere.hpp"
 #include "geometric_primitives/triangle.hpp"
 
+#include "generators/cubegenerator.hpp"
 #include "generators/spheregenerator.hpp"
 
 #include "minimum_bounding_sphere.hpp"
 #include "model.hpp"
 
 #include "utils/no_such_triangle_exception.hpp"
+#include "utils/fixed_stack.hpp"
 #include "utils/not_implemented_exception.hpp"
+#include "utils/query_statistics.hpp"
+#include "utils/thread_pool.hpp"
 #include "utils/throw_if.hpp"
 
 namespace lowpoly3d {
 
+// Selects how a BVH partitions the triangles of a model during construction
+enum class BVHBuildStrategy {
+	split,     // Recursively partitions by a plane through the mean triangle midpoint, see split()
+	binned_sah // Binned surface area heuristic over precomputed triangle bounds, see build_binned_sah()
+};
+
+/* Selects how a BVH fits the BVs of internal nodes. Merging bounds the BVs of the two children,
+ * which is fast but makes spheres grow looser towards the root. Fitting to the vertices of the
+ * triangles of the subtree gives the tightest BV at the cost of a slower build and refit.
+ * Merged boxes are as tight as fitted ones, so only spheres get any tighter. */
+enum class BVHFitting {
+	merge,   // Fits the BV of each node around the BVs of its children
+	vertices // Fits the BV of each node to the vertices of its subtree, e.g. with Welzl's algorithm
+};
+
 // Returns two subsets of "indices" into trinagles that represent a binary partition of triangles
 std::pair<std::vector<std::size_t>, std::vector<std::size_t>> split(const Model& model, const std::vector<std::size_t>& indices);
 
+/* The shape of a binary BVH without any bounding volumes. Nodes are stored in post-order
+ * (children before parents, root last) and follow the same left_idx/right_idx/is_leaf
+ * contract as BinaryBV. "order" holds all triangle indices, permuted such that
+ * the leaves of any subtree refer to a contiguous range of "order". */
+struct BVHTopology {
+	struct Node {
+		std::size_t left_idx, right_idx;
+		bool is_leaf;
+	};
+	std::vector<Node> nodes;
+	std::vector<std::size_t> order;
+	std::size_t depth = 0;
+};
+
+/* Builds the topology of a BVH over all triangles of model using binned SAH partitioning.
+ * Triangle centroids and bounds are computed once up front, a single index array is
+ * partitioned in place and sufficiently large independent subtrees are built in parallel on pool. */
+BVHTopology build_binned_sah(const Model& model, ThreadPool& pool = ThreadPool::global());
+
+/* Describes how a BVH fits and draws bounding volumes of type BV. Specialize it
+ * for each type of bounding volume that a BVH should be able to hold. */
+template<typename BV>
+struct BVTraits;
+
+template<typename fpt, std::size_t dim>
+struct BVTraits<TSphere<fpt, dim>> {
+	static TSphere<fpt, dim> fit(const TTriangle<fpt, dim>& triangle) { return mbs(triangle); }
+	static TSphere<fpt, dim> merge(const TSphere<fpt, dim>& a, const TSphere<fpt, dim>& b) { return mbs(a, b); }
+	static TSphere<fpt, dim> fit(const std::vector<TPoint<fpt, dim>>& points) { return mbs(points); }
+	static fpt surface_area(const TSphere<fpt, dim>& sphere) { return fpt(4) * glm::pi<fpt>() * sphere.r * sphere.r; }
+	static Model triangulate(const TSphere<fpt, dim>& sphere) { return SphereGenerator({255, 0, 255}, 0).generate(sphere); }
+	static constexpr const char* name = "sphere";
+};
+
+template<typename fpt, std::size_t dim>
+struct BVTraits<TAABB<fpt, dim>> {
+	static TAABB<fpt, dim> fit(const TTriangle<fpt, dim>& triangle) { return aabb(triangle); }
+	static TAABB<fpt, dim> merge(const TAABB<fpt, dim>& a, const TAABB<fpt, dim>& b) { return ::lowpoly3d::merge(a, b); }
+	static TAABB<fpt, dim> fit(const std::vector<TPoint<fpt, dim>>& points) {
+		TAABB<fpt, dim> box(points.front(), points.front());
+		for(const auto& point : points) {
+			box.lower = glm::min(box.lower, point);
+			box.upper = glm::max(box.upper, point);
+		}
+		return box;
+	}
+	static fpt surface_area(const TAABB<fpt, dim>& box) { return box.surface_area(); }
+	static Model triangulate(const TAABB<fpt, dim>& box) { return CubeGenerator({255, 0, 255}).generate(box); }
+	static constexpr const char* name = "aabb";
+};
+
 // A binary bounding volume that holds indices to its children
 // If it is a leaf, then both left_idx and right_idx holds the index to its triangle
 template<typename BV>
@@ -44,53 +122,147 @@ public:
 	using value_type = TValue;
 	using bv_type = BinaryBV<value_type>;
 	using floating_point_type = typename TValue::floating_point_type;
+	using traits_type = BVTraits<value_type>;
 private:
 	std::vector<bv_type> bvs;
 	std::size_t depth = 0;
+	floating_point_type built_cost = 0;
+	BVHFitting fitting = BVHFitting::merge;
+
+	/* The nodes of the BVH. They are either the nodes of bvs or nodes that live in memory
+	 * kept alive by "owner", such as a mapped BVH cache file (see bvh_cache.hpp). */
+	std::span<const bv_type> nodes;
+	std::shared_ptr<const void> owner;
+
+	/* Makes the BVH hold its own copy of the nodes, so that they may be modified. Only functions
+	 * that write to the nodes, like refit(), call this. Every read goes through the nodes as they
+	 * are, which keeps a loaded BVH a view of its file and lets threads share it. */
+	void own() {
+		if(!owner) return;
+		bvs.assign(nodes.begin(), nodes.end());
+		nodes = bvs;
+		owner.reset();
+	}
+
+	static value_type fit(const Model& model, std::size_t triangle_idx) {
+		const auto& triangle = model.getTriangleIndices(triangle_idx);
+		return traits_type::fit(
+			TTriangle<floating_point_type, 3> {
+				model.vertices[triangle[0]],
+				model.vertices[triangle[1]],
+				model.vertices[triangle[2]]
+			});
+	}
 
 	// Returns an index into bvs of the most recently added BV
 	const std::size_t build(const Model& model, const std::vector<std::size_t>& indices, std::size_t depth) {
 		if(indices.size() == 1) {
 			// Extract triangle at the sole index
-			const auto& triangle = model.getTriangleIndices(indices.front());
-			bvs.emplace_back(mbs<typename bv_type::floating_point_type, bv_type::dimension>(
-				TTriangle<floating_point_type, 3> {
-					model.vertices[triangle[0]],
-					model.vertices[triangle[1]],
-					model.vertices[triangle[2]]
-				}), indices[0], indices[0], true);
+			bvs.emplace_back(fit(model, indices.front()), indices[0], indices[0], true);
 		} else {
 			// Split and recurse
 			const auto pair = split(model, indices);
 			std::size_t first_bv_index = 0, second_bv_index = 0;
 			first_bv_index = pair.first.size() != 0 ? build(model, pair.first, depth+1) : 0,
 			second_bv_index = pair.second.size() != 0 ? build(model, pair.second, depth+1) : 0;
-			const Sphere& bvl = bvs[first_bv_index];
-			const Sphere& bvr = bvs[second_bv_index];
-			const Sphere bv = mbs(bvl, bvr);
+			const value_type& bvl = bvs[first_bv_index];
+			const value_type& bvr = bvs[second_bv_index];
+			const value_type bv = traits_type::merge(bvl, bvr);
 			bvs.emplace_back(bv, first_bv_index, second_bv_index, false);
 		}
 		this->depth = std::max(this->depth, depth);
-		return size()-1;
+		return bvs.size()-1;
+	}
+
+	// Fits the BV of every internal node to the vertices of the triangles of its subtree
+	void fit_to_vertices(const Model& model) {
+		std::vector<std::size_t> stack, vertex_indices;
+		std::vector<TPoint<floating_point_type, 3>> points;
+		for(bv_type& bv : bvs) {
+			if(bv.is_leaf) continue;
+			vertex_indices.clear();
+			stack.assign({bv.left_idx, bv.right_idx});
+			while(!stack.empty()) {
+				const bv_type& node = bvs[stack.back()];
+				stack.pop_back();
+				if(node.is_leaf) {
+					const auto& triangle = model.getTriangleIndices(node.left_idx);
+					vertex_indices.insert(vertex_indices.end(), {triangle[0], triangle[1], triangle[2]});
+				} else {
+					stack.insert(stack.end(), {node.left_idx, node.right_idx});
+				}
+			}
+			// Triangles share vertices, which need only be fitted once
+			std::sort(vertex_indices.begin(), vertex_indices.end());
+			vertex_indices.erase(std::unique(vertex_indices.begin(), vertex_indices.end()), vertex_indices.end());
+			points.clear();
+			for(std::size_t vertex_idx : vertex_indices) {
+				points.push_back(model.vertices[vertex_idx]);
+			}
+			value_type& volume = bv;
+			volume = traits_type::fit(points);
+		}
+	}
+
+	// Fits bounding volumes to a prebuilt topology. Post-order guarantees that
+	// both children of a node have been fitted before the node itself.
+	void build(const Model& model, const BVHTopology& topology) {
+		bvs.reserve(topology.nodes.size());
+		for(const auto& node : topology.nodes) {
+			if(node.is_leaf) {
+				bvs.emplace_back(fit(model, node.left_idx), node.left_idx, node.right_idx, true);
+			} else {
+				const value_type bv = traits_type::merge(
+					static_cast<const value_type&>(bvs[node.left_idx]),
+					static_cast<const value_type&>(bvs[node.right_idx]));
+				bvs.emplace_back(bv, node.left_idx, node.right_idx, false);
+			}
+		}
+		depth = topology.depth;
 	}
 
 public:
-	BVH(const Model& model) {
-		std::vector<std::size_t> indices(model.getNumTriangles());
-		std::iota(indices.begin(), indices.end(), 0);
-		if(model.getNumTriangles() > 0 && model.getNumVertices() > 2) {
+	BVH(const Model& model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah, BVHFitting fitting = BVHFitting::merge) :
+		fitting(fitting) {
+		if(model.getNumTriangles() == 0 || model.getNumVertices() <= 2) return;
+
+		if(strategy == BVHBuildStrategy::binned_sah) {
+			build(model, build_binned_sah(model));
+		} else {
+			std::vector<std::size_t> indices(model.getNumTriangles());
+			std::iota(indices.begin(), indices.end(), 0);
 			build(model, indices, 1);
 		}
+		if(fitting == BVHFitting::vertices) fit_to_vertices(model);
+		nodes = bvs;
+		built_cost = cost();
 	}
 
-	BVH(const BVH& bvh) : bvs(bvh.bvs), depth(bvh.depth) { }
-	BVH(BVH&& bvh) : bvs(std::move(bvh.bvs)), depth(std::move(bvh.depth)) { }
+	/* Views "nodes" without copying them. The nodes must form a BVH as built by the other
+	 * constructor with "fitting" and stay valid for as long as "owner" (or a copy of this BVH)
+	 * is alive. Anything that modifies the BVH, such as refit(), first copies the nodes. */
+	BVH(std::span<const bv_type> nodes, std::size_t depth, floating_point_type built_cost, BVHFitting fitting, std::shared_ptr<const void> owner) :
+		depth(depth), built_cost(built_cost), fitting(fitting), nodes(nodes), owner(std::move(owner)) { }
+
+	// An empty BVH
+	BVH() { }
+
+	BVH(const BVH& bvh) : bvs(bvh.bvs), depth(bvh.depth), built_cost(bvh.built_cost), fitting(bvh.fitting), owner(bvh.owner) {
+		nodes = owner ? bvh.nodes : std::span<const bv_type>(bvs);
+	}
+	// Moving a vector keeps its buffer, so nodes stays valid
+	BVH(BVH&& bvh) : bvs(std::move(bvh.bvs)), depth(std::move(bvh.depth)), built_cost(bvh.built_cost), fitting(bvh.fitting),
+		nodes(std::exchange(bvh.nodes, {})), owner(std::move(bvh.owner)) { }
 
 	virtual ~BVH() { }
 
 	BVH& swap(BVH bvh) {
 		std::swap(bvs, bvh.bvs);
 		std::swap(depth, bvh.depth);
+		std::swap(built_cost, bvh.built_cost);
+		std::swap(fitting, bvh.fitting);
+		std::swap(nodes, bvh.nodes);
+		std::swap(owner, bvh.owner);
 		return *this;
 	}
 
@@ -101,40 +273,30 @@ public:
 	BVH& operator=(BVH&& bvh) {
 		bvs = std::move(bvh.bvs);
 		depth = std::move(bvh.depth);
+		built_cost = bvh.built_cost;
+		fitting = bvh.fitting;
+		nodes = std::exchange(bvh.nodes, {});
+		owner = std::move(bvh.owner);
 		return *this;
 	}
 
 	std::size_t root_idx() const {
-		assert(!bvs.empty());
+		assert(!nodes.empty());
 		return size()-1;
 	}
 
-	bv_type& root() {
-		return bvs[root_idx()];
-	}
-
 	const bv_type& root() const {
-		return bvs[root_idx()];
-	}
-
-	bv_type& left(const bv_type& parent) {
-		assert(!parent.is_leaf);
-		return bvs[parent.left_idx];
-	}
-
-	bv_type& right(const bv_type& parent) {
-		assert(!parent.is_leaf);
-		return bvs[parent.right_idx];
+		return nodes[root_idx()];
 	}
 
 	const bv_type& left(const bv_type& parent) const {
 		assert(!parent.is_leaf);
-		return bvs[parent.left_idx];
+		return nodes[parent.left_idx];
 	}
 
 	const bv_type& right(const bv_type& parent) const {
 		assert(!parent.is_leaf);
-		return bvs[parent.right_idx];
+		return nodes[parent.right_idx];
 	}
 
 	// Returns how well balanced the BVH is, i.e. 1.0f if it is perfectly balanced or 0.0f if close to a linked list
@@ -148,7 +310,7 @@ public:
 		    0 0
 		Figure 1: A tree close to a linked list */
 	float balance() const {
-		if(bvs.empty()) return 0.0f;
+		if(nodes.empty()) return 0.0f;
 		if(size() == 1) return 1.0f;
 		const std::size_t worst_depth = (size()+1)/2;
 		const std::size_t best_depth = std::log2(size())+1;
@@ -158,29 +320,85 @@ public:
 		return 1.0f - numerator / denominator;
 	}
 
-	bv_type& operator[](std::size_t idx) {
-		assert(idx < size());
-		return bvs[idx];
+	/* Returns the surface area heuristic cost of the BVH, i.e. the sum of the surface areas
+	 * of all BVs relative to the root. It is proportional to the expected number of BVs that
+	 * a random ray visits, and does not change when the whole model is moved or scaled. */
+	floating_point_type cost() const {
+		if(nodes.empty()) return 0;
+		const floating_point_type root_area = traits_type::surface_area(root());
+		if(root_area <= 0) return 0;
+		floating_point_type area = 0;
+		for(const value_type& bv : nodes) {
+			area += traits_type::surface_area(bv);
 		}
+		return area / root_area;
+	}
+
+	/* Returns the cost of the BVH relative to its cost when it was built. Refitting a deformed
+	 * model makes this grow as the topology fits the new shape worse, once it is well above
+	 * 1.0 it is worth rebuilding the BVH. */
+	floating_point_type degradation() const {
+		return built_cost > 0 ? cost() / built_cost : floating_point_type(1);
+	}
+
+	// Returns cost() as it was when the BVH was built
+	floating_point_type getBuiltCost() const {
+		return built_cost;
+	}
+
+	/* Fits all BVs to the current vertices of model, bottom-up, without changing the topology.
+	 * Model must have the same triangles as the model that the BVH was built over, only its
+	 * vertices may have moved. Internal nodes are fitted as the BVH was built, which takes O(n)
+	 * for BVHFitting::merge. BVHFitting::vertices fits every node to all vertices beneath it,
+	 * which takes O(n log^2 n) for a balanced BVH. Returns degradation() afterwards. */
+	floating_point_type refit(const Model& model) {
+		own();
+		// Children precede their parents, so a single pass fits every node after its children
+		for(bv_type& bv : bvs) {
+			value_type& volume = bv;
+			if(bv.is_leaf) {
+				volume = fit(model, bv.left_idx);
+			} else {
+				volume = traits_type::merge(bvs[bv.left_idx], bvs[bv.right_idx]);
+			}
+		}
+		if(fitting == BVHFitting::vertices) fit_to_vertices(model);
+		return degradation();
+	}
+
 	const bv_type& operator[](std::size_t idx) const {
 		assert(idx < size());
-		return bvs[idx];
+		return nodes[idx];
 		}
 
-	const std::vector<bv_type>& getBVs() const {
-		return bvs;
+	std::span<const bv_type> getBVs() const {
+		return nodes;
+	}
+
+	// Returns true if the nodes are viewed rather than owned, see the constructor that takes an owner
+	bool is_view() const {
+		return owner != nullptr;
 	}
 
 	std::size_t size() const {
-		return bvs.size();
+		return nodes.size();
 		}
 
-	// Assumes that BVs are spheres and creates a single model that represents this BVH geometry
+	// Returns how the BVs of internal nodes were fitted when the BVH was built
+	BVHFitting getFitting() const {
+		return fitting;
+	}
+
+	// Returns the number of nodes on the longest path from the root to a leaf
+	std::size_t getDepth() const {
+		return depth;
+	}
+
+	// Creates a single model that represents this BVH geometry
 	Model triangulate() const {
 		Model ret;
-		SphereGenerator sg({255, 0, 255}, 0);
-		for(const Sphere& sphere : bvs) {
-			ret.append(sg.generate(sphere));
+		for(const value_type& bv : nodes) {
+			ret.append(traits_type::triangulate(bv));
 		}
 		return ret;
 	}
@@ -190,7 +408,7 @@ public:
 		const std::function<void(const BVH<value_type>&, const std::size_t&)>& unaryNodeFunction,
 		const std::size_t& idx) const {
 
-		const bv_type& current = bvs[idx];
+		const bv_type& current = nodes[idx];
 		unaryNodeFunction(*this, idx);
 		if(current.is_leaf) return;
 		depthfirst(unaryNodeFunction, current.left_idx);
@@ -201,7 +419,7 @@ public:
 		const std::function<void(const BVH<value_type>&, const std::size_t&)>& unaryNodeFunction,
 		const std::size_t& idx) const {
 		
-		const bv_type& current = bvs[idx];
+		const bv_type& current = nodes[idx];
 		if(current.is_leaf) return;
 		unaryNodeFunction(*this, idx);
 		depthfirstExceptLeaves(unaryNodeFunction, current.left_idx);
@@ -210,17 +428,17 @@ public:
 
 	/* Returns true if predicate is true for all BVs */
 	bool all_of(std::function<bool(bv_type const&)> const& predicate) {
-		return std::all_of(bvs.begin(), bvs.end(), predicate);
+		return std::all_of(nodes.begin(), nodes.end(), predicate);
 	}
 
 	/* Returns true if predicate is true for any BV */
 	bool any_of(std::function<bool(bv_type const&)> const& predicate) {
-		return std::any_of(bvs.begin(), bvs.end(), predicate);
+		return std::any_of(nodes.begin(), nodes.end(), predicate);
 	}
 
 	/* Returns true if predicate is true for no BV */
 	bool none_of(std::function<bool(bv_type const&)> const& predicate) {
-		return std::none_of(bvs.begin(), bvs.end(), predicate);
+		return std::none_of(nodes.begin(), nodes.end(), predicate);
 	}
 
 	std::string dotgraph() const {
@@ -243,104 +461,372 @@ public:
 	}
 };
 
+namespace detail {
+
+// Returns triangle idx of model, throwing if there is no such triangle. Shared by the BVHs over models.
+template<typename fpt>
+TTriangle<fpt, 3> model_triangle(const Model& model, std::size_t idx) {
+	throw_no_such_triangle_if_geq(idx, model.triangleIndices.size());
+	auto const& vertices = model.vertices;
+	auto const& triangle = model.triangleIndices[idx];
+	return TTriangle<fpt, 3>(
+		vertices[triangle[0]],
+		vertices[triangle[1]],
+		vertices[triangle[2]]
+	);
+}
+
+// Returns the BV of the root of bvh, or a BV of the origin if bvh is empty. Shared by the BVHs that store their root BV.
+template<typename TValue>
+TValue root_or_origin(const BVH<TValue>& bvh) {
+	using point_type = TPoint<typename TValue::floating_point_type, 3>;
+	if(bvh.size() == 0) return BVTraits<TValue>::fit(std::vector<point_type>{point_type(0)});
+	return static_cast<const TValue&>(bvh.root());
+}
+
+} // End of namespace detail
+
 /** The Model class equipped with a BVH **/
-class BVHModel : public BVH<Sphere> {
+template<typename TValue>
+class TBVHModel : public BVH<TValue> {
 	const Model* model;
 public:
-	BVHModel(const Model* model) : BVH(*model), model(model) { }
+	using floating_point_type = typename BVH<TValue>::floating_point_type;
+
+	TBVHModel(const Model* model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah, BVHFitting fitting = BVHFitting::merge) :
+		BVH<TValue>(*model, strategy, fitting), model(model) { }
+
+	// Equips model with a BVH that was built over it elsewhere, e.g. loaded from a BVHCache
+	TBVHModel(const Model* model, BVH<TValue> bvh) :
+		BVH<TValue>(std::move(bvh)), model(model) { }
+
+	using BVH<TValue>::refit;
+
+	// Fits all BVs to the current vertices of the model, see BVH::refit
+	floating_point_type refit() {
+		return refit(*model);
+	}
 
 	TTriangle<floating_point_type, 3> getTriangle(std::size_t idx) const {
-		throw_no_such_triangle_if_geq(idx, model->triangleIndices.size());
-		auto const& vertices = model->vertices;
-		auto const& triangle = model->triangleIndices[idx];
-		return TTriangle<floating_point_type, 3>(
-			vertices[triangle[0]],
-			vertices[triangle[1]],
-			vertices[triangle[2]]
-		);
+		return detail::model_triangle<floating_point_type>(*model, idx);
 	}
 };
 
-// Traverses a BVTT by always splitting the largest BV node. Also traverses the child BVTT node with the smallest signed distance first
-bool collides_recursive(const BVHModel& a, const BVHModel& b, const glm::mat4& a_world, const glm::mat4& b_world, std::size_t a_idx, std::size_t b_idx) {
-
-	// If the two current bounding volumes are not colliding, then this execution path cannot collide
-	const auto bva = a[a_idx];
-	const auto bvb = b[b_idx];
-	// Radius on root for terrain is ~4.66 seems to small.
-	// Don't confuse this issue with earlier issue of small radius
-	// this issue has unknown cause!
-	if(!colliding(bva, bvb, a_world, b_world)) {
-		return false;
-	}
-
-	// Now we know that they are colliding --- so check if both are intermediate nodes
-	else if(!a[a_idx].is_leaf && !b[b_idx].is_leaf) {
-		// This is where I determine what BVTT to traverse
-		// I can chose between AX => BX + CX or AX => AY + AZ
-		// So check if size(A) > size(X), if so, chose AX => BX + CX.
-		// Otherwise, chose AX => AY + AZ
-		if(a[a_idx].size() > b[b_idx].size()) {
-			// AX => BX + CX is chosen!
-			// Now, we're looking for a collision, so assume that the likelihood for collision is higher the more two BVs penetrate...
-			// so descend upon BV-pair with smallest signed distance first (i.e. pair with most penetration depth)
-			if(signed_distance(a[a[a_idx].left_idx], b[b_idx], a_world, b_world) < signed_distance(a[a[a_idx].right_idx], b[b_idx], a_world, b_world)) {
-				// ||BX|| < ||CX|| so descend into BX before CX
-				return collides_recursive(a, b, a_world, b_world, a[a_idx].left_idx, b_idx) || collides_recursive(a, b, a_world, b_world, a[a_idx].right_idx, b_idx);
-			} else {
-				// ||BX|| >= ||CX|| so descend into CX before BX
-				return collides_recursive(a, b, a_world, b_world, a[a_idx].right_idx, b_idx) || collides_recursive(a, b, a_world, b_world, a[a_idx].left_idx, b_idx);
+using BVHModel = TBVHModel<Sphere>;
+using AABBBVHModel = TBVHModel<AABB>;
+
+namespace detail {
+
+// A node of the BVTT, i.e a pair of BVs of a and b, along with the BV of b[b_idx] in the modelspace of a
+template<typename TValue>
+struct BVTTNode {
+	std::size_t a_idx, b_idx;
+	TValue b_bv;
+};
+
+// Capacity of the allocation-free stack, BVTTs of deeper BVHs are traversed on a heap-allocated stack
+constexpr std::size_t bvtt_stack_capacity = 128;
+
+/* Pushes those of two BVTT nodes whose BVs overlap, given their signed distances,
+ * such that the node with the smallest signed distance is popped first */
+template<typename Stack, typename Node, typename fpt>
+void push_overlapping(Stack& stack, const Node& first, fpt first_distance, const Node& second, fpt second_distance) {
+	if(first_distance > second_distance) {
+		if(first_distance <= fpt(0)) stack.push_back(first);
+		if(second_distance <= fpt(0)) stack.push_back(second);
+	} else {
+		if(second_distance <= fpt(0)) stack.push_back(second);
+		if(first_distance <= fpt(0)) stack.push_back(first);
+	}
+}
+
+/* Calls f with an empty stack of Node that can hold "size" elements, which
+ * lives on the call stack unless it needs more than bvtt_stack_capacity elements */
+template<typename Node, typename F>
+auto with_stack(std::size_t size, F&& f) {
+	if(size <= bvtt_stack_capacity) {
+		FixedStack<Node, bvtt_stack_capacity> stack;
+		return f(stack);
+	}
+	std::vector<Node> stack;
+	stack.reserve(size);
+	return f(stack);
+}
+
+/* Calls f with an empty stack that can hold the BVTT of two BVHs whose depths sum to
+ * "depth". Every visited pair pushes at most two child pairs, one of which is visited
+ * next, so a BVTT stack never holds more pairs than the sum of the depths. */
+template<typename TValue, typename F>
+auto with_bvtt_stack(std::size_t depth, F&& f) {
+	return with_stack<BVTTNode<TValue>>(depth, std::forward<F>(f));
+}
+
+/* Traverses the BVTT of a and b depth-first on an explicit stack and calls
+ * leaf_function(a_triangle_idx, b_triangle_idx) for every pair of overlapping leaves.
+ * Returns true as soon as leaf_function does, false once the BVTT is exhausted.
+ * b_to_a takes b into the modelspace of a, so that only BVs of b ever need to be transformed.
+ * Always splits the largest BV of a pair and visits the child pair with the smallest
+ * signed distance (i.e. most penetration) first. A pair is only pushed if its BVs overlap. */
+template<typename TValue, typename Stack, typename LeafFunction>
+bool traverse_bvtt(const BVH<TValue>& a, const BVH<TValue>& b, const glm::mat4& b_to_a, Stack& stack, LeafFunction&& leaf_function) {
+	using node_type = BVTTNode<TValue>;
+
+	count_query();
+	count_bv_tests(1);
+	const TValue b_root = transform(b.root(), b_to_a);
+	if(signed_distance(a.root(), b_root) > 0) return false;
+	stack.push_back(node_type{a.root_idx(), b.root_idx(), b_root});
+
+	while(!stack.empty()) {
+		count_stack_depth(stack.size());
+		const node_type node = stack.back();
+		stack.pop_back();
+
+		const auto& bva = a[node.a_idx];
+		const auto& bvb = b[node.b_idx];
+
+		if(bva.is_leaf && bvb.is_leaf) {
+			// Leaves refer to their triangle by both left_idx and right_idx
+			count_triangle_test();
+			if(leaf_function(bva.left_idx, bvb.left_idx)) {
+				return true;
 			}
+		} else if(bvb.is_leaf || (!bva.is_leaf && bva.size() > node.b_bv.size())) {
+			const node_type left {bva.left_idx, node.b_idx, node.b_bv};
+			const node_type right {bva.right_idx, node.b_idx, node.b_bv};
+			count_bv_tests(2);
+			push_overlapping(stack,
+				left, signed_distance(a[bva.left_idx], node.b_bv),
+				right, signed_distance(a[bva.right_idx], node.b_bv));
 		} else {
-			// AX => AY + AZ is chosen!
-			// Now, we're looking for a collision, so assume that the likelihood for collision is higher the more two BVs penetrate...
-			// so descend upon BV-pair with smallest signed distance first (i.e. pair with most penetration depth)
-			if(signed_distance(a[a_idx], b[b[b_idx].left_idx]) < signed_distance(a[a_idx], b[b[b_idx].right_idx])) {
-				// ||AY|| < ||AZ|| so descend into AY before AZ
-				return collides_recursive(a, b, a_world, b_world, a_idx, b[b_idx].left_idx) || collides_recursive(a, b, a_world, b_world, a_idx, b[b_idx].right_idx);
-			} else {
-				// ||AY|| => ||AZ|| so descend into AZ before AY
-				return collides_recursive(a, b, a_world, b_world, a_idx, b[b_idx].right_idx) || collides_recursive(a, b, a_world, b_world, a_idx, b[b_idx].left_idx);
-			}
+			const node_type left {node.a_idx, bvb.left_idx, transform(b[bvb.left_idx], b_to_a)};
+			const node_type right {node.a_idx, bvb.right_idx, transform(b[bvb.right_idx], b_to_a)};
+			count_bv_tests(2);
+			push_overlapping(stack,
+				left, signed_distance(bva, left.b_bv),
+				right, signed_distance(bva, right.b_bv));
 		}
 	}
+	return false;
+}
+
+} // End of namespace detail
+
+// Returns true if any triangle of a intersects any triangle of b, once both are taken into world-space
+template<typename TValue>
+bool collides(const TBVHModel<TValue>& a, const TBVHModel<TValue>& b, const glm::mat4& a_world, const glm::mat4& b_world) {
+	if(a.size() == 0 || b.size() == 0) return false;
+	const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+
+	return detail::with_bvtt_stack<TValue>(a.getDepth() + b.getDepth(), [&](auto& stack) {
+		return detail::traverse_bvtt(a, b, b_to_a, stack, [&](std::size_t a_triangle_idx, std::size_t b_triangle_idx) {
+			return intersects(a.getTriangle(a_triangle_idx), b.getTriangle(b_triangle_idx).transform(b_to_a));
+		});
+	});
+}
+
+// A pair of triangle indices, the first into the model of one BVHModel and the second into the model of another
+using TrianglePair = std::pair<std::size_t, std::size_t>;
+
+/* Finds the pairs of intersecting triangles of a and b, once both are taken into world-space,
+ * and writes them into "pairs". The buffer is cleared first but keeps its capacity, so
+ * reusing it between queries avoids reallocations. At most "max_pairs" pairs are written,
+ * after which the traversal stops. Returns the number of pairs written. */
+template<typename TValue>
+std::size_t contacts(
+	const TBVHModel<TValue>& a,
+	const TBVHModel<TValue>& b,
+	const glm::mat4& a_world,
+	const glm::mat4& b_world,
+	std::vector<TrianglePair>& pairs,
+	std::size_t max_pairs = std::numeric_limits<std::size_t>::max()) {
+	pairs.clear();
+	if(a.size() == 0 || b.size() == 0 || max_pairs == 0) return 0;
+	const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+
+	detail::with_bvtt_stack<TValue>(a.getDepth() + b.getDepth(), [&](auto& stack) {
+		return detail::traverse_bvtt(a, b, b_to_a, stack, [&](std::size_t a_triangle_idx, std::size_t b_triangle_idx) {
+			if(intersects(a.getTriangle(a_triangle_idx), b.getTriangle(b_triangle_idx).transform(b_to_a))) {
+				pairs.emplace_back(a_triangle_idx, b_triangle_idx);
+			}
+			return pairs.size() >= max_pairs;
+		});
+	});
+	return pairs.size();
+}
+
+namespace detail {
+
+// A pair of nodes of the same BVH, or a node paired with itself
+struct SelfBVTTNode {
+	std::size_t a_idx, b_idx;
+};
 
-	// If a_idx is not leaf and b_idx is leaf, then we must decend into children of a
-	else if(!a[a_idx].is_leaf && b[b_idx].is_leaf) {
-		return collides_recursive(a, b, a_world, b_world, a[a_idx].left_idx, b_idx) || collides_recursive(a, b, a_world, b_world, a[a_idx].right_idx, b_idx);
+/* Returns true if a and b share a vertex. Compares positions rather than indices,
+ * since generators may give every triangle its own copy of a shared vertex. */
+template<typename fpt>
+bool share_vertex(const TTriangle<fpt, 3>& a, const TTriangle<fpt, 3>& b) {
+	for(std::size_t i = 0; i < 3; i++) {
+		if(a[i] == b[0] || a[i] == b[1] || a[i] == b[2]) return true;
 	}
+	return false;
+}
 
-	// If a_idx is leaf and b_idx is not leaf, then we must decend into children of b
-	else if(a[a_idx].is_leaf && !b[b_idx].is_leaf) {
-		return collides_recursive(a, b, a_world, b_world, a_idx, b[b_idx].left_idx) || collides_recursive(a, b, a_world, b_world, a_idx, b[b_idx].right_idx);
+/* Traverses the BVTT of bvh against itself and calls leaf_function(a_triangle_idx, b_triangle_idx)
+ * once for every unordered pair of distinct triangles whose leaves overlap. A node paired with
+ * itself is split into its two children paired with themselves and with each other, so no pair
+ * is visited twice. Returns true as soon as leaf_function does, false once the BVTT is exhausted. */
+template<typename TValue, typename Stack, typename LeafFunction>
+bool traverse_self_bvtt(const BVH<TValue>& bvh, Stack& stack, LeafFunction&& leaf_function) {
+	count_query();
+	stack.push_back(SelfBVTTNode{bvh.root_idx(), bvh.root_idx()});
+
+	while(!stack.empty()) {
+		count_stack_depth(stack.size());
+		const SelfBVTTNode node = stack.back();
+		stack.pop_back();
+
+		const auto& bva = bvh[node.a_idx];
+		const auto& bvb = bvh[node.b_idx];
+
+		if(node.a_idx == node.b_idx) {
+			if(!bva.is_leaf) {
+				stack.push_back(SelfBVTTNode{bva.left_idx, bva.left_idx});
+				stack.push_back(SelfBVTTNode{bva.right_idx, bva.right_idx});
+				count_bv_tests(1);
+				if(signed_distance(bvh[bva.left_idx], bvh[bva.right_idx]) <= 0) {
+					stack.push_back(SelfBVTTNode{bva.left_idx, bva.right_idx});
+				}
+			}
+		} else if(bva.is_leaf && bvb.is_leaf) {
+			count_triangle_test();
+			if(leaf_function(bva.left_idx, bvb.left_idx)) {
+				return true;
+			}
+		} else if(bvb.is_leaf || (!bva.is_leaf && bva.size() > bvb.size())) {
+			count_bv_tests(2);
+			const auto left_distance = signed_distance(bvh[bva.left_idx], bvb);
+			const auto right_distance = signed_distance(bvh[bva.right_idx], bvb);
+			push_overlapping(stack,
+				SelfBVTTNode{bva.left_idx, node.b_idx}, left_distance,
+				SelfBVTTNode{bva.right_idx, node.b_idx}, right_distance);
+		} else {
+			count_bv_tests(2);
+			const auto left_distance = signed_distance(bva, bvh[bvb.left_idx]);
+			const auto right_distance = signed_distance(bva, bvh[bvb.right_idx]);
+			push_overlapping(stack,
+				SelfBVTTNode{node.a_idx, bvb.left_idx}, left_distance,
+				SelfBVTTNode{node.a_idx, bvb.right_idx}, right_distance);
+		}
 	}
+	return false;
+}
+
+} // End of namespace detail
 
-	// Both are triangles so test triangles
-	else {
-		auto const& a_leaf = a[a_idx];
-		auto const& b_leaf = b[b_idx];
-		assert(a_leaf.is_leaf);
-		assert(b_leaf.is_leaf);
+/* Finds the pairs of intersecting triangles of a single model, such as a generated mesh
+ * that folds into itself, and writes them into "pairs" like contacts(), smallest triangle
+ * index first. Triangles that share a vertex are adjacent and never reported. Coplanar
+ * triangles that overlap, such as duplicated or folded faces, are reported like any other.
+ * Returns the number of pairs written. */
+template<typename TValue>
+std::size_t self_intersections(
+	const TBVHModel<TValue>& bvh,
+	std::vector<TrianglePair>& pairs,
+	std::size_t max_pairs = std::numeric_limits<std::size_t>::max()) {
+
+	pairs.clear();
+	if(bvh.size() == 0 || max_pairs == 0) return 0;
+
+	/* Every node paired with itself on the path down leaves at most two pairs on the stack,
+	 * and the pairs of distinct nodes below it need no more than a BVTT stack */
+	detail::with_stack<detail::SelfBVTTNode>(4 * bvh.getDepth() + 1, [&](auto& stack) {
+		return detail::traverse_self_bvtt(bvh, stack, [&](std::size_t a_triangle_idx, std::size_t b_triangle_idx) {
+			const auto a = bvh.getTriangle(a_triangle_idx);
+			const auto b = bvh.getTriangle(b_triangle_idx);
+			if(!detail::share_vertex(a, b) && intersects(a, b)) {
+				pairs.emplace_back(std::min(a_triangle_idx, b_triangle_idx), std::max(a_triangle_idx, b_triangle_idx));
+			}
+			return pairs.size() >= max_pairs;
+		});
+	});
+	return pairs.size();
+}
 
-		auto const a_triangle_idx = a_leaf.left_idx;
-		auto const b_triangle_idx = b_leaf.left_idx;
-		// It should not matter if we take left or right idx on BV-leaves,
-		// since either idx on BV-leaves should point to the same triangle
-		// by construction
-		assert(a_triangle_idx == a_leaf.right_idx);
-		assert(b_triangle_idx == b_leaf.right_idx);
+/* The contact of a pair of intersecting triangles of two BVHModels, in world-space. The
+ * triangles intersect along the segment from start to end. Pushing the triangle of b
+ * "penetration" units along "normal" separates it from the triangle of a. */
+template<typename fpt>
+struct TContact {
+	std::size_t a_triangle_idx, b_triangle_idx;
+	TPoint<fpt, 3> start, end;
+	glm::vec<3, fpt> normal;
+	fpt penetration;
+};
 
-		auto const a_triangle_in_model = a.getTriangle(a_triangle_idx);
-		auto const b_triangle_in_model = b.getTriangle(b_triangle_idx);
-		auto const a_triangle_in_world = a_triangle_in_model.transform(a_world);
-		auto const b_triangle_in_world = b_triangle_in_model.transform(b_world);
-		return intersects(a_triangle_in_world, b_triangle_in_world);
+using Contact = TContact<float>;
+
+namespace detail {
+
+/* Estimates how far the intersecting triangle b must move to separate it from a, as the
+ * smaller of how deep b reaches below the plane of a and how deep a reaches below the plane
+ * of b. Writes the direction in which to move b to normal and returns the distance. */
+template<typename fpt>
+fpt penetration(const TTriangle<fpt, 3>& a, const TTriangle<fpt, 3>& b, glm::vec<3, fpt>& normal) {
+	const glm::vec<3, fpt> a_normal = ::lowpoly3d::normal(a);
+	const glm::vec<3, fpt> b_normal = ::lowpoly3d::normal(b);
+	fpt b_depth = fpt(0), a_depth = fpt(0);
+	for(std::size_t i = 0; i < 3; i++) {
+		b_depth = std::max(b_depth, -glm::dot(a_normal, b[i] - a.p1));
+		a_depth = std::max(a_depth, -glm::dot(b_normal, a[i] - b.p1));
 	}
+	normal = b_depth <= a_depth ? a_normal : -b_normal;
+	return std::min(b_depth, a_depth);
 }
 
-// Take both BVHs into world-space 
-bool collides(const BVHModel& a, const BVHModel& b, const glm::mat4& a_world, const glm::mat4& b_world) {
-	return collides_recursive(a, b, a_world, b_world, a.size()-1, b.size()-1);
+} // End of namespace detail
+
+/* Finds the contacts of the intersecting triangles of a and b, once both are taken into
+ * world-space, and writes them into "contacts" like contacts() writes pairs. Coplanar pairs
+ * of triangles, which overlap in an area rather than along a segment, have no contact.
+ * a_world may translate, rotate and scale uniformly, b_world may be any affine transformation.
+ * Returns the number of contacts written. */
+template<typename TValue>
+std::size_t contact_manifold(
+	const TBVHModel<TValue>& a,
+	const TBVHModel<TValue>& b,
+	const glm::mat4& a_world,
+	const glm::mat4& b_world,
+	std::vector<TContact<typename TValue::floating_point_type>>& contacts,
+	std::size_t max_contacts = std::numeric_limits<std::size_t>::max()) {
+	using fpt = typename TValue::floating_point_type;
+	using vec_type = glm::vec<3, fpt>;
+
+	contacts.clear();
+	if(a.size() == 0 || b.size() == 0 || max_contacts == 0) return 0;
+	const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+	const fpt scale = glm::length(vec_type(a_world[0]));
+
+	detail::with_bvtt_stack<TValue>(a.getDepth() + b.getDepth(), [&](auto& stack) {
+		return detail::traverse_bvtt(a, b, b_to_a, stack, [&](std::size_t a_triangle_idx, std::size_t b_triangle_idx) {
+			const auto a_triangle = a.getTriangle(a_triangle_idx);
+			const auto b_triangle = b.getTriangle(b_triangle_idx).transform(b_to_a);
+			TPoint<fpt, 3> start, end;
+			if(intersection(a_triangle, b_triangle, start, end)) {
+				vec_type normal;
+				const fpt depth = detail::penetration(a_triangle, b_triangle, normal);
+				contacts.push_back(TContact<fpt>{
+					a_triangle_idx,
+					b_triangle_idx,
+					vec_type(a_world * glm::vec4(start, 1.0f)),
+					vec_type(a_world * glm::vec4(end, 1.0f)),
+					glm::normalize(vec_type(a_world * glm::vec4(normal, 0.0f))),
+					depth * scale});
+			}
+			return contacts.size() >= max_contacts;
+		});
+	});
+	return contacts.size();
 }
 
 struct CollisionData {
@@ -349,7 +835,7 @@ struct CollisionData {
 	CollisionData(const BVHModel* model, const glm::mat4* matrix) : model(model), matrix(matrix) { }
 };
 
-bool collides(const CollisionData& a, const CollisionData& b) {
+inline bool collides(const CollisionData& a, const CollisionData& b) {
 	return collides(*a.model, *b.model, *a.matrix, *b.matrix);
 }
 
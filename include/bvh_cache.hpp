@@ -0,0 +1,132 @@
+#ifndef BVH_CACHE_HPP
+#define BVH_CACHE_HPP
+
+#include <cstdint> // std::uint32_t, std::uint64_t
+#include <filesystem>
+#include <memory> // std::shared_ptr
+#include <span>
+#include <string_view>
+#include <type_traits> // std::is_trivially_copyable_v
+
+#include "bounding_volume_hierarchy.hpp"
+#include "model.hpp"
+#include "utils/mapped_file.hpp"
+
+namespace lowpoly3d {
+
+/* The header of a BVH cache file. It is followed by num_nodes nodes of node_size bytes
+ * each, exactly as they are laid out in memory, such that a mapped file can be used as
+ * the nodes of a BVH as is. Files written by builds that lay out nodes differently are
+ * rejected by their node size or byte order. */
+struct BVHCacheHeader {
+	static constexpr char magic_string[8] = "LP3DBVH";
+	static constexpr std::uint32_t current_version = 2;
+	static constexpr std::uint32_t byte_order_mark = 0x01020304;
+
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byte_order;
+	std::uint64_t key;
+	std::uint64_t node_size;
+	std::uint64_t num_nodes;
+	std::uint64_t depth;
+	double built_cost;
+	std::uint32_t fitting; // A BVHFitting
+	std::uint32_t reserved;
+};
+static_assert(sizeof(BVHCacheHeader) == 64, "Nodes must start at a well-aligned offset of a BVH cache file");
+
+/* A directory of BVHs that have been built before, keyed by a hash of the vertices and
+ * triangle indices of the model they were built over. Models from deterministic generators
+ * come out the same on every run, so their BVHs need only be built once. A cached BVH
+ * is loaded by mapping its file and viewing the nodes in place, nothing is copied. */
+class BVHCache {
+	std::filesystem::path directory;
+
+	static std::uint64_t key(std::uint64_t content, std::string_view bv_name, std::size_t node_size, BVHBuildStrategy strategy, BVHFitting fitting);
+
+	// Maps the file of key, or returns nullptr unless it is a cache file of nodes of node_size bytes
+	std::shared_ptr<const MappedFile> map(std::uint64_t key, std::size_t node_size) const;
+
+	// Writes header followed by its nodes to the file of header.key, returns true on success
+	bool write(const BVHCacheHeader& header, const void* nodes) const;
+
+public:
+	explicit BVHCache(std::filesystem::path directory);
+
+	const std::filesystem::path& getDirectory() const;
+
+	// Returns the key of the BVH that strategy builds over model with fitting
+	template<typename TValue>
+	static std::uint64_t key(const Model& model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah, BVHFitting fitting = BVHFitting::merge) {
+		return key(content_hash(model), BVTraits<TValue>::name, sizeof(typename BVH<TValue>::bv_type), strategy, fitting);
+	}
+
+	// Returns the path of the file that holds the BVH of key
+	std::filesystem::path path(std::uint64_t key) const;
+
+	/* Replaces bvh with a view of the cached BVH that strategy built over model with fitting, if
+	 * there is one. Returns false if there is none or if its file is not valid. */
+	template<typename TValue>
+	bool load(const Model& model, BVH<TValue>& bvh, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah,
+		BVHFitting fitting = BVHFitting::merge) const {
+		using bv_type = typename BVH<TValue>::bv_type;
+		static_assert(std::is_trivially_copyable_v<bv_type>);
+		static_assert(sizeof(BVHCacheHeader) % alignof(bv_type) == 0);
+
+		const auto file = map(key<TValue>(model, strategy, fitting), sizeof(bv_type));
+		if(!file) return false;
+
+		const auto& header = *reinterpret_cast<const BVHCacheHeader*>(file->data());
+		if(header.fitting != static_cast<std::uint32_t>(fitting)) return false;
+		const std::span<const bv_type> nodes(
+			reinterpret_cast<const bv_type*>(file->data() + sizeof(BVHCacheHeader)), header.num_nodes);
+
+		// Children precede their parents and leaves refer to triangles of model
+		for(std::size_t i = 0; i < nodes.size(); i++) {
+			const bv_type& node = nodes[i];
+			const bool valid = node.is_leaf ?
+				node.left_idx == node.right_idx && node.left_idx < model.getNumTriangles() :
+				node.left_idx < i && node.right_idx < i;
+			if(!valid) return false;
+		}
+
+		bvh.swap(BVH<TValue>(nodes, header.depth, static_cast<typename BVH<TValue>::floating_point_type>(header.built_cost), fitting, file));
+		return true;
+	}
+
+	// Writes bvh, which strategy built over model, to the cache along with its fitting. Returns true on success.
+	template<typename TValue>
+	bool store(const Model& model, const BVH<TValue>& bvh, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah) const {
+		using bv_type = typename BVH<TValue>::bv_type;
+		static_assert(std::is_trivially_copyable_v<bv_type>);
+
+		BVHCacheHeader header {};
+		std::copy(std::begin(BVHCacheHeader::magic_string), std::end(BVHCacheHeader::magic_string), header.magic);
+		header.version = BVHCacheHeader::current_version;
+		header.byte_order = BVHCacheHeader::byte_order_mark;
+		header.key = key<TValue>(model, strategy, bvh.getFitting());
+		header.node_size = sizeof(bv_type);
+		header.num_nodes = bvh.size();
+		header.depth = bvh.getDepth();
+		header.built_cost = bvh.getBuiltCost();
+		header.fitting = static_cast<std::uint32_t>(bvh.getFitting());
+		return write(header, bvh.getBVs().data());
+	}
+
+	/* Returns the cached BVH of model, or builds it with strategy and fitting and caches it if
+	 * there is none. Failing to write the cache is not an error, the BVH is returned anyway. */
+	template<typename TValue>
+	BVH<TValue> get(const Model& model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah,
+		BVHFitting fitting = BVHFitting::merge) const {
+		BVH<TValue> cached;
+		if(load(model, cached, strategy, fitting)) return cached;
+		BVH<TValue> bvh(model, strategy, fitting);
+		store(model, bvh, strategy);
+		return bvh;
+	}
+};
+
+} // End of namespace lowpoly3d
+
+#endif // BVH_CACHE_HPP
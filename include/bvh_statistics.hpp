@@ -0,0 +1,127 @@
+#ifndef BVH_STATISTICS_HPP
+#define BVH_STATISTICS_HPP
+
+#include <chrono>
+#include <cmath> // std::abs
+#include <cstddef> // std::size_t
+#include <string>
+#include <utility> // std::pair
+#include <vector>
+
+#include <glm/gtc/constants.hpp> // glm::pi
+
+#include "bounding_volume_hierarchy.hpp"
+#include "model.hpp"
+#include "utils/query_statistics.hpp"
+
+namespace lowpoly3d {
+
+/* Measures of how well a BVH is built, to compare BVH builders by more than balance().
+ * Every measure except build_seconds is unaffected by moving or scaling the model. */
+struct BVHStatistics {
+	std::string bv_name;
+	std::size_t num_nodes = 0;
+	std::size_t num_leaves = 0;
+	std::size_t depth = 0;
+
+	// Seconds it took to build the BVH, only measured by build_statistics()
+	double build_seconds = 0.0;
+
+	// The surface area heuristic cost of the BVH, see BVH::cost()
+	double sah_cost = 0.0;
+
+	/* The sum over all internal nodes of the volume in which their two children overlap,
+	 * relative to the volume of the root. Overlapping siblings are both visited by any
+	 * query that reaches into their overlap. */
+	double sibling_overlap = 0.0;
+
+	// leaves_per_depth[i] is the number of leaves i levels below the root
+	std::vector<std::size_t> leaves_per_depth;
+};
+
+namespace detail {
+
+template<typename fpt>
+fpt volume(const TSphere<fpt, 3>& sphere) {
+	return fpt(4) / fpt(3) * glm::pi<fpt>() * sphere.r * sphere.r * sphere.r;
+}
+
+template<typename fpt>
+fpt volume(const TAABB<fpt, 3>& box) {
+	const auto extent = box.upper - box.lower;
+	return extent.x * extent.y * extent.z;
+}
+
+// Returns the volume of the lens in which two spheres overlap
+template<typename fpt>
+fpt overlap_volume(const TSphere<fpt, 3>& a, const TSphere<fpt, 3>& b) {
+	const fpt d = glm::distance(a.p, b.p);
+	if(d >= a.r + b.r) return fpt(0);
+	if(d <= std::abs(a.r - b.r)) return volume(a.r < b.r ? a : b);
+	const fpt sum = a.r + b.r, difference = a.r - b.r;
+	return glm::pi<fpt>() * (sum - d) * (sum - d) * (d * d + fpt(2) * d * sum - fpt(3) * difference * difference) / (fpt(12) * d);
+}
+
+// Returns the volume of the box in which two boxes overlap
+template<typename fpt>
+fpt overlap_volume(const TAABB<fpt, 3>& a, const TAABB<fpt, 3>& b) {
+	const auto extent = glm::max(glm::min(a.upper, b.upper) - glm::max(a.lower, b.lower), glm::vec<3, fpt>(fpt(0)));
+	return extent.x * extent.y * extent.z;
+}
+
+} // End of namespace detail
+
+// Measures the quality of bvh
+template<typename TValue>
+BVHStatistics statistics(const BVH<TValue>& bvh) {
+	BVHStatistics result;
+	result.bv_name = BVTraits<TValue>::name;
+	result.num_nodes = bvh.size();
+	result.depth = bvh.getDepth();
+	result.sah_cost = bvh.cost();
+	if(bvh.size() == 0) return result;
+
+	const double root_volume = detail::volume(static_cast<const TValue&>(bvh.root()));
+	double overlap = 0.0;
+	std::vector<std::pair<std::size_t, std::size_t>> stack {{bvh.root_idx(), 0}};
+	while(!stack.empty()) {
+		const auto [idx, level] = stack.back();
+		stack.pop_back();
+
+		const auto& bv = bvh[idx];
+		if(bv.is_leaf) {
+			if(result.leaves_per_depth.size() <= level) result.leaves_per_depth.resize(level + 1, 0);
+			result.leaves_per_depth[level]++;
+			result.num_leaves++;
+		} else {
+			overlap += detail::overlap_volume(
+				static_cast<const TValue&>(bvh.left(bv)),
+				static_cast<const TValue&>(bvh.right(bv)));
+			stack.emplace_back(bv.left_idx, level + 1);
+			stack.emplace_back(bv.right_idx, level + 1);
+		}
+	}
+	result.sibling_overlap = root_volume > 0.0 ? overlap / root_volume : 0.0;
+	return result;
+}
+
+// Builds a BVH over model like its constructor does, and measures the time it took and its quality
+template<typename TValue>
+BVHStatistics build_statistics(const Model& model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah) {
+	const auto start = std::chrono::steady_clock::now();
+	const BVH<TValue> bvh(model, strategy);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	BVHStatistics result = statistics(bvh);
+	result.build_seconds = elapsed.count();
+	return result;
+}
+
+/* Writes statistics as JSON objects with one member per line, in a fixed order,
+ * such that the output of two builds can be compared with diff */
+std::string to_json(const BVHStatistics& statistics);
+std::string to_json(const QueryStatistics& statistics);
+
+} // End of namespace lowpoly3d
+
+#endif // BVH_STATISTICS_HPP
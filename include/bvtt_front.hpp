@@ -0,0 +1,247 @@
+#ifndef BVTT_FRONT_HPP
+#define BVTT_FRONT_HPP
+
+#include <algorithm> // std::max
+#include <cstdint> // std::uint32_t
+#include <limits>
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+
+namespace lowpoly3d {
+
+/* A collision query between two BVHModels that remembers where its BVTT traversal stopped,
+ * for pairs of objects that are tested every frame and move little between frames.
+ *
+ * The traversed part of the BVTT is kept as a tree of node pairs, whose leaves are the front:
+ * pairs whose BVs were apart, and pairs of leaves whose triangles were tested. collides()
+ * starts from the front instead of the roots. Front pairs whose BVs came to overlap are split
+ * further, and two pairs whose BVs are apart are merged back into their parent if its BVs are apart too.
+ * The pair of triangles that intersected last is tested first, so a resting contact costs
+ * a single BV test and a single triangle test per frame for as long as those triangles keep intersecting.
+ *
+ * Once intersecting triangles are found the rest of the front is kept as it is, so the front may
+ * hold overlapping pairs that a later query splits if it has to. A query that reports a miss has
+ * gone through the whole front, which is where it saves work over ::collides() when little moved.
+ * The BVHs may be refit between queries, but reset() must be called if either is rebuilt. */
+template<typename TValue>
+class TBVTTFront {
+	static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+	/* A pair of the BVTT. Children are allocated two at a time, so the second child is children + 1.
+	 * apart_in is the last query that found the BVs of the pair apart. */
+	struct Node {
+		std::uint32_t a_idx, b_idx;
+		std::uint32_t parent;
+		std::uint32_t children;
+		std::uint32_t apart_in;
+		bool alive;
+	};
+
+	const TBVHModel<TValue>* a;
+	const TBVHModel<TValue>* b;
+	std::vector<Node> nodes;
+	std::vector<std::uint32_t> front, next_front, stack;
+	std::vector<std::uint32_t> free_children, freed_children;
+	std::uint32_t last_hit = none;
+	std::uint32_t query = 0;
+
+	/* The BVs of b transformed into the space of a in this query, in a hash table with linear probing
+	 * whose size is a power of two. Entries of earlier queries are empty slots, so the table is emptied
+	 * by counting the query and holds about as many entries as there are BVs of b near the front. */
+	struct Transformed {
+		std::uint32_t b_idx, transformed_in;
+		TValue bv;
+	};
+	std::vector<Transformed> b_in_a;
+	std::size_t transformed_count = 0;
+
+	std::uint32_t allocate_children() {
+		if(!free_children.empty()) {
+			const std::uint32_t children = free_children.back();
+			free_children.pop_back();
+			return children;
+		}
+		nodes.resize(nodes.size() + 2);
+		return static_cast<std::uint32_t>(nodes.size() - 2);
+	}
+
+	// Returns the slot of b_idx in the table, or the empty slot where it belongs
+	Transformed& slot(std::uint32_t b_idx) {
+		const std::size_t mask = b_in_a.size() - 1;
+		for(std::size_t i = b_idx & mask;; i = (i + 1) & mask) {
+			if(b_in_a[i].transformed_in != query || b_in_a[i].b_idx == b_idx) return b_in_a[i];
+		}
+	}
+
+	// Doubles the table, keeping the entries of this query
+	void grow() {
+		std::vector<Transformed> old(std::max<std::size_t>(16, 2 * b_in_a.size()), Transformed{none, none, b->root()});
+		old.swap(b_in_a);
+		for(const Transformed& entry : old) {
+			if(entry.transformed_in == query) slot(entry.b_idx) = entry;
+		}
+	}
+
+	// Returns the BV of b at b_idx in the space of a, transforming it once per query
+	const TValue& transformed(std::uint32_t b_idx, const glm::mat4& b_to_a) {
+		// Keep the table at most half full so that probes stay short
+		if(2 * (transformed_count + 1) > b_in_a.size()) grow();
+		Transformed& entry = slot(b_idx);
+		if(entry.transformed_in != query) {
+			entry = Transformed{b_idx, query, transform(static_cast<const TValue&>((*b)[b_idx]), b_to_a)};
+			transformed_count++;
+		}
+		return entry.bv;
+	}
+
+	// Returns true if the BVs of the pair are apart, given the transform from b to a
+	bool apart(const Node& node, const glm::mat4& b_to_a) {
+		detail::count_bv_tests(1);
+		return signed_distance(static_cast<const TValue&>((*a)[node.a_idx]), transformed(node.b_idx, b_to_a)) > 0;
+	}
+
+	bool triangles_intersect(const Node& node, const glm::mat4& b_to_a) const {
+		detail::count_triangle_test();
+		return intersects(a->getTriangle((*a)[node.a_idx].left_idx), b->getTriangle((*b)[node.b_idx].left_idx).transform(b_to_a));
+	}
+
+	/* Splits the overlapping pair at nodes[idx] like traverse_bvtt() would, and keeps splitting
+	 * its descendants until they are apart or pairs of leaves, or until intersecting triangles
+	 * are found. Every pair it stops at is added to next_front. Returns true once a pair of
+	 * leaves whose triangles intersect has been found. */
+	bool split(std::uint32_t idx, const glm::mat4& b_to_a, bool found) {
+		stack.push_back(idx);
+		while(!stack.empty()) {
+			const std::uint32_t node_idx = stack.back();
+			stack.pop_back();
+			// The front may hold overlapping pairs, which the next query that needs to will split
+			if(found) {
+				next_front.push_back(node_idx);
+				continue;
+			}
+			const Node node = nodes[node_idx];
+			const auto& bva = (*a)[node.a_idx];
+			const auto& bvb = (*b)[node.b_idx];
+
+			if(bva.is_leaf && bvb.is_leaf) {
+				next_front.push_back(node_idx);
+				if(triangles_intersect(node, b_to_a)) {
+					found = true;
+					last_hit = node_idx;
+				}
+				continue;
+			}
+
+			const std::uint32_t children = allocate_children();
+			if(bvb.is_leaf || (!bva.is_leaf && bva.size() > transformed(node.b_idx, b_to_a).size())) {
+				nodes[children] = Node{static_cast<std::uint32_t>(bva.left_idx), node.b_idx, node_idx, none, none, true};
+				nodes[children + 1] = Node{static_cast<std::uint32_t>(bva.right_idx), node.b_idx, node_idx, none, none, true};
+			} else {
+				nodes[children] = Node{node.a_idx, static_cast<std::uint32_t>(bvb.left_idx), node_idx, none, none, true};
+				nodes[children + 1] = Node{node.a_idx, static_cast<std::uint32_t>(bvb.right_idx), node_idx, none, none, true};
+			}
+			nodes[node_idx].children = children;
+
+			for(std::uint32_t child = children; child < children + 2; child++) {
+				if(apart(nodes[child], b_to_a)) {
+					nodes[child].apart_in = query;
+					next_front.push_back(child);
+				} else {
+					stack.push_back(child);
+				}
+			}
+		}
+		return found;
+	}
+
+	/* Merges the pair at nodes[idx], whose BVs are apart, into its parent for as long as the
+	 * other child of the parent has been found apart in this query and the BVs of the parent
+	 * are apart too. Returns the pair that remains on the front. */
+	std::uint32_t merge(std::uint32_t idx, const glm::mat4& b_to_a) {
+		nodes[idx].apart_in = query;
+		while(nodes[idx].parent != none) {
+			const std::uint32_t parent = nodes[idx].parent;
+			const std::uint32_t children = nodes[parent].children;
+			const std::uint32_t sibling = idx == children ? children + 1 : children;
+			if(nodes[sibling].children != none || nodes[sibling].apart_in != query || !apart(nodes[parent], b_to_a)) break;
+
+			// Children of a parent whose BVs are apart are apart too, so the sibling needs no test
+			nodes[children].alive = nodes[children + 1].alive = false;
+			nodes[parent].children = none;
+			freed_children.push_back(children);
+			if(last_hit == children || last_hit == children + 1) last_hit = none;
+			nodes[parent].apart_in = query;
+			idx = parent;
+		}
+		return idx;
+	}
+
+public:
+	// The BVHModels must outlive the front
+	TBVTTFront(const TBVHModel<TValue>& a, const TBVHModel<TValue>& b) : a(&a), b(&b) {
+		reset();
+	}
+
+	// Forgets the front, so that the next query starts from the roots
+	void reset() {
+		nodes.clear();
+		front.clear();
+		free_children.clear();
+		last_hit = none;
+		if(a->size() == 0 || b->size() == 0) return;
+		nodes.push_back(Node{static_cast<std::uint32_t>(a->root_idx()), static_cast<std::uint32_t>(b->root_idx()), none, none, none, true});
+		front.push_back(0);
+	}
+
+	// Returns true if any triangle of a intersects any triangle of b, once both are taken into world-space
+	bool collides(const glm::mat4& a_world, const glm::mat4& b_world) {
+		if(front.empty()) return false;
+		const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+		detail::count_query();
+		// none marks pairs that were never found apart and empty slots, so the count skips it when it wraps around
+		if(++query == none) query = 0;
+		transformed_count = 0;
+
+		// Triangles whose BVs are apart are never tested, just like in ::collides()
+		if(last_hit != none && !apart(nodes[last_hit], b_to_a) && triangles_intersect(nodes[last_hit], b_to_a)) {
+			return true;
+		}
+		last_hit = none;
+
+		bool found = false;
+		next_front.clear();
+		for(const std::uint32_t idx : front) {
+			// Skip pairs that were merged into their parent or split earlier in this query
+			if(!nodes[idx].alive || nodes[idx].children != none) continue;
+			if(found) {
+				next_front.push_back(idx);
+			} else if(apart(nodes[idx], b_to_a)) {
+				next_front.push_back(merge(idx, b_to_a));
+			} else {
+				found = split(idx, b_to_a, found);
+			}
+		}
+
+		// Drop pairs that were merged after they were put on the front, and only now reuse their slots
+		front.clear();
+		for(const std::uint32_t idx : next_front) {
+			if(nodes[idx].alive && nodes[idx].children == none) front.push_back(idx);
+		}
+		free_children.insert(free_children.end(), freed_children.begin(), freed_children.end());
+		freed_children.clear();
+		return found;
+	}
+
+	// Returns the number of pairs on the front
+	std::size_t size() const {
+		return front.size();
+	}
+};
+
+using BVTTFront = TBVTTFront<Sphere>;
+using AABBBVTTFront = TBVTTFront<AABB>;
+
+} // End of namespace lowpoly3d
+
+#endif // BVTT_FRONT_HPP
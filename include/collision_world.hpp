@@ -0,0 +1,100 @@
+#ifndef COLLISION_WORLD_HPP
+#define COLLISION_WORLD_HPP
+
+#include <array>
+#include <cstdint> // std::uint32_t, std::uint64_t
+#include <unordered_map>
+#include <unordered_set>
+#include <utility> // std::pair
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "bvtt_front.hpp"
+#include "geometric_primitives/aabb.hpp"
+#include "utils/thread_pool.hpp"
+
+namespace lowpoly3d {
+
+/* A set of CollisionData objects that finds colliding objects without testing all pairs.
+ *
+ * The broad phase is an incremental sweep-and-prune over the world-space bounds of all objects.
+ * Bound endpoints are kept sorted along each axis and are re-sorted by insertion sort on update(),
+ * which is close to linear when objects move coherently between frames. Every swap of two endpoints
+ * is an event where two bounds start or stop overlapping along an axis, so the set of overlapping
+ * pairs is maintained incrementally rather than recomputed. The narrow phase queries the candidate
+ * pairs on a thread pool, each through a BVTTFront that is kept for as long as the pair remains a
+ * candidate, so that pairs that rest on each other start where their previous query stopped. */
+class CollisionWorld {
+public:
+	using handle_type = std::uint32_t;
+	using pair_type = std::pair<handle_type, handle_type>;
+
+	explicit CollisionWorld(ThreadPool& pool = ThreadPool::global());
+
+	CollisionWorld(const CollisionWorld&) = delete;
+	CollisionWorld& operator=(const CollisionWorld&) = delete;
+
+	/* Adds an object to the world and returns a handle to it. The model and matrix
+	 * of "data" are referred to, not copied, so they must outlive the object. */
+	handle_type add(const CollisionData& data);
+
+	// Removes an object from the world. Its handle may be reused by a later add().
+	void remove(handle_type handle);
+
+	// Re-reads the world matrices of all objects and updates the candidate pairs accordingly
+	void update();
+
+	/* Updates the world and writes every pair of colliding objects into "colliding",
+	 * which is cleared first. Returns the number of colliding pairs. */
+	std::size_t step(std::vector<pair_type>& colliding);
+
+	/* Pairs of objects whose world-space bounds overlapped at the last update(),
+	 * with the smallest handle first and sorted by handle */
+	const std::vector<pair_type>& getCandidatePairs() const;
+
+	// Returns the world-space bounds of an object as of the last update()
+	const AABB& getBounds(handle_type handle) const;
+
+	const CollisionData& operator[](handle_type handle) const;
+
+	// Returns the number of objects in the world
+	std::size_t size() const;
+
+private:
+	// partners are the objects whose pairs with this one are in overlapping
+	struct Object {
+		CollisionData data;
+		AABB bounds;
+		bool alive;
+		std::vector<handle_type> partners;
+	};
+
+	// The lower (is_min) or upper bound of an object along an axis
+	struct Endpoint {
+		float value;
+		handle_type handle;
+		bool is_min;
+	};
+
+	void sort_axis(std::size_t axis);
+	void start_overlap(handle_type a, handle_type b);
+	void stop_overlap(handle_type a, handle_type b);
+	void refresh_candidates();
+	static std::uint64_t key(handle_type a, handle_type b);
+
+	ThreadPool& pool;
+	std::vector<Object> objects;
+	std::vector<handle_type> free_handles;
+	std::array<std::vector<Endpoint>, 3> axes;
+	std::unordered_set<std::uint64_t> overlapping;
+	std::vector<pair_type> candidates;
+	// The fronts of pairs in overlapping, which are dropped as soon as their pair stops overlapping
+	std::unordered_map<std::uint64_t, BVTTFront> fronts;
+	std::vector<BVTTFront*> candidate_fronts;
+	std::vector<char> narrow_phase_results;
+	bool candidates_dirty = false;
+};
+
+} // End of namespace lowpoly3d
+
+#endif // COLLISION_WORLD_HPP
@@ -0,0 +1,228 @@
+#ifndef FLAT_BOUNDING_VOLUME_HIERARCHY_HPP
+#define FLAT_BOUNDING_VOLUME_HIERARCHY_HPP
+
+#include <cassert>
+#include <cstdint> // std::uint32_t
+#include <limits>
+#include <utility> // std::pair
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+
+namespace lowpoly3d {
+
+/* A node of a FlatBVH. Internal nodes have count == 0, their left child is the
+ * next node and "offset" is the index of their right child. Leaves have count > 0
+ * and refer to the triangles [offset, offset+count) of the reordered triangle array. */
+template<typename BV>
+struct FlatBV : public BV {
+	std::uint32_t offset;
+	std::uint32_t count;
+	FlatBV(const BV& bv, std::uint32_t offset, std::uint32_t count) :
+		BV(bv), offset(offset), count(count) { }
+
+	bool is_leaf() const { return count != 0; }
+};
+
+/* A BVH flattened into a single array in depth-first order, so that a node is
+ * followed by its left subtree and only the index of the right child is stored.
+ * Triangles are copied into an array in leaf order, so that a leaf refers to a
+ * contiguous range of triangles and traversal never has to go through the model. */
+template<typename TValue>
+class FlatBVH {
+public:
+	using value_type = TValue;
+	using bv_type = FlatBV<value_type>;
+	using floating_point_type = typename TValue::floating_point_type;
+	using triangle_type = TTriangle<floating_point_type, 3>;
+private:
+	std::vector<bv_type> nodes;
+	std::vector<triangle_type> triangles;
+	std::vector<std::uint32_t> triangle_indices;
+	std::size_t depth = 0;
+
+	// Appends the triangles of all leaves of the subtree at bvh[idx], from left to right
+	void append_triangles(const Model& model, const BVH<value_type>& bvh, std::size_t idx) {
+		std::vector<std::size_t> stack {idx};
+		while(!stack.empty()) {
+			const auto& bv = bvh[stack.back()];
+			stack.pop_back();
+			if(bv.is_leaf) {
+				const auto& indices = model.getTriangleIndices(bv.left_idx);
+				triangles.emplace_back(
+					model.vertices[indices[0]],
+					model.vertices[indices[1]],
+					model.vertices[indices[2]]);
+				triangle_indices.push_back(static_cast<std::uint32_t>(bv.left_idx));
+			} else {
+				stack.push_back(bv.right_idx);
+				stack.push_back(bv.left_idx);
+			}
+		}
+	}
+
+public:
+	/* Flattens bvh, which must have been built over model. Subtrees over at most
+	 * "max_leaf_size" triangles are collapsed into a single leaf. */
+	FlatBVH(const Model& model, const BVH<value_type>& bvh, std::size_t max_leaf_size = 1) {
+		if(bvh.size() == 0) return;
+		assert(max_leaf_size >= 1);
+		assert(bvh.size() < std::numeric_limits<std::uint32_t>::max());
+
+		// Number of triangles in each subtree. Children precede their parents in a BVH.
+		std::vector<std::size_t> num_triangles(bvh.size());
+		for(std::size_t i = 0; i < bvh.size(); i++) {
+			num_triangles[i] = bvh[i].is_leaf ? 1 : num_triangles[bvh[i].left_idx] + num_triangles[bvh[i].right_idx];
+		}
+
+		nodes.reserve(bvh.size());
+		triangles.reserve(num_triangles[bvh.root_idx()]);
+		triangle_indices.reserve(num_triangles[bvh.root_idx()]);
+
+		// BVH index, index of the flat parent whose right child it is (if any) and depth
+		struct Entry { std::size_t idx, parent, depth; };
+		constexpr std::size_t no_parent = std::numeric_limits<std::size_t>::max();
+		std::vector<Entry> stack {{bvh.root_idx(), no_parent, 1}};
+		while(!stack.empty()) {
+			const auto [idx, parent, node_depth] = stack.back();
+			stack.pop_back();
+			depth = std::max(depth, node_depth);
+
+			const std::uint32_t flat_idx = static_cast<std::uint32_t>(nodes.size());
+			if(parent != no_parent) {
+				nodes[parent].offset = flat_idx;
+			}
+
+			const auto& bv = bvh[idx];
+			const value_type& volume = bv;
+			if(bv.is_leaf || num_triangles[idx] <= max_leaf_size) {
+				const std::uint32_t first = static_cast<std::uint32_t>(triangles.size());
+				append_triangles(model, bvh, idx);
+				nodes.emplace_back(volume, first, static_cast<std::uint32_t>(num_triangles[idx]));
+			} else {
+				nodes.emplace_back(volume, 0, 0);
+				stack.push_back({bv.right_idx, flat_idx, node_depth + 1});
+				stack.push_back({bv.left_idx, no_parent, node_depth + 1});
+			}
+		}
+	}
+
+	// Builds a BVH over model and flattens it
+	FlatBVH(
+		const Model& model,
+		std::size_t max_leaf_size = 1,
+		BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah) :
+		FlatBVH(model, BVH<value_type>(model, strategy), max_leaf_size) { }
+
+	std::size_t root_idx() const {
+		assert(!nodes.empty());
+		return 0;
+	}
+
+	const bv_type& root() const {
+		return nodes[root_idx()];
+	}
+
+	std::size_t left_idx(std::size_t idx) const {
+		assert(!nodes[idx].is_leaf());
+		return idx + 1;
+	}
+
+	std::size_t right_idx(std::size_t idx) const {
+		assert(!nodes[idx].is_leaf());
+		return nodes[idx].offset;
+	}
+
+	const bv_type& operator[](std::size_t idx) const {
+		assert(idx < size());
+		return nodes[idx];
+	}
+
+	const std::vector<bv_type>& getBVs() const {
+		return nodes;
+	}
+
+	std::size_t size() const {
+		return nodes.size();
+	}
+
+	// Returns the number of nodes on the longest path from the root to a leaf
+	std::size_t getDepth() const {
+		return depth;
+	}
+
+	// Returns the triangles in leaf order, leaves refer to ranges of this array
+	const std::vector<triangle_type>& getTriangles() const {
+		return triangles;
+	}
+
+	// Returns the index in the model of the i:th triangle of getTriangles()
+	std::size_t getTriangleIndex(std::size_t i) const {
+		throw_no_such_triangle_if_geq(i, triangle_indices.size());
+		return triangle_indices[i];
+	}
+};
+
+namespace detail {
+
+// Traverses the BVTT of two flat BVHs just like collides() on two BVHModels does
+template<typename TValue, typename Stack>
+bool collides(const FlatBVH<TValue>& a, const FlatBVH<TValue>& b, const glm::mat4& b_to_a, Stack& stack) {
+	using node_type = BVTTNode<TValue>;
+
+	const TValue b_root = transform(b.root(), b_to_a);
+	if(signed_distance(a.root(), b_root) > 0) return false;
+	stack.push_back(node_type{a.root_idx(), b.root_idx(), b_root});
+
+	const auto& a_triangles = a.getTriangles();
+	const auto& b_triangles = b.getTriangles();
+	while(!stack.empty()) {
+		const node_type node = stack.back();
+		stack.pop_back();
+
+		const auto& bva = a[node.a_idx];
+		const auto& bvb = b[node.b_idx];
+
+		if(bva.is_leaf() && bvb.is_leaf()) {
+			for(std::uint32_t j = bvb.offset; j < bvb.offset + bvb.count; j++) {
+				const auto b_triangle_in_a = b_triangles[j].transform(b_to_a);
+				for(std::uint32_t i = bva.offset; i < bva.offset + bva.count; i++) {
+					if(intersects(a_triangles[i], b_triangle_in_a)) {
+						return true;
+					}
+				}
+			}
+		} else if(bvb.is_leaf() || (!bva.is_leaf() && bva.size() > node.b_bv.size())) {
+			const node_type left {a.left_idx(node.a_idx), node.b_idx, node.b_bv};
+			const node_type right {a.right_idx(node.a_idx), node.b_idx, node.b_bv};
+			push_overlapping(stack,
+				left, signed_distance(a[left.a_idx], node.b_bv),
+				right, signed_distance(a[right.a_idx], node.b_bv));
+		} else {
+			const std::size_t left_idx = b.left_idx(node.b_idx), right_idx = b.right_idx(node.b_idx);
+			const node_type left {node.a_idx, left_idx, transform(b[left_idx], b_to_a)};
+			const node_type right {node.a_idx, right_idx, transform(b[right_idx], b_to_a)};
+			push_overlapping(stack,
+				left, signed_distance(bva, left.b_bv),
+				right, signed_distance(bva, right.b_bv));
+		}
+	}
+	return false;
+}
+
+} // End of namespace detail
+
+// Returns true if any triangle of a intersects any triangle of b, once both are taken into world-space
+template<typename TValue>
+bool collides(const FlatBVH<TValue>& a, const FlatBVH<TValue>& b, const glm::mat4& a_world, const glm::mat4& b_world) {
+	if(a.size() == 0 || b.size() == 0) return false;
+	const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+
+	return detail::with_bvtt_stack<TValue>(a.getDepth() + b.getDepth(), [&](auto& stack) {
+		return detail::collides(a, b, b_to_a, stack);
+	});
+}
+
+} // End of namespace lowpoly3d
+
+#endif // FLAT_BOUNDING_VOLUME_HIERARCHY_HPP
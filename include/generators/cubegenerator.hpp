@@ -2,6 +2,7 @@
 #define CUBEGENERATOR_HPP
 
 #include "modelgenerator.hpp"
+#include "geometric_primitives/aabb.hpp"
 
 namespace lowpoly3d {
 
@@ -9,6 +10,7 @@ struct CubeGenerator : public ModelGenerator {
 	const Color color;
 	CubeGenerator(const Color& color = {255, 0, 255});
 	Model generate() override;
+	Model generate(const AABB& box);
 };
 
 }
@@ -0,0 +1,125 @@
+#ifndef AABB_HPP
+#define AABB_HPP
+
+#include <cassert>
+#include <cmath>
+#include <ostream>
+#include <glm/glm.hpp>
+
+namespace lowpoly3d {
+
+template<typename fpt, std::size_t dim>
+using TPoint = glm::vec<dim, fpt>;
+
+template<typename fpt, std::size_t dim>
+struct TTriangle;
+
+/* An axis-aligned bounding box represented by its lower and upper corner.
+ * A box is closed, so a box with lower == upper is a single point. */
+template<typename TFloatingPointType, std::size_t TDimension>
+struct TAABB {
+	using floating_point_type = TFloatingPointType;
+	static constexpr std::size_t dimension = TDimension;
+	using vec_type = ::glm::vec<dimension, floating_point_type>;
+	using point_type = TPoint<floating_point_type, dimension>;
+	using triangle_type = TTriangle<floating_point_type, dimension>;
+	vec_type lower, upper;
+
+	constexpr TAABB(const vec_type& lower, const vec_type& upper) : lower(lower), upper(upper) {
+		for(std::size_t i = 0; i < dimension; i++) {
+			assert(!std::isnan(lower[i]) && !std::isnan(upper[i]));
+			assert(lower[i] <= upper[i]);
+		}
+	}
+
+	constexpr TAABB(const TAABB& other) = default;
+	TAABB& operator=(const TAABB& other) = default;
+
+	bool operator==(const TAABB& other) const;
+	bool operator!=(const TAABB& other) const;
+
+	// Returns true if other lies within this (closed) box
+	bool encloses(const TAABB& other) const;
+	bool enclosed(const TAABB& other) const;
+
+	// Returns true if point is within this (closed) box
+	bool contains(
+		const point_type& point,
+		floating_point_type tolerance = floating_point_type(1e-4)) const;
+	// Returns true if triangle is within this (closed) box
+	bool contains(
+		const triangle_type& triangle,
+		floating_point_type tolerance = floating_point_type(1e-4)) const;
+
+	vec_type center() const;
+
+	// Returns the half-widths of this box along each axis
+	vec_type extents() const;
+
+	floating_point_type surface_area() const;
+	floating_point_type volume() const;
+
+	// Returns half the length of the diagonal, i.e the radius of the sphere circumscribing this box.
+	// This makes the size of a box comparable to the size of a sphere.
+	floating_point_type size() const;
+};
+
+using AABB = TAABB<float, 3>;
+using AABBf = TAABB<float, 3>;
+using AABBd = TAABB<double, 3>;
+
+template<typename floating_point_type, std::size_t dimension>
+std::ostream& operator<<(std::ostream& os, const TAABB<floating_point_type, dimension>& obj) {
+	os << "(lower={" << obj.lower.x << ", " << obj.lower.y << ", " << obj.lower.z << "}, ";
+	os << "upper={" << obj.upper.x << ", " << obj.upper.y << ", " << obj.upper.z << "})";
+	return os;
+}
+
+// Returns the smallest box enclosing the triangle
+template<typename fpt, std::size_t dim>
+TAABB<fpt, dim> aabb(const TTriangle<fpt, dim>& triangle);
+
+// Returns the smallest box enclosing both a and b
+template<typename fpt, std::size_t dim>
+TAABB<fpt, dim> merge(const TAABB<fpt, dim>& a, const TAABB<fpt, dim>& b);
+
+/* Transforms the box into the space given by the homogenous transformation m and
+ * re-bounds the result, so the returned box encloses every transformed point of
+ * the box but is generally larger than the box itself when m rotates. */
+template<typename fpt>
+TAABB<fpt, 3> transform(const TAABB<fpt, 3>& box, const ::glm::mat<4, 4, fpt>& m);
+
+// Returns true if the two (closed) boxes overlap
+template<typename fpt, std::size_t dim>
+bool colliding(const TAABB<fpt, dim>& a, const TAABB<fpt, dim>& b);
+
+// Returns true if the two boxes overlap after they have been transformed into world space
+template<typename fpt>
+bool colliding(
+	const TAABB<fpt, 3>& a,
+	const TAABB<fpt, 3>& b,
+	const ::glm::mat<4, 4, fpt>& a_transform,
+	const ::glm::mat<4, 4, fpt>& b_transform);
+
+/* Returns the signed distance between two boxes. If the boxes are disjoint it is the
+ * euclidean distance between them, otherwise it is the negated penetration depth,
+ * i.e the smallest translation along any axis that would make them touch. */
+template<typename fpt, std::size_t dim>
+fpt signed_distance(const TAABB<fpt, dim>& a, const TAABB<fpt, dim>& b);
+
+/* Returns the signed distance from box to point. If point is outside the box it is the euclidean
+ * distance between them, otherwise it is the negated distance to the closest face of the box. */
+template<typename fpt>
+fpt signed_distance(const TAABB<fpt, 3>& box, const TPoint<fpt, 3>& point);
+
+// Returns the signed distance between two boxes after they have been transformed into world space
+template<typename fpt>
+fpt signed_distance(
+	const TAABB<fpt, 3>& a,
+	const TAABB<fpt, 3>& b,
+	const ::glm::mat<4, 4, fpt>& a_transform,
+	const ::glm::mat<4, 4, fpt>& b_transform);
+
+} // End of namespace lowpoly3d
+
+#endif // AABB_HPP
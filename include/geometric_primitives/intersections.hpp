@@ -77,10 +77,17 @@ TPoint<float, 3> intersection(TLine<float, 3> const&, TTriangle<float, 3> const&
 TPoint<double, 3> intersection(TLine<double, 3> const&, TTriangle<double, 3> const&);
 
 /* Triangle-triangle intersection that returns the linesegment of intersection
- * Returns a linesegment with two NaN points if no intersection exists */
+ * Returns a linesegment with two NaN points if no intersection exists, if the triangles
+ * only touch at a point or if they are coplanar */
 TLineSegment<float, 3> intersection(TTriangle<float, 3> const&, TTriangle<float, 3> const&);
 TLineSegment<double, 3> intersection(TTriangle<double, 3> const&, TTriangle<double, 3> const&);
 
+/* Triangle-triangle intersection that writes the end points of the linesegment of intersection
+ * to start and end, which are equal if the triangles only touch at a point. Returns false if
+ * no intersection exists or if the triangles are coplanar */
+bool intersection(TTriangle<float, 3> const& t1, TTriangle<float, 3> const& t2, TPoint<float, 3>& start, TPoint<float, 3>& end);
+bool intersection(TTriangle<double, 3> const& t1, TTriangle<double, 3> const& t2, TPoint<double, 3>& start, TPoint<double, 3>& end);
+
 /* Solves a system of three linear equations by (naively) using Cramer's rule. */
 glm::vec<3,  float, glm::qualifier::defaultp> cramer(glm::mat<3, 3,  float, glm::qualifier::defaultp> const& A, glm::vec<3,  float, glm::qualifier::defaultp> const& b);
 glm::vec<3, double, glm::qualifier::defaultp> cramer(glm::mat<3, 3, double, glm::qualifier::defaultp> const& A, glm::vec<3, double, glm::qualifier::defaultp> const& b);
@@ -14,6 +14,7 @@
 #include "geometric_primitives/point.hpp"
 
 #include "utils/glm/glmutils.hpp"
+#include "utils/predicates.hpp"
 #include "utils/strong_type.hpp"
 #include "utils/not_implemented_exception.hpp"
 
@@ -70,17 +71,18 @@ public:
 		return -glm::dot(n, p);
 	}
 
-	// Returns true if point is above the plane, otherwise false
+	// Returns true if point is above the plane, otherwise false. Exact for the normal and point of the plane.
 	bool above(const point_type& point) const {
-		return glm::dot(n, point - p) > 0.0f;
+		return side(n, p, point) > 0;
 	}
 
-	// Returns true if point is below the plane, otherwise false
+	// Returns true if point is below the plane, otherwise false. Exact for the normal and point of the plane.
 	bool below(const point_type& point) const {
-		return glm::dot(n, point - p) < 0.0f;
+		return side(n, p, point) < 0;
 	}
 
-	// Returns true if point lies on the plane, otherwise false
+	/* Returns true if point lies on the plane, otherwise false. Unlike above() and below() this has a
+	 * tolerance, since the normalized normal is rarely exact and points are rarely exactly on a plane. */
 	bool contains(const point_type& point) const {
 		// It should really be + since we want to check the difference between negative d and dot-product.
 		return std::abs(glm::dot(n, point) + getD()) <= floating_point_type{1e-6};
@@ -0,0 +1,183 @@
+#ifndef SOA_HPP
+#define SOA_HPP
+
+#include <cstddef> // std::size_t
+#include <cstdint> // std::int8_t
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "geometric_primitives/plane.hpp"
+#include "geometric_primitives/point.hpp"
+#include "geometric_primitives/sphere.hpp"
+#include "geometric_primitives/triangle.hpp"
+
+/* Containers of many spheres, planes or triangles stored as a structure of arrays, one array per
+ * coordinate, such that the kernels below process eight of them per instruction with AVX (or two
+ * times four with SSE2, or plain loops elsewhere, see utils/simd.hpp). Every array is padded to a
+ * multiple of width with lanes past size() whose values are unspecified and which kernels ignore. */
+
+namespace lowpoly3d {
+
+namespace detail {
+
+constexpr std::size_t soa_width = 8;
+
+constexpr std::size_t soa_padded(std::size_t count) {
+	return (count + soa_width - 1) / soa_width * soa_width;
+}
+
+} // End of namespace detail
+
+// Sphere i has center (center[0][i], center[1][i], center[2][i]) and radius radius[i]
+struct SphereSoA {
+	static constexpr std::size_t width = detail::soa_width;
+
+	std::vector<float> center[3], radius;
+	std::size_t count = 0;
+
+	void push_back(const Sphere& sphere) {
+		resize(count + 1);
+		for(std::size_t c = 0; c < 3; c++) center[c][count - 1] = sphere.p[c];
+		radius[count - 1] = sphere.r;
+	}
+
+	Sphere operator[](std::size_t i) const {
+		return Sphere({center[0][i], center[1][i], center[2][i]}, radius[i]);
+	}
+
+	// Resizes to n spheres, where spheres past the previous size are unspecified
+	void resize(std::size_t n) {
+		for(auto& column : center) column.resize(detail::soa_padded(n));
+		radius.resize(detail::soa_padded(n));
+		count = n;
+	}
+
+	void reserve(std::size_t n) {
+		for(auto& column : center) column.reserve(detail::soa_padded(n));
+		radius.reserve(detail::soa_padded(n));
+	}
+
+	std::size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	void clear() { resize(0); }
+};
+
+// Plane i passes through point[.][i] and has the unit normal normal[.][i], like TPlane
+struct PlaneSoA {
+	static constexpr std::size_t width = detail::soa_width;
+
+	std::vector<float> point[3], normal[3];
+	std::size_t count = 0;
+
+	void push_back(const Plane& plane) {
+		resize(count + 1);
+		for(std::size_t c = 0; c < 3; c++) {
+			point[c][count - 1] = plane.getPoint()[c];
+			normal[c][count - 1] = plane.getNormal()[c];
+		}
+	}
+
+	// Note that Plane normalizes the normal again, which may change it slightly
+	Plane operator[](std::size_t i) const {
+		return Plane(Point(point[0][i], point[1][i], point[2][i]), Point(normal[0][i], normal[1][i], normal[2][i]));
+	}
+
+	// Resizes to n planes, where planes past the previous size are unspecified
+	void resize(std::size_t n) {
+		for(std::size_t c = 0; c < 3; c++) {
+			point[c].resize(detail::soa_padded(n));
+			normal[c].resize(detail::soa_padded(n));
+		}
+		count = n;
+	}
+
+	void reserve(std::size_t n) {
+		for(std::size_t c = 0; c < 3; c++) {
+			point[c].reserve(detail::soa_padded(n));
+			normal[c].reserve(detail::soa_padded(n));
+		}
+	}
+
+	std::size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	void clear() { resize(0); }
+};
+
+// Coordinate c of corner k of triangle i is at coordinates[k][c][i], like TTriangleBatch
+struct TriangleSoA {
+	static constexpr std::size_t width = detail::soa_width;
+
+	std::vector<float> coordinates[3][3];
+	std::size_t count = 0;
+
+	void push_back(const Triangle& triangle) {
+		resize(count + 1);
+		for(std::size_t k = 0; k < 3; k++) {
+			for(std::size_t c = 0; c < 3; c++) {
+				coordinates[k][c][count - 1] = triangle[k][c];
+			}
+		}
+	}
+
+	Triangle operator[](std::size_t i) const {
+		return Triangle(
+			{coordinates[0][0][i], coordinates[0][1][i], coordinates[0][2][i]},
+			{coordinates[1][0][i], coordinates[1][1][i], coordinates[1][2][i]},
+			{coordinates[2][0][i], coordinates[2][1][i], coordinates[2][2][i]});
+	}
+
+	// Resizes to n triangles, where triangles past the previous size are unspecified
+	void resize(std::size_t n) {
+		for(auto& corner : coordinates) {
+			for(auto& column : corner) column.resize(detail::soa_padded(n));
+		}
+		count = n;
+	}
+
+	void reserve(std::size_t n) {
+		for(auto& corner : coordinates) {
+			for(auto& column : corner) column.reserve(detail::soa_padded(n));
+		}
+	}
+
+	std::size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	void clear() { resize(0); }
+};
+
+/* Writes every primitive transformed by the homogenous transformation m into out, which is
+ * resized to match. Spheres are transformed like transform(Sphere, mat4) and planes like
+ * TPlane, whose normal is transformed by the inverse transpose of m and normalized. */
+void transform(const SphereSoA& spheres, const glm::mat4& m, SphereSoA& out);
+void transform(const PlaneSoA& planes, const glm::mat4& m, PlaneSoA& out);
+void transform(const TriangleSoA& triangles, const glm::mat4& m, TriangleSoA& out);
+
+/* Writes the indices of the primitives that contain point into "containing" and returns how many
+ * there are. The buffer is cleared first and can be reused between calls to avoid allocations.
+ * The results agree with Sphere::contains and Triangle::contains, which is exact. */
+std::size_t contains(const SphereSoA& spheres, const Point& point, std::vector<std::size_t>& containing, float tolerance = 1e-4f);
+std::size_t contains(const TriangleSoA& triangles, const Point& point, std::vector<std::size_t>& containing);
+
+/* Writes the indices of the spheres that are colliding with sphere into "colliding" and returns how
+ * many there are. Spheres collide if the distance between their centers is less than their radii. */
+std::size_t colliding(const SphereSoA& spheres, const Sphere& sphere, std::vector<std::size_t>& colliding);
+
+/* Writes the signed distance of every primitive to point or sphere into "distances", which is
+ * resized to match. It is negative for points inside a sphere and below a plane, and for spheres
+ * that overlap, like signed_distance of a Sphere. */
+void signed_distance(const SphereSoA& spheres, const Point& point, std::vector<float>& distances);
+void signed_distance(const SphereSoA& spheres, const Sphere& sphere, std::vector<float>& distances);
+void signed_distance(const PlaneSoA& planes, const Point& point, std::vector<float>& distances);
+
+/* Writes which side of every plane point is on into "sides", which is resized to match: 1 if it is
+ * above, -1 if it is below and 0 if it is in the plane. Exact like Plane::above and Plane::below. */
+void classify(const PlaneSoA& planes, const Point& point, std::vector<std::int8_t>& sides);
+
+/* Writes which side of plane every sphere is on into "sides": 1 if the sphere is entirely above,
+ * -1 if it is entirely below and 0 if it intersects the plane, e.g. to cull against a frustum */
+void classify(const SphereSoA& spheres, const Plane& plane, std::vector<std::int8_t>& sides);
+
+} // End of namespace lowpoly3d
+
+#endif // SOA_HPP
@@ -80,6 +80,14 @@ typename TSphere<floating_point_type, dimension>::floating_point_type signed_dis
 	return ::glm::distance(a.p, b.p) - a.r - b.r;
 }
 
+// Returns the signed distance from sphere to point, which is negative if point is inside sphere
+template<typename floating_point_type>
+floating_point_type signed_distance(
+	const TSphere<floating_point_type, 3>& sphere,
+	const TPoint<floating_point_type, 3>& point) {
+	return ::glm::distance(sphere.p, point) - sphere.r;
+}
+
 // Returns the signed distance (=distance or penetration depth)
 Sphere::floating_point_type signed_distance(
 	const Sphere& a,
@@ -95,6 +103,13 @@ bool colliding(
 }
 
 bool colliding(const Sphere& a, const Sphere& b, const ::glm::mat4& a_transform, const ::glm::mat4& b_transform);
+
+/* Transforms the sphere by the homogenous transformation m. The radius is scaled by an
+ * upper bound on how much m stretches any direction, so the result always encloses the
+ * transformed sphere. It is exact for rotation, translation and uniform scaling, or scaling
+ * along the rotated axes, but only an upper bound when a non-uniform scale follows a rotation. */
+template<typename fpt>
+TSphere<fpt, 3> transform(const TSphere<fpt, 3>& sphere, const ::glm::mat<4, 4, fpt>& m);
 	
 }; //End of lowpoly3d
 
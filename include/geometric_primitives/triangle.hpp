@@ -127,6 +127,20 @@ TTriangle<fpt, 2> projectIntoLocal(TTriangle<fpt, 3> const& triangle, TPlane<fpt
 template<typename fpt>
 TTriangle<fpt, 2> projectLocal(TTriangle<fpt, 3> const& triangle, TOrientedPlane<fpt> const& plane);
 
+// Returns the point of triangle that is closest to point
+template<typename fpt>
+TPoint<fpt, 3> closest_point(TTriangle<fpt, 3> const& triangle, TPoint<fpt, 3> const& point);
+
+/* Finds a point of a and a point of b that are as close to each other as any two points of
+ * the triangles, writes them to on_a and on_b and returns the distance between them.
+ * If the triangles intersect, the distance is zero and on_a and on_b are a common point. */
+template<typename fpt>
+fpt closest_points(
+	TTriangle<fpt, 3> const& a,
+	TTriangle<fpt, 3> const& b,
+	TPoint<fpt, 3>& on_a,
+	TPoint<fpt, 3>& on_b);
+
 template<typename fpt>
 TPoint<fpt, 2> circumcenter(TTriangle<fpt, 2> const& triangle);
 
@@ -0,0 +1,60 @@
+#ifndef TRIANGLE_BATCH_HPP
+#define TRIANGLE_BATCH_HPP
+
+#include <cassert>
+#include <cstddef> // std::size_t
+
+#include "geometric_primitives/linesegment.hpp"
+#include "geometric_primitives/triangle.hpp"
+
+namespace lowpoly3d {
+
+/* Up to N triangles stored as a structure of arrays, such that a linesegment or a triangle
+ * can be tested against all of them at once with SIMD. Coordinate c of corner k of triangle i
+ * is at coordinates[k][c][i]. Lanes past size() are unspecified and the kernels ignore them. */
+template<std::size_t N>
+struct TTriangleBatch {
+	static constexpr std::size_t width = N;
+
+	alignas(32) float coordinates[3][3][N] = {};
+	std::size_t count = 0;
+
+	// Appends triangle to the batch, which must not be full
+	void push_back(const Triangle& triangle) {
+		assert(count < N && "Triangle batch is full");
+		for(std::size_t k = 0; k < 3; k++) {
+			for(std::size_t c = 0; c < 3; c++) {
+				coordinates[k][c][count] = triangle[k][c];
+			}
+		}
+		count++;
+	}
+
+	Triangle operator[](std::size_t i) const {
+		return Triangle(
+			{coordinates[0][0][i], coordinates[0][1][i], coordinates[0][2][i]},
+			{coordinates[1][0][i], coordinates[1][1][i], coordinates[1][2][i]},
+			{coordinates[2][0][i], coordinates[2][1][i], coordinates[2][2][i]});
+	}
+
+	std::size_t size() const { return count; }
+	bool full() const { return count == N; }
+	// Empties the batch, whose lanes keep the triangles that were in them until they are pushed over
+	void clear() { count = 0; }
+};
+
+using TriangleBatch4 = TTriangleBatch<4>;
+using TriangleBatch8 = TTriangleBatch<8>;
+
+/* Returns a mask whose bit i is set iff the linesegment or triangle intersects triangle i of batch.
+ * The result agrees with intersects() on each triangle of the batch, which these fall back to for
+ * the lanes where the sign of an orientation is not certain from its float evaluation. That includes
+ * lanes where a vertex lies in the plane of the other triangle, or where a triangle is degenerate. */
+int intersects(LineSegment const& segment, TriangleBatch4 const& batch);
+int intersects(LineSegment const& segment, TriangleBatch8 const& batch);
+int intersects(   Triangle const& triangle, TriangleBatch4 const& batch);
+int intersects(   Triangle const& triangle, TriangleBatch8 const& batch);
+
+} // End of namespace lowpoly3d
+
+#endif // TRIANGLE_BATCH_HPP
@@ -1,6 +1,8 @@
 #ifndef MINIMUM_BOUNDING_SPHERE_HPP
 #define MINIMUM_BOUNDING_SPHERE_HPP
 
+#include <vector>
+
 namespace lowpoly3d
 {
 
@@ -20,6 +22,19 @@ TSphere<fpt, dim> mbs(
 	TSphere<fpt, dim> const& a,
 	TSphere<fpt, dim> const& b);
 
+/* Returns the minimum bounding sphere of a non-empty set of points, found with Welzl's
+ * algorithm in expected linear time. The points are visited in a fixed pseudo-random
+ * order, so the same points always give the same sphere. */
+template<typename fpt>
+TSphere<fpt, 3> mbs(std::vector<TPoint<fpt, 3>> const& points);
+
+/* Returns a bounding sphere of a non-empty set of points that is usually within a few
+ * percent of the minimum, in two passes over the points. The minimum bounding sphere of
+ * the extreme points along 7 directions is grown to enclose the remaining points as in
+ * Ritter's algorithm, see Larsson's "Fast and tight fitting bounding spheres" (EPOS-14). */
+template<typename fpt>
+TSphere<fpt, 3> approximate_mbs(std::vector<TPoint<fpt, 3>> const& points);
+
 } // End of namespace lowpoly3d
 
 #endif // MINIMUM_BOUNDING_SPHERE_HPP
\ No newline at end of file
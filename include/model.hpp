@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <algorithm> //std::transform
+#include <cstdint> //std::uint64_t
 #include <numeric> //std::accumulate
 #include <modeldefs.hpp>
 #include <glm/glm.hpp>
@@ -58,6 +59,10 @@ Model& transform(Model& m, const glm::mat4& transform);
 //Joins arbitrary amount models (ie concatenate them) but first apply transform to vertices
 Model join(const std::vector<Model>& models, const std::vector<glm::mat4>& transforms);
 
+/* Returns a 64-bit FNV-1a hash of the vertices and triangle indices of model. Colors are
+ * not hashed, so two models hash equally if they have the same shape. */
+std::uint64_t content_hash(const Model& model);
+
 //Creates a model consisting of a single triangle. Useful for debugging.
 Model getSingleTriangleModel();
 
@@ -0,0 +1,235 @@
+#ifndef PROXIMITY_HPP
+#define PROXIMITY_HPP
+
+#include <cstddef> // std::size_t
+#include <limits>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/point.hpp"
+
+namespace lowpoly3d {
+
+// The point of a triangle that is closest to some query point
+template<typename fpt>
+struct TClosestPoint {
+	std::size_t triangle_idx;
+	TPoint<fpt, 3> point;
+	fpt distance;
+};
+
+/* The two points, one on a triangle of each of two models, that are closer to each
+ * other than any other points of the models. The triangles are the witnesses of the distance. */
+template<typename fpt>
+struct TClosestPoints {
+	std::size_t a_triangle_idx, b_triangle_idx;
+	TPoint<fpt, 3> a_point, b_point;
+	fpt distance;
+};
+
+using ClosestPoint = TClosestPoint<float>;
+using ClosestPoints = TClosestPoints<float>;
+
+namespace detail {
+
+// A node of a BVH to visit, along with a lower bound of the distance to its triangles
+template<typename fpt>
+struct ProximityNode {
+	std::size_t idx;
+	fpt distance;
+};
+
+// A node of the BVTT to visit, along with a lower bound of the distance between the triangles of its BVs
+template<typename TValue>
+struct ProximityBVTTNode {
+	std::size_t a_idx, b_idx;
+	TValue b_bv;
+	typename TValue::floating_point_type distance;
+};
+
+// Pushes those of two nodes that may be closer than best, such that the nearest is popped first
+template<typename Stack, typename Node, typename fpt>
+void push_nearest_last(Stack& stack, const Node& first, const Node& second, fpt best) {
+	const Node& near = first.distance <= second.distance ? first : second;
+	const Node& far = first.distance <= second.distance ? second : first;
+	if(far.distance <= best) stack.push_back(far);
+	if(near.distance <= best) stack.push_back(near);
+}
+
+/* Finds the triangle of bvh that is closest to point, among those within max_distance.
+ * Subtrees whose BVs are farther away than the closest triangle so far are skipped,
+ * and the search stops as soon as a triangle within early_exit_distance is found. */
+template<typename TValue, typename Stack, typename fpt = typename TValue::floating_point_type>
+bool closest_point(
+	const TBVHModel<TValue>& bvh,
+	const TPoint<fpt, 3>& point,
+	fpt max_distance,
+	fpt early_exit_distance,
+	Stack& stack,
+	TClosestPoint<fpt>& result) {
+
+	using node_type = ProximityNode<fpt>;
+	const fpt root_distance = signed_distance(static_cast<const TValue&>(bvh.root()), point);
+	if(root_distance > max_distance) return false;
+	stack.push_back(node_type{bvh.root_idx(), root_distance});
+
+	bool found = false;
+	fpt best = max_distance;
+	while(!stack.empty()) {
+		const node_type node = stack.back();
+		stack.pop_back();
+		if(node.distance > best) continue;
+
+		const auto& bv = bvh[node.idx];
+		if(bv.is_leaf) {
+			const TPoint<fpt, 3> closest = closest_point(bvh.getTriangle(bv.left_idx), point);
+			const fpt distance = glm::distance(closest, point);
+			if(distance < best || (!found && distance <= best)) {
+				best = distance;
+				result = TClosestPoint<fpt>{bv.left_idx, closest, distance};
+				found = true;
+				if(best <= early_exit_distance) return true;
+			}
+		} else {
+			push_nearest_last(stack,
+				node_type{bv.left_idx, signed_distance(static_cast<const TValue&>(bvh[bv.left_idx]), point)},
+				node_type{bv.right_idx, signed_distance(static_cast<const TValue&>(bvh[bv.right_idx]), point)},
+				best);
+		}
+	}
+	return found;
+}
+
+/* Finds the closest pair of triangles of a and b, among those within max_distance.
+ * b_to_a takes b into the modelspace of a. Pairs of BVs that are farther apart than
+ * the closest pair of triangles so far are skipped, and the search stops as soon as
+ * a pair within early_exit_distance is found. Splits the largest BV of a pair, like traverse_bvtt. */
+template<typename TValue, typename Stack, typename fpt = typename TValue::floating_point_type>
+bool minimum_distance(
+	const TBVHModel<TValue>& a,
+	const TBVHModel<TValue>& b,
+	const glm::mat4& b_to_a,
+	fpt max_distance,
+	fpt early_exit_distance,
+	Stack& stack,
+	TClosestPoints<fpt>& result) {
+
+	using node_type = ProximityBVTTNode<TValue>;
+	const TValue b_root = transform(b.root(), b_to_a);
+	const fpt root_distance = signed_distance(a.root(), b_root);
+	if(root_distance > max_distance) return false;
+	stack.push_back(node_type{a.root_idx(), b.root_idx(), b_root, root_distance});
+
+	bool found = false;
+	fpt best = max_distance;
+	while(!stack.empty()) {
+		const node_type node = stack.back();
+		stack.pop_back();
+		if(node.distance > best) continue;
+
+		const auto& bva = a[node.a_idx];
+		const auto& bvb = b[node.b_idx];
+
+		if(bva.is_leaf && bvb.is_leaf) {
+			TPoint<fpt, 3> on_a, on_b;
+			const fpt distance = closest_points(
+				a.getTriangle(bva.left_idx), b.getTriangle(bvb.left_idx).transform(b_to_a), on_a, on_b);
+			if(distance < best || (!found && distance <= best)) {
+				best = distance;
+				result = TClosestPoints<fpt>{bva.left_idx, bvb.left_idx, on_a, on_b, distance};
+				found = true;
+				if(best <= early_exit_distance) return true;
+			}
+		} else if(bvb.is_leaf || (!bva.is_leaf && bva.size() > node.b_bv.size())) {
+			push_nearest_last(stack,
+				node_type{bva.left_idx, node.b_idx, node.b_bv, signed_distance(a[bva.left_idx], node.b_bv)},
+				node_type{bva.right_idx, node.b_idx, node.b_bv, signed_distance(a[bva.right_idx], node.b_bv)},
+				best);
+		} else {
+			const TValue left = transform(b[bvb.left_idx], b_to_a);
+			const TValue right = transform(b[bvb.right_idx], b_to_a);
+			push_nearest_last(stack,
+				node_type{node.a_idx, bvb.left_idx, left, signed_distance(bva, left)},
+				node_type{node.a_idx, bvb.right_idx, right, signed_distance(bva, right)},
+				best);
+		}
+	}
+	return found;
+}
+
+// Returns how much a transformation that rotates, translates and scales uniformly scales distances
+template<typename fpt>
+fpt uniform_scale(const glm::mat<4, 4, fpt>& m) {
+	return glm::length(glm::vec<3, fpt>(m[0]));
+}
+
+} // End of namespace detail
+
+/* Finds the point of the triangles of bvh that is closest to point, once bvh is taken into
+ * world-space by bvh_world, and writes it to result in world-space. Only triangles within
+ * max_distance are considered and the search stops early, with any triangle within
+ * early_exit_distance, once it finds one. Returns true if a triangle was found.
+ * bvh_world may translate, rotate and scale uniformly. */
+template<typename TValue>
+bool closest_point(
+	const TBVHModel<TValue>& bvh,
+	const glm::mat4& bvh_world,
+	const TPoint<typename TValue::floating_point_type, 3>& point,
+	TClosestPoint<typename TValue::floating_point_type>& result,
+	typename TValue::floating_point_type max_distance = std::numeric_limits<typename TValue::floating_point_type>::infinity(),
+	typename TValue::floating_point_type early_exit_distance = 0) {
+
+	using fpt = typename TValue::floating_point_type;
+	using vec_type = glm::vec<3, fpt>;
+	if(bvh.size() == 0) return false;
+
+	// Distances in modelspace are world-space distances divided by the scale
+	const fpt scale = detail::uniform_scale(bvh_world);
+	const vec_type model_point = vec_type(glm::inverse(bvh_world) * glm::vec4(point, 1.0f));
+
+	// Every visited node pushes at most two children, one of which is visited next
+	const bool found = detail::with_stack<detail::ProximityNode<fpt>>(bvh.getDepth(), [&](auto& stack) {
+		return detail::closest_point(bvh, model_point, max_distance / scale, early_exit_distance / scale, stack, result);
+	});
+	if(found) {
+		result.point = vec_type(bvh_world * glm::vec4(result.point, 1.0f));
+		result.distance *= scale;
+	}
+	return found;
+}
+
+/* Finds the closest points of the triangles of a and b, once both are taken into world-space,
+ * and writes them and their triangles to result. Intersecting models are at distance zero.
+ * Only pairs of triangles within max_distance are considered and the search stops early,
+ * with any pair within early_exit_distance, once it finds one. Returns true if a pair was found.
+ * a_world may translate, rotate and scale uniformly, b_world may be any affine transformation. */
+template<typename TValue>
+bool minimum_distance(
+	const TBVHModel<TValue>& a,
+	const TBVHModel<TValue>& b,
+	const glm::mat4& a_world,
+	const glm::mat4& b_world,
+	TClosestPoints<typename TValue::floating_point_type>& result,
+	typename TValue::floating_point_type max_distance = std::numeric_limits<typename TValue::floating_point_type>::infinity(),
+	typename TValue::floating_point_type early_exit_distance = 0) {
+
+	using fpt = typename TValue::floating_point_type;
+	using vec_type = glm::vec<3, fpt>;
+	if(a.size() == 0 || b.size() == 0) return false;
+
+	const fpt scale = detail::uniform_scale(a_world);
+	const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+
+	const bool found = detail::with_stack<detail::ProximityBVTTNode<TValue>>(a.getDepth() + b.getDepth(), [&](auto& stack) {
+		return detail::minimum_distance(a, b, b_to_a, max_distance / scale, early_exit_distance / scale, stack, result);
+	});
+	if(found) {
+		result.a_point = vec_type(a_world * glm::vec4(result.a_point, 1.0f));
+		result.b_point = vec_type(a_world * glm::vec4(result.b_point, 1.0f));
+		result.distance *= scale;
+	}
+	return found;
+}
+
+} // End of namespace lowpoly3d
+
+#endif // PROXIMITY_HPP
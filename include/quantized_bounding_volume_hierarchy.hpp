@@ -0,0 +1,373 @@
+#ifndef QUANTIZED_BOUNDING_VOLUME_HIERARCHY_HPP
+#define QUANTIZED_BOUNDING_VOLUME_HIERARCHY_HPP
+
+#include <algorithm> // std::clamp, std::max
+#include <array>
+#include <cassert>
+#include <cmath> // std::floor, std::ceil
+#include <cstdint> // std::uint8_t, std::uint16_t, std::uint32_t
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "ray_cast.hpp"
+
+namespace lowpoly3d {
+
+/* Describes how a QuantizedBVH stores a BV of type BV relative to the BV of its parent, as
+ * "size" integers of type TQuantized. Decoding must enclose the encoded BV, so that queries
+ * on decoded BVs never miss a triangle, only visit somewhat more nodes. */
+template<typename BV, typename TQuantized>
+struct QuantizationTraits;
+
+/* A box is stored as its lower and upper corner on a grid of 2^bits - 1 cells along each
+ * axis of its parent, the lower corner rounded down and the upper corner rounded up */
+template<typename fpt, typename TQuantized>
+struct QuantizationTraits<TAABB<fpt, 3>, TQuantized> {
+	static constexpr std::size_t size = 6;
+	using code_type = std::array<TQuantized, size>;
+	static constexpr fpt max = fpt(std::numeric_limits<TQuantized>::max());
+
+	static fpt decode(TQuantized code, fpt parent_lower, fpt parent_upper) {
+		// The upper end of the grid is the upper corner of the parent, without rounding errors
+		if(code == std::numeric_limits<TQuantized>::max()) return parent_upper;
+		return parent_lower + fpt(code) * ((parent_upper - parent_lower) / max);
+	}
+
+	static TAABB<fpt, 3> decode(const code_type& code, const TAABB<fpt, 3>& parent) {
+		TAABB<fpt, 3> box = parent;
+		for(int i = 0; i < 3; i++) {
+			box.lower[i] = decode(code[i], parent.lower[i], parent.upper[i]);
+			box.upper[i] = decode(code[3 + i], parent.lower[i], parent.upper[i]);
+		}
+		return box;
+	}
+
+	static code_type encode(const TAABB<fpt, 3>& box, const TAABB<fpt, 3>& parent) {
+		code_type code;
+		for(int i = 0; i < 3; i++) {
+			const fpt cell = (parent.upper[i] - parent.lower[i]) / max;
+			fpt lower = cell > fpt(0) ? std::floor((box.lower[i] - parent.lower[i]) / cell) : fpt(0);
+			fpt upper = cell > fpt(0) ? std::ceil((box.upper[i] - parent.lower[i]) / cell) : max;
+			lower = std::clamp(lower, fpt(0), max);
+			upper = std::clamp(upper, fpt(0), max);
+
+			// Step outwards until rounding errors of the decoding can not cut the box
+			while(lower > fpt(0) && decode(TQuantized(lower), parent.lower[i], parent.upper[i]) > box.lower[i]) lower--;
+			while(upper < max && decode(TQuantized(upper), parent.lower[i], parent.upper[i]) < box.upper[i]) upper++;
+			code[i] = TQuantized(lower);
+			code[3 + i] = TQuantized(upper);
+		}
+		return code;
+	}
+};
+
+/* A sphere is stored as its center on a grid of 2^bits - 1 cells along each axis of the cube
+ * around its parent, and its radius on a grid over twice the radius of its parent, rounded up
+ * to also cover how far the center was moved onto the grid */
+template<typename fpt, typename TQuantized>
+struct QuantizationTraits<TSphere<fpt, 3>, TQuantized> {
+	static constexpr std::size_t size = 4;
+	using code_type = std::array<TQuantized, size>;
+	static constexpr fpt max = fpt(std::numeric_limits<TQuantized>::max());
+
+	static TSphere<fpt, 3> decode(const code_type& code, const TSphere<fpt, 3>& parent) {
+		const fpt cell = fpt(2) * parent.r / max;
+		const glm::vec<3, fpt> center = parent.p - parent.r + glm::vec<3, fpt>(code[0], code[1], code[2]) * cell;
+		return TSphere<fpt, 3>(center, fpt(code[3]) * cell);
+	}
+
+	static code_type encode(const TSphere<fpt, 3>& sphere, const TSphere<fpt, 3>& parent) {
+		code_type code;
+		const fpt cell = fpt(2) * parent.r / max;
+		for(int i = 0; i < 3; i++) {
+			const fpt center = cell > fpt(0) ? std::round((sphere.p[i] - parent.p[i] + parent.r) / cell) : fpt(0);
+			code[i] = TQuantized(std::clamp(center, fpt(0), max));
+		}
+		code[3] = 0;
+		if(cell <= fpt(0)) return code;
+
+		const fpt needed = sphere.r + glm::distance(decode(code, parent).p, sphere.p);
+		fpt radius = std::clamp(std::ceil(needed / cell), fpt(0), max);
+		code[3] = TQuantized(radius);
+		while(radius < max && decode(code, parent).r < needed) code[3] = TQuantized(++radius);
+		assert(decode(code, parent).r >= needed && "a child sphere sticks out of its parent by more than its own radius");
+		return code;
+	}
+};
+
+/* A node of a QuantizedBVH, whose BV is stored relative to the BV of its parent. Internal nodes
+ * are followed by their left child and "index" is the index of their right child, leaves refer
+ * to their triangle by "index". */
+template<typename BV, typename TQuantized>
+struct QuantizedBV {
+	using traits_type = QuantizationTraits<BV, TQuantized>;
+	static constexpr std::uint32_t leaf_bit = std::uint32_t(1) << 31;
+
+	typename traits_type::code_type code;
+	std::uint32_t index_and_leaf;
+
+	bool is_leaf() const { return (index_and_leaf & leaf_bit) != 0; }
+	std::uint32_t index() const { return index_and_leaf & ~leaf_bit; }
+};
+
+/* A BVH whose BVs are quantized to 8 or 16 bits relative to the BV of their parent, for models
+ * that are too many or too large to hold full BVHs of in memory. Only the root is stored in full,
+ * every other BV is decoded from its parent during traversal. Decoded BVs enclose the BVs they
+ * were encoded from, so queries give the same results as on the BVH, just with looser BVs.
+ * TQuantized selects the format per instance: std::uint8_t for the smallest nodes or
+ * std::uint16_t for nearly as tight BVs as the BVH. Nodes are in depth-first order, like a FlatBVH. */
+template<typename TValue, typename TQuantized>
+class QuantizedBVH {
+	static_assert(std::is_same_v<TQuantized, std::uint8_t> || std::is_same_v<TQuantized, std::uint16_t>,
+		"BVs can be quantized to 8 or 16 bits");
+public:
+	using value_type = TValue;
+	using bv_type = QuantizedBV<value_type, TQuantized>;
+	using traits_type = QuantizationTraits<value_type, TQuantized>;
+	using floating_point_type = typename TValue::floating_point_type;
+private:
+	const Model* model;
+	std::vector<bv_type> nodes;
+	value_type root_bv;
+	std::size_t depth = 0;
+
+	/* Appends the subtree at bvh[idx], whose BV is encoded relative to the decoded BV of its
+	 * parent. Encoding relative to the decoded parent, rather than the parent itself, lets
+	 * traversal decode every BV from the BVs it has decoded on the way down. */
+	void append(const BVH<value_type>& bvh, std::size_t idx, const value_type& parent, std::size_t node_depth) {
+		depth = std::max(depth, node_depth);
+		const auto& bv = bvh[idx];
+		const auto code = traits_type::encode(bv, parent);
+		const value_type decoded = traits_type::decode(code, parent);
+		const std::size_t flat_idx = nodes.size();
+		nodes.push_back(bv_type{code, 0});
+		if(bv.is_leaf) {
+			nodes[flat_idx].index_and_leaf = static_cast<std::uint32_t>(bv.left_idx) | bv_type::leaf_bit;
+			return;
+		}
+		append(bvh, bv.left_idx, decoded, node_depth + 1);
+		nodes[flat_idx].index_and_leaf = static_cast<std::uint32_t>(nodes.size());
+		append(bvh, bv.right_idx, decoded, node_depth + 1);
+	}
+
+public:
+	// Quantizes bvh, which must have been built over model. The model must outlive this BVH.
+	QuantizedBVH(const Model* model, const BVH<value_type>& bvh) : model(model), root_bv(detail::root_or_origin(bvh)) {
+		if(bvh.size() == 0) return;
+		assert(bvh.size() < bv_type::leaf_bit);
+		nodes.reserve(bvh.size());
+		append(bvh, bvh.root_idx(), root_bv, 1);
+	}
+
+	// Builds a BVH over model and quantizes it
+	QuantizedBVH(const Model* model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah) :
+		QuantizedBVH(model, BVH<value_type>(*model, strategy)) { }
+
+	std::size_t root_idx() const {
+		assert(!nodes.empty());
+		return 0;
+	}
+
+	// Returns the BV of the root, the only BV that is stored in full
+	const value_type& root() const {
+		return root_bv;
+	}
+
+	std::size_t left_idx(std::size_t idx) const {
+		assert(!nodes[idx].is_leaf());
+		return idx + 1;
+	}
+
+	std::size_t right_idx(std::size_t idx) const {
+		assert(!nodes[idx].is_leaf());
+		return nodes[idx].index();
+	}
+
+	// Returns the BV of nodes[idx] given the decoded BV of its parent
+	value_type decode(std::size_t idx, const value_type& parent) const {
+		return traits_type::decode(nodes[idx].code, parent);
+	}
+
+	const bv_type& operator[](std::size_t idx) const {
+		assert(idx < size());
+		return nodes[idx];
+	}
+
+	std::size_t size() const {
+		return nodes.size();
+	}
+
+	// Returns the number of bytes taken by the nodes, including the root BV
+	std::size_t memory() const {
+		return nodes.size() * sizeof(bv_type) + sizeof(value_type);
+	}
+
+	// Returns the number of nodes on the longest path from the root to a leaf
+	std::size_t getDepth() const {
+		return depth;
+	}
+
+	TTriangle<floating_point_type, 3> getTriangle(std::size_t idx) const {
+		return detail::model_triangle<floating_point_type>(*model, idx);
+	}
+};
+
+namespace detail {
+
+// A node of the BVTT of two QuantizedBVHs, with the decoded BV of a, of b and of b in the modelspace of a
+template<typename TValue>
+struct QuantizedBVTTNode {
+	std::size_t a_idx, b_idx;
+	TValue a_bv, b_bv, b_bv_in_a;
+};
+
+// Traverses the BVTT of two quantized BVHs just like collides() on two BVHModels does
+template<typename TValue, typename TQuantized, typename Stack>
+bool collides(const QuantizedBVH<TValue, TQuantized>& a, const QuantizedBVH<TValue, TQuantized>& b, const glm::mat4& b_to_a, Stack& stack) {
+	using node_type = QuantizedBVTTNode<TValue>;
+
+	if(a.size() == 0 || b.size() == 0) return false;
+	count_query();
+	count_bv_tests(1);
+	const TValue a_root = a.decode(a.root_idx(), a.root());
+	const TValue b_root = b.decode(b.root_idx(), b.root());
+	const TValue b_root_in_a = transform(b_root, b_to_a);
+	if(signed_distance(a_root, b_root_in_a) > 0) return false;
+	stack.push_back(node_type{a.root_idx(), b.root_idx(), a_root, b_root, b_root_in_a});
+
+	while(!stack.empty()) {
+		count_stack_depth(stack.size());
+		const node_type node = stack.back();
+		stack.pop_back();
+
+		const auto& bva = a[node.a_idx];
+		const auto& bvb = b[node.b_idx];
+
+		if(bva.is_leaf() && bvb.is_leaf()) {
+			count_triangle_test();
+			if(intersects(a.getTriangle(bva.index()), b.getTriangle(bvb.index()).transform(b_to_a))) {
+				return true;
+			}
+		} else if(bvb.is_leaf() || (!bva.is_leaf() && node.a_bv.size() > node.b_bv_in_a.size())) {
+			const std::size_t left_idx = a.left_idx(node.a_idx), right_idx = a.right_idx(node.a_idx);
+			const node_type left {left_idx, node.b_idx, a.decode(left_idx, node.a_bv), node.b_bv, node.b_bv_in_a};
+			const node_type right {right_idx, node.b_idx, a.decode(right_idx, node.a_bv), node.b_bv, node.b_bv_in_a};
+			count_bv_tests(2);
+			push_overlapping(stack,
+				left, signed_distance(left.a_bv, node.b_bv_in_a),
+				right, signed_distance(right.a_bv, node.b_bv_in_a));
+		} else {
+			const std::size_t left_idx = b.left_idx(node.b_idx), right_idx = b.right_idx(node.b_idx);
+			const TValue left_bv = b.decode(left_idx, node.b_bv), right_bv = b.decode(right_idx, node.b_bv);
+			const node_type left {node.a_idx, left_idx, node.a_bv, left_bv, transform(left_bv, b_to_a)};
+			const node_type right {node.a_idx, right_idx, node.a_bv, right_bv, transform(right_bv, b_to_a)};
+			count_bv_tests(2);
+			push_overlapping(stack,
+				left, signed_distance(node.a_bv, left.b_bv_in_a),
+				right, signed_distance(node.a_bv, right.b_bv_in_a));
+		}
+	}
+	return false;
+}
+
+// A node of a quantized BVH to visit, along with its decoded BV and the t at which the ray enters it
+template<typename TValue>
+struct QuantizedRayNode {
+	std::size_t idx;
+	typename TValue::floating_point_type t;
+	TValue bv;
+};
+
+// Finds the closest hit of a ray in the modelspace of bvh just like ray_cast() on a BVHModel does
+template<typename TValue, typename TQuantized, typename Stack, typename fpt = typename TValue::floating_point_type>
+bool ray_cast(
+	const QuantizedBVH<TValue, TQuantized>& bvh,
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	fpt t_max,
+	Stack& stack,
+	TRayHit<fpt>& hit) {
+
+	using node_type = QuantizedRayNode<TValue>;
+	if(bvh.size() == 0) return false;
+	const glm::vec<3, fpt> inv_direction = fpt(1) / direction;
+	node_type root {bvh.root_idx(), 0, bvh.decode(bvh.root_idx(), bvh.root())};
+	if(!ray_entry(root.bv, origin, direction, inv_direction, t_max, root.t)) return false;
+	stack.push_back(root);
+
+	bool found = false;
+	fpt best = t_max;
+	while(!stack.empty()) {
+		const node_type node = stack.back();
+		stack.pop_back();
+		if(node.t > best) continue;
+
+		const auto& bv = bvh[node.idx];
+		if(bv.is_leaf()) {
+			fpt t, u, v;
+			if(ray_triangle(origin, direction, bvh.getTriangle(bv.index()), best, t, u, v)) {
+				best = t;
+				hit = TRayHit<fpt>{bv.index(), t, u, v};
+				found = true;
+			}
+			continue;
+		}
+
+		const std::size_t left_idx = bvh.left_idx(node.idx), right_idx = bvh.right_idx(node.idx);
+		node_type left {left_idx, 0, bvh.decode(left_idx, node.bv)}, right {right_idx, 0, bvh.decode(right_idx, node.bv)};
+		const bool left_hit = ray_entry(left.bv, origin, direction, inv_direction, best, left.t);
+		const bool right_hit = ray_entry(right.bv, origin, direction, inv_direction, best, right.t);
+
+		// Push the farthest child first, so that the nearest child is visited first
+		if(left_hit && right_hit) {
+			stack.push_back(left.t <= right.t ? right : left);
+			stack.push_back(left.t <= right.t ? left : right);
+		} else if(left_hit) {
+			stack.push_back(left);
+		} else if(right_hit) {
+			stack.push_back(right);
+		}
+	}
+	return found;
+}
+
+} // End of namespace detail
+
+// Returns true if any triangle of a intersects any triangle of b, once both are taken into world-space
+template<typename TValue, typename TQuantized>
+bool collides(const QuantizedBVH<TValue, TQuantized>& a, const QuantizedBVH<TValue, TQuantized>& b, const glm::mat4& a_world, const glm::mat4& b_world) {
+	const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+
+	return detail::with_stack<detail::QuantizedBVTTNode<TValue>>(a.getDepth() + b.getDepth(), [&](auto& stack) {
+		return detail::collides(a, b, b_to_a, stack);
+	});
+}
+
+/* Casts a ray against the triangles of bvh, which is placed in world-space by bvh_world,
+ * just like ray_cast() on a BVHModel */
+template<typename TValue, typename TQuantized>
+bool ray_cast(
+	const QuantizedBVH<TValue, TQuantized>& bvh,
+	const glm::mat4& bvh_world,
+	const TLine<typename TValue::floating_point_type, 3>& ray,
+	TRayHit<typename TValue::floating_point_type>& hit,
+	typename TValue::floating_point_type max_distance = std::numeric_limits<typename TValue::floating_point_type>::infinity()) {
+
+	using fpt = typename TValue::floating_point_type;
+	using vec_type = glm::vec<3, fpt>;
+
+	const glm::mat4 world_to_model = glm::inverse(bvh_world);
+	const vec_type origin = vec_type(world_to_model * glm::vec4(ray.getPoint(), 1.0f));
+	const vec_type direction = vec_type(world_to_model * glm::vec4(ray.getDirection(), 0.0f));
+
+	// Every visited node pushes at most two children, one of which is visited next
+	return detail::with_stack<detail::QuantizedRayNode<TValue>>(bvh.getDepth(), [&](auto& stack) {
+		return detail::ray_cast(bvh, origin, direction, max_distance, stack, hit);
+	});
+}
+
+} // End of namespace lowpoly3d
+
+#endif // QUANTIZED_BOUNDING_VOLUME_HIERARCHY_HPP
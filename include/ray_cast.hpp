@@ -0,0 +1,500 @@
+#ifndef RAY_CAST_HPP
+#define RAY_CAST_HPP
+
+#include <algorithm> // std::min, std::max
+#include <array>
+#include <cmath> // std::sqrt
+#include <cstddef> // std::size_t
+#include <limits>
+#include <numeric> // std::accumulate
+#include <type_traits>
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/line.hpp"
+#include "geometric_primitives/linesegment.hpp"
+
+#include "utils/simd.hpp"
+
+namespace lowpoly3d {
+
+/* The closest triangle hit by a ray or linesegment. The point of the hit is
+ * (1-u-v)*p1 + u*p2 + v*p3 of the triangle, i.e. u and v are barycentric coordinates.
+ * Batched casts report a miss as triangle_idx == no_triangle and an infinite distance. */
+template<typename fpt>
+struct TRayHit {
+	static constexpr std::size_t no_triangle = std::numeric_limits<std::size_t>::max();
+
+	std::size_t triangle_idx;
+	fpt distance;
+	fpt u, v;
+
+	bool hit() const { return triangle_idx != no_triangle; }
+};
+
+// Number of rays that a batched ray_cast() traverses a BVH with at once
+constexpr std::size_t ray_packet_size = 8;
+
+using RayHit = TRayHit<float>;
+
+namespace detail {
+
+/* Möller-Trumbore ray-triangle intersection. Returns true if origin + t*direction hits
+ * either side of triangle for some t in [0, t_max], in which case t, u and v are written */
+template<typename fpt>
+bool ray_triangle(
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	const TTriangle<fpt, 3>& triangle,
+	fpt t_max,
+	fpt& t, fpt& u, fpt& v) {
+
+	const auto e1 = triangle.p2 - triangle.p1;
+	const auto e2 = triangle.p3 - triangle.p1;
+	const auto p = glm::cross(direction, e2);
+	const fpt det = glm::dot(e1, p);
+	// The ray is parallel to the triangle or the triangle is degenerate
+	if(det == fpt(0)) return false;
+
+	const fpt inv_det = fpt(1) / det;
+	const auto s = origin - triangle.p1;
+	u = glm::dot(s, p) * inv_det;
+	if(u < fpt(0) || u > fpt(1)) return false;
+
+	const auto q = glm::cross(s, e1);
+	v = glm::dot(direction, q) * inv_det;
+	if(v < fpt(0) || u + v > fpt(1)) return false;
+
+	t = glm::dot(e2, q) * inv_det;
+	return t >= fpt(0) && t <= t_max;
+}
+
+/* Returns true if origin + t*direction is inside the BV for some t in [0, t_max],
+ * in which case the smallest such t is written */
+template<typename fpt>
+bool ray_entry(
+	const TSphere<fpt, 3>& sphere,
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	const glm::vec<3, fpt>& /* inv_direction */,
+	fpt t_max,
+	fpt& t) {
+
+	const auto m = origin - sphere.p;
+	const fpt c = glm::dot(m, m) - sphere.r * sphere.r;
+	if(c <= fpt(0)) {
+		t = fpt(0);
+		return true;
+	}
+
+	const fpt b = glm::dot(m, direction);
+	if(b >= fpt(0)) return false;
+
+	const fpt a = glm::dot(direction, direction);
+	const fpt discriminant = b * b - a * c;
+	if(discriminant < fpt(0)) return false;
+
+	t = (-b - std::sqrt(discriminant)) / a;
+	return t <= t_max;
+}
+
+template<typename fpt>
+bool ray_entry(
+	const TAABB<fpt, 3>& box,
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	const glm::vec<3, fpt>& inv_direction,
+	fpt t_max,
+	fpt& t) {
+
+	// Slab test
+	fpt near = fpt(0), far = t_max;
+	for(int axis = 0; axis < 3; axis++) {
+		/* A ray parallel to the slab is in it everywhere or nowhere. The slab test would multiply
+		 * an infinite inverse direction by zero, giving NaN, if the ray starts in the plane of a face. */
+		if(direction[axis] == fpt(0)) {
+			if(origin[axis] < box.lower[axis] || origin[axis] > box.upper[axis]) return false;
+			continue;
+		}
+		const fpt t0 = (box.lower[axis] - origin[axis]) * inv_direction[axis];
+		const fpt t1 = (box.upper[axis] - origin[axis]) * inv_direction[axis];
+		near = std::max(near, std::min(t0, t1));
+		far = std::min(far, std::max(t0, t1));
+	}
+	t = near;
+	return near <= far;
+}
+
+// A node of the BVH to visit, along with the t at which the ray enters its BV
+template<typename fpt>
+struct RayNode {
+	std::size_t idx;
+	fpt t;
+};
+
+/* Finds the triangle of bvh hit by origin + t*direction with the smallest t in [0, t_max].
+ * Children are visited nearest first, and a subtree is skipped once the ray enters its BV
+ * beyond the closest hit so far. The distance of the hit is t. */
+template<typename TValue, typename Stack, typename fpt = typename TValue::floating_point_type>
+bool ray_cast(
+	const TBVHModel<TValue>& bvh,
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	fpt t_max,
+	Stack& stack,
+	TRayHit<fpt>& hit) {
+
+	const glm::vec<3, fpt> inv_direction = fpt(1) / direction;
+	fpt root_t;
+	if(!ray_entry(static_cast<const TValue&>(bvh.root()), origin, direction, inv_direction, t_max, root_t)) return false;
+	stack.push_back(RayNode<fpt>{bvh.root_idx(), root_t});
+
+	bool found = false;
+	fpt best = t_max;
+	while(!stack.empty()) {
+		const RayNode<fpt> node = stack.back();
+		stack.pop_back();
+		if(node.t > best) continue;
+
+		const auto& bv = bvh[node.idx];
+		if(bv.is_leaf) {
+			fpt t, u, v;
+			if(ray_triangle(origin, direction, bvh.getTriangle(bv.left_idx), best, t, u, v)) {
+				best = t;
+				hit = TRayHit<fpt>{bv.left_idx, t, u, v};
+				found = true;
+			}
+		} else {
+			RayNode<fpt> left {bv.left_idx, 0}, right {bv.right_idx, 0};
+			const bool left_hit = ray_entry(static_cast<const TValue&>(bvh[left.idx]), origin, direction, inv_direction, best, left.t);
+			const bool right_hit = ray_entry(static_cast<const TValue&>(bvh[right.idx]), origin, direction, inv_direction, best, right.t);
+
+			// Push the farthest child first, so that the nearest child is visited first
+			if(left_hit && right_hit) {
+				stack.push_back(left.t <= right.t ? right : left);
+				stack.push_back(left.t <= right.t ? left : right);
+			} else if(left_hit) {
+				stack.push_back(left);
+			} else if(right_hit) {
+				stack.push_back(right);
+			}
+		}
+	}
+	return found;
+}
+
+template<typename TValue, typename fpt = typename TValue::floating_point_type>
+bool ray_cast(
+	const TBVHModel<TValue>& bvh,
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	fpt t_max,
+	TRayHit<fpt>& hit) {
+
+	if(bvh.size() == 0) return false;
+	// Every visited node pushes at most two children, one of which is visited next
+	return with_stack<RayNode<fpt>>(bvh.getDepth(), [&](auto& stack) {
+		return ray_cast(bvh, origin, direction, t_max, stack, hit);
+	});
+}
+
+/* N rays in structure-of-arrays layout, in groups of four lanes that are operated on
+ * with SIMD instructions. A lane whose t_max is negative never hits anything. */
+template<std::size_t N>
+struct RayPacket {
+	static_assert(N % 4 == 0, "rays are tested four at a time");
+	static constexpr std::size_t num_groups = N / 4;
+	using lanes_type = std::array<simd::float4, num_groups>;
+
+	lanes_type ox, oy, oz; // Origins
+	lanes_type dx, dy, dz; // Directions
+	lanes_type ix, iy, iz; // Inverse directions
+	lanes_type t_max; // Distance to the closest hit so far
+	lanes_type u, v;
+	std::array<std::size_t, N> triangle_idx;
+};
+
+/* Returns true if any lane of the packet is inside the BV for some t in [0, t_max] of
+ * that lane, in which case the smallest such t of all lanes is written */
+template<std::size_t N>
+bool packet_entry(const TSphere<float, 3>& sphere, const RayPacket<N>& packet, float& t_min) {
+	using simd::float4;
+	const float4 miss = std::numeric_limits<float>::infinity(), zero = 0.0f;
+	const float4 px = sphere.p.x, py = sphere.p.y, pz = sphere.p.z, r2 = sphere.r * sphere.r;
+	float4 nearest = miss;
+	for(std::size_t g = 0; g < packet.num_groups; g++) {
+		const float4 mx = packet.ox[g] - px, my = packet.oy[g] - py, mz = packet.oz[g] - pz;
+		const float4 a = packet.dx[g] * packet.dx[g] + packet.dy[g] * packet.dy[g] + packet.dz[g] * packet.dz[g];
+		const float4 b = mx * packet.dx[g] + my * packet.dy[g] + mz * packet.dz[g];
+		const float4 c = mx * mx + my * my + mz * mz - r2;
+		const float4 discriminant = b * b - a * c;
+		const float4 enter = (zero - b - sqrt(max(discriminant, zero))) / a;
+		const simd::mask4 inside = c <= zero;
+		const simd::mask4 hit = (packet.t_max[g] >= zero) &
+			(inside | ((b < zero) & (discriminant >= zero) & (enter <= packet.t_max[g])));
+		nearest = min(nearest, select(hit, select(inside, zero, enter), miss));
+	}
+	t_min = simd::reduce_min(nearest);
+	return t_min != std::numeric_limits<float>::infinity();
+}
+
+/* Narrows [enter, exit] of every lane to the t at which it is within the slab [lower, upper] along one
+ * axis. A lane parallel to the slab is in it for every t or for none, since the slab test would
+ * multiply its infinite inverse direction by zero, giving NaN, if it starts in the plane of a face. */
+inline void packet_slab(
+	simd::float4 lower, simd::float4 upper,
+	simd::float4 origin, simd::float4 direction, simd::float4 inv_direction,
+	simd::float4& enter, simd::float4& exit) {
+
+	using simd::float4;
+	const float4 infinity = std::numeric_limits<float>::infinity(), zero = 0.0f;
+	const float4 t0 = (lower - origin) * inv_direction, t1 = (upper - origin) * inv_direction;
+	const simd::mask4 parallel = abs(direction) <= zero;
+	const simd::mask4 outside = (origin < lower) | (origin > upper);
+	enter = max(enter, select(parallel, select(outside, infinity, zero - infinity), min(t0, t1)));
+	exit = min(exit, select(parallel, infinity, max(t0, t1)));
+}
+
+template<std::size_t N>
+bool packet_entry(const TAABB<float, 3>& box, const RayPacket<N>& packet, float& t_min) {
+	using simd::float4;
+	const float4 miss = std::numeric_limits<float>::infinity();
+	const float4 lx = box.lower.x, ly = box.lower.y, lz = box.lower.z;
+	const float4 ux = box.upper.x, uy = box.upper.y, uz = box.upper.z;
+	float4 nearest = miss;
+	for(std::size_t g = 0; g < packet.num_groups; g++) {
+		float4 enter = 0.0f, exit = packet.t_max[g];
+		packet_slab(lx, ux, packet.ox[g], packet.dx[g], packet.ix[g], enter, exit);
+		packet_slab(ly, uy, packet.oy[g], packet.dy[g], packet.iy[g], enter, exit);
+		packet_slab(lz, uz, packet.oz[g], packet.dz[g], packet.iz[g], enter, exit);
+		nearest = min(nearest, select(enter <= exit, enter, miss));
+	}
+	t_min = simd::reduce_min(nearest);
+	return t_min != std::numeric_limits<float>::infinity();
+}
+
+// Möller-Trumbore on every lane of the packet, lanes that hit closer than their t_max are updated
+template<std::size_t N>
+void packet_triangle(RayPacket<N>& packet, const TTriangle<float, 3>& triangle, std::size_t triangle_idx) {
+	using simd::float4;
+	const float4 zero = 0.0f, one = 1.0f;
+	const auto e1 = triangle.p2 - triangle.p1;
+	const auto e2 = triangle.p3 - triangle.p1;
+	const float4 e1x = e1.x, e1y = e1.y, e1z = e1.z, e2x = e2.x, e2y = e2.y, e2z = e2.z;
+	for(std::size_t g = 0; g < packet.num_groups; g++) {
+		const float4 sx = packet.ox[g] - triangle.p1.x, sy = packet.oy[g] - triangle.p1.y, sz = packet.oz[g] - triangle.p1.z;
+		// p = cross(direction, e2), q = cross(s, e1)
+		const float4 px = packet.dy[g] * e2z - packet.dz[g] * e2y;
+		const float4 py = packet.dz[g] * e2x - packet.dx[g] * e2z;
+		const float4 pz = packet.dx[g] * e2y - packet.dy[g] * e2x;
+		const float4 qx = sy * e1z - sz * e1y;
+		const float4 qy = sz * e1x - sx * e1z;
+		const float4 qz = sx * e1y - sy * e1x;
+		const float4 inv_det = one / (e1x * px + e1y * py + e1z * pz);
+		const float4 u = (sx * px + sy * py + sz * pz) * inv_det;
+		const float4 v = (packet.dx[g] * qx + packet.dy[g] * qy + packet.dz[g] * qz) * inv_det;
+		const float4 t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+
+		// NaNs of a zero determinant fail every comparison
+		const simd::mask4 hit = (u >= zero) & (v >= zero) & (u + v <= one) & (t >= zero) & (t <= packet.t_max[g]);
+		const int bits = hit.bits();
+		if(bits == 0) continue;
+		packet.t_max[g] = select(hit, t, packet.t_max[g]);
+		packet.u[g] = select(hit, u, packet.u[g]);
+		packet.v[g] = select(hit, v, packet.v[g]);
+		for(std::size_t lane = 0; lane < 4; lane++) {
+			if(bits & (1 << lane)) packet.triangle_idx[4 * g + lane] = triangle_idx;
+		}
+	}
+}
+
+// Returns the largest t_max of all lanes of the packet
+template<std::size_t N>
+float packet_t_max(const RayPacket<N>& packet) {
+	simd::float4 largest = packet.t_max[0];
+	for(std::size_t g = 1; g < packet.num_groups; g++) {
+		largest = max(largest, packet.t_max[g]);
+	}
+	return simd::reduce_max(largest);
+}
+
+/* Finds the closest hit of every lane of the packet. A node is visited if any lane enters its
+ * BV before the closest hit of that lane, so the packet pays for the union of the nodes that
+ * its rays would visit on their own, but loads and tests every node once for all lanes. */
+template<typename TValue, typename Stack, std::size_t N>
+void ray_cast(const TBVHModel<TValue>& bvh, RayPacket<N>& packet, Stack& stack) {
+	using fpt = float;
+	fpt root_t;
+	if(!packet_entry(static_cast<const TValue&>(bvh.root()), packet, root_t)) return;
+	stack.push_back(RayNode<fpt>{bvh.root_idx(), root_t});
+
+	while(!stack.empty()) {
+		const RayNode<fpt> node = stack.back();
+		stack.pop_back();
+		if(node.t > packet_t_max(packet)) continue;
+
+		const auto& bv = bvh[node.idx];
+		if(bv.is_leaf) {
+			packet_triangle(packet, bvh.getTriangle(bv.left_idx), bv.left_idx);
+		} else {
+			RayNode<fpt> left {bv.left_idx, 0}, right {bv.right_idx, 0};
+			const bool left_hit = packet_entry(static_cast<const TValue&>(bvh[left.idx]), packet, left.t);
+			const bool right_hit = packet_entry(static_cast<const TValue&>(bvh[right.idx]), packet, right.t);
+
+			// Push the farthest child first, so that the nearest child is visited first
+			if(left_hit && right_hit) {
+				stack.push_back(left.t <= right.t ? right : left);
+				stack.push_back(left.t <= right.t ? left : right);
+			} else if(left_hit) {
+				stack.push_back(left);
+			} else if(right_hit) {
+				stack.push_back(right);
+			}
+		}
+	}
+}
+
+/* Casts the first "count" rays, at most N, as a single packet and writes their hits.
+ * Rays are taken into modelspace by world_to_model. Returns the number of hits. */
+template<std::size_t N, typename TValue>
+std::size_t ray_cast_packet(
+	const TBVHModel<TValue>& bvh,
+	const glm::mat4& world_to_model,
+	const Line* rays,
+	std::size_t count,
+	float max_distance,
+	RayHit* hits) {
+
+	assert(count > 0 && count <= N);
+	// Lanes are gathered into plain arrays first and then loaded four at a time
+	std::array<std::array<float, N>, 10> lanes;
+	auto& [ox, oy, oz, dx, dy, dz, ix, iy, iz, t_max] = lanes;
+	for(std::size_t i = 0; i < N; i++) {
+		// Unused lanes repeat the first ray, but never hit anything
+		const auto& ray = rays[i < count ? i : 0];
+		const glm::vec3 origin = glm::vec3(world_to_model * glm::vec4(ray.getPoint(), 1.0f));
+		const glm::vec3 direction = glm::vec3(world_to_model * glm::vec4(ray.getDirection(), 0.0f));
+		ox[i] = origin.x; oy[i] = origin.y; oz[i] = origin.z;
+		dx[i] = direction.x; dy[i] = direction.y; dz[i] = direction.z;
+		ix[i] = 1.0f / direction.x; iy[i] = 1.0f / direction.y; iz[i] = 1.0f / direction.z;
+		t_max[i] = i < count ? max_distance : -1.0f;
+	}
+
+	RayPacket<N> packet;
+	for(std::size_t g = 0; g < packet.num_groups; g++) {
+		packet.ox[g] = simd::float4::load(&ox[4 * g]);
+		packet.oy[g] = simd::float4::load(&oy[4 * g]);
+		packet.oz[g] = simd::float4::load(&oz[4 * g]);
+		packet.dx[g] = simd::float4::load(&dx[4 * g]);
+		packet.dy[g] = simd::float4::load(&dy[4 * g]);
+		packet.dz[g] = simd::float4::load(&dz[4 * g]);
+		packet.ix[g] = simd::float4::load(&ix[4 * g]);
+		packet.iy[g] = simd::float4::load(&iy[4 * g]);
+		packet.iz[g] = simd::float4::load(&iz[4 * g]);
+		packet.t_max[g] = simd::float4::load(&t_max[4 * g]);
+		packet.u[g] = packet.v[g] = 0.0f;
+	}
+	packet.triangle_idx.fill(RayHit::no_triangle);
+
+	with_stack<RayNode<float>>(bvh.getDepth(), [&](auto& stack) {
+		ray_cast(bvh, packet, stack);
+		return 0;
+	});
+
+	std::size_t num_hits = 0;
+	for(std::size_t i = 0; i < count; i++) {
+		const bool hit = packet.triangle_idx[i] != RayHit::no_triangle;
+		hits[i] = RayHit{
+			packet.triangle_idx[i],
+			hit ? packet.t_max[i / 4][i % 4] : std::numeric_limits<float>::infinity(),
+			packet.u[i / 4][i % 4],
+			packet.v[i / 4][i % 4]};
+		num_hits += hit;
+	}
+	return num_hits;
+}
+
+} // End of namespace detail
+
+/* Casts a ray against the triangles of bvh, which is placed in world-space by bvh_world.
+ * The ray is given in world-space and only hits within max_distance of its point count.
+ * Returns true and writes the closest hit to "hit" if any triangle is hit. The distance
+ * of the hit is in world-space, as long as bvh_world is invertible. */
+template<typename TValue>
+bool ray_cast(
+	const TBVHModel<TValue>& bvh,
+	const glm::mat4& bvh_world,
+	const TLine<typename TValue::floating_point_type, 3>& ray,
+	TRayHit<typename TValue::floating_point_type>& hit,
+	typename TValue::floating_point_type max_distance = std::numeric_limits<typename TValue::floating_point_type>::infinity()) {
+
+	using fpt = typename TValue::floating_point_type;
+	using vec_type = glm::vec<3, fpt>;
+
+	// The direction is not normalized in modelspace, so that t is a world-space distance
+	const glm::mat4 world_to_model = glm::inverse(bvh_world);
+	const vec_type origin = vec_type(world_to_model * glm::vec4(ray.getPoint(), 1.0f));
+	const vec_type direction = vec_type(world_to_model * glm::vec4(ray.getDirection(), 0.0f));
+	return detail::ray_cast(bvh, origin, direction, max_distance, hit);
+}
+
+/* Casts a linesegment against the triangles of bvh, just like a ray from the start of the
+ * segment that only counts hits up to the end of the segment */
+template<typename TValue>
+bool ray_cast(
+	const TBVHModel<TValue>& bvh,
+	const glm::mat4& bvh_world,
+	const TLineSegment<typename TValue::floating_point_type, 3>& segment,
+	TRayHit<typename TValue::floating_point_type>& hit) {
+
+	using fpt = typename TValue::floating_point_type;
+	using vec_type = glm::vec<3, fpt>;
+
+	const glm::mat4 world_to_model = glm::inverse(bvh_world);
+	const vec_type start = vec_type(world_to_model * glm::vec4(segment.start, 1.0f));
+	const vec_type end = vec_type(world_to_model * glm::vec4(segment.end, 1.0f));
+	if(!detail::ray_cast(bvh, start, end - start, fpt(1), hit)) return false;
+	hit.distance *= segment.length();
+	return true;
+}
+
+/* Casts every ray of "rays" against the triangles of bvh, just like the single ray cast,
+ * and writes the closest hit of rays[i] to hits[i]. Returns the number of rays that hit.
+ * Adjacent rays are traversed together in packets of ray_packet_size, so rays that start
+ * close to each other and point in similar directions should be adjacent in "rays".
+ * Packets are spread over the threads of "pool". */
+template<typename TValue>
+std::size_t ray_cast(
+	const TBVHModel<TValue>& bvh,
+	const glm::mat4& bvh_world,
+	const std::vector<TLine<typename TValue::floating_point_type, 3>>& rays,
+	std::vector<TRayHit<typename TValue::floating_point_type>>& hits,
+	typename TValue::floating_point_type max_distance = std::numeric_limits<typename TValue::floating_point_type>::infinity(),
+	ThreadPool& pool = ThreadPool::global()) {
+
+	using fpt = typename TValue::floating_point_type;
+	static_assert(std::is_same_v<fpt, float>, "ray packets are made of floats");
+	constexpr fpt inf = std::numeric_limits<fpt>::infinity();
+	hits.assign(rays.size(), TRayHit<fpt>{TRayHit<fpt>::no_triangle, inf, fpt(0), fpt(0)});
+	if(bvh.size() == 0 || rays.empty()) return 0;
+
+	const glm::mat4 world_to_model = glm::inverse(bvh_world);
+	const std::size_t num_packets = (rays.size() + ray_packet_size - 1) / ray_packet_size;
+	std::vector<std::size_t> num_hits(num_packets);
+
+	constexpr std::size_t packets_per_task = 16;
+	pool.parallel_for(0, num_packets, [&](std::size_t begin, std::size_t end) {
+		for(std::size_t i = begin; i < end; i++) {
+			const std::size_t first = i * ray_packet_size;
+			const std::size_t count = std::min(ray_packet_size, rays.size() - first);
+			num_hits[i] = detail::ray_cast_packet<ray_packet_size>(
+				bvh, world_to_model, rays.data() + first, count, max_distance, hits.data() + first);
+		}
+	}, packets_per_task);
+
+	return std::accumulate(num_hits.begin(), num_hits.end(), std::size_t(0));
+}
+
+} // End of namespace lowpoly3d
+
+#endif // RAY_CAST_HPP
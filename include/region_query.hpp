@@ -0,0 +1,261 @@
+#ifndef REGION_QUERY_HPP
+#define REGION_QUERY_HPP
+
+#include <algorithm> // std::sort
+#include <array>
+#include <cstddef> // std::size_t
+#include <utility> // std::pair
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/plane.hpp"
+
+namespace lowpoly3d {
+
+/* A convex region bounded by six planes whose normals point into the region,
+ * in the order left, right, bottom, top, near, far */
+template<typename fpt>
+using TFrustum = std::array<TPlane<fpt, 3>, 6>;
+
+using Frustum = TFrustum<float>;
+
+/* Returns the frustum of the clip-space transformation "clip", e.g. projection * view,
+ * with OpenGL clip-space depth in [-w, w]. Passing projection * view * model gives the
+ * frustum in the modelspace of model, as taken by the queries below. */
+template<typename fpt>
+TFrustum<fpt> frustum(const glm::mat<4, 4, fpt>& clip) {
+	using vec_type = glm::vec<3, fpt>;
+
+	// Each plane is a sum of the last row of clip and another row, see Gribb & Hartmann
+	const auto plane = [&clip](std::size_t row, fpt sign) {
+		const glm::vec<4, fpt> equation {
+			clip[0][3] + sign * clip[0][row],
+			clip[1][3] + sign * clip[1][row],
+			clip[2][3] + sign * clip[2][row],
+			clip[3][3] + sign * clip[3][row]};
+		const vec_type normal(equation);
+		return TPlane<fpt, 3>(normal, -equation.w / glm::length(normal));
+	};
+	return {plane(0, 1), plane(0, -1), plane(1, 1), plane(1, -1), plane(2, 1), plane(2, -1)};
+}
+
+// The triangles [first, second) of a model, in the order of its triangle indices
+using TriangleRange = std::pair<std::size_t, std::size_t>;
+
+namespace detail {
+
+// Where a bounding volume lies relative to a query region
+enum class RegionOverlap { outside, partial, inside };
+
+// Returns the signed distance from plane to point, positive on the side that the normal points to
+template<typename fpt>
+fpt plane_distance(const TPlane<fpt, 3>& plane, const TPoint<fpt, 3>& point) {
+	return glm::dot(plane.getNormal(), point) + plane.getD();
+}
+
+/* Classifies a BV with the given center and half-width along each plane normal against
+ * the frustum. A BV that is outside no single plane but still outside the frustum, near
+ * its corners, is classified partial and rejected further down. */
+template<typename fpt, typename HalfWidth>
+RegionOverlap classify(const TFrustum<fpt>& frustum, const TPoint<fpt, 3>& center, HalfWidth&& half_width) {
+	RegionOverlap result = RegionOverlap::inside;
+	for(const auto& plane : frustum) {
+		const fpt distance = plane_distance(plane, center);
+		const fpt radius = half_width(plane.getNormal());
+		if(distance < -radius) return RegionOverlap::outside;
+		if(distance < radius) result = RegionOverlap::partial;
+	}
+	return result;
+}
+
+template<typename fpt>
+RegionOverlap classify(const TSphere<fpt, 3>& bv, const TFrustum<fpt>& frustum) {
+	return classify(frustum, bv.p, [&bv](const glm::vec<3, fpt>&) { return bv.r; });
+}
+
+template<typename fpt>
+RegionOverlap classify(const TAABB<fpt, 3>& bv, const TFrustum<fpt>& frustum) {
+	const auto extents = bv.extents();
+	return classify(frustum, bv.center(), [&extents](const glm::vec<3, fpt>& normal) {
+		return glm::dot(glm::abs(normal), extents);
+	});
+}
+
+template<typename fpt>
+RegionOverlap classify(const TSphere<fpt, 3>& bv, const TSphere<fpt, 3>& sphere) {
+	const fpt distance = glm::distance(bv.p, sphere.p);
+	if(distance > bv.r + sphere.r) return RegionOverlap::outside;
+	return distance + bv.r <= sphere.r ? RegionOverlap::inside : RegionOverlap::partial;
+}
+
+template<typename fpt>
+RegionOverlap classify(const TAABB<fpt, 3>& bv, const TSphere<fpt, 3>& sphere) {
+	const auto nearest = glm::clamp(sphere.p, bv.lower, bv.upper);
+	if(glm::distance(nearest, sphere.p) > sphere.r) return RegionOverlap::outside;
+	const auto farthest = glm::max(glm::abs(sphere.p - bv.lower), glm::abs(sphere.p - bv.upper));
+	return glm::length(farthest) <= sphere.r ? RegionOverlap::inside : RegionOverlap::partial;
+}
+
+template<typename fpt>
+RegionOverlap classify(const TSphere<fpt, 3>& bv, const TAABB<fpt, 3>& box) {
+	const auto nearest = glm::clamp(bv.p, box.lower, box.upper);
+	if(glm::distance(nearest, bv.p) > bv.r) return RegionOverlap::outside;
+	const bool inside = glm::all(glm::greaterThanEqual(bv.p - bv.r, box.lower)) && glm::all(glm::lessThanEqual(bv.p + bv.r, box.upper));
+	return inside ? RegionOverlap::inside : RegionOverlap::partial;
+}
+
+template<typename fpt>
+RegionOverlap classify(const TAABB<fpt, 3>& bv, const TAABB<fpt, 3>& box) {
+	if(!colliding(bv, box)) return RegionOverlap::outside;
+	const bool inside = glm::all(glm::greaterThanEqual(bv.lower, box.lower)) && glm::all(glm::lessThanEqual(bv.upper, box.upper));
+	return inside ? RegionOverlap::inside : RegionOverlap::partial;
+}
+
+/* Returns true if any point of triangle is on the inner side of every plane, by clipping
+ * the triangle by one plane at a time until nothing or a convex polygon within all of them remains */
+template<typename fpt, std::size_t num_planes>
+bool overlaps(const TTriangle<fpt, 3>& triangle, const std::array<TPlane<fpt, 3>, num_planes>& planes) {
+	// Clipping a convex polygon by a plane adds at most one vertex
+	std::array<TPoint<fpt, 3>, 3 + num_planes> polygon {triangle[0], triangle[1], triangle[2]}, clipped;
+	std::size_t size = 3;
+	for(const auto& plane : planes) {
+		std::size_t clipped_size = 0;
+		for(std::size_t i = 0; i < size; i++) {
+			const TPoint<fpt, 3>& current = polygon[i];
+			const TPoint<fpt, 3>& next = polygon[(i + 1) % size];
+			const fpt current_distance = plane_distance(plane, current);
+			const fpt next_distance = plane_distance(plane, next);
+			if(current_distance >= 0) clipped[clipped_size++] = current;
+			if((current_distance < 0) != (next_distance < 0)) {
+				const fpt t = current_distance / (current_distance - next_distance);
+				clipped[clipped_size++] = current + t * (next - current);
+			}
+		}
+		if(clipped_size == 0) return false;
+		polygon = clipped;
+		size = clipped_size;
+	}
+	return true;
+}
+
+template<typename fpt>
+bool overlaps(const TTriangle<fpt, 3>& triangle, const TSphere<fpt, 3>& sphere) {
+	return glm::distance(closest_point(triangle, sphere.p), sphere.p) <= sphere.r;
+}
+
+template<typename fpt>
+bool overlaps(const TTriangle<fpt, 3>& triangle, const TAABB<fpt, 3>& box) {
+	// A box is the region within six axis-aligned planes
+	using vec_type = glm::vec<3, fpt>;
+	const std::array<TPlane<fpt, 3>, 6> planes {
+		TPlane<fpt, 3>(box.lower, vec_type(1, 0, 0)), TPlane<fpt, 3>(box.upper, vec_type(-1, 0, 0)),
+		TPlane<fpt, 3>(box.lower, vec_type(0, 1, 0)), TPlane<fpt, 3>(box.upper, vec_type(0, -1, 0)),
+		TPlane<fpt, 3>(box.lower, vec_type(0, 0, 1)), TPlane<fpt, 3>(box.upper, vec_type(0, 0, -1))};
+	return overlaps(triangle, planes);
+}
+
+// A node of a BVH to visit, and whether its BV is known to lie within the region
+struct RegionNode {
+	std::size_t idx;
+	bool inside;
+};
+
+/* Writes the triangle indices of bvh that overlap region into "triangles". Subtrees whose
+ * BVs lie outside the region are skipped and subtrees whose BVs lie inside it are taken
+ * whole, so only triangles whose BVs straddle the boundary of the region are tested. */
+template<typename TValue, typename Region, typename Stack>
+void triangles_in(const TBVHModel<TValue>& bvh, const Region& region, Stack& stack, std::vector<std::size_t>& triangles) {
+	count_query();
+	stack.push_back(RegionNode{bvh.root_idx(), false});
+	while(!stack.empty()) {
+		count_stack_depth(stack.size());
+		const RegionNode node = stack.back();
+		stack.pop_back();
+
+		const auto& bv = bvh[node.idx];
+		RegionOverlap overlap = RegionOverlap::inside;
+		if(!node.inside) {
+			count_bv_tests(1);
+			overlap = classify(static_cast<const TValue&>(bv), region);
+		}
+		if(overlap == RegionOverlap::outside) continue;
+
+		if(!bv.is_leaf) {
+			const bool inside = overlap == RegionOverlap::inside;
+			stack.push_back(RegionNode{bv.right_idx, inside});
+			stack.push_back(RegionNode{bv.left_idx, inside});
+		} else if(overlap == RegionOverlap::inside) {
+			triangles.push_back(bv.left_idx);
+		} else {
+			count_triangle_test();
+			if(overlaps(bvh.getTriangle(bv.left_idx), region)) {
+				triangles.push_back(bv.left_idx);
+			}
+		}
+	}
+}
+
+/* Finds the triangles of bvh that overlap region and writes them into "ranges" as the
+ * fewest ranges of consecutive triangle indices, in increasing order. The buffer is cleared
+ * first but keeps its capacity. Returns the number of triangles. */
+template<typename TValue, typename Region>
+std::size_t triangle_ranges_in(const TBVHModel<TValue>& bvh, const Region& region, std::vector<TriangleRange>& ranges) {
+	ranges.clear();
+	if(bvh.size() == 0) return 0;
+
+	std::vector<std::size_t> triangles;
+	// Every visited node pushes at most two children, one of which is visited next
+	with_stack<RegionNode>(bvh.getDepth() + 1, [&](auto& stack) {
+		triangles_in(bvh, region, stack, triangles);
+		return true;
+	});
+
+	std::sort(triangles.begin(), triangles.end());
+	for(const std::size_t triangle_idx : triangles) {
+		if(ranges.empty() || ranges.back().second != triangle_idx) {
+			ranges.emplace_back(triangle_idx, triangle_idx + 1);
+		} else {
+			ranges.back().second++;
+		}
+	}
+	return triangles.size();
+}
+
+} // End of namespace detail
+
+/* Region queries find the triangles of a BVHModel that overlap a region given in the
+ * modelspace of the BVHModel, touching included, e.g. to select, decal or re-upload part of a
+ * large joined model. They write the triangles into "ranges" as ranges of consecutive
+ * triangle indices, in increasing order and as few as possible. The buffer is cleared first
+ * but keeps its capacity. Each query returns the number of triangles found. */
+
+// Finds the triangles that are at least partly within frustum, see frustum() to get one from a camera
+template<typename TValue>
+std::size_t triangles_in(
+	const TBVHModel<TValue>& bvh,
+	const TFrustum<typename TValue::floating_point_type>& frustum,
+	std::vector<TriangleRange>& ranges) {
+	return detail::triangle_ranges_in(bvh, frustum, ranges);
+}
+
+// Finds the triangles that are at least partly within sphere
+template<typename TValue>
+std::size_t triangles_in(
+	const TBVHModel<TValue>& bvh,
+	const TSphere<typename TValue::floating_point_type, 3>& sphere,
+	std::vector<TriangleRange>& ranges) {
+	return detail::triangle_ranges_in(bvh, sphere, ranges);
+}
+
+// Finds the triangles that are at least partly within box
+template<typename TValue>
+std::size_t triangles_in(
+	const TBVHModel<TValue>& bvh,
+	const TAABB<typename TValue::floating_point_type, 3>& box,
+	std::vector<TriangleRange>& ranges) {
+	return detail::triangle_ranges_in(bvh, box, ranges);
+}
+
+} // End of namespace lowpoly3d
+
+#endif // REGION_QUERY_HPP
@@ -0,0 +1,322 @@
+#ifndef SCENE_BVH_HPP
+#define SCENE_BVH_HPP
+
+#include <cassert>
+#include <cstdint> // std::uint32_t
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/aabb.hpp"
+#include "geometric_primitives/line.hpp"
+#include "ray_cast.hpp"
+#include "region_query.hpp"
+#include "renderdata.hpp"
+
+namespace lowpoly3d {
+
+// The closest triangle hit by a ray cast against a scene, and the instance it belongs to
+struct SceneRayHit {
+	std::uint32_t instance;
+	RayHit hit;
+};
+
+namespace detail {
+
+/* Builds a BVH over the boxes bounds[i] for every i of "instances" in linear time, after a radix
+ * sort of the instances along a Morton curve through their centers. Each node splits its sorted
+ * instances in halves, so the tree is balanced and siblings are close to each other. Nodes are
+ * written to "nodes" in post-order, like the nodes of a BVH, and leaves refer to their instance
+ * by both left_idx and right_idx.
+ * Returns the number of nodes on the longest path from the root to a leaf. */
+std::size_t build_instance_tree(
+	const std::vector<AABB>& bounds,
+	const std::vector<std::uint32_t>& instances,
+	std::vector<BinaryBV<AABB>>& nodes);
+
+// Fits every node of a tree built by build_instance_tree() to the current bounds of its instances
+void refit_instance_tree(const std::vector<AABB>& bounds, std::vector<BinaryBV<AABB>>& nodes);
+
+// Returns the world-space box around a BV that is placed in world-space by world
+inline AABB world_bounds(const Sphere& bv, const glm::mat4& world) {
+	const Sphere sphere = transform(bv, world);
+	return AABB(sphere.p - glm::vec3(sphere.r), sphere.p + glm::vec3(sphere.r));
+}
+
+inline AABB world_bounds(const AABB& bv, const glm::mat4& world) {
+	return transform(bv, world);
+}
+
+} // End of namespace detail
+
+/* A two-level acceleration structure over the instances of a scene. Every unique model has a
+ * single bottom-level BVH in its own modelspace, and every instance refers to a model and to
+ * the world matrix that places it, like a RenderData does. The top level is a BVH over the
+ * world-space bounds of the instances, so queries against the whole scene find the instances
+ * they may touch and only then descend into their models, without a BVH per instance.
+ *
+ * Instances refer to their world matrix rather than copying it. update() re-reads the matrices
+ * and refits the top level, or rebuilds it if instances were added or removed since. */
+template<typename TValue>
+class TSceneBVH {
+public:
+	using handle_type = std::uint32_t;
+	using model_type = TBVHModel<TValue>;
+
+	TSceneBVH() = default;
+	TSceneBVH(const TSceneBVH&) = delete;
+	TSceneBVH& operator=(const TSceneBVH&) = delete;
+
+	/* Builds the bottom-level BVH of model and adds it under "name", unless a model was
+	 * already added under that name. The model is referred to, so it must outlive the scene. */
+	const model_type& addModel(const std::string& name, const Model& model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah) {
+		return models.try_emplace(name, &model, strategy).first->second;
+	}
+
+	// Adds a model under "name" with a BVH that was built over it elsewhere, e.g. loaded from a BVHCache
+	const model_type& addModel(const std::string& name, const Model& model, BVH<TValue> bvh) {
+		return models.try_emplace(name, &model, std::move(bvh)).first->second;
+	}
+
+	// Returns the model added under "name", or nullptr if there is none
+	const model_type* getModel(const std::string& name) const {
+		const auto it = models.find(name);
+		return it != models.end() ? &it->second : nullptr;
+	}
+
+	/* Adds an instance of the model added under "model", placed in world-space by *matrix,
+	 * and returns a handle to it. Throws std::out_of_range if there is no such model. */
+	handle_type add(const std::string& model, const glm::mat4* matrix) {
+		const model_type* bvh = &models.at(model);
+		const Instance instance {bvh, matrix, true};
+		handle_type handle;
+		if(free_handles.empty()) {
+			handle = static_cast<handle_type>(instances.size());
+			instances.push_back(instance);
+			bounds.push_back(bounds_of(*bvh, *matrix));
+		} else {
+			handle = free_handles.back();
+			free_handles.pop_back();
+			instances[handle] = instance;
+			bounds[handle] = bounds_of(*bvh, *matrix);
+		}
+		dirty = true;
+		return handle;
+	}
+
+	// Adds an instance of the model and matrix of "data", which must outlive the instance
+	handle_type add(const RenderData& data) {
+		return add(data.model, &data.modelMatrix);
+	}
+
+	// Removes an instance. Its handle may be reused by a later add().
+	void remove(handle_type handle) {
+		assert(handle < instances.size() && instances[handle].alive);
+		instances[handle].alive = false;
+		free_handles.push_back(handle);
+		dirty = true;
+	}
+
+	/* Re-reads the world matrices of all instances and refits the top level to their bounds,
+	 * or rebuilds it if instances were added or removed since the last update */
+	void update() {
+		for(std::size_t i = 0; i < instances.size(); i++) {
+			if(instances[i].alive) {
+				bounds[i] = bounds_of(*instances[i].model, *instances[i].matrix);
+			}
+		}
+		if(dirty) {
+			rebuild();
+		} else {
+			detail::refit_instance_tree(bounds, nodes);
+		}
+	}
+
+	/* Rebuilds the top level over the bounds of the instances as of the last update(). Worth
+	 * calling when instances have moved so far that the refitted top level overlaps a lot. */
+	void rebuild() {
+		order.clear();
+		for(std::size_t i = 0; i < instances.size(); i++) {
+			if(instances[i].alive) order.push_back(static_cast<handle_type>(i));
+		}
+		depth = detail::build_instance_tree(bounds, order, nodes);
+		dirty = false;
+	}
+
+	/* Casts a ray, given in world-space, against the triangles of all instances. Only hits
+	 * within max_distance of the point of the ray count. Returns true and writes the closest
+	 * hit to "hit" if any triangle is hit. */
+	bool ray_cast(const Line& ray, SceneRayHit& hit, float max_distance = std::numeric_limits<float>::infinity()) const {
+		assert(!dirty && "call update() after add() or remove()");
+		if(nodes.empty()) return false;
+
+		const glm::vec3 origin = ray.getPoint(), direction = ray.getDirection();
+		const glm::vec3 inv_direction = 1.0f / direction;
+		float root_t;
+		if(!detail::ray_entry(static_cast<const AABB&>(nodes.back()), origin, direction, inv_direction, max_distance, root_t)) return false;
+
+		// Every visited node pushes at most two children, one of which is visited next
+		return detail::with_stack<detail::RayNode<float>>(depth, [&](auto& stack) {
+			stack.push_back(detail::RayNode<float>{nodes.size() - 1, root_t});
+			bool found = false;
+			float best = max_distance;
+			while(!stack.empty()) {
+				const auto node = stack.back();
+				stack.pop_back();
+				if(node.t > best) continue;
+
+				const auto& bv = nodes[node.idx];
+				if(bv.is_leaf) {
+					const Instance& instance = instances[bv.left_idx];
+					RayHit instance_hit;
+					if(lowpoly3d::ray_cast(*instance.model, *instance.matrix, ray, instance_hit, best)) {
+						best = instance_hit.distance;
+						hit = SceneRayHit{static_cast<handle_type>(bv.left_idx), instance_hit};
+						found = true;
+					}
+					continue;
+				}
+
+				detail::RayNode<float> left {bv.left_idx, 0.0f}, right {bv.right_idx, 0.0f};
+				const bool left_hit = detail::ray_entry(static_cast<const AABB&>(nodes[left.idx]), origin, direction, inv_direction, best, left.t);
+				const bool right_hit = detail::ray_entry(static_cast<const AABB&>(nodes[right.idx]), origin, direction, inv_direction, best, right.t);
+				if(left_hit && right_hit) {
+					stack.push_back(left.t <= right.t ? right : left);
+					stack.push_back(left.t <= right.t ? left : right);
+				} else if(left_hit) {
+					stack.push_back(left);
+				} else if(right_hit) {
+					stack.push_back(right);
+				}
+			}
+			return found;
+		});
+	}
+
+	/* Finds the instances whose world-space bounds overlap a world-space frustum, sphere or box,
+	 * e.g. to cull instances outside the view of a camera, and writes their handles into
+	 * "overlapping". Subtrees within the region are taken whole. The buffer is cleared first
+	 * but keeps its capacity. Returns the number of instances found. */
+	template<typename Region>
+	std::size_t instances_in(const Region& region, std::vector<handle_type>& overlapping) const {
+		assert(!dirty && "call update() after add() or remove()");
+		overlapping.clear();
+		if(nodes.empty()) return 0;
+
+		detail::with_stack<detail::RegionNode>(depth, [&](auto& stack) {
+			stack.push_back(detail::RegionNode{nodes.size() - 1, false});
+			while(!stack.empty()) {
+				const auto node = stack.back();
+				stack.pop_back();
+
+				const auto& bv = nodes[node.idx];
+				const auto overlap = node.inside ? detail::RegionOverlap::inside : detail::classify(static_cast<const AABB&>(bv), region);
+				if(overlap == detail::RegionOverlap::outside) continue;
+				if(bv.is_leaf) {
+					overlapping.push_back(static_cast<handle_type>(bv.left_idx));
+				} else {
+					const bool inside = overlap == detail::RegionOverlap::inside;
+					stack.push_back(detail::RegionNode{bv.right_idx, inside});
+					stack.push_back(detail::RegionNode{bv.left_idx, inside});
+				}
+			}
+			return true;
+		});
+		return overlapping.size();
+	}
+
+	/* Finds the instances whose triangles intersect the triangles of model, once it is placed
+	 * in world-space by "world", and writes their handles into "colliding". The buffer is
+	 * cleared first but keeps its capacity. Returns the number of instances found. */
+	std::size_t colliding(const model_type& model, const glm::mat4& world, std::vector<handle_type>& colliding) const {
+		assert(!dirty && "call update() after add() or remove()");
+		colliding.clear();
+		if(nodes.empty() || model.size() == 0) return 0;
+
+		const AABB model_bounds = bounds_of(model, world);
+		detail::with_stack<std::size_t>(depth, [&](auto& stack) {
+			stack.push_back(nodes.size() - 1);
+			while(!stack.empty()) {
+				const auto& bv = nodes[stack.back()];
+				stack.pop_back();
+				if(!lowpoly3d::colliding(static_cast<const AABB&>(bv), model_bounds)) continue;
+
+				if(bv.is_leaf) {
+					const Instance& instance = instances[bv.left_idx];
+					if(collides(model, *instance.model, world, *instance.matrix)) {
+						colliding.push_back(static_cast<handle_type>(bv.left_idx));
+					}
+				} else {
+					stack.push_back(bv.right_idx);
+					stack.push_back(bv.left_idx);
+				}
+			}
+			return true;
+		});
+		return colliding.size();
+	}
+
+	// Returns the world-space bounds of an instance as of the last update()
+	const AABB& getBounds(handle_type handle) const {
+		assert(handle < instances.size() && instances[handle].alive);
+		return bounds[handle];
+	}
+
+	// Returns the model of an instance
+	const model_type& getInstanceModel(handle_type handle) const {
+		assert(handle < instances.size() && instances[handle].alive);
+		return *instances[handle].model;
+	}
+
+	// Returns the number of instances in the scene
+	std::size_t size() const {
+		return instances.size() - free_handles.size();
+	}
+
+	// Returns the number of unique models in the scene
+	std::size_t getNumModels() const {
+		return models.size();
+	}
+
+	// Returns the number of nodes on the longest path from the root of the top level to a leaf
+	std::size_t getDepth() const {
+		return depth;
+	}
+
+private:
+	struct Instance {
+		const model_type* model;
+		const glm::mat4* matrix;
+		bool alive;
+	};
+
+	// Returns the world-space bounds of the root BV of model, placed in world-space by matrix
+	static AABB bounds_of(const model_type& model, const glm::mat4& matrix) {
+		if(model.size() == 0) {
+			const glm::vec3 origin = glm::vec3(matrix[3]);
+			return AABB(origin, origin);
+		}
+		return detail::world_bounds(static_cast<const TValue&>(model.root()), matrix);
+	}
+
+	// Models are stored in nodes of the map, so pointers to them stay valid as models are added
+	std::unordered_map<std::string, model_type> models;
+	std::vector<Instance> instances;
+	std::vector<handle_type> free_handles;
+
+	// Bounds of every instance, indexed by handle, that the top level is built over
+	std::vector<AABB> bounds;
+	std::vector<handle_type> order;
+	std::vector<BinaryBV<AABB>> nodes;
+	std::size_t depth = 0;
+	bool dirty = false;
+};
+
+using SceneBVH = TSceneBVH<Sphere>;
+using AABBSceneBVH = TSceneBVH<AABB>;
+
+} // End of namespace lowpoly3d
+
+#endif // SCENE_BVH_HPP
@@ -0,0 +1,257 @@
+#ifndef SPHERE_CAST_HPP
+#define SPHERE_CAST_HPP
+
+#include <cmath> // std::sqrt
+#include <cstddef> // std::size_t
+#include <limits>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/linesegment.hpp"
+#include "geometric_primitives/sphere.hpp"
+#include "proximity.hpp" // detail::uniform_scale
+#include "ray_cast.hpp" // detail::ray_entry, detail::RayNode
+
+namespace lowpoly3d {
+
+/* The first contact of a swept sphere with a triangle. "time" is in [0, 1], where 0 is the start
+ * of the sweep and 1 is its end. "point" is the point of the triangle that the sphere touches and
+ * "normal" is the unit normal of the triangle, on the side of the triangle the sphere came from. */
+template<typename fpt>
+struct TSphereHit {
+	std::size_t triangle_idx;
+	fpt time;
+	TPoint<fpt, 3> point;
+	glm::vec<3, fpt> normal;
+};
+
+using SphereHit = TSphereHit<float>;
+
+namespace detail {
+
+// Returns the BV grown by radius in every direction, which contains every sphere of that radius centered within the BV
+template<typename fpt>
+TSphere<fpt, 3> inflated(const TSphere<fpt, 3>& sphere, fpt radius) {
+	return TSphere<fpt, 3>(sphere.p, sphere.r + radius);
+}
+
+template<typename fpt>
+TAABB<fpt, 3> inflated(const TAABB<fpt, 3>& box, fpt radius) {
+	return TAABB<fpt, 3>(box.lower - radius, box.upper + radius);
+}
+
+/* Returns the smallest t >= 0 at which origin + t*direction is at distance radius of point,
+ * or infinity if it never gets that close or already is at t = 0 */
+template<typename fpt>
+fpt sphere_point(const glm::vec<3, fpt>& origin, const glm::vec<3, fpt>& direction, fpt radius, const TPoint<fpt, 3>& point) {
+	constexpr fpt miss = std::numeric_limits<fpt>::infinity();
+	const auto m = origin - point;
+	const fpt b = glm::dot(m, direction);
+	const fpt c = glm::dot(m, m) - radius * radius;
+	if(c <= fpt(0) || b >= fpt(0)) return miss;
+	const fpt a = glm::dot(direction, direction);
+	const fpt discriminant = b * b - a * c;
+	return discriminant < fpt(0) ? miss : (-b - std::sqrt(discriminant)) / a;
+}
+
+/* Returns the smallest t >= 0 at which origin + t*direction is at distance radius of the segment
+ * from p to q, for a point of the segment other than its ends, and writes that point. Returns
+ * infinity if there is no such t, which sphere_point() on the ends of the segment covers. */
+template<typename fpt>
+fpt sphere_edge(const glm::vec<3, fpt>& origin, const glm::vec<3, fpt>& direction, fpt radius,
+	const TPoint<fpt, 3>& p, const TPoint<fpt, 3>& q, TPoint<fpt, 3>& point) {
+
+	// The distance to the line through p and q is radius where a*t^2 + 2*b*t + c = 0, see Ericson 5.3.7
+	constexpr fpt miss = std::numeric_limits<fpt>::infinity();
+	const auto e = q - p;
+	const auto m = origin - p;
+	const fpt ee = glm::dot(e, e), me = glm::dot(m, e), de = glm::dot(direction, e);
+	const fpt a = ee * glm::dot(direction, direction) - de * de;
+	const fpt b = ee * glm::dot(m, direction) - me * de;
+	const fpt c = ee * (glm::dot(m, m) - radius * radius) - me * me;
+	// Moving parallel to the edge, away from it or starting within radius of its line
+	if(a <= fpt(0) || b >= fpt(0) || c <= fpt(0)) return miss;
+	const fpt discriminant = b * b - a * c;
+	if(discriminant < fpt(0)) return miss;
+
+	const fpt t = (-b - std::sqrt(discriminant)) / a;
+	const fpt s = (me + t * de) / ee;
+	if(s <= fpt(0) || s >= fpt(1)) return miss;
+	point = p + s * e;
+	return t;
+}
+
+/* Sweeps a sphere of the given radius whose center moves along origin + t*direction against
+ * triangle. Returns true if the sphere touches the triangle for some t in [0, t_max], in which
+ * case the smallest such t, the point of the triangle it touches first and the normal of the
+ * triangle on the side of origin are written. A sphere that starts out touching the triangle
+ * touches it at t = 0. */
+template<typename fpt>
+bool sphere_triangle(
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	fpt radius,
+	const TTriangle<fpt, 3>& triangle,
+	fpt t_max,
+	fpt& t,
+	TPoint<fpt, 3>& point,
+	glm::vec<3, fpt>& normal) {
+
+	using vec_type = glm::vec<3, fpt>;
+
+	// A degenerate triangle has no face, but its edges and corners can still be touched
+	const vec_type cross = glm::cross(triangle.p2 - triangle.p1, triangle.p3 - triangle.p1);
+	const fpt cross_length = glm::length(cross);
+	normal = cross_length > fpt(0) ? cross / cross_length : vec_type(fpt(0));
+	const fpt start_distance = glm::dot(origin - triangle.p1, normal);
+	if(start_distance < fpt(0)) normal = -normal;
+
+	// Nothing of the triangle is touched before the sphere is within radius of its plane
+	const fpt gap = std::abs(start_distance) - radius;
+	if(gap > fpt(0)) {
+		const fpt approach = -glm::dot(direction, normal);
+		if(approach <= fpt(0) || gap > t_max * approach) return false;
+
+		// The face, which the sphere touches first if it touches it at all
+		const fpt face_t = gap / approach;
+		const TPoint<fpt, 3> touched = origin + face_t * direction - radius * normal;
+		// The touched point is in the plane of the triangle, so it is inside if it is left of every edge
+		const bool inside =
+			glm::dot(glm::cross(triangle.p2 - triangle.p1, touched - triangle.p1), cross) >= fpt(0) &&
+			glm::dot(glm::cross(triangle.p3 - triangle.p2, touched - triangle.p2), cross) >= fpt(0) &&
+			glm::dot(glm::cross(triangle.p1 - triangle.p3, touched - triangle.p3), cross) >= fpt(0);
+		if(inside) {
+			t = face_t;
+			point = touched;
+			return true;
+		}
+	} else {
+		const TPoint<fpt, 3> closest = closest_point(triangle, origin);
+		if(glm::distance(closest, origin) <= radius) {
+			t = fpt(0);
+			point = closest;
+			return true;
+		}
+	}
+
+	fpt best = std::numeric_limits<fpt>::infinity();
+
+	// The edges and the corners, which the face test misses when the sphere passes outside the face
+	const TPoint<fpt, 3>* corners[3] = {&triangle.p1, &triangle.p2, &triangle.p3};
+	for(std::size_t i = 0; i < 3; i++) {
+		TPoint<fpt, 3> on_edge;
+		const fpt edge_t = sphere_edge(origin, direction, radius, *corners[i], *corners[(i + 1) % 3], on_edge);
+		if(edge_t < best) {
+			best = edge_t;
+			point = on_edge;
+		}
+		const fpt corner_t = sphere_point(origin, direction, radius, *corners[i]);
+		if(corner_t < best) {
+			best = corner_t;
+			point = *corners[i];
+		}
+	}
+
+	if(best > t_max) return false;
+	t = best;
+	return true;
+}
+
+/* Finds the triangle of bvh that a sphere of the given radius touches first as its center moves
+ * along origin + t*direction for t in [0, t_max]. BVs are grown by the radius, so that the sphere
+ * can only touch the triangles of a BV whose grown BV its center enters, and are then visited
+ * nearest first like in ray_cast(). */
+template<typename TValue, typename Stack, typename fpt = typename TValue::floating_point_type>
+bool sphere_cast(
+	const TBVHModel<TValue>& bvh,
+	const glm::vec<3, fpt>& origin,
+	const glm::vec<3, fpt>& direction,
+	fpt radius,
+	fpt t_max,
+	Stack& stack,
+	TSphereHit<fpt>& hit) {
+
+	const glm::vec<3, fpt> inv_direction = fpt(1) / direction;
+	const auto entry = [&](std::size_t idx, fpt limit, fpt& t) {
+		return ray_entry(inflated(static_cast<const TValue&>(bvh[idx]), radius), origin, direction, inv_direction, limit, t);
+	};
+
+	fpt root_t;
+	if(!entry(bvh.root_idx(), t_max, root_t)) return false;
+	stack.push_back(RayNode<fpt>{bvh.root_idx(), root_t});
+
+	bool found = false;
+	fpt best = t_max;
+	while(!stack.empty()) {
+		const RayNode<fpt> node = stack.back();
+		stack.pop_back();
+		if(node.t > best) continue;
+
+		const auto& bv = bvh[node.idx];
+		if(bv.is_leaf) {
+			fpt t;
+			TPoint<fpt, 3> point;
+			glm::vec<3, fpt> normal;
+			if(sphere_triangle(origin, direction, radius, bvh.getTriangle(bv.left_idx), best, t, point, normal)) {
+				best = t;
+				hit = TSphereHit<fpt>{bv.left_idx, t, point, normal};
+				found = true;
+			}
+		} else {
+			RayNode<fpt> left {bv.left_idx, 0}, right {bv.right_idx, 0};
+			const bool left_hit = entry(left.idx, best, left.t);
+			const bool right_hit = entry(right.idx, best, right.t);
+
+			// Push the farthest child first, so that the nearest child is visited first
+			if(left_hit && right_hit) {
+				stack.push_back(left.t <= right.t ? right : left);
+				stack.push_back(left.t <= right.t ? left : right);
+			} else if(left_hit) {
+				stack.push_back(left);
+			} else if(right_hit) {
+				stack.push_back(right);
+			}
+		}
+	}
+	return found;
+}
+
+} // End of namespace detail
+
+/* Sweeps sphere against the triangles of bvh, which is placed in world-space by bvh_world,
+ * such that the center of the sphere moves from the start to the end of segment. Only the
+ * radius of sphere is used. Returns true and writes the first contact to "hit", in world-space,
+ * if the sphere touches any triangle on the way. bvh_world may translate, rotate and scale uniformly. */
+template<typename TValue>
+bool sphere_cast(
+	const TBVHModel<TValue>& bvh,
+	const glm::mat4& bvh_world,
+	const TSphere<typename TValue::floating_point_type, 3>& sphere,
+	const TLineSegment<typename TValue::floating_point_type, 3>& segment,
+	TSphereHit<typename TValue::floating_point_type>& hit) {
+
+	using fpt = typename TValue::floating_point_type;
+	using vec_type = glm::vec<3, fpt>;
+	if(bvh.size() == 0) return false;
+
+	// Times are the same in modelspace, where the sphere is smaller by the scale of bvh_world
+	const glm::mat4 world_to_model = glm::inverse(bvh_world);
+	const vec_type start = vec_type(world_to_model * glm::vec4(segment.start, 1.0f));
+	const vec_type end = vec_type(world_to_model * glm::vec4(segment.end, 1.0f));
+	const fpt radius = sphere.r / detail::uniform_scale(bvh_world);
+
+	// Every visited node pushes at most two children, one of which is visited next
+	const bool found = detail::with_stack<detail::RayNode<fpt>>(bvh.getDepth(), [&](auto& stack) {
+		return detail::sphere_cast(bvh, start, end - start, radius, fpt(1), stack, hit);
+	});
+	if(found) {
+		hit.point = vec_type(bvh_world * glm::vec4(hit.point, 1.0f));
+		// The normal of a degenerate triangle is zero and stays so
+		const vec_type normal = vec_type(bvh_world * glm::vec4(hit.normal, 0.0f));
+		hit.normal = normal == vec_type(fpt(0)) ? normal : glm::normalize(normal);
+	}
+	return found;
+}
+
+} // End of namespace lowpoly3d
+
+#endif // SPHERE_CAST_HPP
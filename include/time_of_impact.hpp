@@ -0,0 +1,383 @@
+#ifndef TIME_OF_IMPACT_HPP
+#define TIME_OF_IMPACT_HPP
+
+#include <algorithm> // std::clamp, std::max
+#include <array>
+#include <cmath> // std::acos, std::sqrt
+#include <cstddef> // std::size_t
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp> // glm::rotate, glm::translate
+
+#include "bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/point.hpp"
+
+namespace lowpoly3d {
+
+/* The motion of an object from a start transformation to an end transformation, where
+ * time goes from 0 to 1. The object moves along a straight line and rotates about a
+ * fixed axis at constant speed, so that it stays rigid in between, unlike when the
+ * two matrices are interpolated. Both transformations may translate, rotate and scale
+ * uniformly, and must scale by the same amount. */
+template<typename fpt>
+class TMotion {
+	using vec_type = glm::vec<3, fpt>;
+	using mat_type = glm::mat<4, 4, fpt>;
+
+	mat_type start_linear; // The start transformation without its translation
+	vec_type start_translation, translation;
+	vec_type axis;
+	fpt angle;
+	fpt scale;
+
+public:
+	TMotion(const mat_type& start, const mat_type& end) :
+		start_linear(start),
+		start_translation(start[3]),
+		translation(vec_type(end[3]) - vec_type(start[3])),
+		axis(fpt(0), fpt(0), fpt(1)),
+		angle(fpt(0)),
+		scale(glm::length(vec_type(start[0]))) {
+
+		start_linear[3] = glm::vec<4, fpt>(fpt(0), fpt(0), fpt(0), fpt(1));
+		mat_type end_linear = end;
+		end_linear[3] = glm::vec<4, fpt>(fpt(0), fpt(0), fpt(0), fpt(1));
+
+		// The rotation from start to end, whose scalings cancel out. Elements are r[column][row].
+		const mat_type r = end_linear * glm::inverse(start_linear);
+		const fpt cosine = std::clamp((r[0][0] + r[1][1] + r[2][2] - fpt(1)) / fpt(2), fpt(-1), fpt(1));
+		angle = std::acos(cosine);
+
+		const vec_type skew(r[1][2] - r[2][1], r[2][0] - r[0][2], r[0][1] - r[1][0]);
+		const fpt skew_length = glm::length(skew);
+		if(skew_length > fpt(1e-6)) {
+			axis = skew / skew_length;
+		} else if(cosine < fpt(0)) {
+			// A half turn, whose axis is found from the diagonal r = 2*axis*axis^T - I instead
+			vec_type diagonal(r[0][0], r[1][1], r[2][2]);
+			const int i = diagonal.x >= diagonal.y && diagonal.x >= diagonal.z ? 0 : (diagonal.y >= diagonal.z ? 1 : 2);
+			vec_type column(r[i]);
+			column[i] += fpt(1);
+			axis = glm::normalize(column);
+		} else {
+			angle = fpt(0);
+		}
+	}
+
+	// Returns the transformation at time t
+	mat_type at(fpt t) const {
+		mat_type m = glm::translate(mat_type(fpt(1)), start_translation + t * translation);
+		if(angle != fpt(0)) {
+			m = glm::rotate(m, t * angle, axis);
+		}
+		return m * start_linear;
+	}
+
+	// Returns how far the origin of the modelspace of the object moves in world-space during a unit of time
+	const vec_type& velocity() const {
+		return translation;
+	}
+
+	/* Returns an upper bound on how far any point of the object that is at most "radius" from
+	 * the origin of its modelspace moves about that origin in world-space during a unit of time */
+	fpt angular_bound(fpt radius) const {
+		return angle * scale * radius;
+	}
+
+	// Returns an upper bound on how far such a point moves in world-space during a unit of time
+	fpt bound(fpt radius) const {
+		return glm::length(translation) + angular_bound(radius);
+	}
+};
+
+using Motion = TMotion<float>;
+
+/* The first contact of two moving models. "time" is in [0, 1], where 0 is the start
+ * of their motions and 1 is the end, and "point" is the world-space point of contact. */
+template<typename fpt>
+struct TImpact {
+	fpt time;
+	std::size_t a_triangle_idx, b_triangle_idx;
+	TPoint<fpt, 3> point;
+};
+
+using Impact = TImpact<float>;
+
+namespace detail {
+
+// Returns the largest distance from the origin to a point of the BV
+template<typename fpt>
+fpt max_distance_from_origin(const TSphere<fpt, 3>& sphere) {
+	return glm::length(sphere.p) + sphere.r;
+}
+
+template<typename fpt>
+fpt max_distance_from_origin(const TAABB<fpt, 3>& box) {
+	return glm::length(glm::max(glm::abs(box.lower), glm::abs(box.upper)));
+}
+
+template<typename fpt>
+fpt max_distance_from_origin(const TTriangle<fpt, 3>& triangle) {
+	return std::sqrt(std::max({
+		glm::dot(triangle.p1, triangle.p1),
+		glm::dot(triangle.p2, triangle.p2),
+		glm::dot(triangle.p3, triangle.p3)}));
+}
+
+/* Returns a direction from a towards b, in the modelspace of a, along which a and b are
+ * separated by their distance. Only meaningful if a and b are apart. */
+template<typename fpt>
+glm::vec<3, fpt> separating_direction(const TSphere<fpt, 3>& a, const TSphere<fpt, 3>& b) {
+	return b.p - a.p;
+}
+
+template<typename fpt>
+glm::vec<3, fpt> separating_direction(const TAABB<fpt, 3>& a, const TAABB<fpt, 3>& b) {
+	glm::vec<3, fpt> direction(fpt(0));
+	for(int i = 0; i < 3; i++) {
+		if(b.lower[i] > a.upper[i]) direction[i] = b.lower[i] - a.upper[i];
+		else if(a.lower[i] > b.upper[i]) direction[i] = b.upper[i] - a.lower[i];
+	}
+	return direction;
+}
+
+/* Returns an upper bound on how fast the gap between a and b along the world-space unit
+ * direction from a towards b closes. The parts within "radius" of their origins move along
+ * with their origins and rotate about them. */
+template<typename fpt>
+fpt approach_speed(
+	const TMotion<fpt>& a_motion,
+	const TMotion<fpt>& b_motion,
+	const glm::vec<3, fpt>& direction,
+	fpt a_radius,
+	fpt b_radius) {
+	return std::max(fpt(0), glm::dot(a_motion.velocity() - b_motion.velocity(), direction)) +
+		a_motion.angular_bound(a_radius) + b_motion.angular_bound(b_radius);
+}
+
+/* A node of the BVTT to visit, along with a lower bound on the time at which its BVs may touch.
+ * b_bv is the BV of b in the modelspace of a at that time. */
+template<typename TValue>
+struct ImpactNode {
+	std::size_t a_idx, b_idx;
+	TValue b_bv;
+	typename TValue::floating_point_type time;
+};
+
+/* Maximum number of advancements of a pair of BVs or triangles. BVs that have not touched by then are
+ * assumed to touch, which only costs a visit of their children, while triangles are searched for
+ * their first contact in what is left of the interval, see first_contact(). */
+constexpr std::size_t max_advancements = 64;
+
+// Maximum number of times that first_contact() halves the interval, which leaves parts of 2^-24 of it
+constexpr std::size_t contact_bisections = 24;
+
+// Returns the transformation that takes the modelspace of b into the modelspace of a at time t
+template<typename fpt>
+glm::mat<4, 4, fpt> relative_transform(const TMotion<fpt>& a_motion, const TMotion<fpt>& b_motion, fpt t) {
+	return glm::inverse(a_motion.at(t)) * b_motion.at(t);
+}
+
+/* Finds the first time in [t, t_max] at which two triangles, which are apart at t, come within
+ * "tolerance" of each other, for pairs that conservative advancement closes in on too slowly.
+ * The interval is bisected, earliest half first, and a part is dropped once the distance at its
+ * start is beyond tolerance by more than the triangles can approach each other over the part.
+ * Unlike a step of conservative advancement, a part shrinks by half no matter how loose that
+ * bound is. A part that is still undecided after contact_bisections is taken to touch at its
+ * start. Returns true and writes the time and the world-space contact point if they touch. */
+template<typename fpt>
+bool first_contact(
+	const TTriangle<fpt, 3>& a,
+	const TTriangle<fpt, 3>& b,
+	const TMotion<fpt>& a_motion,
+	const TMotion<fpt>& b_motion,
+	fpt t,
+	fpt t_max,
+	fpt tolerance,
+	fpt& time,
+	TPoint<fpt, 3>& point) {
+
+	// An upper bound on how fast the triangles approach each other along any direction
+	const fpt speed = glm::length(a_motion.velocity() - b_motion.velocity()) +
+		a_motion.angular_bound(max_distance_from_origin(a)) + b_motion.angular_bound(max_distance_from_origin(b));
+
+	// Every part pushes its halves one level deeper, so there are never more parts than levels
+	struct Part {
+		fpt start, end;
+		std::size_t depth;
+	};
+	std::array<Part, contact_bisections + 1> parts;
+	std::size_t count = 0;
+	parts[count++] = Part{t, t_max, 0};
+	while(count > 0) {
+		const Part part = parts[--count];
+		TPoint<fpt, 3> on_a, on_b;
+		const fpt distance = closest_points(a.transform(a_motion.at(part.start)), b.transform(b_motion.at(part.start)), on_a, on_b);
+		if(distance - speed * (part.end - part.start) > tolerance) continue;
+		if(distance <= tolerance || part.depth == contact_bisections) {
+			time = part.start;
+			point = fpt(0.5) * (on_a + on_b);
+			return true;
+		}
+		const fpt middle = fpt(0.5) * (part.start + part.end);
+		parts[count++] = Part{middle, part.end, part.depth + 1};
+		parts[count++] = Part{part.start, middle, part.depth + 1};
+	}
+	return false;
+}
+
+/* Conservative advancement of two triangles, given in the modelspaces of their objects.
+ * Starting at time t, steps forward by their distance divided by an upper bound on how fast
+ * they approach each other along the line through their closest points, which never steps
+ * past their first contact. Returns true and writes the time of contact and the world-space
+ * contact point if the triangles come within "tolerance" of each other before t_max. Pairs
+ * that approach so slowly, or graze each other so closely, that they are still apart after
+ * max_advancements are left to first_contact() from the time they were advanced to. */
+template<typename fpt>
+bool advance(
+	const TTriangle<fpt, 3>& a,
+	const TTriangle<fpt, 3>& b,
+	const TMotion<fpt>& a_motion,
+	const TMotion<fpt>& b_motion,
+	fpt t,
+	fpt t_max,
+	fpt tolerance,
+	fpt& time,
+	TPoint<fpt, 3>& point) {
+
+	const fpt a_radius = max_distance_from_origin(a), b_radius = max_distance_from_origin(b);
+	for(std::size_t i = 0; i < max_advancements; i++) {
+		if(t > t_max) return false;
+		TPoint<fpt, 3> on_a, on_b;
+		const fpt distance = closest_points(a.transform(a_motion.at(t)), b.transform(b_motion.at(t)), on_a, on_b);
+		if(distance <= tolerance) {
+			time = t;
+			point = fpt(0.5) * (on_a + on_b);
+			return true;
+		}
+		const fpt speed = approach_speed(a_motion, b_motion, (on_b - on_a) / distance, a_radius, b_radius);
+		if(speed <= fpt(0)) return false;
+		t += distance / speed;
+	}
+	return t <= t_max && first_contact(a, b, a_motion, b_motion, t, t_max, tolerance, time, point);
+}
+
+/* Finds the earliest time of impact of a and b by traversing their BVTT. Every pair of BVs
+ * is advanced conservatively, like pairs of triangles, from the time of its parent pair
+ * until they touch, which is a lower bound on the time at which any of their triangles
+ * touch. Pairs that do not touch before the earliest impact so far are skipped. a_scale
+ * takes distances in the modelspace of a into world-space. */
+template<typename TValue, typename Stack, typename fpt = typename TValue::floating_point_type>
+bool time_of_impact(
+	const TBVHModel<TValue>& a,
+	const TBVHModel<TValue>& b,
+	const TMotion<fpt>& a_motion,
+	const TMotion<fpt>& b_motion,
+	fpt a_scale,
+	fpt tolerance,
+	Stack& stack,
+	TImpact<fpt>& impact) {
+
+	using node_type = ImpactNode<TValue>;
+	fpt best = fpt(1);
+
+	/* Advances a[a_idx] and b[b_idx] from time t, where b_bv is b[b_idx] in the modelspace of a,
+	 * and returns the node at which they touch. Its time is greater than best if they do not. */
+	const auto advance_node = [&](std::size_t a_idx, std::size_t b_idx, TValue b_bv, fpt t) {
+		const TValue& bva = a[a_idx];
+		const TValue& bvb = b[b_idx];
+		const fpt a_radius = max_distance_from_origin(bva), b_radius = max_distance_from_origin(bvb);
+		for(std::size_t i = 0; i < max_advancements; i++) {
+			const fpt distance = signed_distance(bva, b_bv) * a_scale;
+			if(distance <= tolerance) break;
+			const glm::vec<4, fpt> direction(separating_direction(bva, b_bv), fpt(0));
+			const fpt speed = approach_speed(a_motion, b_motion,
+				glm::normalize(glm::vec<3, fpt>(a_motion.at(t) * direction)), a_radius, b_radius);
+			if(speed <= fpt(0)) return node_type{a_idx, b_idx, b_bv, std::numeric_limits<fpt>::infinity()};
+			t += distance / speed;
+			if(t > best) break;
+			b_bv = transform(bvb, relative_transform(a_motion, b_motion, t));
+		}
+		return node_type{a_idx, b_idx, b_bv, t};
+	};
+
+	// Pushes those of two nodes that may touch before best, such that the earliest is popped first
+	const auto push = [&](const node_type& first, const node_type& second) {
+		const node_type& early = first.time <= second.time ? first : second;
+		const node_type& late = first.time <= second.time ? second : first;
+		if(late.time <= best) stack.push_back(late);
+		if(early.time <= best) stack.push_back(early);
+	};
+
+	const node_type root = advance_node(a.root_idx(), b.root_idx(),
+		transform(b.root(), relative_transform(a_motion, b_motion, fpt(0))), fpt(0));
+	if(root.time > best) return false;
+	stack.push_back(root);
+
+	bool found = false;
+	while(!stack.empty()) {
+		const node_type node = stack.back();
+		stack.pop_back();
+		if(node.time > best) continue;
+
+		const auto& bva = a[node.a_idx];
+		const auto& bvb = b[node.b_idx];
+
+		if(bva.is_leaf && bvb.is_leaf) {
+			fpt time;
+			TPoint<fpt, 3> point;
+			if(advance(a.getTriangle(bva.left_idx), b.getTriangle(bvb.left_idx), a_motion, b_motion,
+				node.time, best, tolerance, time, point) && (!found || time < best)) {
+				best = time;
+				impact = TImpact<fpt>{time, bva.left_idx, bvb.left_idx, point};
+				found = true;
+			}
+		} else if(bvb.is_leaf || (!bva.is_leaf && bva.size() > node.b_bv.size())) {
+			push(
+				advance_node(bva.left_idx, node.b_idx, node.b_bv, node.time),
+				advance_node(bva.right_idx, node.b_idx, node.b_bv, node.time));
+		} else {
+			const glm::mat<4, 4, fpt> b_to_a = relative_transform(a_motion, b_motion, node.time);
+			push(
+				advance_node(node.a_idx, bvb.left_idx, transform(b[bvb.left_idx], b_to_a), node.time),
+				advance_node(node.a_idx, bvb.right_idx, transform(b[bvb.right_idx], b_to_a), node.time));
+		}
+	}
+	return found;
+}
+
+} // End of namespace detail
+
+/* Finds the first time at which a triangle of a touches a triangle of b, as a moves from
+ * a_start to a_end while b moves from b_start to b_end, see TMotion. Triangles touch once
+ * they come within "tolerance" of each other, in world-space units. Returns true and writes
+ * the impact if they touch at some time in [0, 1]. A pair of triangles that conservative
+ * advancement does not bring within tolerance in a bounded number of steps is bisected over
+ * the rest of the interval instead. No impact is reported for triangles that are never closer
+ * than tolerance plus how far they can approach each other over 2^-24 of the interval. */
+template<typename TValue>
+bool time_of_impact(
+	const TBVHModel<TValue>& a,
+	const TBVHModel<TValue>& b,
+	const glm::mat4& a_start,
+	const glm::mat4& a_end,
+	const glm::mat4& b_start,
+	const glm::mat4& b_end,
+	TImpact<typename TValue::floating_point_type>& impact,
+	typename TValue::floating_point_type tolerance = typename TValue::floating_point_type(1e-3)) {
+
+	using fpt = typename TValue::floating_point_type;
+	if(a.size() == 0 || b.size() == 0) return false;
+
+	const TMotion<fpt> a_motion(a_start, a_end), b_motion(b_start, b_end);
+	const fpt a_scale = glm::length(glm::vec<3, fpt>(a_start[0]));
+
+	// Every visited pair pushes at most two child pairs, one of which is visited next
+	return detail::with_stack<detail::ImpactNode<TValue>>(a.getDepth() + b.getDepth(), [&](auto& stack) {
+		return detail::time_of_impact(a, b, a_motion, b_motion, a_scale, tolerance, stack, impact);
+	});
+}
+
+} // End of namespace lowpoly3d
+
+#endif // TIME_OF_IMPACT_HPP
@@ -0,0 +1,65 @@
+#ifndef FIXED_STACK_HPP
+#define FIXED_STACK_HPP
+
+#include <cassert>
+#include <cstddef> // std::size_t
+#include <new> // placement new
+#include <type_traits>
+#include <utility> // std::forward
+
+namespace lowpoly3d {
+
+/* A stack with storage for "capacity" elements inside the object itself, so it never
+ * allocates. Its interface is the subset of std::vector used by explicit-stack traversals,
+ * so a traversal can be written once and run on either. Elements need not be default
+ * constructible, but must be trivially destructible since popped elements are not destroyed. */
+template<typename T, std::size_t capacity>
+class FixedStack {
+	static_assert(std::is_trivially_destructible_v<T>, "FixedStack never runs destructors");
+	alignas(T) unsigned char storage[capacity * sizeof(T)];
+	std::size_t count = 0;
+
+	T* data() { return reinterpret_cast<T*>(storage); }
+	const T* data() const { return reinterpret_cast<const T*>(storage); }
+
+public:
+	FixedStack() = default;
+	FixedStack(const FixedStack&) = delete;
+	FixedStack& operator=(const FixedStack&) = delete;
+
+	template<typename... Args>
+	void emplace_back(Args&&... args) {
+		assert(count < capacity);
+		new (data() + count) T{std::forward<Args>(args)...};
+		count++;
+	}
+
+	void push_back(const T& value) {
+		emplace_back(value);
+	}
+
+	void pop_back() {
+		assert(count > 0);
+		count--;
+	}
+
+	T& back() {
+		assert(count > 0);
+		return data()[count-1];
+	}
+
+	const T& back() const {
+		assert(count > 0);
+		return data()[count-1];
+	}
+
+	bool empty() const { return count == 0; }
+	bool full() const { return count == capacity; }
+	std::size_t size() const { return count; }
+	static constexpr std::size_t max_size() { return capacity; }
+	void clear() { count = 0; }
+};
+
+} // End of namespace lowpoly3d
+
+#endif // FIXED_STACK_HPP
@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef> // std::size_t, std::byte
+#include <filesystem>
+
+namespace lowpoly3d {
+
+/* A file mapped read-only into memory for as long as the MappedFile is alive.
+ * Pages are read from disk on first access, so mapping a file is cheap
+ * regardless of its size. */
+class MappedFile {
+public:
+	// Maps the file at path. If it can not be opened or mapped, is_open() is false.
+	explicit MappedFile(const std::filesystem::path& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool is_open() const { return bytes != nullptr; }
+
+	// Returns the first byte of the file, which is aligned to at least a page
+	const std::byte* data() const { return bytes; }
+	std::size_t size() const { return num_bytes; }
+
+private:
+	const std::byte* bytes = nullptr;
+	std::size_t num_bytes = 0;
+#if defined(_WIN32)
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+};
+
+} // End of namespace lowpoly3d
+
+#endif // MAPPED_FILE_HPP
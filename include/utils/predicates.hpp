@@ -0,0 +1,136 @@
+/* Orientation predicates that return the exact sign of their determinant, in the style of
+ * Shewchuk's "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+ *
+ * A determinant is first evaluated in the floating-point type of its points. Its sign is returned
+ * if the determinant is larger than a bound on the rounding error, which is the case for all but
+ * nearly degenerate inputs. Otherwise it is evaluated exactly with expansions of doubles, which
+ * float and double coordinates both convert to without rounding. Overflow and underflow are not
+ * accounted for. All predicates return 1, 0 or -1. */
+
+#ifndef PREDICATES_HPP
+#define PREDICATES_HPP
+
+#include <cmath> // std::abs
+#include <cstddef> // std::size_t
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#include "geometric_primitives/point.hpp"
+
+namespace lowpoly3d {
+
+namespace detail {
+
+// Half of the distance from 1 to the next representable number, i.e. the relative error of one rounding
+template<typename fpt>
+constexpr fpt rounding_error = std::numeric_limits<fpt>::epsilon() / fpt(2);
+
+/* A determinant whose magnitude is above its bound times its permanent, the same determinant
+ * evaluated with the absolute values of all products, has the sign it was evaluated to */
+template<typename fpt>
+constexpr fpt orient2d_bound = (fpt(3) + fpt(16) * rounding_error<fpt>) * rounding_error<fpt>;
+
+template<typename fpt>
+constexpr fpt orient3d_bound = (fpt(7) + fpt(56) * rounding_error<fpt>) * rounding_error<fpt>;
+
+template<typename fpt, glm::length_t dim>
+constexpr fpt side_bound = (fpt(dim + 1) + fpt(16 * dim) * rounding_error<fpt>) * rounding_error<fpt>;
+
+template<typename fpt>
+int sign(fpt x) {
+	return (x > fpt(0)) - (x < fpt(0));
+}
+
+// The exact fallbacks of the predicates below, see predicates.cpp
+int orient2d_exact(glm::dvec2 const& a, glm::dvec2 const& b, glm::dvec2 const& c);
+int orient3d_exact(glm::dvec3 const& a, glm::dvec3 const& b, glm::dvec3 const& c, glm::dvec3 const& d);
+template<glm::length_t dim>
+int side_exact(glm::vec<dim, double> const& n, glm::vec<dim, double> const& p, glm::vec<dim, double> const& d);
+
+} // End of namespace detail
+
+// The sign of (b - a) x (c - a), which is positive if c is to the left of the line from a to b
+template<typename fpt>
+int orient2d(TPoint<fpt, 2> const& a, TPoint<fpt, 2> const& b, TPoint<fpt, 2> const& c) {
+	const fpt left = (b.x - a.x) * (c.y - a.y), right = (b.y - a.y) * (c.x - a.x);
+	const fpt det = left - right;
+	if(std::abs(det) > detail::orient2d_bound<fpt> * (std::abs(left) + std::abs(right))) return detail::sign(det);
+	return detail::orient2d_exact(glm::dvec2(a), glm::dvec2(b), glm::dvec2(c));
+}
+
+/* The sign of (d - c) . ((a - c) x (b - c)) for the plane through a, b and c, which is computed once
+ * such that many points d can be tested against it. The sign is positive if d is on the side of the
+ * plane that (a - c) x (b - c) points to, and zero if d is in the plane or if a, b and c are collinear. */
+template<typename fpt>
+class TOrient3d {
+public:
+	using vec_type = glm::vec<3, fpt>;
+
+	TOrient3d(TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b, TPoint<fpt, 3> const& c) : a(a), b(b), c(c) {
+		const vec_type v = a - c, w = b - c;
+		n = glm::cross(v, w);
+		permanent = glm::abs(vec_type(v.y * w.z, v.z * w.x, v.x * w.y)) + glm::abs(vec_type(v.z * w.y, v.x * w.z, v.y * w.x));
+	}
+
+	int operator()(TPoint<fpt, 3> const& d) const {
+		const vec_type u = d - c;
+		const fpt det = glm::dot(u, n);
+		if(std::abs(det) > detail::orient3d_bound<fpt> * glm::dot(glm::abs(u), permanent)) return detail::sign(det);
+		return detail::orient3d_exact(glm::dvec3(a), glm::dvec3(b), glm::dvec3(c), glm::dvec3(d));
+	}
+
+	// True iff a, b and c are collinear, in which case every point is in their "plane"
+	bool degenerate() const {
+		// Every component of the normal is a 2D orientation of a, b and c, projected along an axis
+		for(std::size_t axis = 0; axis < 3; axis++) {
+			if(std::abs(n[axis]) > detail::orient2d_bound<fpt> * permanent[axis]) return false;
+		}
+		const std::size_t y[3] = {1, 2, 0}, z[3] = {2, 0, 1};
+		for(std::size_t axis = 0; axis < 3; axis++) {
+			const auto project = [&](TPoint<fpt, 3> const& p) { return glm::dvec2(p[y[axis]], p[z[axis]]); };
+			if(detail::orient2d_exact(project(a), project(b), project(c)) != 0) return false;
+		}
+		return true;
+	}
+
+	// The normal (a - c) x (b - c), as evaluated in fpt
+	vec_type const& normal() const { return n; }
+
+	// The normal evaluated with the absolute values of its products, which bounds the rounding error of the normal
+	vec_type const& normal_permanent() const { return permanent; }
+
+	TPoint<fpt, 3> const& point() const { return c; }
+
+private:
+	TPoint<fpt, 3> a, b, c;
+	vec_type n, permanent;
+};
+
+using Orient3d = TOrient3d<float>;
+
+// The sign of (d - c) . ((a - c) x (b - c)), see TOrient3d
+template<typename fpt>
+int orient3d(TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b, TPoint<fpt, 3> const& c, TPoint<fpt, 3> const& d) {
+	return TOrient3d<fpt>(a, b, c)(d);
+}
+
+// True iff a, b and c are on a line, which includes when two or all of them are equal
+template<typename fpt>
+bool collinear(TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b, TPoint<fpt, 3> const& c) {
+	return TOrient3d<fpt>(a, b, c).degenerate();
+}
+
+/* The sign of (d - p) . n, which is positive if d is on the side of the plane through p with
+ * normal n that n points to. Unlike orient3d, the normal is taken to be exact as given. */
+template<typename fpt, glm::length_t dim>
+int side(glm::vec<dim, fpt> const& n, glm::vec<dim, fpt> const& p, glm::vec<dim, fpt> const& d) {
+	const glm::vec<dim, fpt> u = d - p;
+	const fpt det = glm::dot(u, n);
+	if(std::abs(det) > detail::side_bound<fpt, dim> * glm::dot(glm::abs(u), glm::abs(n))) return detail::sign(det);
+	return detail::side_exact<dim>(glm::vec<dim, double>(n), glm::vec<dim, double>(p), glm::vec<dim, double>(d));
+}
+
+} // End of namespace lowpoly3d
+
+#endif // PREDICATES_HPP
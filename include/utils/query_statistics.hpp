@@ -0,0 +1,82 @@
+#ifndef QUERY_STATISTICS_HPP
+#define QUERY_STATISTICS_HPP
+
+#include <algorithm> // std::max
+#include <cstddef> // std::size_t
+
+/* Counting the work done by BVH queries costs a little on every BV test, so it is only
+ * compiled in when LOWPOLY3D_BVH_STATISTICS is defined, see the CMake option
+ * lowpoly3d_BVH_STATISTICS. Otherwise the counters are empty inline functions. */
+
+namespace lowpoly3d {
+
+// The work done by the BVH queries that ran within the scope of a QueryProfiler
+struct QueryStatistics {
+	std::size_t queries = 0;
+	std::size_t bv_tests = 0;        // Pairs of BVs tested for overlap
+	std::size_t triangle_tests = 0;  // Pairs of triangles tested for intersection
+	std::size_t max_stack_depth = 0; // Most nodes on the traversal stack at once, over all queries
+};
+
+#ifdef LOWPOLY3D_BVH_STATISTICS
+constexpr bool query_statistics_enabled = true;
+#else
+constexpr bool query_statistics_enabled = false;
+#endif
+
+namespace detail {
+
+#ifdef LOWPOLY3D_BVH_STATISTICS
+// The statistics of the innermost QueryProfiler on this thread, if any
+inline thread_local QueryStatistics* current_query_statistics = nullptr;
+
+inline void count_query() {
+	if(current_query_statistics) current_query_statistics->queries++;
+}
+
+inline void count_bv_tests(std::size_t count) {
+	if(current_query_statistics) current_query_statistics->bv_tests += count;
+}
+
+inline void count_triangle_test() {
+	if(current_query_statistics) current_query_statistics->triangle_tests++;
+}
+
+inline void count_stack_depth(std::size_t depth) {
+	if(current_query_statistics) {
+		current_query_statistics->max_stack_depth = std::max(current_query_statistics->max_stack_depth, depth);
+	}
+}
+#else
+inline void count_query() { }
+inline void count_bv_tests(std::size_t) { }
+inline void count_triangle_test() { }
+inline void count_stack_depth(std::size_t) { }
+#endif
+
+} // End of namespace detail
+
+/* Adds the work of every BVH query on this thread to "statistics" for as long as the
+ * profiler lives. Profilers nest, only the innermost one counts. Does nothing unless
+ * query_statistics_enabled. */
+class QueryProfiler {
+#ifdef LOWPOLY3D_BVH_STATISTICS
+	QueryStatistics* previous;
+public:
+	explicit QueryProfiler(QueryStatistics& statistics) : previous(detail::current_query_statistics) {
+		detail::current_query_statistics = &statistics;
+	}
+	~QueryProfiler() {
+		detail::current_query_statistics = previous;
+	}
+#else
+public:
+	explicit QueryProfiler(QueryStatistics&) { }
+#endif
+	QueryProfiler(const QueryProfiler&) = delete;
+	QueryProfiler& operator=(const QueryProfiler&) = delete;
+};
+
+} // End of namespace lowpoly3d
+
+#endif // QUERY_STATISTICS_HPP
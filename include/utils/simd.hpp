@@ -0,0 +1,242 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <array>
+#include <cmath> // std::sqrt, std::abs
+#include <cstddef> // std::size_t
+
+/* SSE2 is part of every x86-64 target, so no compiler flags are needed for it.
+ * Other targets fall back to plain loops over four floats. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LOWPOLY3D_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+/* AVX needs to be enabled with the lowpoly3d_AVX option. Without it float8 is two float4. */
+#if defined(__AVX__)
+#define LOWPOLY3D_SIMD_AVX
+#include <immintrin.h>
+#endif
+
+namespace lowpoly3d::simd {
+
+/* Four lanes of true or false, the result of comparing two float4 */
+class mask4 {
+#ifdef LOWPOLY3D_SIMD_SSE2
+	__m128 v;
+public:
+	explicit mask4(__m128 v) : v(v) { }
+	__m128 native() const { return v; }
+
+	friend mask4 operator&(mask4 a, mask4 b) { return mask4(_mm_and_ps(a.v, b.v)); }
+	friend mask4 operator|(mask4 a, mask4 b) { return mask4(_mm_or_ps(a.v, b.v)); }
+
+	// Returns bit i set if lane i is true
+	int bits() const { return _mm_movemask_ps(v); }
+#else
+	std::array<bool, 4> v;
+public:
+	explicit mask4(const std::array<bool, 4>& v) : v(v) { }
+	bool operator[](std::size_t i) const { return v[i]; }
+
+	friend mask4 operator&(mask4 a, mask4 b) { return mask4({a.v[0] && b.v[0], a.v[1] && b.v[1], a.v[2] && b.v[2], a.v[3] && b.v[3]}); }
+	friend mask4 operator|(mask4 a, mask4 b) { return mask4({a.v[0] || b.v[0], a.v[1] || b.v[1], a.v[2] || b.v[2], a.v[3] || b.v[3]}); }
+
+	int bits() const { return int(v[0]) | int(v[1]) << 1 | int(v[2]) << 2 | int(v[3]) << 3; }
+#endif
+	bool any() const { return bits() != 0; }
+	bool all() const { return bits() == 0xF; }
+};
+
+/* Four floats that are operated on at once */
+class float4 {
+#ifdef LOWPOLY3D_SIMD_SSE2
+	__m128 v;
+public:
+	float4() = default;
+	explicit float4(__m128 v) : v(v) { }
+	float4(float x) : v(_mm_set1_ps(x)) { }
+	float4(float x, float y, float z, float w) : v(_mm_setr_ps(x, y, z, w)) { }
+	__m128 native() const { return v; }
+
+	static float4 load(const float* p) { return float4(_mm_loadu_ps(p)); }
+	void store(float* p) const { _mm_storeu_ps(p, v); }
+
+	friend float4 operator+(float4 a, float4 b) { return float4(_mm_add_ps(a.v, b.v)); }
+	friend float4 operator-(float4 a, float4 b) { return float4(_mm_sub_ps(a.v, b.v)); }
+	friend float4 operator*(float4 a, float4 b) { return float4(_mm_mul_ps(a.v, b.v)); }
+	friend float4 operator/(float4 a, float4 b) { return float4(_mm_div_ps(a.v, b.v)); }
+
+	friend mask4 operator<(float4 a, float4 b) { return mask4(_mm_cmplt_ps(a.v, b.v)); }
+	friend mask4 operator<=(float4 a, float4 b) { return mask4(_mm_cmple_ps(a.v, b.v)); }
+	friend mask4 operator>(float4 a, float4 b) { return mask4(_mm_cmpgt_ps(a.v, b.v)); }
+	friend mask4 operator>=(float4 a, float4 b) { return mask4(_mm_cmpge_ps(a.v, b.v)); }
+
+	// Note that min and max return b if either a or b is NaN
+	friend float4 min(float4 a, float4 b) { return float4(_mm_min_ps(a.v, b.v)); }
+	friend float4 max(float4 a, float4 b) { return float4(_mm_max_ps(a.v, b.v)); }
+	friend float4 sqrt(float4 a) { return float4(_mm_sqrt_ps(a.v)); }
+	friend float4 abs(float4 a) { return float4(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+
+	// Returns a where m is true and b elsewhere
+	friend float4 select(mask4 m, float4 a, float4 b) {
+		return float4(_mm_or_ps(_mm_and_ps(m.native(), a.v), _mm_andnot_ps(m.native(), b.v)));
+	}
+#else
+	std::array<float, 4> v;
+
+	template<typename F>
+	static float4 map(float4 a, float4 b, F&& f) { return float4(f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3])); }
+	template<typename F>
+	static mask4 compare(float4 a, float4 b, F&& f) { return mask4({f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3])}); }
+public:
+	float4() = default;
+	float4(float x) : v{x, x, x, x} { }
+	float4(float x, float y, float z, float w) : v{x, y, z, w} { }
+
+	static float4 load(const float* p) { return float4(p[0], p[1], p[2], p[3]); }
+	void store(float* p) const { for(std::size_t i = 0; i < 4; i++) p[i] = v[i]; }
+
+	friend float4 operator+(float4 a, float4 b) { return map(a, b, [](float x, float y) { return x + y; }); }
+	friend float4 operator-(float4 a, float4 b) { return map(a, b, [](float x, float y) { return x - y; }); }
+	friend float4 operator*(float4 a, float4 b) { return map(a, b, [](float x, float y) { return x * y; }); }
+	friend float4 operator/(float4 a, float4 b) { return map(a, b, [](float x, float y) { return x / y; }); }
+
+	friend mask4 operator<(float4 a, float4 b) { return compare(a, b, [](float x, float y) { return x < y; }); }
+	friend mask4 operator<=(float4 a, float4 b) { return compare(a, b, [](float x, float y) { return x <= y; }); }
+	friend mask4 operator>(float4 a, float4 b) { return compare(a, b, [](float x, float y) { return x > y; }); }
+	friend mask4 operator>=(float4 a, float4 b) { return compare(a, b, [](float x, float y) { return x >= y; }); }
+
+	// Same NaN behaviour as SSE: b is returned unless a < b (or a > b) holds
+	friend float4 min(float4 a, float4 b) { return map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+	friend float4 max(float4 a, float4 b) { return map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+	friend float4 sqrt(float4 a) { return float4(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])); }
+	friend float4 abs(float4 a) { return float4(std::abs(a.v[0]), std::abs(a.v[1]), std::abs(a.v[2]), std::abs(a.v[3])); }
+
+	friend float4 select(mask4 m, float4 a, float4 b) {
+		return float4(m[0] ? a.v[0] : b.v[0], m[1] ? a.v[1] : b.v[1], m[2] ? a.v[2] : b.v[2], m[3] ? a.v[3] : b.v[3]);
+	}
+#endif
+
+	// Returns lane i
+	float operator[](std::size_t i) const {
+		alignas(16) float lanes[4];
+		store(lanes);
+		return lanes[i];
+	}
+};
+
+/* Eight lanes of true or false, the result of comparing two float8 */
+class mask8 {
+#ifdef LOWPOLY3D_SIMD_AVX
+	__m256 v;
+public:
+	explicit mask8(__m256 v) : v(v) { }
+	__m256 native() const { return v; }
+
+	friend mask8 operator&(mask8 a, mask8 b) { return mask8(_mm256_and_ps(a.v, b.v)); }
+	friend mask8 operator|(mask8 a, mask8 b) { return mask8(_mm256_or_ps(a.v, b.v)); }
+
+	int bits() const { return _mm256_movemask_ps(v); }
+#else
+	mask4 lo, hi;
+public:
+	mask8(mask4 lo, mask4 hi) : lo(lo), hi(hi) { }
+	mask4 low() const { return lo; }
+	mask4 high() const { return hi; }
+
+	friend mask8 operator&(mask8 a, mask8 b) { return mask8(a.lo & b.lo, a.hi & b.hi); }
+	friend mask8 operator|(mask8 a, mask8 b) { return mask8(a.lo | b.lo, a.hi | b.hi); }
+
+	int bits() const { return lo.bits() | hi.bits() << 4; }
+#endif
+	bool any() const { return bits() != 0; }
+	bool all() const { return bits() == 0xFF; }
+};
+
+/* Eight floats that are operated on at once, with the same interface as float4 */
+class float8 {
+#ifdef LOWPOLY3D_SIMD_AVX
+	__m256 v;
+public:
+	float8() = default;
+	explicit float8(__m256 v) : v(v) { }
+	float8(float x) : v(_mm256_set1_ps(x)) { }
+	__m256 native() const { return v; }
+
+	static float8 load(const float* p) { return float8(_mm256_loadu_ps(p)); }
+	void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+	friend float8 operator+(float8 a, float8 b) { return float8(_mm256_add_ps(a.v, b.v)); }
+	friend float8 operator-(float8 a, float8 b) { return float8(_mm256_sub_ps(a.v, b.v)); }
+	friend float8 operator*(float8 a, float8 b) { return float8(_mm256_mul_ps(a.v, b.v)); }
+	friend float8 operator/(float8 a, float8 b) { return float8(_mm256_div_ps(a.v, b.v)); }
+
+	friend mask8 operator<(float8 a, float8 b) { return mask8(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+	friend mask8 operator<=(float8 a, float8 b) { return mask8(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+	friend mask8 operator>(float8 a, float8 b) { return mask8(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)); }
+	friend mask8 operator>=(float8 a, float8 b) { return mask8(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)); }
+
+	friend float8 min(float8 a, float8 b) { return float8(_mm256_min_ps(a.v, b.v)); }
+	friend float8 max(float8 a, float8 b) { return float8(_mm256_max_ps(a.v, b.v)); }
+	friend float8 sqrt(float8 a) { return float8(_mm256_sqrt_ps(a.v)); }
+	friend float8 abs(float8 a) { return float8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+
+	friend float8 select(mask8 m, float8 a, float8 b) { return float8(_mm256_blendv_ps(b.v, a.v, m.native())); }
+#else
+	float4 lo, hi;
+public:
+	float8() = default;
+	float8(float4 lo, float4 hi) : lo(lo), hi(hi) { }
+	float8(float x) : lo(x), hi(x) { }
+
+	static float8 load(const float* p) { return float8(float4::load(p), float4::load(p + 4)); }
+	void store(float* p) const { lo.store(p); hi.store(p + 4); }
+
+	friend float8 operator+(float8 a, float8 b) { return float8(a.lo + b.lo, a.hi + b.hi); }
+	friend float8 operator-(float8 a, float8 b) { return float8(a.lo - b.lo, a.hi - b.hi); }
+	friend float8 operator*(float8 a, float8 b) { return float8(a.lo * b.lo, a.hi * b.hi); }
+	friend float8 operator/(float8 a, float8 b) { return float8(a.lo / b.lo, a.hi / b.hi); }
+
+	friend mask8 operator<(float8 a, float8 b) { return mask8(a.lo < b.lo, a.hi < b.hi); }
+	friend mask8 operator<=(float8 a, float8 b) { return mask8(a.lo <= b.lo, a.hi <= b.hi); }
+	friend mask8 operator>(float8 a, float8 b) { return mask8(a.lo > b.lo, a.hi > b.hi); }
+	friend mask8 operator>=(float8 a, float8 b) { return mask8(a.lo >= b.lo, a.hi >= b.hi); }
+
+	friend float8 min(float8 a, float8 b) { return float8(min(a.lo, b.lo), min(a.hi, b.hi)); }
+	friend float8 max(float8 a, float8 b) { return float8(max(a.lo, b.lo), max(a.hi, b.hi)); }
+	friend float8 sqrt(float8 a) { return float8(sqrt(a.lo), sqrt(a.hi)); }
+	friend float8 abs(float8 a) { return float8(abs(a.lo), abs(a.hi)); }
+
+	friend float8 select(mask8 m, float8 a, float8 b) { return float8(select(m.low(), a.lo, b.lo), select(m.high(), a.hi, b.hi)); }
+#endif
+
+	// Returns lane i
+	float operator[](std::size_t i) const {
+		alignas(32) float lanes[8];
+		store(lanes);
+		return lanes[i];
+	}
+};
+
+// Returns the smallest of the four lanes
+inline float reduce_min(float4 a) {
+	alignas(16) float lanes[4];
+	a.store(lanes);
+	const float low = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+	const float high = lanes[2] < lanes[3] ? lanes[2] : lanes[3];
+	return low < high ? low : high;
+}
+
+// Returns the largest of the four lanes
+inline float reduce_max(float4 a) {
+	alignas(16) float lanes[4];
+	a.store(lanes);
+	const float low = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+	const float high = lanes[2] > lanes[3] ? lanes[2] : lanes[3];
+	return low > high ? low : high;
+}
+
+} // End of namespace lowpoly3d::simd
+
+#endif // SIMD_HPP
@@ -0,0 +1,115 @@
+/* Points, planes and orientations of several lanes at once, for kernels that test one primitive
+ * against several others with float4 or float8. See triangle_batch.cpp and soa.cpp. */
+
+#ifndef SIMD_GEOMETRY_HPP
+#define SIMD_GEOMETRY_HPP
+
+#include <glm/glm.hpp>
+
+#include "geometric_primitives/point.hpp"
+#include "utils/predicates.hpp"
+#include "utils/simd.hpp"
+
+namespace lowpoly3d::simd {
+
+// Points of all lanes, one coordinate per register
+template<typename floatN>
+struct Lanes3 {
+	floatN x, y, z;
+};
+
+// The same point in every lane
+template<typename floatN>
+Lanes3<floatN> broadcast(Point const& p) {
+	return {p.x, p.y, p.z};
+}
+
+template<typename floatN>
+Lanes3<floatN> operator+(Lanes3<floatN> const& a, Lanes3<floatN> const& b) {
+	return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+template<typename floatN>
+Lanes3<floatN> operator-(Lanes3<floatN> const& a, Lanes3<floatN> const& b) {
+	return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+template<typename floatN>
+Lanes3<floatN> cross(Lanes3<floatN> const& a, Lanes3<floatN> const& b) {
+	return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+template<typename floatN>
+floatN dot(Lanes3<floatN> const& a, Lanes3<floatN> const& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template<typename floatN>
+Lanes3<floatN> abs(Lanes3<floatN> const& a) {
+	return {abs(a.x), abs(a.y), abs(a.z)};
+}
+
+// Returns m * (p, w) for every lane, summed in the same order as glm does
+template<typename floatN>
+Lanes3<floatN> transform(glm::mat4 const& m, Lanes3<floatN> const& p, float w) {
+	const auto row = [&](int i) {
+		return (floatN(m[0][i]) * p.x + floatN(m[1][i]) * p.y) + (floatN(m[2][i]) * p.z + floatN(m[3][i] * w));
+	};
+	return {row(0), row(1), row(2)};
+}
+
+/* A determinant and the bound on its rounding error, see utils/predicates.hpp. Its sign is
+ * certain where it is larger than the bound, and is left to the scalar predicate elsewhere. */
+template<typename floatN>
+struct Filtered {
+	floatN value, bound;
+
+	auto positive() const { return value > bound; }
+	auto negative() const { return value < floatN(0.0f) - bound; }
+	auto uncertain() const { return abs(value) <= bound; }
+};
+
+// The planes through a, b and c of all lanes, like TOrient3d
+template<typename floatN>
+struct Planes {
+	Lanes3<floatN> c, normal, permanent;
+};
+
+template<typename floatN>
+Planes<floatN> planes(Lanes3<floatN> const& a, Lanes3<floatN> const& b, Lanes3<floatN> const& c) {
+	const auto v = a - c, w = b - c;
+	const Lanes3<floatN> permanent {
+		abs(v.y * w.z) + abs(v.z * w.y),
+		abs(v.z * w.x) + abs(v.x * w.z),
+		abs(v.x * w.y) + abs(v.y * w.x)};
+	return {c, cross(v, w), permanent};
+}
+
+// The same plane in every lane
+template<typename floatN>
+Planes<floatN> broadcast(Orient3d const& plane) {
+	return {broadcast<floatN>(plane.point()), broadcast<floatN>(plane.normal()), broadcast<floatN>(plane.normal_permanent())};
+}
+
+// The filtered orient3d(a, b, c, d) of every lane, given the planes through a, b and c
+template<typename floatN>
+Filtered<floatN> side(Planes<floatN> const& planes, Lanes3<floatN> const& d) {
+	const auto u = d - planes.c;
+	return {dot(u, planes.normal), floatN(detail::orient3d_bound<float>) * dot(abs(u), planes.permanent)};
+}
+
+// The filtered side(n, p, d) of every lane, where n is taken to be exact like side() does
+template<typename floatN>
+Filtered<floatN> side(Lanes3<floatN> const& n, Lanes3<floatN> const& p, Lanes3<floatN> const& d) {
+	const auto u = d - p;
+	return {dot(u, n), floatN(detail::side_bound<float, 3>) * dot(abs(u), abs(n))};
+}
+
+template<typename floatN>
+Filtered<floatN> orient3d(Lanes3<floatN> const& a, Lanes3<floatN> const& b, Lanes3<floatN> const& c, Lanes3<floatN> const& d) {
+	return side(planes(a, b, c), d);
+}
+
+} // End of namespace lowpoly3d::simd
+
+#endif // SIMD_GEOMETRY_HPP
@@ -0,0 +1,86 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef> // std::size_t
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lowpoly3d {
+
+/* A fixed-size pool of worker threads that executes submitted tasks in FIFO order.
+ *
+ * A thread that waits on a task via ThreadPool::wait() executes pending tasks
+ * while waiting, so tasks may themselves submit and wait on other tasks
+ * (e.g recursive divide-and-conquer) without starving the pool. */
+class ThreadPool {
+public:
+	// Creates a pool with "num_threads" workers. A pool with zero workers is
+	// valid, tasks are then executed by whichever thread waits on them.
+	explicit ThreadPool(std::size_t num_threads = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Enqueues f and returns a future to its result
+	template<typename F>
+	std::future<std::invoke_result_t<F>> submit(F&& f) {
+		using result_type = std::invoke_result_t<F>;
+		auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+		std::future<result_type> future = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.emplace_back([task]() { (*task)(); });
+		}
+		condition.notify_one();
+		return future;
+	}
+
+	// Blocks until future is ready, executing pending tasks in the meantime
+	template<typename T>
+	T wait(std::future<T>& future) {
+		while(future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			if(!run_pending_task()) {
+				future.wait_for(std::chrono::microseconds(50));
+			}
+		}
+		return future.get();
+	}
+
+	// Calls f(chunk_begin, chunk_end) over disjoint chunks of [begin, end), each chunk
+	// consisting of at least "grain" indices, and blocks until all chunks are done
+	void parallel_for(
+		std::size_t begin,
+		std::size_t end,
+		const std::function<void(std::size_t, std::size_t)>& f,
+		std::size_t grain = 1);
+
+	// Returns the number of worker threads
+	std::size_t size() const;
+
+	// Returns a pool shared by the whole process, with one worker per hardware thread
+	static ThreadPool& global();
+
+private:
+	// Pops and executes the oldest pending task. Returns false if there was no pending task.
+	bool run_pending_task();
+	void work();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping = false;
+};
+
+} // End of namespace lowpoly3d
+
+#endif // THREAD_POOL_HPP
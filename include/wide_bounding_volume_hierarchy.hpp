@@ -0,0 +1,443 @@
+#ifndef WIDE_BOUNDING_VOLUME_HIERARCHY_HPP
+#define WIDE_BOUNDING_VOLUME_HIERARCHY_HPP
+
+#include <algorithm> // std::max, std::sort
+#include <array>
+#include <cassert>
+#include <cstdint> // std::uint32_t
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "ray_cast.hpp"
+#include "utils/simd.hpp"
+
+namespace lowpoly3d {
+
+/* The BVs of the up to four children of a node of a WideBVH, one array per component,
+ * so that a single float4 operation tests a BV against all four children */
+template<typename BV>
+struct WideBounds;
+
+template<>
+struct WideBounds<Sphere> {
+	alignas(16) std::array<float, 4> x, y, z, r;
+
+	void set(std::size_t i, const Sphere& sphere) {
+		x[i] = sphere.p.x;
+		y[i] = sphere.p.y;
+		z[i] = sphere.p.z;
+		r[i] = sphere.r;
+	}
+
+	Sphere get(std::size_t i) const {
+		return Sphere({x[i], y[i], z[i]}, r[i]);
+	}
+
+	// A transform along with the largest factor by which it stretches a radius
+	struct transform_type {
+		glm::mat4 m;
+		float stretch;
+		explicit transform_type(const glm::mat4& m) : m(m), stretch(transform(Sphere({0.0f, 0.0f, 0.0f}, 1.0f), m).r) { }
+	};
+
+	// Returns the spheres transformed like transform() on each sphere would
+	WideBounds transformed(const transform_type& t) const {
+		using simd::float4;
+		const float4 px = float4::load(x.data()), py = float4::load(y.data()), pz = float4::load(z.data());
+		WideBounds result;
+		(px * t.m[0][0] + py * t.m[1][0] + pz * t.m[2][0] + t.m[3][0]).store(result.x.data());
+		(px * t.m[0][1] + py * t.m[1][1] + pz * t.m[2][1] + t.m[3][1]).store(result.y.data());
+		(px * t.m[0][2] + py * t.m[1][2] + pz * t.m[2][2] + t.m[3][2]).store(result.z.data());
+		(float4::load(r.data()) * t.stretch).store(result.r.data());
+		return result;
+	}
+
+	// Returns the signed distance from every child to sphere, which is not positive where they overlap
+	simd::float4 signed_distances(const Sphere& sphere) const {
+		using simd::float4;
+		const float4 dx = float4::load(x.data()) - sphere.p.x;
+		const float4 dy = float4::load(y.data()) - sphere.p.y;
+		const float4 dz = float4::load(z.data()) - sphere.p.z;
+		return sqrt(dx * dx + dy * dy + dz * dz) - float4::load(r.data()) - sphere.r;
+	}
+
+	/* Returns the children that origin + t*direction is inside of for some t in [0, t_max],
+	 * and writes the smallest such t of every child to t, like detail::ray_entry() */
+	simd::mask4 ray_entry(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3&, float t_max, simd::float4& t) const {
+		using simd::float4;
+		const float4 zero = 0.0f;
+		const float4 mx = float4(origin.x) - float4::load(x.data());
+		const float4 my = float4(origin.y) - float4::load(y.data());
+		const float4 mz = float4(origin.z) - float4::load(z.data());
+		const float4 radius = float4::load(r.data());
+		const float4 c = mx * mx + my * my + mz * mz - radius * radius;
+		const float4 b = mx * direction.x + my * direction.y + mz * direction.z;
+		const float4 a = glm::dot(direction, direction);
+		const float4 discriminant = b * b - a * c;
+		const float4 enter = (zero - b - sqrt(max(discriminant, zero))) / a;
+		const simd::mask4 inside = c <= zero;
+		t = select(inside, zero, enter);
+		return inside | ((b < zero) & (discriminant >= zero) & (enter <= float4(t_max)));
+	}
+};
+
+template<>
+struct WideBounds<AABB> {
+	alignas(16) std::array<float, 4> lower_x, lower_y, lower_z, upper_x, upper_y, upper_z;
+
+	void set(std::size_t i, const AABB& box) {
+		lower_x[i] = box.lower.x;
+		lower_y[i] = box.lower.y;
+		lower_z[i] = box.lower.z;
+		upper_x[i] = box.upper.x;
+		upper_y[i] = box.upper.y;
+		upper_z[i] = box.upper.z;
+	}
+
+	AABB get(std::size_t i) const {
+		return AABB({lower_x[i], lower_y[i], lower_z[i]}, {upper_x[i], upper_y[i], upper_z[i]});
+	}
+
+	// A transform along with the absolute values of its linear part
+	struct transform_type {
+		glm::mat4 m;
+		glm::mat3 abs;
+		explicit transform_type(const glm::mat4& m) : m(m), abs(glm::abs(glm::mat3(m)[0]), glm::abs(glm::mat3(m)[1]), glm::abs(glm::mat3(m)[2])) { }
+	};
+
+	// Returns the boxes transformed like transform() on each box would
+	WideBounds transformed(const transform_type& t) const {
+		using simd::float4;
+		const float4 half = 0.5f;
+		const float4 lx = float4::load(lower_x.data()), ly = float4::load(lower_y.data()), lz = float4::load(lower_z.data());
+		const float4 ux = float4::load(upper_x.data()), uy = float4::load(upper_y.data()), uz = float4::load(upper_z.data());
+		const float4 cx = (lx + ux) * half, cy = (ly + uy) * half, cz = (lz + uz) * half;
+		const float4 ex = (ux - lx) * half, ey = (uy - ly) * half, ez = (uz - lz) * half;
+
+		WideBounds result;
+		const auto store = [&](int i, std::array<float, 4>& lower, std::array<float, 4>& upper) {
+			const float4 center = cx * t.m[0][i] + cy * t.m[1][i] + cz * t.m[2][i] + t.m[3][i];
+			const float4 extent = ex * t.abs[0][i] + ey * t.abs[1][i] + ez * t.abs[2][i];
+			(center - extent).store(lower.data());
+			(center + extent).store(upper.data());
+		};
+		store(0, result.lower_x, result.upper_x);
+		store(1, result.lower_y, result.upper_y);
+		store(2, result.lower_z, result.upper_z);
+		return result;
+	}
+
+	/* Returns the largest gap along any axis between every child and box, which is not
+	 * positive where they overlap and otherwise no larger than signed_distance() */
+	simd::float4 signed_distances(const AABB& box) const {
+		using simd::float4;
+		const float4 gap_x = max(float4::load(lower_x.data()) - box.upper.x, float4(box.lower.x) - float4::load(upper_x.data()));
+		const float4 gap_y = max(float4::load(lower_y.data()) - box.upper.y, float4(box.lower.y) - float4::load(upper_y.data()));
+		const float4 gap_z = max(float4::load(lower_z.data()) - box.upper.z, float4(box.lower.z) - float4::load(upper_z.data()));
+		return max(max(gap_x, gap_y), gap_z);
+	}
+
+	simd::mask4 ray_entry(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& inv_direction, float t_max, simd::float4& t) const {
+		using simd::float4;
+		float4 exit = t_max;
+		t = 0.0f;
+		detail::packet_slab(float4::load(lower_x.data()), float4::load(upper_x.data()), origin.x, direction.x, inv_direction.x, t, exit);
+		detail::packet_slab(float4::load(lower_y.data()), float4::load(upper_y.data()), origin.y, direction.y, inv_direction.y, t, exit);
+		detail::packet_slab(float4::load(lower_z.data()), float4::load(upper_z.data()), origin.z, direction.z, inv_direction.z, t, exit);
+		return t <= exit;
+	}
+};
+
+/* A node of a WideBVH with up to four children, which are the first "count" slots.
+ * A child is either another node or, if its leaf bit is set, a triangle of the model. */
+template<typename BV>
+struct WideBV {
+	static constexpr std::uint32_t leaf_bit = std::uint32_t(1) << 31;
+
+	WideBounds<BV> bounds;
+	std::array<std::uint32_t, 4> children;
+	std::uint32_t count;
+
+	bool is_leaf(std::size_t i) const { return (children[i] & leaf_bit) != 0; }
+	std::uint32_t index(std::size_t i) const { return children[i] & ~leaf_bit; }
+
+	// Returns one bit for each slot that holds a child
+	int used() const { return (1 << count) - 1; }
+};
+
+/* A BVH with four children per node, collapsed from a binary BVH by repeatedly
+ * replacing the largest internal child of a node with its two children. The BVs
+ * of the children of a node are tested against a BV or ray with a single float4
+ * operation, and the tree is about half as deep as the binary BVH. Nodes are in
+ * depth-first order with the root first. Only BVHs of float BVs can be widened. */
+template<typename TValue>
+class WideBVH {
+	static_assert(std::is_same_v<TValue, Sphere> || std::is_same_v<TValue, AABB>,
+		"BVs of four children are tested with float4");
+public:
+	using value_type = TValue;
+	using bv_type = WideBV<value_type>;
+	using floating_point_type = float;
+private:
+	const Model* model;
+	std::vector<bv_type> nodes;
+	value_type root_bv;
+	std::size_t depth = 0;
+
+	// Appends the node over the binary subtree at bvh[idx] and returns its index
+	std::uint32_t append(const BVH<value_type>& bvh, std::size_t idx, std::size_t node_depth) {
+		depth = std::max(depth, node_depth);
+
+		// Open the largest internal child until there are four children or only leaves
+		std::vector<std::size_t> children {idx};
+		if(!bvh[idx].is_leaf) children = {bvh[idx].left_idx, bvh[idx].right_idx};
+		while(children.size() < 4) {
+			auto largest = children.end();
+			for(auto it = children.begin(); it != children.end(); it++) {
+				if(bvh[*it].is_leaf) continue;
+				if(largest == children.end() || bvh[*it].size() > bvh[*largest].size()) largest = it;
+			}
+			if(largest == children.end()) break;
+			const std::size_t opened = *largest;
+			*largest = bvh[opened].left_idx;
+			children.push_back(bvh[opened].right_idx);
+		}
+
+		const std::uint32_t node_idx = static_cast<std::uint32_t>(nodes.size());
+		nodes.emplace_back();
+		nodes[node_idx].count = static_cast<std::uint32_t>(children.size());
+		for(std::size_t i = 0; i < 4; i++) {
+			// Unused slots repeat the first child, so that they never hold NaNs or infinities
+			const auto& child = bvh[children[i < children.size() ? i : 0]];
+			nodes[node_idx].bounds.set(i, child);
+			nodes[node_idx].children[i] = static_cast<std::uint32_t>(child.left_idx) | bv_type::leaf_bit;
+		}
+		for(std::size_t i = 0; i < children.size(); i++) {
+			if(bvh[children[i]].is_leaf) continue;
+			const std::uint32_t child_idx = append(bvh, children[i], node_depth + 1);
+			nodes[node_idx].children[i] = child_idx;
+		}
+		return node_idx;
+	}
+
+public:
+	// Widens bvh, which must have been built over model. The model must outlive this BVH.
+	WideBVH(const Model* model, const BVH<value_type>& bvh) : model(model), root_bv(detail::root_or_origin(bvh)) {
+		if(bvh.size() == 0) return;
+		assert(bvh.size() < bv_type::leaf_bit);
+		nodes.reserve(bvh.size() / 2 + 1);
+		append(bvh, bvh.root_idx(), 1);
+	}
+
+	// Builds a BVH over model and widens it
+	WideBVH(const Model* model, BVHBuildStrategy strategy = BVHBuildStrategy::binned_sah) :
+		WideBVH(model, BVH<value_type>(*model, strategy)) { }
+
+	std::size_t root_idx() const {
+		assert(!nodes.empty());
+		return 0;
+	}
+
+	const value_type& root() const {
+		return root_bv;
+	}
+
+	const bv_type& operator[](std::size_t idx) const {
+		assert(idx < size());
+		return nodes[idx];
+	}
+
+	std::size_t size() const {
+		return nodes.size();
+	}
+
+	// Returns the number of nodes on the longest path from the root to a node whose children are all triangles
+	std::size_t getDepth() const {
+		return depth;
+	}
+
+	TTriangle<float, 3> getTriangle(std::size_t idx) const {
+		return detail::model_triangle<float>(*model, idx);
+	}
+};
+
+namespace detail {
+
+/* A pair of children of two WideBVHs, each a node or a triangle as in WideBV::children,
+ * with the BV of a and the BV of b in the modelspace of a */
+template<typename TValue>
+struct WideBVTTNode {
+	std::uint32_t a_child, b_child;
+	TValue a_bv, b_bv_in_a;
+};
+
+// Pushes the overlapping pairs among the four in "pairs" onto stack, the most overlapping last
+template<typename TValue, typename Stack>
+void push_overlapping(Stack& stack, const std::array<WideBVTTNode<TValue>, 4>& pairs, simd::float4 signed_distances, int used) {
+	alignas(16) float distances[4];
+	signed_distances.store(distances);
+	std::array<std::size_t, 4> order;
+	std::size_t count = 0;
+	for(std::size_t i = 0; i < 4; i++) {
+		if((used & (1 << i)) && distances[i] <= 0.0f) order[count++] = i;
+	}
+	std::sort(order.begin(), order.begin() + count, [&](std::size_t l, std::size_t r) { return distances[l] > distances[r]; });
+	for(std::size_t i = 0; i < count; i++) {
+		stack.push_back(pairs[order[i]]);
+	}
+}
+
+/* Traverses the BVTT of two WideBVHs like traverse_bvtt() does, but opens the largest BV
+ * of a pair into all four of its children at once. The children of b are taken into the
+ * modelspace of a four at a time, so that either way the four child BVs are tested with
+ * a single float4 operation. */
+template<typename TValue, typename Stack>
+bool collides(const WideBVH<TValue>& a, const WideBVH<TValue>& b, const glm::mat4& b_to_a, Stack& stack) {
+	using node_type = WideBVTTNode<TValue>;
+	using bv_type = typename WideBVH<TValue>::bv_type;
+	const typename WideBounds<TValue>::transform_type b_to_a_bounds(b_to_a);
+
+	if(a.size() == 0 || b.size() == 0) return false;
+	count_query();
+	count_bv_tests(1);
+	const TValue b_root_in_a = transform(b.root(), b_to_a);
+	if(signed_distance(a.root(), b_root_in_a) > 0) return false;
+	stack.push_back(node_type{static_cast<std::uint32_t>(a.root_idx()), static_cast<std::uint32_t>(b.root_idx()), a.root(), b_root_in_a});
+
+	const auto is_leaf = [](std::uint32_t child) { return (child & bv_type::leaf_bit) != 0; };
+	std::array<node_type, 4> pairs {node_type{0, 0, a.root(), b_root_in_a}, node_type{0, 0, a.root(), b_root_in_a},
+		node_type{0, 0, a.root(), b_root_in_a}, node_type{0, 0, a.root(), b_root_in_a}};
+	while(!stack.empty()) {
+		count_stack_depth(stack.size());
+		const node_type node = stack.back();
+		stack.pop_back();
+
+		const bool a_leaf = is_leaf(node.a_child), b_leaf = is_leaf(node.b_child);
+		if(a_leaf && b_leaf) {
+			count_triangle_test();
+			const std::uint32_t a_triangle = node.a_child & ~bv_type::leaf_bit;
+			const std::uint32_t b_triangle = node.b_child & ~bv_type::leaf_bit;
+			if(intersects(a.getTriangle(a_triangle), b.getTriangle(b_triangle).transform(b_to_a))) {
+				return true;
+			}
+		} else if(b_leaf || (!a_leaf && node.a_bv.size() > node.b_bv_in_a.size())) {
+			const bv_type& bva = a[node.a_child];
+			count_bv_tests(bva.count);
+			for(std::size_t i = 0; i < bva.count; i++) {
+				pairs[i] = node_type{bva.children[i], node.b_child, bva.bounds.get(i), node.b_bv_in_a};
+			}
+			push_overlapping(stack, pairs, bva.bounds.signed_distances(node.b_bv_in_a), bva.used());
+		} else {
+			const bv_type& bvb = b[node.b_child];
+			count_bv_tests(bvb.count);
+			const WideBounds<TValue> bounds_in_a = bvb.bounds.transformed(b_to_a_bounds);
+			for(std::size_t i = 0; i < bvb.count; i++) {
+				pairs[i] = node_type{node.a_child, bvb.children[i], node.a_bv, bounds_in_a.get(i)};
+			}
+			push_overlapping(stack, pairs, bounds_in_a.signed_distances(node.a_bv), bvb.used());
+		}
+	}
+	return false;
+}
+
+// A node of a WideBVH to visit, along with the t at which the ray enters its BV
+struct WideRayNode {
+	std::uint32_t idx;
+	float t;
+};
+
+/* Finds the triangle of bvh hit by origin + t*direction with the smallest t in [0, t_max],
+ * like ray_cast() on a BVHModel. The ray is tested against all children of a node at once,
+ * triangles that it enters the BVs of are tested right away and nodes are visited nearest first. */
+template<typename TValue, typename Stack>
+bool ray_cast(
+	const WideBVH<TValue>& bvh,
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float t_max,
+	Stack& stack,
+	RayHit& hit) {
+
+	if(bvh.size() == 0) return false;
+	const glm::vec3 inv_direction = 1.0f / direction;
+	float root_t;
+	if(!ray_entry(bvh.root(), origin, direction, inv_direction, t_max, root_t)) return false;
+	stack.push_back(WideRayNode{static_cast<std::uint32_t>(bvh.root_idx()), root_t});
+
+	bool found = false;
+	float best = t_max;
+	while(!stack.empty()) {
+		const WideRayNode node = stack.back();
+		stack.pop_back();
+		if(node.t > best) continue;
+
+		const auto& bv = bvh[node.idx];
+		simd::float4 entries;
+		const int entered = bv.bounds.ray_entry(origin, direction, inv_direction, best, entries).bits() & bv.used();
+		if(entered == 0) continue;
+		alignas(16) float t_entry[4];
+		entries.store(t_entry);
+
+		std::array<WideRayNode, 4> children;
+		std::size_t count = 0;
+		for(std::size_t i = 0; i < 4; i++) {
+			if(!(entered & (1 << i))) continue;
+			if(bv.is_leaf(i)) {
+				float t, u, v;
+				if(ray_triangle(origin, direction, bvh.getTriangle(bv.index(i)), best, t, u, v)) {
+					best = t;
+					hit = RayHit{bv.index(i), t, u, v};
+					found = true;
+				}
+			} else {
+				children[count++] = WideRayNode{bv.children[i], t_entry[i]};
+			}
+		}
+
+		// Push the farthest child first, so that the nearest child is visited first
+		std::sort(children.begin(), children.begin() + count, [](const WideRayNode& l, const WideRayNode& r) { return l.t > r.t; });
+		for(std::size_t i = 0; i < count; i++) {
+			if(children[i].t <= best) stack.push_back(children[i]);
+		}
+	}
+	return found;
+}
+
+} // End of namespace detail
+
+// Returns true if any triangle of a intersects any triangle of b, once both are taken into world-space
+template<typename TValue>
+bool collides(const WideBVH<TValue>& a, const WideBVH<TValue>& b, const glm::mat4& a_world, const glm::mat4& b_world) {
+	const glm::mat4 b_to_a = glm::inverse(a_world) * b_world;
+
+	// Every visited pair pushes at most four child pairs, one of which is visited next
+	return detail::with_stack<detail::WideBVTTNode<TValue>>(3 * (a.getDepth() + b.getDepth()) + 1, [&](auto& stack) {
+		return detail::collides(a, b, b_to_a, stack);
+	});
+}
+
+/* Casts a ray against the triangles of bvh, which is placed in world-space by bvh_world,
+ * just like ray_cast() on a BVHModel */
+template<typename TValue>
+bool ray_cast(
+	const WideBVH<TValue>& bvh,
+	const glm::mat4& bvh_world,
+	const Line& ray,
+	RayHit& hit,
+	float max_distance = std::numeric_limits<float>::infinity()) {
+
+	const glm::mat4 world_to_model = glm::inverse(bvh_world);
+	const glm::vec3 origin = glm::vec3(world_to_model * glm::vec4(ray.getPoint(), 1.0f));
+	const glm::vec3 direction = glm::vec3(world_to_model * glm::vec4(ray.getDirection(), 0.0f));
+
+	// Every visited node pushes at most four children, one of which is visited next
+	return detail::with_stack<detail::WideRayNode>(3 * bvh.getDepth() + 1, [&](auto& stack) {
+		return detail::ray_cast(bvh, origin, direction, max_distance, stack, hit);
+	});
+}
+
+} // End of namespace lowpoly3d
+
+#endif // WIDE_BOUNDING_VOLUME_HIERARCHY_HPP
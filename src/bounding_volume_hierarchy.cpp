@@ -1,7 +1,190 @@
 #include "bounding_volume_hierarchy.hpp"
 
+#include <array>
+#include <atomic>
+#include <limits>
+
 namespace lowpoly3d {
 
+namespace {
+
+// Number of bins that centroids are sorted into per axis when evaluating the SAH
+constexpr std::size_t sah_num_bins = 16;
+
+// Subtrees over fewer triangles than this are built on the calling thread
+constexpr std::size_t sah_parallel_threshold = 4096;
+
+// Axis-aligned bounds used while building. Empty bounds have lower > upper.
+struct BuildBounds {
+	glm::vec3 lower = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 upper = glm::vec3(std::numeric_limits<float>::lowest());
+
+	void grow(const glm::vec3& point) {
+		lower = glm::min(lower, point);
+		upper = glm::max(upper, point);
+	}
+
+	void grow(const BuildBounds& other) {
+		lower = glm::min(lower, other.lower);
+		upper = glm::max(upper, other.upper);
+	}
+
+	float surface_area() const {
+		if(lower.x > upper.x) return 0.0f;
+		const glm::vec3 d = upper - lower;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+};
+
+struct BinnedSAHBuilder {
+	const std::vector<glm::vec3>& centroids;
+	const std::vector<BuildBounds>& bounds;
+	std::vector<std::size_t>& order;
+	std::vector<BVHTopology::Node>& nodes;
+	ThreadPool& pool;
+	std::atomic<std::size_t> depth {0};
+
+	// Partitions order[begin, end) in place and returns the first index of the
+	// right partition. Both partitions are guaranteed to be non-empty.
+	std::size_t partition(std::size_t begin, std::size_t end) const {
+		BuildBounds centroid_bounds;
+		for(std::size_t i = begin; i < end; i++) {
+			centroid_bounds.grow(centroids[order[i]]);
+		}
+		const glm::vec3 extent = centroid_bounds.upper - centroid_bounds.lower;
+
+		const auto bin_index = [&centroid_bounds, &extent](float coordinate, int axis) {
+			const float relative = (coordinate - centroid_bounds.lower[axis]) / extent[axis];
+			const auto bin = static_cast<std::size_t>(relative * float(sah_num_bins));
+			return std::min(bin, sah_num_bins - 1);
+		};
+
+		float best_cost = std::numeric_limits<float>::max();
+		int best_axis = -1;
+		std::size_t best_bin = 0;
+
+		for(int axis = 0; axis < 3; axis++) {
+			if(extent[axis] <= 0.0f) continue;
+
+			std::array<BuildBounds, sah_num_bins> bin_bounds;
+			std::array<std::size_t, sah_num_bins> bin_counts {};
+			for(std::size_t i = begin; i < end; i++) {
+				const std::size_t triangle = order[i];
+				const std::size_t bin = bin_index(centroids[triangle][axis], axis);
+				bin_bounds[bin].grow(bounds[triangle]);
+				bin_counts[bin]++;
+			}
+
+			// Sweep from the right, so that the area and count right of each split plane is known...
+			std::array<float, sah_num_bins - 1> right_areas;
+			std::array<std::size_t, sah_num_bins - 1> right_counts;
+			BuildBounds accumulated;
+			std::size_t accumulated_count = 0;
+			for(std::size_t bin = sah_num_bins - 1; bin > 0; bin--) {
+				accumulated.grow(bin_bounds[bin]);
+				accumulated_count += bin_counts[bin];
+				right_areas[bin - 1] = accumulated.surface_area();
+				right_counts[bin - 1] = accumulated_count;
+			}
+
+			// ... then sweep from the left and evaluate the cost of splitting after each bin
+			accumulated = BuildBounds();
+			accumulated_count = 0;
+			for(std::size_t bin = 0; bin < sah_num_bins - 1; bin++) {
+				accumulated.grow(bin_bounds[bin]);
+				accumulated_count += bin_counts[bin];
+				if(accumulated_count == 0 || right_counts[bin] == 0) continue;
+				const float cost =
+					accumulated.surface_area() * float(accumulated_count) +
+					right_areas[bin] * float(right_counts[bin]);
+				if(cost < best_cost) {
+					best_cost = cost;
+					best_axis = axis;
+					best_bin = bin;
+				}
+			}
+		}
+
+		// All centroids coincide, so no plane separates them. Split by count instead.
+		if(best_axis < 0) {
+			return begin + (end - begin) / 2;
+		}
+
+		const auto first = order.begin() + begin;
+		const auto last = order.begin() + end;
+		const auto middle = std::partition(first, last, [this, &bin_index, best_axis, best_bin](std::size_t triangle) {
+			return bin_index(centroids[triangle][best_axis], best_axis) <= best_bin;
+		});
+		return std::size_t(middle - order.begin());
+	}
+
+	// Builds the subtree over order[begin, end). A subtree over n triangles has 2n-1 nodes,
+	// so its nodes in post-order are known to be exactly nodes[first, first + 2n - 1).
+	// That lets independent subtrees be written concurrently without any merging.
+	void build(std::size_t begin, std::size_t end, std::size_t first, std::size_t current_depth) {
+		std::size_t deepest = depth.load();
+		while(deepest < current_depth && !depth.compare_exchange_weak(deepest, current_depth)) { }
+
+		const std::size_t count = end - begin;
+		const std::size_t root = first + 2 * count - 2;
+		if(count == 1) {
+			nodes[root] = {order[begin], order[begin], true};
+			return;
+		}
+
+		const std::size_t middle = partition(begin, end);
+		const std::size_t left_count = middle - begin;
+		const std::size_t right_first = first + 2 * left_count - 1;
+
+		if(count >= sah_parallel_threshold) {
+			auto left = pool.submit([this, begin, middle, first, current_depth]() {
+				build(begin, middle, first, current_depth + 1);
+			});
+			build(middle, end, right_first, current_depth + 1);
+			pool.wait(left);
+		} else {
+			build(begin, middle, first, current_depth + 1);
+			build(middle, end, right_first, current_depth + 1);
+		}
+
+		nodes[root] = {right_first - 1, root - 1, false};
+	}
+};
+
+} // End of anonymous namespace
+
+BVHTopology build_binned_sah(const Model& model, ThreadPool& pool) {
+	const std::size_t num_triangles = model.getNumTriangles();
+
+	BVHTopology topology;
+	if(num_triangles == 0) return topology;
+
+	// Precompute centroids and bounds once instead of once per level
+	std::vector<glm::vec3> centroids(num_triangles);
+	std::vector<BuildBounds> bounds(num_triangles);
+	pool.parallel_for(0, num_triangles, [&model, &centroids, &bounds](std::size_t begin, std::size_t end) {
+		for(std::size_t i = begin; i < end; i++) {
+			const auto& triangle = model.triangleIndices[i];
+			const glm::vec3& a = model.vertices[triangle[0]];
+			const glm::vec3& b = model.vertices[triangle[1]];
+			const glm::vec3& c = model.vertices[triangle[2]];
+			centroids[i] = (1.0f / 3.0f) * (a + b + c);
+			bounds[i].grow(a);
+			bounds[i].grow(b);
+			bounds[i].grow(c);
+		}
+	}, sah_parallel_threshold);
+
+	topology.order.resize(num_triangles);
+	std::iota(topology.order.begin(), topology.order.end(), 0);
+	topology.nodes.resize(2 * num_triangles - 1);
+
+	BinnedSAHBuilder builder {centroids, bounds, topology.order, topology.nodes, pool};
+	builder.build(0, num_triangles, 0, 1);
+	topology.depth = builder.depth.load();
+	return topology;
+}
+
 // Returns two subsets of "indices" into trinagles that represent a binary partition of triangles
 std::pair<std::vector<std::size_t>, std::vector<std::size_t>> split(const Model& model, const std::vector<std::size_t>& indices) {
 	using Partition = std::pair<std::vector<std::size_t>, std::vector<std::size_t>>;
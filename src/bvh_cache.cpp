@@ -0,0 +1,79 @@
+#include "bvh_cache.hpp"
+
+#include <algorithm> // std::equal
+#include <cstdio> // std::snprintf
+#include <fstream>
+#include <system_error>
+
+namespace lowpoly3d {
+
+BVHCache::BVHCache(std::filesystem::path directory) : directory(std::move(directory)) { }
+
+const std::filesystem::path& BVHCache::getDirectory() const {
+	return directory;
+}
+
+std::uint64_t BVHCache::key(std::uint64_t content, std::string_view bv_name, std::size_t node_size, BVHBuildStrategy strategy, BVHFitting fitting) {
+	// Continues the FNV-1a hash of the model with everything else that decides the nodes
+	std::uint64_t hash = content;
+	const auto feed = [&hash](std::uint64_t value) { hash = (hash ^ value) * 0x100000001b3ull; };
+	for(const char c : bv_name) {
+		feed(static_cast<unsigned char>(c));
+	}
+	feed(node_size);
+	feed(static_cast<std::uint64_t>(strategy));
+	feed(static_cast<std::uint64_t>(fitting));
+	feed(BVHCacheHeader::current_version);
+	return hash;
+}
+
+std::filesystem::path BVHCache::path(std::uint64_t key) const {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bvh", static_cast<unsigned long long>(key));
+	return directory / name;
+}
+
+std::shared_ptr<const MappedFile> BVHCache::map(std::uint64_t key, std::size_t node_size) const {
+	auto file = std::make_shared<const MappedFile>(path(key));
+	if(!file->is_open() || file->size() < sizeof(BVHCacheHeader)) return nullptr;
+
+	const auto& header = *reinterpret_cast<const BVHCacheHeader*>(file->data());
+	const bool valid =
+		std::equal(std::begin(header.magic), std::end(header.magic), std::begin(BVHCacheHeader::magic_string)) &&
+		header.version == BVHCacheHeader::current_version &&
+		header.byte_order == BVHCacheHeader::byte_order_mark &&
+		header.key == key &&
+		header.node_size == node_size &&
+		header.num_nodes <= (file->size() - sizeof(BVHCacheHeader)) / node_size &&
+		file->size() == sizeof(BVHCacheHeader) + header.num_nodes * node_size;
+	return valid ? file : nullptr;
+}
+
+bool BVHCache::write(const BVHCacheHeader& header, const void* nodes) const {
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if(error) return false;
+
+	// Write to a temporary file first, so that a file is either complete or missing
+	const std::filesystem::path destination = path(header.key);
+	std::filesystem::path temporary = destination;
+	temporary += ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(static_cast<const char*>(nodes), static_cast<std::streamsize>(header.num_nodes * header.node_size));
+		if(!out) {
+			out.close();
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+	}
+	std::filesystem::rename(temporary, destination, error);
+	if(error) {
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,38 @@
+#include "bvh_statistics.hpp"
+
+#include <sstream>
+
+namespace lowpoly3d {
+
+std::string to_json(const BVHStatistics& statistics) {
+	std::ostringstream out;
+	out.precision(9);
+	out << "{\n";
+	out << "\t\"bv\": \"" << statistics.bv_name << "\",\n";
+	out << "\t\"num_nodes\": " << statistics.num_nodes << ",\n";
+	out << "\t\"num_leaves\": " << statistics.num_leaves << ",\n";
+	out << "\t\"depth\": " << statistics.depth << ",\n";
+	out << "\t\"build_seconds\": " << statistics.build_seconds << ",\n";
+	out << "\t\"sah_cost\": " << statistics.sah_cost << ",\n";
+	out << "\t\"sibling_overlap\": " << statistics.sibling_overlap << ",\n";
+	out << "\t\"leaves_per_depth\": [";
+	for(std::size_t i = 0; i < statistics.leaves_per_depth.size(); i++) {
+		out << (i == 0 ? "" : ", ") << statistics.leaves_per_depth[i];
+	}
+	out << "]\n";
+	out << "}\n";
+	return out.str();
+}
+
+std::string to_json(const QueryStatistics& statistics) {
+	std::ostringstream out;
+	out << "{\n";
+	out << "\t\"queries\": " << statistics.queries << ",\n";
+	out << "\t\"bv_tests\": " << statistics.bv_tests << ",\n";
+	out << "\t\"triangle_tests\": " << statistics.triangle_tests << ",\n";
+	out << "\t\"max_stack_depth\": " << statistics.max_stack_depth << "\n";
+	out << "}\n";
+	return out.str();
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,188 @@
+#include "collision_world.hpp"
+
+#include <algorithm> // std::find, std::remove_if, std::sort
+#include <cassert>
+
+namespace lowpoly3d {
+
+namespace {
+
+// Returns the world-space bounds of the root BV of an object
+AABB world_bounds(const CollisionData& data) {
+	if(data.model->size() == 0) {
+		const glm::vec3 origin = glm::vec3((*data.matrix)[3]);
+		return AABB(origin, origin);
+	}
+	const Sphere sphere = transform(static_cast<const Sphere&>(data.model->root()), *data.matrix);
+	return AABB(sphere.p - glm::vec3(sphere.r), sphere.p + glm::vec3(sphere.r));
+}
+
+} // End of anonymous namespace
+
+CollisionWorld::CollisionWorld(ThreadPool& pool) : pool(pool) { }
+
+CollisionWorld::handle_type CollisionWorld::add(const CollisionData& data) {
+	handle_type handle;
+	const AABB bounds = world_bounds(data);
+	if(free_handles.empty()) {
+		handle = static_cast<handle_type>(objects.size());
+		objects.push_back({data, bounds, true, {}});
+	} else {
+		handle = free_handles.back();
+		free_handles.pop_back();
+		objects[handle] = {data, bounds, true, {}};
+	}
+
+	// Append the endpoints and let insertion sort move them into place, which
+	// reports every object that the new object overlaps
+	for(std::size_t axis = 0; axis < 3; axis++) {
+		axes[axis].push_back({bounds.upper[axis], handle, false});
+		axes[axis].push_back({bounds.lower[axis], handle, true});
+		sort_axis(axis);
+	}
+	candidates_dirty = true;
+	return handle;
+}
+
+void CollisionWorld::remove(handle_type handle) {
+	assert(handle < objects.size() && objects[handle].alive);
+	objects[handle].alive = false;
+	free_handles.push_back(handle);
+
+	for(auto& endpoints : axes) {
+		endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(), [handle](const Endpoint& endpoint) {
+			return endpoint.handle == handle;
+		}), endpoints.end());
+	}
+	/* The handle may be reused by an object of another model, which the fronts must not be kept for.
+	 * Only the pairs of the object are visited, so this does not scale with the size of the world. */
+	while(!objects[handle].partners.empty()) {
+		stop_overlap(handle, objects[handle].partners.back());
+	}
+	candidates_dirty = true;
+}
+
+void CollisionWorld::update() {
+	for(auto& object : objects) {
+		if(object.alive) {
+			object.bounds = world_bounds(object.data);
+		}
+	}
+	for(std::size_t axis = 0; axis < 3; axis++) {
+		for(auto& endpoint : axes[axis]) {
+			const AABB& bounds = objects[endpoint.handle].bounds;
+			endpoint.value = endpoint.is_min ? bounds.lower[axis] : bounds.upper[axis];
+		}
+		sort_axis(axis);
+	}
+	refresh_candidates();
+}
+
+std::size_t CollisionWorld::step(std::vector<pair_type>& colliding) {
+	update();
+	colliding.clear();
+
+	// Pairs that are no longer candidates have dropped their fronts, so start fronts for new candidates
+	candidate_fronts.clear();
+	for(const auto& [a, b] : candidates) {
+		auto [it, inserted] = fronts.try_emplace(key(a, b), *objects[a].data.model, *objects[b].data.model);
+		candidate_fronts.push_back(&it->second);
+	}
+
+	// Every pair has a front of its own, so the pairs can be queried in parallel
+	narrow_phase_results.assign(candidates.size(), 0);
+	pool.parallel_for(0, candidates.size(), [this](std::size_t begin, std::size_t end) {
+		for(std::size_t i = begin; i < end; i++) {
+			const auto& [a, b] = candidates[i];
+			narrow_phase_results[i] = candidate_fronts[i]->collides(*objects[a].data.matrix, *objects[b].data.matrix);
+		}
+	});
+
+	for(std::size_t i = 0; i < candidates.size(); i++) {
+		if(narrow_phase_results[i]) {
+			colliding.push_back(candidates[i]);
+		}
+	}
+	return colliding.size();
+}
+
+const std::vector<CollisionWorld::pair_type>& CollisionWorld::getCandidatePairs() const {
+	assert(!candidates_dirty && "call update() after add() or remove()");
+	return candidates;
+}
+
+const AABB& CollisionWorld::getBounds(handle_type handle) const {
+	assert(handle < objects.size() && objects[handle].alive);
+	return objects[handle].bounds;
+}
+
+const CollisionData& CollisionWorld::operator[](handle_type handle) const {
+	assert(handle < objects.size() && objects[handle].alive);
+	return objects[handle].data;
+}
+
+std::size_t CollisionWorld::size() const {
+	return objects.size() - free_handles.size();
+}
+
+void CollisionWorld::sort_axis(std::size_t axis) {
+	auto& endpoints = axes[axis];
+	for(std::size_t i = 1; i < endpoints.size(); i++) {
+		const Endpoint endpoint = endpoints[i];
+		std::size_t j = i;
+
+		// A lower bound sorts before an equal upper bound, so that touching bounds overlap
+		while(j > 0 && (endpoints[j-1].value > endpoint.value ||
+			(endpoints[j-1].value == endpoint.value && !endpoints[j-1].is_min && endpoint.is_min))) {
+			const Endpoint& other = endpoints[j-1];
+			if(other.handle != endpoint.handle && other.is_min != endpoint.is_min) {
+				if(endpoint.is_min) {
+					// A lower bound passed an upper bound, the two may now overlap along all axes
+					if(colliding(objects[endpoint.handle].bounds, objects[other.handle].bounds)) {
+						start_overlap(endpoint.handle, other.handle);
+					}
+				} else {
+					// An upper bound passed a lower bound, the two no longer overlap along this axis
+					stop_overlap(endpoint.handle, other.handle);
+				}
+			}
+			endpoints[j] = other;
+			j--;
+		}
+		endpoints[j] = endpoint;
+	}
+}
+
+void CollisionWorld::start_overlap(handle_type a, handle_type b) {
+	if(overlapping.insert(key(a, b)).second) {
+		objects[a].partners.push_back(b);
+		objects[b].partners.push_back(a);
+	}
+}
+
+void CollisionWorld::stop_overlap(handle_type a, handle_type b) {
+	if(overlapping.erase(key(a, b)) == 0) return;
+	fronts.erase(key(a, b));
+	for(const auto& [from, to] : {std::pair(a, b), std::pair(b, a)}) {
+		auto& partners = objects[from].partners;
+		*std::find(partners.begin(), partners.end(), to) = partners.back();
+		partners.pop_back();
+	}
+}
+
+void CollisionWorld::refresh_candidates() {
+	candidates.clear();
+	candidates.reserve(overlapping.size());
+	for(const std::uint64_t pair : overlapping) {
+		candidates.emplace_back(handle_type(pair >> 32), handle_type(pair));
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates_dirty = false;
+}
+
+std::uint64_t CollisionWorld::key(handle_type a, handle_type b) {
+	if(a > b) std::swap(a, b);
+	return (std::uint64_t(a) << 32) | std::uint64_t(b);
+}
+
+} // End of namespace lowpoly3d
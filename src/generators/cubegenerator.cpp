@@ -2,6 +2,8 @@
 #include <complex>
 #include <vector>
 
+#include <glm/gtc/matrix_transform.hpp> // glm::translate, glm::scale
+
 typedef std::complex<float> fz;
 using namespace std::literals::complex_literals;
 
@@ -32,4 +34,10 @@ Model CubeGenerator::generate() {
 	return {vertices, colors, triangleIndices};
 }
 
+Model CubeGenerator::generate(const AABB& box) {
+	// The unit cube spans [-1, 1] along each axis, so scale it by the half-widths of box
+	Model ret = generate();
+	return transform(ret, glm::scale(glm::translate(glm::mat4(1.0f), box.center()), box.extents()));
+}
+
 }
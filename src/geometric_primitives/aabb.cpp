@@ -0,0 +1,207 @@
+#include <algorithm> // std::all_of, std::min, std::max
+#include <cmath>
+#include <cassert>
+#include <limits>
+
+#include "geometric_primitives/aabb.hpp"
+#include "geometric_primitives/triangle.hpp"
+
+namespace lowpoly3d {
+
+template<typename floating_point_type, std::size_t dimension>
+bool TAABB<floating_point_type, dimension>::operator==(
+	const TAABB& other) const {
+	return lower == other.lower && upper == other.upper;
+}
+
+template<typename floating_point_type, std::size_t dimension>
+bool TAABB<floating_point_type, dimension>::operator!=(
+	const TAABB& other) const {
+	return !(*this == other);
+}
+
+template<typename floating_point_type, std::size_t dimension>
+bool TAABB<floating_point_type, dimension>::encloses(
+	const TAABB& other) const {
+	for(std::size_t i = 0; i < dimension; i++) {
+		if(other.lower[i] < lower[i] || other.upper[i] > upper[i]) return false;
+	}
+	return true;
+}
+
+template<typename floating_point_type, std::size_t dimension>
+bool TAABB<floating_point_type, dimension>::enclosed(
+	const TAABB& other) const {
+	return other.encloses(*this);
+}
+
+template<typename floating_point_type, std::size_t dimension>
+bool TAABB<floating_point_type, dimension>::contains(
+	const point_type& point,
+	floating_point_type tolerance) const {
+	for(std::size_t i = 0; i < dimension; i++) {
+		if(point[i] < lower[i] - tolerance || point[i] > upper[i] + tolerance) return false;
+	}
+	return true;
+}
+
+template<typename floating_point_type, std::size_t dimension>
+bool TAABB<floating_point_type, dimension>::contains(
+	const triangle_type& triangle,
+	floating_point_type tolerance) const {
+	return std::all_of(
+		triangle.cbegin(),
+		triangle.cend(),
+	[this, tolerance](auto const& point) {
+		return contains(point, tolerance);
+	});
+}
+
+template<typename floating_point_type, std::size_t dimension>
+typename TAABB<floating_point_type, dimension>::vec_type TAABB<floating_point_type, dimension>::center() const {
+	return floating_point_type(0.5) * (lower + upper);
+}
+
+template<typename floating_point_type, std::size_t dimension>
+typename TAABB<floating_point_type, dimension>::vec_type TAABB<floating_point_type, dimension>::extents() const {
+	return floating_point_type(0.5) * (upper - lower);
+}
+
+template<typename floating_point_type, std::size_t dimension>
+floating_point_type TAABB<floating_point_type, dimension>::surface_area() const {
+	static_assert(dimension == 3, "surface_area is only defined for boxes in 3D");
+	const vec_type d = upper - lower;
+	return floating_point_type(2) * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+template<typename floating_point_type, std::size_t dimension>
+floating_point_type TAABB<floating_point_type, dimension>::volume() const {
+	floating_point_type ret = floating_point_type(1);
+	for(std::size_t i = 0; i < dimension; i++) {
+		ret *= upper[i] - lower[i];
+	}
+	return ret;
+}
+
+template<typename floating_point_type, std::size_t dimension>
+floating_point_type TAABB<floating_point_type, dimension>::size() const {
+	return ::glm::length(extents());
+}
+
+template<typename fpt, std::size_t dim>
+TAABB<fpt, dim> aabb(const TTriangle<fpt, dim>& triangle) {
+	return TAABB<fpt, dim>(
+		::glm::min(triangle[0], ::glm::min(triangle[1], triangle[2])),
+		::glm::max(triangle[0], ::glm::max(triangle[1], triangle[2])));
+}
+
+template<typename fpt, std::size_t dim>
+TAABB<fpt, dim> merge(const TAABB<fpt, dim>& a, const TAABB<fpt, dim>& b) {
+	return TAABB<fpt, dim>(::glm::min(a.lower, b.lower), ::glm::max(a.upper, b.upper));
+}
+
+template<typename fpt>
+TAABB<fpt, 3> transform(const TAABB<fpt, 3>& box, const ::glm::mat<4, 4, fpt>& m) {
+	/* Transform the center and project the extents onto each world axis. Each world
+	 * extent is the sum of the absolute contributions of all local extents, which
+	 * is the tightest box around the transformed box (Arvo, Graphics Gems 1990) */
+	using vec_type = typename TAABB<fpt, 3>::vec_type;
+	const vec_type center = vec_type(m * ::glm::vec<4, fpt>(box.center(), fpt(1)));
+	const vec_type local_extents = box.extents();
+	vec_type world_extents(fpt(0));
+	for(std::size_t i = 0; i < 3; i++) {
+		for(std::size_t j = 0; j < 3; j++) {
+			// glm matrices are column-major so m[j][i] is row i, column j
+			world_extents[i] += std::abs(m[j][i]) * local_extents[j];
+		}
+	}
+	return TAABB<fpt, 3>(center - world_extents, center + world_extents);
+}
+
+template<typename fpt, std::size_t dim>
+bool colliding(const TAABB<fpt, dim>& a, const TAABB<fpt, dim>& b) {
+	for(std::size_t i = 0; i < dim; i++) {
+		if(a.upper[i] < b.lower[i] || b.upper[i] < a.lower[i]) return false;
+	}
+	return true;
+}
+
+template<typename fpt>
+bool colliding(
+	const TAABB<fpt, 3>& a,
+	const TAABB<fpt, 3>& b,
+	const ::glm::mat<4, 4, fpt>& a_transform,
+	const ::glm::mat<4, 4, fpt>& b_transform) {
+	return colliding(transform(a, a_transform), transform(b, b_transform));
+}
+
+template<typename fpt, std::size_t dim>
+fpt signed_distance(const TAABB<fpt, dim>& a, const TAABB<fpt, dim>& b) {
+	// Per-axis gap between the boxes. A negative gap along an axis is an overlap along that axis.
+	fpt distance_squared = fpt(0);
+	fpt smallest_overlap = std::numeric_limits<fpt>::max();
+	bool separated = false;
+	for(std::size_t i = 0; i < dim; i++) {
+		const fpt gap = std::max(b.lower[i] - a.upper[i], a.lower[i] - b.upper[i]);
+		if(gap > fpt(0)) {
+			separated = true;
+			distance_squared += gap * gap;
+		} else {
+			smallest_overlap = std::min(smallest_overlap, -gap);
+		}
+	}
+	return separated ? std::sqrt(distance_squared) : -smallest_overlap;
+}
+
+template<typename fpt>
+fpt signed_distance(const TAABB<fpt, 3>& box, const TPoint<fpt, 3>& point) {
+	fpt distance_squared = fpt(0);
+	fpt smallest_depth = std::numeric_limits<fpt>::max();
+	bool outside = false;
+	for(std::size_t i = 0; i < 3; i++) {
+		const fpt gap = std::max(box.lower[i] - point[i], point[i] - box.upper[i]);
+		if(gap > fpt(0)) {
+			outside = true;
+			distance_squared += gap * gap;
+		} else {
+			smallest_depth = std::min(smallest_depth, -gap);
+		}
+	}
+	return outside ? std::sqrt(distance_squared) : -smallest_depth;
+}
+
+template<typename fpt>
+fpt signed_distance(
+	const TAABB<fpt, 3>& a,
+	const TAABB<fpt, 3>& b,
+	const ::glm::mat<4, 4, fpt>& a_transform,
+	const ::glm::mat<4, 4, fpt>& b_transform) {
+	return signed_distance(transform(a, a_transform), transform(b, b_transform));
+}
+
+// Explicit instantiations of AABB
+template struct TAABB<float, 3>;
+template struct TAABB<double, 3>;
+
+template TAABB< float, 3> aabb(TTriangle< float, 3> const&);
+template TAABB<double, 3> aabb(TTriangle<double, 3> const&);
+
+template TAABB< float, 3> merge(TAABB< float, 3> const&, TAABB< float, 3> const&);
+template TAABB<double, 3> merge(TAABB<double, 3> const&, TAABB<double, 3> const&);
+
+template TAABB< float, 3> transform(TAABB< float, 3> const&, glm::mat<4, 4, float> const&);
+template TAABB<double, 3> transform(TAABB<double, 3> const&, glm::mat<4, 4, double> const&);
+
+template bool colliding(TAABB< float, 3> const&, TAABB< float, 3> const&);
+template bool colliding(TAABB<double, 3> const&, TAABB<double, 3> const&);
+template bool colliding(TAABB< float, 3> const&, TAABB< float, 3> const&, glm::mat<4, 4, float> const&, glm::mat<4, 4, float> const&);
+template bool colliding(TAABB<double, 3> const&, TAABB<double, 3> const&, glm::mat<4, 4, double> const&, glm::mat<4, 4, double> const&);
+
+template  float signed_distance(TAABB< float, 3> const&, TAABB< float, 3> const&);
+template double signed_distance(TAABB<double, 3> const&, TAABB<double, 3> const&);
+template  float signed_distance(TAABB< float, 3> const&, TPoint< float, 3> const&);
+template double signed_distance(TAABB<double, 3> const&, TPoint<double, 3> const&);
+template  float signed_distance(TAABB< float, 3> const&, TAABB< float, 3> const&, glm::mat<4, 4, float> const&, glm::mat<4, 4, float> const&);
+template double signed_distance(TAABB<double, 3> const&, TAABB<double, 3> const&, glm::mat<4, 4, double> const&, glm::mat<4, 4, double> const&);
+
+} // End of namespace lowpoly3d
@@ -1,10 +1,13 @@
 #include "geometric_primitives/intersections.hpp"
 
+#include <algorithm> // std::max
+#include <array>
 #include <cmath> // NAN
 #include <sstream>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/epsilon.hpp>
+#include <glm/gtx/component_wise.hpp> // glm::compMax
 #include <glm/gtx/vector_query.hpp> //glm::areCollinear
 #include <glm/gtx/string_cast.hpp>
 
@@ -135,14 +138,99 @@ TPoint<fpt, 2> intersection(TLine<fpt, 2> const& l1, TLine<fpt, 2> const& l2)
 	return l1.parametrization(timepoints.x);
 }
 
+/* Finds the points where triangle cuts the plane of another triangle, given the signed distances
+ * of its vertices to that plane, and writes the first and last of them along direction to lo and hi */
+template<typename fpt>
+void cut(
+	TTriangle<fpt, 3> const& triangle,
+	std::array<fpt, 3> const& distances,
+	glm::vec<3, fpt> const& direction,
+	TPoint<fpt, 3>& lo, fpt& lo_param,
+	TPoint<fpt, 3>& hi, fpt& hi_param)
+{
+	lo_param = std::numeric_limits<fpt>::infinity();
+	hi_param = -std::numeric_limits<fpt>::infinity();
+	auto const consider = [&](TPoint<fpt, 3> const& point) {
+		auto const param = glm::dot(direction, point);
+		if(param < lo_param) { lo = point; lo_param = param; }
+		if(param > hi_param) { hi = point; hi_param = param; }
+	};
+
+	for(std::size_t i = 0; i < 3; i++) {
+		std::size_t const j = (i + 1) % 3;
+		if(distances[i] == fpt(0)) {
+			consider(triangle[i]);
+		}
+		if((distances[i] < fpt(0) && distances[j] > fpt(0)) || (distances[i] > fpt(0) && distances[j] < fpt(0))) {
+			consider(triangle[i] + (triangle[j] - triangle[i]) * (distances[i] / (distances[i] - distances[j])));
+		}
+	}
+}
+
+template<typename fpt>
+bool intersection(TTriangle<fpt, 3> const& t1, TTriangle<fpt, 3> const& t2, TPoint<fpt, 3>& start, TPoint<fpt, 3>& end) {
+	/* Interval overlap method, see Moller's "A Fast Triangle-Triangle Intersection Test":
+	 * 1. Each triangle must have vertices on both sides of the plane of the other triangle.
+	 * 2. Then each triangle cuts the line of intersection of the two planes in an interval.
+	 * 3. The triangles intersect where their intervals overlap.
+	 *
+	 * The line has the direction n1 x n2, like in intersection(TPlane, TPlane). The end points
+	 * of the intervals are interpolated along the edges instead of measured from a point on
+	 * the line, which also works for nearly parallel planes. */
+	auto const cross1 = glm::cross(t1.p2 - t1.p1, t1.p3 - t1.p1);
+	auto const cross2 = glm::cross(t2.p2 - t2.p1, t2.p3 - t2.p1);
+	if(glm::dot(cross1, cross1) == fpt(0) || glm::dot(cross2, cross2) == fpt(0)) return false;
+	auto const n1 = glm::normalize(cross1);
+	auto const n2 = glm::normalize(cross2);
+
+	// Distances this small are rounding errors of the dot products, so such vertices lie on the plane
+	fpt extent = fpt(0);
+	for(std::size_t i = 0; i < 3; i++) {
+		extent = std::max({extent, glm::compMax(glm::abs(t1[i])), glm::compMax(glm::abs(t2[i]))});
+	}
+	auto const tolerance = fpt(8) * std::numeric_limits<fpt>::epsilon() * extent;
+
+	// Returns the signed distances of the vertices of triangle to the plane through point with normal n,
+	// or false if they all lie on the same side of it
+	auto const distances = [tolerance](TTriangle<fpt, 3> const& triangle, glm::vec<3, fpt> const& n, TPoint<fpt, 3> const& point, std::array<fpt, 3>& d) {
+		for(std::size_t i = 0; i < 3; i++) {
+			d[i] = glm::dot(n, triangle[i] - point);
+			if(std::abs(d[i]) <= tolerance) d[i] = fpt(0);
+		}
+		return !((d[0] > fpt(0) && d[1] > fpt(0) && d[2] > fpt(0)) || (d[0] < fpt(0) && d[1] < fpt(0) && d[2] < fpt(0)));
+	};
+
+	// 1.
+	std::array<fpt, 3> d1, d2;
+	if(!distances(t2, n1, t1.p1, d2)) return false;
+	if(!distances(t1, n2, t2.p1, d1)) return false;
+
+	// Coplanar triangles intersect in an area, if at all
+	if(d2[0] == fpt(0) && d2[1] == fpt(0) && d2[2] == fpt(0)) return false;
+	auto const direction = glm::cross(n1, n2);
+	if(glm::dot(direction, direction) == fpt(0)) return false;
+
+	// 2.
+	TPoint<fpt, 3> lo1, hi1, lo2, hi2;
+	fpt lo1_param, hi1_param, lo2_param, hi2_param;
+	cut(t1, d1, direction, lo1, lo1_param, hi1, hi1_param);
+	cut(t2, d2, direction, lo2, lo2_param, hi2, hi2_param);
+
+	// 3.
+	if(lo1_param > hi2_param || lo2_param > hi1_param) return false;
+	start = lo1_param >= lo2_param ? lo1 : lo2;
+	end = hi1_param <= hi2_param ? hi1 : hi2;
+	return true;
+}
+
 template<typename fpt>
 TLineSegment<fpt, 3> intersection(TTriangle<fpt, 3> const& t1, TTriangle<fpt, 3> const& t2) {
-	// 1. Take the two planes of t1 and t2 and find their line-intersection.
-	// 2. Then take that line-intersection and what segment of it is contained by t1, if any.
-	//    It is sufficient to just pick one triangle out of t1 and t2.
-	// TODO: Implement
-	//auto const line = intersection(parallel(t1), parallel(t2));
-	return TLineSegment<fpt, 3>({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f});
+	TPoint<fpt, 3> start, end;
+	if(!intersection(t1, t2, start, end) || start == end) {
+		auto const NaN = std::numeric_limits<fpt>::quiet_NaN();
+		return TLineSegment<fpt, 3>(TPoint<fpt, 3>(NaN), TPoint<fpt, 3>(NaN));
+	}
+	return TLineSegment<fpt, 3>(start, end);
 }
 
 /* Solves a system of three linear equations by (naively) using Cramer's rule. */
@@ -255,6 +343,8 @@ TPoint<float, 3> intersection(TLine<float, 3> const& l, TTriangle<float, 3> cons
 TPoint<double, 3> intersection(TLine<double, 3> const& l, TTriangle<double, 3> const& t) { return detail::intersection(t, l); }
 TLineSegment<float, 3> intersection(TTriangle<float, 3> const& t1, TTriangle<float, 3> const& t2) { return detail::intersection(t1, t2); }
 TLineSegment<double, 3> intersection(TTriangle<double, 3> const& t1, TTriangle<double, 3> const& t2) { return detail::intersection(t1, t2); }
+bool intersection(TTriangle<float, 3> const& t1, TTriangle<float, 3> const& t2, TPoint<float, 3>& start, TPoint<float, 3>& end) { return detail::intersection(t1, t2, start, end); }
+bool intersection(TTriangle<double, 3> const& t1, TTriangle<double, 3> const& t2, TPoint<double, 3>& start, TPoint<double, 3>& end) { return detail::intersection(t1, t2, start, end); }
 
 glm::vec<3,  float, glm::qualifier::defaultp> cramer(glm::mat<3, 3,  float, glm::qualifier::defaultp> const& A, glm::vec<3,  float, glm::qualifier::defaultp> const& b) { return detail::cramer(A, b); }
 glm::vec<3, double, glm::qualifier::defaultp> cramer(glm::mat<3, 3, double, glm::qualifier::defaultp> const& A, glm::vec<3, double, glm::qualifier::defaultp> const& b) { return detail::cramer(A, b); }
@@ -1,13 +1,14 @@
 #include "geometric_primitives/intersections.hpp"
 #include "geometric_primitives/intersects.hpp"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtc/epsilon.hpp>
+#include <algorithm> // std::min, std::max
+#include <initializer_list>
 
 #include "geometric_primitives/linesegment.hpp"
 #include "geometric_primitives/plane.hpp"
 #include "geometric_primitives/point.hpp"
 #include "geometric_primitives/triangle.hpp"
+#include "utils/predicates.hpp"
 
 namespace lowpoly3d {
 namespace detail {
@@ -22,7 +23,7 @@ template<typename fpt, std::size_t dim>
 bool intersects(TLineSegment<fpt, dim> const& segment, TPlane<fpt, dim> const& plane)
 {
 	return
-		!(plane.above(segment.p1) && plane.above(segment.p2)) || 
+		!(plane.above(segment.p1) && plane.above(segment.p2)) &&
 		!(plane.below(segment.p1) && plane.below(segment.p2));
 }
 
@@ -45,97 +46,237 @@ bool Intersects<fpt, dim>::intersects(TLineSegment<fpt, dim> l,	TPoint<fpt, dim>
 		std::numeric_limits<double>::epsilon();
 }
 
+/* The triangle tests below decide everything from the signs of orientation determinants,
+ * in the style of Devillers and Guigue, so that touching primitives intersect and no
+ * planes, projections or square roots are needed. The signs are exact, see utils/predicates.hpp,
+ * so the tests are exact for the coordinates they are given. */
+namespace {
+
+// True unless x and y are both positive or both negative
+bool straddles(int x, int y) {
+	return (x <= 0 || y <= 0) && (x >= 0 || y >= 0);
+}
+
+// Returns the axis to drop when projecting onto a plane with normal n
 template<typename fpt>
-bool intersects(TLineSegment<fpt, 3> const& segment, TTriangle<fpt, 3> const& triangle)
-{
-	/* (naive but intuitive) Algorithm idea:
-	*
-	* 1. The segment must at least intersect with paralell plane to the triangle
-	* if they should intersect at all. So check if the LineSegment intersects
-	* the plane parallel to the triangle.
-	* 
-	* 2. Check if LineSegment lies on the plane of the triangle, if so,
-	* check if both points of the LineSegment are contained by the triangle
-	* by projecting the triangle and the LineSegment locally into plane parallel to triangle
-	* 
-	* 3. Project triangle onto plane that is given by a normal parallel
-	* the segment and p1 of LineSegment --- the LineSegment becomes the point
-	* p1 in that plane.
-	* 
-	* 4. If the projected triangle contains p1, then the LineSegment
-	* intersects the triangle. */
-
-	// 1.
-	auto const trianglePlane = parallel(triangle);
-	if(!intersects(segment, trianglePlane)) return false;
-
-	// 2
-	if(trianglePlane.contains(segment.p1) && trianglePlane.contains(segment.p2)) {
-		auto const projectedTriangle = projectIntoLocal(triangle, trianglePlane);
-		auto const projectedSegmentPoint1 = trianglePlane.projectIntoLocal(segment.p1);
-		auto const projectedSegmentPoint2 = trianglePlane.projectIntoLocal(segment.p2);
-		return projectedTriangle.contains(projectedSegmentPoint1) || projectedTriangle.contains(projectedSegmentPoint2);
+std::size_t dominant_axis(glm::vec<3, fpt> const& n) {
+	const auto a = glm::abs(n);
+	return a.x >= a.y && a.x >= a.z ? 0 : (a.y >= a.z ? 1 : 2);
+}
+
+// Returns p with the coordinate along axis dropped
+template<typename fpt>
+TPoint<fpt, 2> drop(TPoint<fpt, 3> const& p, std::size_t axis) {
+	return axis == 0 ? TPoint<fpt, 2>(p.y, p.z) : (axis == 1 ? TPoint<fpt, 2>(p.z, p.x) : TPoint<fpt, 2>(p.x, p.y));
+}
+
+// Returns true if the closed segments from a to b and from c to d intersect
+template<typename fpt>
+bool segments_intersect(TPoint<fpt, 2> const& a, TPoint<fpt, 2> const& b, TPoint<fpt, 2> const& c, TPoint<fpt, 2> const& d) {
+	const int o1 = orient2d(a, b, c), o2 = orient2d(a, b, d);
+	const int o3 = orient2d(c, d, a), o4 = orient2d(c, d, b);
+	if(o1 == 0 && o2 == 0 && o3 == 0 && o4 == 0) {
+		// Collinear, so they intersect if their extents overlap along both axes
+		return
+			std::max(std::min(a.x, b.x), std::min(c.x, d.x)) <= std::min(std::max(a.x, b.x), std::max(c.x, d.x)) &&
+			std::max(std::min(a.y, b.y), std::min(c.y, d.y)) <= std::min(std::max(a.y, b.y), std::max(c.y, d.y));
+	}
+	return straddles(o1, o2) && straddles(o3, o4);
+}
+
+// Returns true if p is strictly inside the triangle abc, which is never the case for a degenerate triangle
+template<typename fpt>
+bool strictly_inside(TPoint<fpt, 2> const& a, TPoint<fpt, 2> const& b, TPoint<fpt, 2> const& c, TPoint<fpt, 2> const& p) {
+	const int o1 = orient2d(a, b, p), o2 = orient2d(b, c, p), o3 = orient2d(c, a, p);
+	return (o1 > 0 && o2 > 0 && o3 > 0) || (o1 < 0 && o2 < 0 && o3 < 0);
+}
+
+// Returns true if the closed segment pq intersects the closed triangle abc in 2D
+template<typename fpt>
+bool segment_triangle_2d(TPoint<fpt, 2> const& p, TPoint<fpt, 2> const& q,
+	TPoint<fpt, 2> const& a, TPoint<fpt, 2> const& b, TPoint<fpt, 2> const& c) {
+	return
+		strictly_inside(a, b, c, p) ||
+		segments_intersect(p, q, a, b) ||
+		segments_intersect(p, q, b, c) ||
+		segments_intersect(p, q, c, a);
+}
+
+/* Returns an axis to drop from the given points, which are known to be coplanar, such that their
+ * projections intersect exactly where they do. That is an axis that is not parallel to their plane,
+ * or to their line if they are collinear. */
+template<typename fpt>
+std::size_t projection_axis(std::initializer_list<TPoint<fpt, 3>> points) {
+	const auto& first = *points.begin();
+	const TPoint<fpt, 3>* farthest = &first;
+	for(const auto& point : points) {
+		if(glm::dot(point - first, point - first) > glm::dot(*farthest - first, *farthest - first)) farthest = &point;
+	}
+
+	// The plane of the points is the plane of any three of them that are not collinear
+	for(const auto& point : points) {
+		const std::size_t dominant = dominant_axis(TOrient3d<fpt>(first, *farthest, point).normal());
+		for(std::size_t i = 0; i < 3; i++) {
+			const std::size_t axis = (dominant + i) % 3;
+			if(orient2d(drop(first, axis), drop(*farthest, axis), drop(point, axis)) != 0) return axis;
+		}
+	}
+
+	// Collinear, so drop the axis that their line is the least along
+	const auto e = glm::abs(*farthest - first);
+	return e.x <= e.y && e.x <= e.z ? 0 : (e.y <= e.z ? 1 : 2);
+}
+
+// Returns true if the closed segment pq intersects the closed triangle abc, given that p and q are in its plane
+template<typename fpt>
+bool coplanar_segment_triangle(TPoint<fpt, 3> const& p, TPoint<fpt, 3> const& q,
+	TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b, TPoint<fpt, 3> const& c) {
+	const std::size_t axis = projection_axis({a, b, c, p, q});
+	return segment_triangle_2d(drop(p, axis), drop(q, axis), drop(a, axis), drop(b, axis), drop(c, axis));
+}
+
+// Returns true if the closed segments pq and ab intersect. Either may be a single point.
+template<typename fpt>
+bool segment_segment(TPoint<fpt, 3> const& p, TPoint<fpt, 3> const& q, TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b) {
+	if(orient3d(p, q, a, b) != 0) return false;
+	const std::size_t axis = projection_axis({p, q, a, b});
+	return segments_intersect(drop(p, axis), drop(q, axis), drop(a, axis), drop(b, axis));
+}
+
+// Returns true if the closed segment pq intersects the closed triangle abc. p and q may be equal.
+template<typename fpt>
+bool segment_triangle(TPoint<fpt, 3> const& p, TPoint<fpt, 3> const& q,
+	TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b, TPoint<fpt, 3> const& c) {
+	const TOrient3d<fpt> plane(a, b, c);
+	const int dp = plane(p), dq = plane(q);
+	if(!straddles(dp, dq)) return false;
+
+	// Every point is in the plane of a degenerate triangle, which is covered by its edges instead
+	if(plane.degenerate()) {
+		return segment_segment(p, q, a, b) || segment_segment(p, q, b, c) || segment_segment(p, q, c, a);
 	}
+	if(dp == 0 && dq == 0) return coplanar_segment_triangle(p, q, a, b, c);
 
-	// 3.
-	// Create plane parallell to the line segment
-	auto const plane = TPlane<fpt, 3>{segment.p1, segment.p2 - segment.p1};
-	auto const projectedTriangle = projectIntoLocal(triangle, plane);
-	auto const projectedSegmentPoint = plane.projectIntoLocal(segment.p1);
+	// The segment crosses the plane, so it hits the triangle if its line passes every edge on the same side
+	const int s1 = orient3d(p, q, a, b), s2 = orient3d(p, q, b, c), s3 = orient3d(p, q, c, a);
+	return
+		(s1 >= 0 && s2 >= 0 && s3 >= 0) ||
+		(s1 <= 0 && s2 <= 0 && s3 <= 0);
+}
 
-	// The two points should be projected into the same point since, see step 2 above
-	assert(glm::all(
-		glm::epsilonEqual(projectedSegmentPoint,
-		plane.projectIntoLocal(segment.p2),
-		std::numeric_limits<fpt>::epsilon())
-	));
+// Returns true if the closed triangles, which lie in the same plane, intersect
+template<typename fpt>
+bool coplanar_triangles(TTriangle<fpt, 3> const& t1, TTriangle<fpt, 3> const& t2) {
+	const std::size_t axis = projection_axis({t1.p1, t1.p2, t1.p3});
+	const TPoint<fpt, 2> p1 = drop(t1.p1, axis), q1 = drop(t1.p2, axis), r1 = drop(t1.p3, axis);
+	const TPoint<fpt, 2> p2 = drop(t2.p1, axis), q2 = drop(t2.p2, axis), r2 = drop(t2.p3, axis);
+	return
+		segment_triangle_2d(p1, q1, p2, q2, r2) ||
+		segment_triangle_2d(q1, r1, p2, q2, r2) ||
+		segment_triangle_2d(r1, p1, p2, q2, r2) ||
+		strictly_inside(p1, q1, r1, p2);
+}
 
-	// 4.
-	return projectedTriangle.contains(projectedSegmentPoint);
+/* The final test of Devillers and Guigue. p1 and p2 are alone on their side of the plane of the
+ * other triangle, and the triangles are ordered such that q1, r1 and q2, r2 are on the negative side.
+ * The triangles then intersect iff the intervals they cut out of the line where their planes meet overlap. */
+template<typename fpt>
+bool check_min_max(TPoint<fpt, 3> const& p1, TPoint<fpt, 3> const& q1, TPoint<fpt, 3> const& r1,
+	TPoint<fpt, 3> const& p2, TPoint<fpt, 3> const& q2, TPoint<fpt, 3> const& r2) {
+	if(orient3d(p2, p1, q1, q2) > 0) return false;
+	if(orient3d(p2, r1, p1, r2) > 0) return false;
+	return true;
+}
+
+// Orders the second triangle such that p2 is alone on its side of the plane of the first triangle
+template<typename fpt>
+bool tri_tri_3d(TPoint<fpt, 3> const& p1, TPoint<fpt, 3> const& q1, TPoint<fpt, 3> const& r1,
+	TPoint<fpt, 3> const& p2, TPoint<fpt, 3> const& q2, TPoint<fpt, 3> const& r2,
+	int dp2, int dq2, int dr2) {
+	if(dp2 > 0) {
+		if(dq2 > 0) return check_min_max(p1, r1, q1, r2, p2, q2);
+		if(dr2 > 0) return check_min_max(p1, r1, q1, q2, r2, p2);
+		return check_min_max(p1, q1, r1, p2, q2, r2);
+	}
+	if(dp2 < 0) {
+		if(dq2 < 0) return check_min_max(p1, q1, r1, r2, p2, q2);
+		if(dr2 < 0) return check_min_max(p1, q1, r1, q2, r2, p2);
+		return check_min_max(p1, r1, q1, p2, q2, r2);
+	}
+	if(dq2 < 0) {
+		if(dr2 >= 0) return check_min_max(p1, r1, q1, q2, r2, p2);
+		return check_min_max(p1, q1, r1, p2, q2, r2);
+	}
+	if(dq2 > 0) {
+		if(dr2 > 0) return check_min_max(p1, r1, q1, p2, q2, r2);
+		return check_min_max(p1, q1, r1, q2, r2, p2);
+	}
+	// p2 and q2 are in the plane of the first triangle, so r2 is not
+	if(dr2 > 0) return check_min_max(p1, q1, r1, r2, p2, q2);
+	return check_min_max(p1, r1, q1, r2, p2, q2);
+}
+
+} // End of anonymous namespace
+
+template<typename fpt>
+bool intersects(TLineSegment<fpt, 3> const& segment, TTriangle<fpt, 3> const& triangle)
+{
+	return segment_triangle(segment.p1, segment.p2, triangle.p1, triangle.p2, triangle.p3);
 }
 
 
 template<typename fpt>
 bool intersects(TTriangle<fpt, 3> const& t, TPoint<fpt, 3> const& p) {
-	return t.contains(p);
+	return segment_triangle(p, p, t.p1, t.p2, t.p3);
 }
 
 template<typename fpt>
 bool intersects(TTriangle<fpt, 3> const& t1, TTriangle<fpt, 3> const& t2)
 {
-	/* A triangle T1 intersects another triangle T2 iff any line segment of T1 intersect T2 (or vice versa)
-	* But I don't really need to check vice-versa, just make sure that we test the line segments of
-	* the smaller triangle against the larger triangle --- this way, we're never at risk of the following situation:
-	*
-	* |\
-	* | \
-	* |  \
-	* |   \
-	* | |\ \
-	* | |_\ \
-	* |______\
-	* 
-	* where one small triangle is contained by the larger triangle and we would've been testing
-	* the larger triangles line segments against the smaller triangle, which wouldt work... but as stated above,
-	* we're good as long as we compare smaller triangle line segments against the larger triangle. */
-	if(t1.area() < t2.area()) {
-		auto const segment1 = TLineSegment<fpt, 3>(t1.p1, t1.p2);
-		auto const segment2 = TLineSegment<fpt, 3>(t1.p2, t1.p3);
-		auto const segment3 = TLineSegment<fpt, 3>(t1.p3, t1.p1);
-		return
-			::lowpoly3d::intersects(segment1, t2) ||
-			::lowpoly3d::intersects(segment2, t2) || 
-			::lowpoly3d::intersects(segment3, t2);
+	const auto& [p1, q1, r1] = t1.points;
+	const auto& [p2, q2, r2] = t2.points;
+
+	// Triangles that are strictly on one side of the plane of the other do not intersect
+	const TOrient3d<fpt> plane2(p2, q2, r2);
+	const int dp1 = plane2(p1), dq1 = plane2(q1), dr1 = plane2(r1);
+	if((dp1 > 0 && dq1 > 0 && dr1 > 0) || (dp1 < 0 && dq1 < 0 && dr1 < 0)) return false;
+	const TOrient3d<fpt> plane1(p1, q1, r1);
+	const int dp2 = plane1(p2), dq2 = plane1(q2), dr2 = plane1(r2);
+	if((dp2 > 0 && dq2 > 0 && dr2 > 0) || (dp2 < 0 && dq2 < 0 && dr2 < 0)) return false;
+
+	// A degenerate triangle has no plane, so every point is on it, but it still has edges, one of which covers it
+	if(plane1.degenerate()) {
+		return segment_triangle(p1, q1, p2, q2, r2) || segment_triangle(q1, r1, p2, q2, r2) || segment_triangle(r1, p1, p2, q2, r2);
 	}
-	else {
-		auto const segment1 = TLineSegment<fpt, 3>(t2.p1, t2.p2);
-		auto const segment2 = TLineSegment<fpt, 3>(t2.p2, t2.p3);
-		auto const segment3 = TLineSegment<fpt, 3>(t2.p3, t2.p1);
-		return
-			::lowpoly3d::intersects(segment1, t1) ||
-			::lowpoly3d::intersects(segment2, t1) || 
-			::lowpoly3d::intersects(segment3, t1);
+	if(plane2.degenerate()) {
+		return segment_triangle(p2, q2, p1, q1, r1) || segment_triangle(q2, r2, p1, q1, r1) || segment_triangle(r2, p2, p1, q1, r1);
+	}
+	if((dp1 == 0 && dq1 == 0 && dr1 == 0) || (dp2 == 0 && dq2 == 0 && dr2 == 0)) {
+		return coplanar_triangles(t1, t2);
+	}
+
+	// Order the first triangle such that p1 is alone on its side of the plane of the second triangle
+	if(dp1 > 0) {
+		if(dq1 > 0) return tri_tri_3d(r1, p1, q1, p2, r2, q2, dp2, dr2, dq2);
+		if(dr1 > 0) return tri_tri_3d(q1, r1, p1, p2, r2, q2, dp2, dr2, dq2);
+		return tri_tri_3d(p1, q1, r1, p2, q2, r2, dp2, dq2, dr2);
+	}
+	if(dp1 < 0) {
+		if(dq1 < 0) return tri_tri_3d(r1, p1, q1, p2, q2, r2, dp2, dq2, dr2);
+		if(dr1 < 0) return tri_tri_3d(q1, r1, p1, p2, q2, r2, dp2, dq2, dr2);
+		return tri_tri_3d(p1, q1, r1, p2, r2, q2, dp2, dr2, dq2);
+	}
+	if(dq1 < 0) {
+		if(dr1 >= 0) return tri_tri_3d(q1, r1, p1, p2, r2, q2, dp2, dr2, dq2);
+		return tri_tri_3d(p1, q1, r1, p2, q2, r2, dp2, dq2, dr2);
+	}
+	if(dq1 > 0) {
+		if(dr1 > 0) return tri_tri_3d(p1, q1, r1, p2, r2, q2, dp2, dr2, dq2);
+		return tri_tri_3d(q1, r1, p1, p2, q2, r2, dp2, dq2, dr2);
 	}
+	// p1 and q1 are in the plane of the second triangle, so r1 is not
+	if(dr1 > 0) return tri_tri_3d(r1, p1, q1, p2, q2, r2, dp2, dq2, dr2);
+	return tri_tri_3d(r1, p1, q1, p2, r2, q2, dp2, dr2, dq2);
 }
 
 // Explicit instantiation definitions
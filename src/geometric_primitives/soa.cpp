@@ -0,0 +1,171 @@
+#include "geometric_primitives/soa.hpp"
+
+#include <bit> // std::countr_zero
+
+#include "utils/predicates.hpp"
+#include "utils/simd_geometry.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+using simd::float8;
+using Lanes = simd::Lanes3<float8>;
+
+constexpr std::size_t width = detail::soa_width;
+
+Lanes load(const std::vector<float> (&columns)[3], std::size_t i) {
+	return {float8::load(columns[0].data() + i), float8::load(columns[1].data() + i), float8::load(columns[2].data() + i)};
+}
+
+void store(const Lanes& lanes, std::vector<float> (&columns)[3], std::size_t i) {
+	lanes.x.store(columns[0].data() + i);
+	lanes.y.store(columns[1].data() + i);
+	lanes.z.store(columns[2].data() + i);
+}
+
+// The bits of the lanes of the group at i that hold one of the count primitives rather than padding
+int valid(std::size_t i, std::size_t count) {
+	return count - i >= width ? 0xFF : (1 << (count - i)) - 1;
+}
+
+// Appends the index of every set bit of bits to indices, where bit 0 is index i
+void append(int bits, std::size_t i, std::vector<std::size_t>& indices) {
+	while(bits) {
+		indices.push_back(i + std::countr_zero(static_cast<unsigned>(bits)));
+		bits &= bits - 1;
+	}
+}
+
+// Writes 1 where positive, -1 where negative and 0 elsewhere to the group of signs at i
+void store_signs(simd::mask8 positive, simd::mask8 negative, std::vector<std::int8_t>& signs, std::size_t i) {
+	const int above = positive.bits(), below = negative.bits();
+	for(std::size_t lane = 0; lane < width; lane++) {
+		signs[i + lane] = static_cast<std::int8_t>(((above >> lane) & 1) - ((below >> lane) & 1));
+	}
+}
+
+} // End of anonymous namespace
+
+void transform(const SphereSoA& spheres, const glm::mat4& m, SphereSoA& out) {
+	out.resize(spheres.size());
+	// Every radius is scaled by the same factor, so let the scalar transform compute it once
+	const float8 scale = transform(Sphere({0.0f, 0.0f, 0.0f}, 1.0f), m).r;
+	for(std::size_t i = 0; i < spheres.size(); i += width) {
+		store(simd::transform(m, load(spheres.center, i), 1.0f), out.center, i);
+		(float8::load(spheres.radius.data() + i) * scale).store(out.radius.data() + i);
+	}
+}
+
+void transform(const PlaneSoA& planes, const glm::mat4& m, PlaneSoA& out) {
+	out.resize(planes.size());
+	const glm::mat4 normal_matrix(glm::transpose(glm::inverse(glm::mat3(m))));
+	for(std::size_t i = 0; i < planes.size(); i += width) {
+		store(simd::transform(m, load(planes.point, i), 1.0f), out.point, i);
+		const Lanes n = simd::transform(normal_matrix, load(planes.normal, i), 0.0f);
+		const float8 length = sqrt(dot(n, n));
+		store({n.x / length, n.y / length, n.z / length}, out.normal, i);
+	}
+}
+
+void transform(const TriangleSoA& triangles, const glm::mat4& m, TriangleSoA& out) {
+	out.resize(triangles.size());
+	for(std::size_t i = 0; i < triangles.size(); i += width) {
+		for(std::size_t k = 0; k < 3; k++) {
+			store(simd::transform(m, load(triangles.coordinates[k], i), 1.0f), out.coordinates[k], i);
+		}
+	}
+}
+
+std::size_t contains(const SphereSoA& spheres, const Point& point, std::vector<std::size_t>& containing, float tolerance) {
+	containing.clear();
+	const Lanes q = simd::broadcast<float8>(point);
+	for(std::size_t i = 0; i < spheres.size(); i += width) {
+		const Lanes d = load(spheres.center, i) - q;
+		const float8 r = float8::load(spheres.radius.data() + i);
+		append((sqrt(dot(d, d)) <= r + float8(tolerance)).bits() & valid(i, spheres.size()), i, containing);
+	}
+	return containing.size();
+}
+
+std::size_t contains(const TriangleSoA& triangles, const Point& point, std::vector<std::size_t>& containing) {
+	containing.clear();
+	const Lanes q = simd::broadcast<float8>(point);
+	for(std::size_t i = 0; i < triangles.size(); i += width) {
+		/* A point that is certainly not in the plane of a triangle is not in the triangle. That rejects
+		 * almost every triangle, and the rest are left to the scalar test, which is exact. */
+		const auto det = simd::orient3d(
+			load(triangles.coordinates[0], i), load(triangles.coordinates[1], i), load(triangles.coordinates[2], i), q);
+		int candidates = det.uncertain().bits() & valid(i, triangles.size());
+		for(; candidates; candidates &= candidates - 1) {
+			const std::size_t j = i + std::countr_zero(static_cast<unsigned>(candidates));
+			if(triangles[j].contains(point)) containing.push_back(j);
+		}
+	}
+	return containing.size();
+}
+
+std::size_t colliding(const SphereSoA& spheres, const Sphere& sphere, std::vector<std::size_t>& colliding) {
+	colliding.clear();
+	const Lanes p = simd::broadcast<float8>(sphere.p);
+	for(std::size_t i = 0; i < spheres.size(); i += width) {
+		const Lanes d = load(spheres.center, i) - p;
+		const float8 r = float8::load(spheres.radius.data() + i) + float8(sphere.r);
+		append((dot(d, d) < r * r).bits() & valid(i, spheres.size()), i, colliding);
+	}
+	return colliding.size();
+}
+
+void signed_distance(const SphereSoA& spheres, const Point& point, std::vector<float>& distances) {
+	signed_distance(spheres, Sphere(point, 0.0f), distances);
+}
+
+void signed_distance(const SphereSoA& spheres, const Sphere& sphere, std::vector<float>& distances) {
+	distances.resize(detail::soa_padded(spheres.size()));
+	const Lanes p = simd::broadcast<float8>(sphere.p);
+	for(std::size_t i = 0; i < spheres.size(); i += width) {
+		const Lanes d = load(spheres.center, i) - p;
+		const float8 r = float8::load(spheres.radius.data() + i);
+		(sqrt(dot(d, d)) - r - float8(sphere.r)).store(distances.data() + i);
+	}
+	distances.resize(spheres.size());
+}
+
+void signed_distance(const PlaneSoA& planes, const Point& point, std::vector<float>& distances) {
+	distances.resize(detail::soa_padded(planes.size()));
+	const Lanes q = simd::broadcast<float8>(point);
+	for(std::size_t i = 0; i < planes.size(); i += width) {
+		dot(q - load(planes.point, i), load(planes.normal, i)).store(distances.data() + i);
+	}
+	distances.resize(planes.size());
+}
+
+void classify(const PlaneSoA& planes, const Point& point, std::vector<std::int8_t>& sides) {
+	sides.resize(detail::soa_padded(planes.size()));
+	const Lanes q = simd::broadcast<float8>(point);
+	for(std::size_t i = 0; i < planes.size(); i += width) {
+		const auto det = simd::side(load(planes.normal, i), load(planes.point, i), q);
+		store_signs(det.positive(), det.negative(), sides, i);
+		int uncertain = det.uncertain().bits() & valid(i, planes.size());
+		for(; uncertain; uncertain &= uncertain - 1) {
+			const std::size_t j = i + std::countr_zero(static_cast<unsigned>(uncertain));
+			const Point n(planes.normal[0][j], planes.normal[1][j], planes.normal[2][j]);
+			const Point p(planes.point[0][j], planes.point[1][j], planes.point[2][j]);
+			sides[j] = static_cast<std::int8_t>(side(n, p, point));
+		}
+	}
+	sides.resize(planes.size());
+}
+
+void classify(const SphereSoA& spheres, const Plane& plane, std::vector<std::int8_t>& sides) {
+	sides.resize(detail::soa_padded(spheres.size()));
+	const Lanes n = simd::broadcast<float8>(plane.getNormal()), p = simd::broadcast<float8>(plane.getPoint());
+	for(std::size_t i = 0; i < spheres.size(); i += width) {
+		const float8 distance = dot(load(spheres.center, i) - p, n);
+		const float8 r = float8::load(spheres.radius.data() + i);
+		store_signs(distance > r, distance < float8(0.0f) - r, sides, i);
+	}
+	sides.resize(spheres.size());
+}
+
+} // End of namespace lowpoly3d
@@ -97,8 +97,29 @@ bool colliding(const Sphere& a, const Sphere& b, const ::glm::mat4& a_transform,
 	return diffdot < radiussq;
 }
 
+template<typename fpt>
+TSphere<fpt, 3> transform(const TSphere<fpt, 3>& sphere, const ::glm::mat<4, 4, fpt>& m) {
+	/* The largest factor by which m stretches a direction is the square root of the largest
+	 * eigenvalue of M^T*M, where M is the linear part of m. Bound it by the largest absolute
+	 * row sum of M^T*M (Gershgorin), which is exact when the columns of M are orthogonal. */
+	fpt max_row_sum = fpt(0);
+	for(int i = 0; i < 3; i++) {
+		fpt row_sum = fpt(0);
+		for(int j = 0; j < 3; j++) {
+			row_sum += std::abs(::glm::dot(::glm::vec<3, fpt>(m[i]), ::glm::vec<3, fpt>(m[j])));
+		}
+		max_row_sum = std::max(max_row_sum, row_sum);
+	}
+	return TSphere<fpt, 3>(
+		::glm::vec<3, fpt>(m * ::glm::vec<4, fpt>(sphere.p, fpt(1))),
+		sphere.r * std::sqrt(max_row_sum));
+}
+
 // Explicit instantiations of sphere
 template struct TSphere<float, 3>;
 template struct TSphere<double, 3>;
+
+template TSphere< float, 3> transform(TSphere< float, 3> const&, glm::mat<4, 4, float> const&);
+template TSphere<double, 3> transform(TSphere<double, 3> const&, glm::mat<4, 4, double> const&);
 	
 }; //End of namespace lowpoly3d
@@ -1,8 +1,11 @@
 #include <algorithm>
+#include <cmath> // std::sqrt, std::abs
 #include <cstddef> // std::size_t
+#include <limits>
 
 #include "geometric_primitives/direction.hpp"
 #include "geometric_primitives/intersections.hpp"
+#include "geometric_primitives/intersects.hpp"
 #include "geometric_primitives/line.hpp"
 #include "geometric_primitives/oriented_plane.hpp"
 #include "geometric_primitives/point.hpp"
@@ -15,7 +18,7 @@
 
 #include "utils/glm/glmprint.hpp"
 #include "utils/glm/vector_projection.hpp"
-#include "utils/solve.hpp"
+#include "utils/predicates.hpp"
 
 namespace lowpoly3d
 {
@@ -59,41 +62,31 @@ struct TriangleContains {};
 
 template<typename fpt>
 struct TriangleContains<fpt, 3> {
-	fpt operator()(TTriangle<fpt, 3> const& triangle, TPoint<fpt, 3> const& point) const
+	bool operator()(TTriangle<fpt, 3> const& triangle, TPoint<fpt, 3> const& point) const
 	{
-		using tri_type = TTriangle<fpt, 3>;
-		auto const tri1 = tri_type { point, triangle.p1, triangle.p2 };
-		auto const tri2 = tri_type { point, triangle.p1, triangle.p3 };
-		auto const tri3 = tri_type { point, triangle.p2, triangle.p3 };
-		// FIXME: This method will break when the triangle degenerates into a line segment,
-		// and the point lies on the line formed from the line segment.
-		return std::abs(tri1.area() + tri2.area() + tri3.area() - triangle.area() <= std::numeric_limits<fpt>::epsilon());
+		// Exactly coplanar and within the triangle, or on an edge of a degenerate triangle, see intersects.cpp
+		return intersects(triangle, point);
 	}
 };
 
 template<typename fpt>
 struct TriangleContains<fpt, 2> {
-	fpt operator()(TTriangle<fpt, 2> const& triangle, TPoint<fpt, 2> const& point) const
+	bool operator()(TTriangle<fpt, 2> const& triangle, TPoint<fpt, 2> const& point) const
 	{
-		auto const ts = solveScalingVecs(triangle.p3 - triangle.p1, triangle.p2 - triangle.p1, point - triangle.p1);
-		auto const sumt = ts.x + ts.y;
-
-		auto inRangeEps = [](
-			fpt variable,
-			fpt start,
-			fpt end,
-			fpt eps
-		){
-			assert(start <= end);
-			assert(eps >= 0);
-			return start - eps <= variable && variable <= end + eps; 
+		auto const& [a, b, c] = triangle.points;
+		int const o1 = orient2d(a, b, point), o2 = orient2d(b, c, point), o3 = orient2d(c, a, point);
+		if(orient2d(a, b, c) != 0) {
+			return (o1 >= 0 && o2 >= 0 && o3 >= 0) || (o1 <= 0 && o2 <= 0 && o3 <= 0);
+		}
+
+		// A degenerate triangle is covered by its edges, and point is on an edge if it is on its line and within its extent
+		auto const onEdge = [&point](TPoint<fpt, 2> const& start, TPoint<fpt, 2> const& end, int orientation) {
+			return
+				orientation == 0 &&
+				std::min(start.x, end.x) <= point.x && point.x <= std::max(start.x, end.x) &&
+				std::min(start.y, end.y) <= point.y && point.y <= std::max(start.y, end.y);
 		};
-
-		fpt const eps = std::numeric_limits<fpt>::epsilon();
-		return
-			inRangeEps(ts.x, 0, 1, eps) &&
-			inRangeEps(ts.y, 0, 1, eps) &&
-			inRangeEps(sumt, 0, 1, eps);
+		return onEdge(a, b, o1) || onEdge(b, c, o2) || onEdge(c, a, o3);
 	}
 };
 
@@ -329,6 +322,174 @@ template TPoint<double, 2> circumcenter(TTriangle<double, 2> const&);
 template TPoint< float, 3> circumcenter(TTriangle< float, 3> const&);
 template TPoint<double, 3> circumcenter(TTriangle<double, 3> const&);
 
+namespace {
+
+/* Writes the closest points of the segments p1-q1 and p2-q2 to c1 and c2 and returns
+ * their squared distance. Segments may be degenerate. See Ericson, Real-Time Collision Detection 5.1.9 */
+template<typename fpt>
+fpt closest_points_of_segments(
+	TPoint<fpt, 3> const& p1, TPoint<fpt, 3> const& q1,
+	TPoint<fpt, 3> const& p2, TPoint<fpt, 3> const& q2,
+	TPoint<fpt, 3>& c1, TPoint<fpt, 3>& c2) {
+	const auto d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+	const fpt a = glm::dot(d1, d1), e = glm::dot(d2, d2), f = glm::dot(d2, r);
+	constexpr fpt epsilon = std::numeric_limits<fpt>::epsilon();
+
+	fpt s = 0, t = 0;
+	if(a <= epsilon && e <= epsilon) {
+		// Both segments are points
+	} else if(a <= epsilon) {
+		t = std::clamp(f / e, fpt(0), fpt(1));
+	} else {
+		const fpt c = glm::dot(d1, r);
+		if(e <= epsilon) {
+			s = std::clamp(-c / a, fpt(0), fpt(1));
+		} else {
+			const fpt b = glm::dot(d1, d2);
+			const fpt denominator = a*e - b*b;
+
+			// Closest point on the line of segment 1 to the line of segment 2, any point if they are parallel
+			s = denominator != fpt(0) ? std::clamp((b*f - c*e) / denominator, fpt(0), fpt(1)) : fpt(0);
+			t = (b*s + f) / e;
+			if(t < fpt(0)) {
+				t = 0;
+				s = std::clamp(-c / a, fpt(0), fpt(1));
+			} else if(t > fpt(1)) {
+				t = 1;
+				s = std::clamp((b - c) / a, fpt(0), fpt(1));
+			}
+		}
+	}
+	c1 = p1 + s*d1;
+	c2 = p2 + t*d2;
+	return glm::dot(c1 - c2, c1 - c2);
+}
+
+// Returns true and writes the crossing to point if the segment p-q crosses triangle
+template<typename fpt>
+bool segment_crosses(TPoint<fpt, 3> const& p, TPoint<fpt, 3> const& q, TTriangle<fpt, 3> const& triangle, TPoint<fpt, 3>& point) {
+	const auto direction = q - p;
+	const auto e1 = triangle.p2 - triangle.p1, e2 = triangle.p3 - triangle.p1;
+	const auto h = glm::cross(direction, e2);
+	const fpt det = glm::dot(e1, h);
+
+	// A segment in the plane of triangle does not cross it, the edges of the triangles meet instead
+	if(std::abs(det) <= std::numeric_limits<fpt>::epsilon() * glm::dot(e1, e1) * glm::length(direction)) return false;
+
+	const fpt inverse = fpt(1) / det;
+	const auto s = p - triangle.p1;
+	const fpt u = inverse * glm::dot(s, h);
+	if(u < fpt(0) || u > fpt(1)) return false;
+	const auto k = glm::cross(s, e1);
+	const fpt v = inverse * glm::dot(direction, k);
+	if(v < fpt(0) || u + v > fpt(1)) return false;
+	const fpt t = inverse * glm::dot(e2, k);
+	if(t < fpt(0) || t > fpt(1)) return false;
+	point = p + t*direction;
+	return true;
+}
+
+} // End of anonymous namespace
+
+template<typename fpt>
+TPoint<fpt, 3> closest_point(TTriangle<fpt, 3> const& triangle, TPoint<fpt, 3> const& point) {
+	// Finds the voronoi region of point, see Ericson, Real-Time Collision Detection 5.1.5
+	const auto& a = triangle.p1;
+	const auto& b = triangle.p2;
+	const auto& c = triangle.p3;
+	const auto ab = b - a, ac = c - a, ap = point - a;
+
+	const fpt d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if(d1 <= fpt(0) && d2 <= fpt(0)) return a;
+
+	const auto bp = point - b;
+	const fpt d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if(d3 >= fpt(0) && d4 <= d3) return b;
+
+	const fpt vc = d1*d4 - d3*d2;
+	if(vc <= fpt(0) && d1 >= fpt(0) && d3 <= fpt(0)) return a + (d1 / (d1 - d3)) * ab;
+
+	const auto cp = point - c;
+	const fpt d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if(d6 >= fpt(0) && d5 <= d6) return c;
+
+	const fpt vb = d5*d2 - d1*d6;
+	if(vb <= fpt(0) && d2 >= fpt(0) && d6 <= fpt(0)) return a + (d2 / (d2 - d6)) * ac;
+
+	const fpt va = d3*d6 - d5*d4;
+	if(va <= fpt(0) && d4 - d3 >= fpt(0) && d5 - d6 >= fpt(0)) return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+
+	const fpt sum = va + vb + vc;
+	if(sum <= fpt(0)) {
+		// Degenerate triangle, the closest point lies on one of its edges
+		TPoint<fpt, 3> best = a, on_edge, unused;
+		fpt best_distance = std::numeric_limits<fpt>::infinity();
+		for(std::size_t i = 0; i < 3; i++) {
+			const fpt distance = closest_points_of_segments(triangle[i], triangle[(i+1)%3], point, point, on_edge, unused);
+			if(distance < best_distance) {
+				best_distance = distance;
+				best = on_edge;
+			}
+		}
+		return best;
+	}
+	return a + (vb / sum) * ab + (vc / sum) * ac;
+}
+
+template<typename fpt>
+fpt closest_points(
+	TTriangle<fpt, 3> const& a,
+	TTriangle<fpt, 3> const& b,
+	TPoint<fpt, 3>& on_a,
+	TPoint<fpt, 3>& on_b) {
+
+	// Intersecting triangles that are not coplanar have an edge of one crossing the other
+	TPoint<fpt, 3> crossing;
+	for(std::size_t i = 0; i < 3; i++) {
+		if(segment_crosses(a[i], a[(i+1)%3], b, crossing) || segment_crosses(b[i], b[(i+1)%3], a, crossing)) {
+			on_a = on_b = crossing;
+			return fpt(0);
+		}
+	}
+
+	// Otherwise the closest points are on two edges, or a vertex and the interior of the other triangle
+	fpt best = std::numeric_limits<fpt>::infinity();
+	TPoint<fpt, 3> p, q;
+	for(std::size_t i = 0; i < 3; i++) {
+		for(std::size_t j = 0; j < 3; j++) {
+			const fpt distance = closest_points_of_segments(a[i], a[(i+1)%3], b[j], b[(j+1)%3], p, q);
+			if(distance < best) {
+				best = distance;
+				on_a = p;
+				on_b = q;
+			}
+		}
+	}
+	for(std::size_t i = 0; i < 3; i++) {
+		q = closest_point(b, a[i]);
+		fpt distance = glm::dot(q - a[i], q - a[i]);
+		if(distance < best) {
+			best = distance;
+			on_a = a[i];
+			on_b = q;
+		}
+		p = closest_point(a, b[i]);
+		distance = glm::dot(p - b[i], p - b[i]);
+		if(distance < best) {
+			best = distance;
+			on_a = p;
+			on_b = b[i];
+		}
+	}
+	return std::sqrt(best);
+}
+
+template TPoint< float, 3> closest_point(TTriangle< float, 3> const&, TPoint< float, 3> const&);
+template TPoint<double, 3> closest_point(TTriangle<double, 3> const&, TPoint<double, 3> const&);
+
+template  float closest_points(TTriangle< float, 3> const&, TTriangle< float, 3> const&, TPoint< float, 3>&, TPoint< float, 3>&);
+template double closest_points(TTriangle<double, 3> const&, TTriangle<double, 3> const&, TPoint<double, 3>&, TPoint<double, 3>&);
+
 template<typename fpt, std::size_t dim>
 std::ostream& operator<<(std::ostream& os, TTriangle<fpt, dim> const& triangle) {
 	os << "(" << glm::to_string(triangle.p1) << "," << glm::to_string(triangle.p2) << "," << glm::to_string(triangle.p3) << ")";
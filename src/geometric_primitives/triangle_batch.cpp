@@ -0,0 +1,125 @@
+#include "geometric_primitives/triangle_batch.hpp"
+
+#include <utility> // std::pair
+
+#include "geometric_primitives/intersects.hpp"
+#include "utils/predicates.hpp"
+#include "utils/simd_geometry.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+using simd::Filtered;
+using simd::Lanes3;
+
+template<typename floatN, std::size_t N>
+Lanes3<floatN> corner(TTriangleBatch<N> const& batch, std::size_t k) {
+	return {floatN::load(batch.coordinates[k][0]), floatN::load(batch.coordinates[k][1]), floatN::load(batch.coordinates[k][2])};
+}
+
+// True where x and y are certainly of opposite signs
+template<typename floatN>
+auto opposite(Filtered<floatN> const& x, Filtered<floatN> const& y) {
+	return (x.positive() & y.negative()) | (x.negative() & y.positive());
+}
+
+template<typename floatN>
+auto same_sign(Filtered<floatN> const& x, Filtered<floatN> const& y, Filtered<floatN> const& z) {
+	return (x.positive() & y.positive() & z.positive()) | (x.negative() & y.negative() & z.negative());
+}
+
+/* The lanes where the line through p and q certainly passes every edge of the triangle abc on
+ * the same side, and the lanes where that is uncertain */
+template<typename floatN>
+std::pair<int, int> passes_inside(Lanes3<floatN> const& p, Lanes3<floatN> const& q,
+	Lanes3<floatN> const& a, Lanes3<floatN> const& b, Lanes3<floatN> const& c) {
+	const auto s1 = orient3d(p, q, a, b), s2 = orient3d(p, q, b, c), s3 = orient3d(p, q, c, a);
+	return {same_sign(s1, s2, s3).bits(), (s1.uncertain() | s2.uncertain() | s3.uncertain()).bits()};
+}
+
+// Calls the scalar test on the lanes in fallback and replaces their bits in hits
+template<std::size_t N, typename Primitive>
+int fall_back(Primitive const& primitive, TTriangleBatch<N> const& batch, int hits, int fallback) {
+	for(std::size_t i = 0; i < batch.size(); i++) {
+		if(fallback & (1 << i)) {
+			hits = intersects(primitive, batch[i]) ? hits | (1 << i) : hits & ~(1 << i);
+		}
+	}
+	return hits;
+}
+
+/* A segment that crosses the plane of a triangle hits the triangle iff its line passes all
+ * edges on the same side. Lanes where the sign of any of these orientations is uncertain, which
+ * includes segments in the plane of a triangle and degenerate triangles, are left to the scalar test. */
+template<typename floatN, std::size_t N>
+int segment_triangles(LineSegment const& segment, TTriangleBatch<N> const& batch) {
+	const int used = (1 << batch.size()) - 1;
+	const auto p = simd::broadcast<floatN>(segment.p1), q = simd::broadcast<floatN>(segment.p2);
+	const auto a = corner<floatN>(batch, 0), b = corner<floatN>(batch, 1), c = corner<floatN>(batch, 2);
+
+	const auto dp = side(planes(a, b, c), p), dq = side(planes(a, b, c), q);
+	const int candidates = ~((dp.positive() & dq.positive()) | (dp.negative() & dq.negative())).bits() & used;
+	if(!candidates) return 0;
+
+	const auto [inside, uncertain] = passes_inside(p, q, a, b, c);
+	const int hits = opposite(dp, dq).bits() & inside & candidates;
+	const int fallback = ((dp.uncertain() | dq.uncertain()).bits() | uncertain) & candidates;
+	return fall_back(segment, batch, hits, fallback);
+}
+
+/* Two triangles that are not coplanar, and that have no vertex in the plane of the other, intersect
+ * iff an edge of one of them crosses the other. Lanes where that is not certain from the signs of
+ * the orientations, which includes degenerate triangles, are left to the scalar test. */
+template<typename floatN, std::size_t N>
+int triangle_triangles(Triangle const& triangle, TTriangleBatch<N> const& batch) {
+	const int used = (1 << batch.size()) - 1;
+	const Lanes3<floatN> t[3] = {simd::broadcast<floatN>(triangle.p1), simd::broadcast<floatN>(triangle.p2), simd::broadcast<floatN>(triangle.p3)};
+	const Lanes3<floatN> l[3] = {corner<floatN>(batch, 0), corner<floatN>(batch, 1), corner<floatN>(batch, 2)};
+
+	// The vertices of the lanes against the plane of the triangle, which is the same in every lane
+	const auto pt = simd::broadcast<floatN>(Orient3d(triangle.p1, triangle.p2, triangle.p3));
+	const Filtered<floatN> dl[3] = {side(pt, l[0]), side(pt, l[1]), side(pt, l[2])};
+	int candidates = ~same_sign(dl[0], dl[1], dl[2]).bits() & used;
+	if(!candidates) return 0;
+
+	// The vertices of the triangle against the planes of the lanes
+	const auto pl = planes(l[0], l[1], l[2]);
+	const Filtered<floatN> dt[3] = {side(pl, t[0]), side(pl, t[1]), side(pl, t[2])};
+	candidates &= ~same_sign(dt[0], dt[1], dt[2]).bits();
+	if(!candidates) return 0;
+
+	int fallback =
+		(dt[0].uncertain() | dt[1].uncertain() | dt[2].uncertain() |
+		 dl[0].uncertain() | dl[1].uncertain() | dl[2].uncertain()).bits() & candidates;
+
+	// The edges of the triangle against the triangles of the lanes, and vice versa
+	int hits = 0;
+	for(std::size_t k = 0; k < 3; k++) {
+		const int crosses = opposite(dt[k], dt[(k + 1) % 3]).bits() & candidates & ~fallback;
+		if(crosses) {
+			const auto [inside, uncertain] = passes_inside(t[k], t[(k + 1) % 3], l[0], l[1], l[2]);
+			hits |= crosses & inside;
+			fallback |= crosses & uncertain;
+		}
+	}
+	for(std::size_t k = 0; k < 3; k++) {
+		const int crosses = opposite(dl[k], dl[(k + 1) % 3]).bits() & candidates & ~fallback;
+		if(crosses) {
+			const auto [inside, uncertain] = passes_inside(l[k], l[(k + 1) % 3], t[0], t[1], t[2]);
+			hits |= crosses & inside;
+			fallback |= crosses & uncertain;
+		}
+	}
+	return fall_back(triangle, batch, hits & ~fallback, fallback);
+}
+
+} // End of anonymous namespace
+
+int intersects(LineSegment const& segment, TriangleBatch4 const& batch) { return segment_triangles<simd::float4>(segment, batch); }
+int intersects(LineSegment const& segment, TriangleBatch8 const& batch) { return segment_triangles<simd::float8>(segment, batch); }
+
+int intersects(Triangle const& triangle, TriangleBatch4 const& batch) { return triangle_triangles<simd::float4>(triangle, batch); }
+int intersects(Triangle const& triangle, TriangleBatch8 const& batch) { return triangle_triangles<simd::float8>(triangle, batch); }
+
+} // End of namespace lowpoly3d
@@ -1,4 +1,7 @@
+#include <algorithm> // std::max, std::shuffle
+#include <array>
 #include <cassert>
+#include <random> // std::mt19937
 
 #include "geometric_primitives/point.hpp"
 #include "geometric_primitives/sphere.hpp"
@@ -158,10 +161,149 @@ TSphere<fpt, dim> mbs(
 	}
 }
 
+namespace {
+
+// Returns the smallest sphere with a and b on its boundary
+template<typename fpt>
+TSphere<fpt, 3> boundary_sphere(TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b) {
+	return TSphere<fpt, 3>(fpt(0.5) * (a + b), fpt(0.5) * glm::distance(a, b));
+}
+
+/* Returns the smallest sphere with a, b and c on its boundary, whose center is the circumcenter
+ * of the triangle. Collinear points have no such sphere and get the sphere of the two farthest apart. */
+template<typename fpt>
+TSphere<fpt, 3> boundary_sphere(TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b, TPoint<fpt, 3> const& c) {
+	const auto ab = b - a, ac = c - a;
+	const auto n = glm::cross(ab, ac);
+	const fpt n2 = glm::dot(n, n);
+	if(n2 <= std::numeric_limits<fpt>::min()) {
+		const fpt abside2 = glm::distance2(a, b), acside2 = glm::distance2(a, c), bcside2 = glm::distance2(b, c);
+		if(abside2 >= acside2 && abside2 >= bcside2) return boundary_sphere(a, b);
+		return acside2 >= bcside2 ? boundary_sphere(a, c) : boundary_sphere(b, c);
+	}
+	const auto offset = (glm::dot(ac, ac) * glm::cross(n, ab) + glm::dot(ab, ab) * glm::cross(ac, n)) / (fpt(2) * n2);
+	return TSphere<fpt, 3>(a + offset, glm::length(offset));
+}
+
+/* Returns the sphere with a, b, c and d on its boundary. Coplanar points have no such sphere,
+ * which only happens due to round-off in mbs(), and get the sphere of a, b and c grown to enclose d. */
+template<typename fpt>
+TSphere<fpt, 3> boundary_sphere(TPoint<fpt, 3> const& a, TPoint<fpt, 3> const& b, TPoint<fpt, 3> const& c, TPoint<fpt, 3> const& d) {
+	const auto ab = b - a, ac = c - a, ad = d - a;
+	const fpt det = glm::dot(ab, glm::cross(ac, ad));
+	if(std::abs(det) <= std::numeric_limits<fpt>::min()) {
+		TSphere<fpt, 3> sphere = boundary_sphere(a, b, c);
+		sphere.r = std::max(sphere.r, glm::distance(sphere.p, d));
+		return sphere;
+	}
+	const auto offset = (
+		glm::dot(ab, ab) * glm::cross(ac, ad) +
+		glm::dot(ac, ac) * glm::cross(ad, ab) +
+		glm::dot(ad, ad) * glm::cross(ab, ac)) / (fpt(2) * det);
+	return TSphere<fpt, 3>(a + offset, glm::length(offset));
+}
+
+// Returns true if point is outside of sphere by more than round-off
+template<typename fpt>
+bool outside(TSphere<fpt, 3> const& sphere, TPoint<fpt, 3> const& point) {
+	constexpr fpt tolerance = fpt(64) * std::numeric_limits<fpt>::epsilon();
+	return glm::distance2(sphere.p, point) > sphere.r * sphere.r * (fpt(1) + tolerance);
+}
+
+// Grows the radius of sphere such that it encloses every point, despite any round-off
+template<typename fpt>
+void enclose(TSphere<fpt, 3>& sphere, std::vector<TPoint<fpt, 3>> const& points) {
+	fpt r2 = sphere.r * sphere.r;
+	for(auto const& point : points) {
+		r2 = std::max(r2, glm::distance2(sphere.p, point));
+	}
+	sphere.r = std::max(sphere.r, std::sqrt(r2));
+}
+
+} // End of anonymous namespace
+
+template<typename fpt>
+TSphere<fpt, 3> mbs(std::vector<TPoint<fpt, 3>> const& input) {
+	assert(!input.empty());
+
+	// A random order makes it unlikely that a point is outside of the sphere of the points before it
+	std::vector<TPoint<fpt, 3>> points(input);
+	std::shuffle(points.begin(), points.end(), std::mt19937(points.size()));
+
+	/* Welzl's algorithm with its recursion unrolled into loops: the sphere of points[0..i] has
+	 * points[i] on its boundary if points[i] is outside the sphere of points[0..i), and so on
+	 * for up to four points on the boundary, which determine the sphere. */
+	TSphere<fpt, 3> sphere(points[0], fpt(0));
+	for(std::size_t i = 1; i < points.size(); i++) {
+		if(!outside(sphere, points[i])) continue;
+		sphere = TSphere<fpt, 3>(points[i], fpt(0));
+		for(std::size_t j = 0; j < i; j++) {
+			if(!outside(sphere, points[j])) continue;
+			sphere = boundary_sphere(points[i], points[j]);
+			for(std::size_t k = 0; k < j; k++) {
+				if(!outside(sphere, points[k])) continue;
+				sphere = boundary_sphere(points[i], points[j], points[k]);
+				for(std::size_t l = 0; l < k; l++) {
+					if(!outside(sphere, points[l])) continue;
+					sphere = boundary_sphere(points[i], points[j], points[k], points[l]);
+				}
+			}
+		}
+	}
+	enclose(sphere, points);
+	return sphere;
+}
+
+template<typename fpt>
+TSphere<fpt, 3> approximate_mbs(std::vector<TPoint<fpt, 3>> const& points) {
+	assert(!points.empty());
+	using vec_type = glm::vec<3, fpt>;
+
+	// The points that are extreme along the axes and the diagonals of the unit cube
+	const std::array<vec_type, 7> directions {
+		vec_type(1, 0, 0), vec_type(0, 1, 0), vec_type(0, 0, 1),
+		vec_type(1, 1, 1), vec_type(1, 1, -1), vec_type(1, -1, 1), vec_type(1, -1, -1)};
+	std::array<std::size_t, 7> lowest {}, highest {};
+	std::array<fpt, 7> lowest_dot, highest_dot;
+	lowest_dot.fill(std::numeric_limits<fpt>::infinity());
+	highest_dot.fill(-std::numeric_limits<fpt>::infinity());
+	for(std::size_t i = 0; i < points.size(); i++) {
+		for(std::size_t d = 0; d < directions.size(); d++) {
+			const fpt dot = glm::dot(points[i], directions[d]);
+			if(dot < lowest_dot[d]) { lowest_dot[d] = dot; lowest[d] = i; }
+			if(dot > highest_dot[d]) { highest_dot[d] = dot; highest[d] = i; }
+		}
+	}
+	std::vector<TPoint<fpt, 3>> extremes;
+	extremes.reserve(2 * directions.size());
+	for(std::size_t d = 0; d < directions.size(); d++) {
+		extremes.push_back(points[lowest[d]]);
+		extremes.push_back(points[highest[d]]);
+	}
+	TSphere<fpt, 3> sphere = mbs(extremes);
+
+	// Ritter's pass, which grows the sphere just enough to enclose each point outside of it
+	for(auto const& point : points) {
+		const fpt distance = glm::distance(sphere.p, point);
+		if(distance <= sphere.r) continue;
+		const fpt radius = fpt(0.5) * (sphere.r + distance);
+		sphere.p += ((radius - sphere.r) / distance) * (point - sphere.p);
+		sphere.r = radius;
+	}
+	enclose(sphere, points);
+	return sphere;
+}
+
 template TSphere< float, 3> mbs(TTriangle< float, 3> const&);
 template TSphere<double, 3> mbs(TTriangle<double, 3> const&);
 
 template TSphere< float, 3> mbs(TSphere< float, 3> const&, TSphere< float, 3> const&);
 template TSphere<double, 3> mbs(TSphere<double, 3> const&, TSphere<double, 3> const&);
 
+template TSphere< float, 3> mbs(std::vector<TPoint< float, 3>> const&);
+template TSphere<double, 3> mbs(std::vector<TPoint<double, 3>> const&);
+
+template TSphere< float, 3> approximate_mbs(std::vector<TPoint< float, 3>> const&);
+template TSphere<double, 3> approximate_mbs(std::vector<TPoint<double, 3>> const&);
+
 } // End of namespace lowpoly3d
\ No newline at end of file
@@ -137,6 +137,28 @@ Model join(const std::vector<Model>& models, const std::vector<glm::mat4>& trans
 	return output;
 }
 
+namespace {
+
+// Feeds "size" bytes at data into the FNV-1a hash "hash"
+std::uint64_t fnv1a(std::uint64_t hash, const void* data, std::size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+} // End of anonymous namespace
+
+std::uint64_t content_hash(const Model& m) {
+	// The counts are hashed as well, so that vertices can not be mistaken for indices
+	const std::uint64_t counts[2] = {m.vertices.size(), m.triangleIndices.size()};
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+	hash = fnv1a(hash, counts, sizeof(counts));
+	hash = fnv1a(hash, m.vertices.data(), m.vertices.size() * sizeof(Model::vertex_type));
+	return fnv1a(hash, m.triangleIndices.data(), m.triangleIndices.size() * sizeof(Model::triangle_indices_type));
+}
+
 // Returns a model consisting of a single triangle {(0,0,0), (1,0,0), (0,1,0)}
 Model getSingleTriangleModel() {
 	const std::vector<Vertex> vertices {
@@ -0,0 +1,111 @@
+#include "scene_bvh.hpp"
+
+#include <algorithm> // std::max
+#include <limits>
+
+namespace lowpoly3d {
+
+namespace detail {
+
+namespace {
+
+// Spreads the lower 10 bits of v apart, with two zero bits between every pair of bits
+std::uint32_t spread_bits(std::uint32_t v) {
+	v = (v * 0x00010001u) & 0xFF0000FFu;
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return v;
+}
+
+// Sorts keys by their upper 32 bits, in four passes of a radix sort over 8 bits each
+void radix_sort(std::vector<std::uint64_t>& keys) {
+	std::vector<std::uint64_t> sorted(keys.size());
+	for(unsigned shift = 32; shift < 64; shift += 8) {
+		std::size_t offsets[257] = {0};
+		for(const std::uint64_t key : keys) offsets[((key >> shift) & 0xFF) + 1]++;
+		for(std::size_t i = 0; i < 256; i++) offsets[i + 1] += offsets[i];
+		for(const std::uint64_t key : keys) sorted[offsets[(key >> shift) & 0xFF]++] = key;
+		keys.swap(sorted);
+	}
+}
+
+// Appends the subtree over the instances in the lower bits of [begin, end) and returns the index of its root
+std::size_t build(
+	const std::vector<AABB>& bounds,
+	const std::uint64_t* begin,
+	const std::uint64_t* end,
+	std::vector<BinaryBV<AABB>>& nodes,
+	std::size_t depth,
+	std::size_t& max_depth) {
+
+	max_depth = std::max(max_depth, depth);
+	if(end - begin == 1) {
+		const std::uint32_t instance = static_cast<std::uint32_t>(*begin);
+		nodes.emplace_back(bounds[instance], instance, instance, true);
+		return nodes.size() - 1;
+	}
+
+	const std::uint64_t* middle = begin + (end - begin) / 2;
+	const std::size_t left = build(bounds, begin, middle, nodes, depth + 1, max_depth);
+	const std::size_t right = build(bounds, middle, end, nodes, depth + 1, max_depth);
+	nodes.emplace_back(merge(static_cast<const AABB&>(nodes[left]), static_cast<const AABB&>(nodes[right])), left, right, false);
+	return nodes.size() - 1;
+}
+
+} // End of anonymous namespace
+
+std::size_t build_instance_tree(
+	const std::vector<AABB>& bounds,
+	const std::vector<std::uint32_t>& instances,
+	std::vector<BinaryBV<AABB>>& nodes) {
+
+	nodes.clear();
+	if(instances.empty()) return 0;
+	nodes.reserve(2 * instances.size() - 1);
+
+	// Centers are taken at twice their value, which spares a multiplication per instance
+	glm::vec3 lower(std::numeric_limits<float>::infinity()), upper(-std::numeric_limits<float>::infinity());
+	for(const std::uint32_t instance : instances) {
+		const glm::vec3 center = bounds[instance].lower + bounds[instance].upper;
+		lower = glm::min(lower, center);
+		upper = glm::max(upper, center);
+	}
+
+	/* Quantize the centers to 10 bits per axis and interleave them into a Morton code above the instance.
+	 * Axes along which all centers are equal, e.g. for a single instance, are quantized to 0. */
+	const glm::vec3 extent = upper - lower;
+	glm::vec3 scale;
+	for(int axis = 0; axis < 3; axis++) scale[axis] = extent[axis] > 0.0f ? 1023.0f / extent[axis] : 0.0f;
+	std::vector<std::uint64_t> keys;
+	keys.reserve(instances.size());
+	for(const std::uint32_t instance : instances) {
+		const glm::vec3 cell = glm::clamp((bounds[instance].lower + bounds[instance].upper - lower) * scale, 0.0f, 1023.0f);
+		const std::uint32_t code =
+			(spread_bits(static_cast<std::uint32_t>(cell.x)) << 2) |
+			(spread_bits(static_cast<std::uint32_t>(cell.y)) << 1) |
+			spread_bits(static_cast<std::uint32_t>(cell.z));
+		keys.push_back((std::uint64_t(code) << 32) | instance);
+	}
+	radix_sort(keys);
+
+	std::size_t depth = 0;
+	build(bounds, keys.data(), keys.data() + keys.size(), nodes, 1, depth);
+	return depth;
+}
+
+void refit_instance_tree(const std::vector<AABB>& bounds, std::vector<BinaryBV<AABB>>& nodes) {
+	// Children precede their parents, so a single pass fits every node after its children
+	for(auto& node : nodes) {
+		AABB& box = node;
+		if(node.is_leaf) {
+			box = bounds[node.left_idx];
+		} else {
+			box = merge(static_cast<const AABB&>(nodes[node.left_idx]), static_cast<const AABB&>(nodes[node.right_idx]));
+		}
+	}
+}
+
+} // End of namespace detail
+
+} // End of namespace lowpoly3d
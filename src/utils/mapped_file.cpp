@@ -0,0 +1,72 @@
+#include "utils/mapped_file.hpp"
+
+#if defined(_WIN32)
+#include <limits>
+#include <windows.h>
+#undef max // culprit: minwindef.h
+
+namespace lowpoly3d {
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+	file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) {
+		file = nullptr;
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+	// A 32-bit process cannot map a file larger than its address space
+	if(static_cast<unsigned long long>(size.QuadPart) > std::numeric_limits<std::size_t>::max()) return;
+
+	mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(mapping == nullptr) return;
+
+	bytes = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if(bytes != nullptr) {
+		num_bytes = static_cast<std::size_t>(size.QuadPart);
+	}
+}
+
+MappedFile::~MappedFile() {
+	if(bytes) UnmapViewOfFile(bytes);
+	if(mapping) CloseHandle(mapping);
+	if(file) CloseHandle(file);
+}
+
+} // End of namespace lowpoly3d
+
+#elif defined(unix) || defined(__unix__) || defined(__unix) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lowpoly3d {
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) return;
+
+	struct stat status;
+	if(fstat(fd, &status) == 0 && status.st_size > 0) {
+		void* address = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if(address != MAP_FAILED) {
+			bytes = static_cast<const std::byte*>(address);
+			num_bytes = static_cast<std::size_t>(status.st_size);
+		}
+	}
+
+	// The mapping stays valid after the file descriptor is closed
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if(bytes) munmap(const_cast<std::byte*>(bytes), num_bytes);
+}
+
+} // End of namespace lowpoly3d
+
+#else
+	static_assert(false, "Unknown platform");
+#endif
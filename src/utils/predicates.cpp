@@ -0,0 +1,134 @@
+#include "utils/predicates.hpp"
+
+#include <cmath> // std::fma
+#include <vector>
+
+namespace lowpoly3d::detail {
+
+namespace {
+
+/* An expansion is a sum of doubles of increasing magnitude whose nonzero components do not
+ * overlap, so that it represents its sum exactly and has the sign of its largest component.
+ * See Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates". */
+using Expansion = std::vector<double>;
+
+// x + y = a + b exactly, where x is a + b rounded
+void two_sum(double a, double b, double& x, double& y) {
+	x = a + b;
+	const double b_virtual = x - a;
+	const double a_virtual = x - b_virtual;
+	y = (a - a_virtual) + (b - b_virtual);
+}
+
+// Like two_sum, given that |a| >= |b|
+void fast_two_sum(double a, double b, double& x, double& y) {
+	x = a + b;
+	y = b - (x - a);
+}
+
+// x + y = a * b exactly, where x is a * b rounded
+void two_product(double a, double b, double& x, double& y) {
+	x = a * b;
+	y = std::fma(a, b, -x);
+}
+
+Expansion difference(double a, double b) {
+	double x, y;
+	two_sum(a, -b, x, y);
+	return {y, x};
+}
+
+// Returns e + b, without zero components
+Expansion grow(Expansion const& e, double b) {
+	Expansion h;
+	h.reserve(e.size() + 1);
+	double q = b;
+	for(const double component : e) {
+		double sum, error;
+		two_sum(q, component, sum, error);
+		q = sum;
+		if(error != 0.0) h.push_back(error);
+	}
+	if(q != 0.0 || h.empty()) h.push_back(q);
+	return h;
+}
+
+Expansion sum(Expansion e, Expansion const& f) {
+	for(const double component : f) e = grow(e, component);
+	return e;
+}
+
+// Returns e * b, without zero components
+Expansion scale(Expansion const& e, double b) {
+	Expansion h;
+	h.reserve(2 * e.size());
+	double q, error;
+	two_product(e[0], b, q, error);
+	if(error != 0.0) h.push_back(error);
+	for(std::size_t i = 1; i < e.size(); i++) {
+		double high, low, partial;
+		two_product(e[i], b, high, low);
+		two_sum(q, low, partial, error);
+		if(error != 0.0) h.push_back(error);
+		fast_two_sum(high, partial, q, error);
+		if(error != 0.0) h.push_back(error);
+	}
+	if(q != 0.0 || h.empty()) h.push_back(q);
+	return h;
+}
+
+Expansion product(Expansion const& e, Expansion const& f) {
+	Expansion result {0.0};
+	for(const double component : f) result = sum(result, scale(e, component));
+	return result;
+}
+
+Expansion negated(Expansion e) {
+	for(double& component : e) component = -component;
+	return e;
+}
+
+int sign_of(Expansion const& e) {
+	return detail::sign(e.back());
+}
+
+} // End of anonymous namespace
+
+int orient2d_exact(glm::dvec2 const& a, glm::dvec2 const& b, glm::dvec2 const& c) {
+	const Expansion left = product(difference(b.x, a.x), difference(c.y, a.y));
+	const Expansion right = product(difference(b.y, a.y), difference(c.x, a.x));
+	return sign_of(sum(left, negated(right)));
+}
+
+int orient3d_exact(glm::dvec3 const& a, glm::dvec3 const& b, glm::dvec3 const& c, glm::dvec3 const& d) {
+	Expansion u[3], v[3], w[3];
+	for(std::size_t i = 0; i < 3; i++) {
+		u[i] = difference(d[i], c[i]);
+		v[i] = difference(a[i], c[i]);
+		w[i] = difference(b[i], c[i]);
+	}
+
+	// (d - c) . ((a - c) x (b - c)), one component of the cross product at a time
+	Expansion det {0.0};
+	for(std::size_t i = 0; i < 3; i++) {
+		const std::size_t j = (i + 1) % 3, k = (i + 2) % 3;
+		const Expansion cross = sum(product(v[j], w[k]), negated(product(v[k], w[j])));
+		det = sum(det, product(u[i], cross));
+	}
+	return sign_of(det);
+}
+
+template<glm::length_t dim>
+int side_exact(glm::vec<dim, double> const& n, glm::vec<dim, double> const& p, glm::vec<dim, double> const& d) {
+	Expansion det {0.0};
+	for(glm::length_t i = 0; i < dim; i++) {
+		det = sum(det, scale(difference(d[i], p[i]), n[i]));
+	}
+	return sign_of(det);
+}
+
+// Explicit instantiation definitions
+template int side_exact<2>(glm::vec<2, double> const&, glm::vec<2, double> const&, glm::vec<2, double> const&);
+template int side_exact<3>(glm::vec<3, double> const&, glm::vec<3, double> const&, glm::vec<3, double> const&);
+
+} // End of namespace lowpoly3d::detail
@@ -0,0 +1,92 @@
+#include "utils/thread_pool.hpp"
+
+#include <algorithm> // std::min, std::max
+
+namespace lowpoly3d {
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+	workers.reserve(num_threads);
+	for(std::size_t i = 0; i < num_threads; i++) {
+		workers.emplace_back([this]() { work(); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	for(auto& worker : workers) {
+		worker.join();
+	}
+
+	// Tasks that were never picked up still have to fulfil their futures
+	while(run_pending_task()) { }
+}
+
+void ThreadPool::parallel_for(
+	std::size_t begin,
+	std::size_t end,
+	const std::function<void(std::size_t, std::size_t)>& f,
+	std::size_t grain) {
+
+	if(begin >= end) return;
+	grain = std::max<std::size_t>(grain, 1);
+
+	// Aim for a few chunks per thread so that uneven chunks even out
+	const std::size_t count = end - begin;
+	const std::size_t num_chunks_wanted = 4 * std::max<std::size_t>(size(), 1);
+	const std::size_t chunk = std::max(grain, (count + num_chunks_wanted - 1) / num_chunks_wanted);
+
+	std::vector<std::future<void>> futures;
+	futures.reserve(count / chunk + 1);
+
+	// The calling thread takes the first chunk itself
+	for(std::size_t chunk_begin = begin + chunk; chunk_begin < end; chunk_begin += chunk) {
+		const std::size_t chunk_end = std::min(end, chunk_begin + chunk);
+		futures.push_back(submit([&f, chunk_begin, chunk_end]() { f(chunk_begin, chunk_end); }));
+	}
+	f(begin, std::min(end, begin + chunk));
+
+	for(auto& future : futures) {
+		wait(future);
+	}
+}
+
+std::size_t ThreadPool::size() const {
+	return workers.size();
+}
+
+ThreadPool& ThreadPool::global() {
+	static ThreadPool pool;
+	return pool;
+}
+
+bool ThreadPool::run_pending_task() {
+	std::function<void()> task;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(tasks.empty()) return false;
+		task = std::move(tasks.front());
+		tasks.pop_front();
+	}
+	task();
+	return true;
+}
+
+void ThreadPool::work() {
+	while(true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if(stopping) return;
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,109 @@
+#include <catch2/catch_all.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "geometric_primitives/aabb.hpp"
+#include "geometric_primitives/triangle.hpp"
+
+namespace lowpoly3d {
+
+SCENARIO("Axis-aligned bounding boxes") {
+
+	GIVEN("A unit box at the origin") {
+		const AABB box({0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f});
+
+		THEN("its center, extents, surface area and volume are those of a unit cube") {
+			REQUIRE(box.center() == glm::vec3(0.5f, 0.5f, 0.5f));
+			REQUIRE(box.extents() == glm::vec3(0.5f, 0.5f, 0.5f));
+			REQUIRE(box.surface_area() == Catch::Approx(6.0f));
+			REQUIRE(box.volume() == Catch::Approx(1.0f));
+			REQUIRE(box.size() == Catch::Approx(std::sqrt(0.75f)));
+		}
+
+		THEN("it contains its corners and center but not points outside of it") {
+			REQUIRE(box.contains(glm::vec3(0.0f, 0.0f, 0.0f)));
+			REQUIRE(box.contains(glm::vec3(1.0f, 1.0f, 1.0f)));
+			REQUIRE(box.contains(box.center()));
+			REQUIRE_FALSE(box.contains(glm::vec3(1.1f, 0.5f, 0.5f)));
+			REQUIRE_FALSE(box.contains(glm::vec3(0.5f, -0.1f, 0.5f)));
+		}
+
+		WHEN("merged with a disjoint box") {
+			const AABB other({2.0f, -1.0f, 0.5f}, {3.0f, 0.0f, 0.75f});
+			const AABB merged = merge(box, other);
+
+			THEN("the result is the smallest box enclosing both") {
+				REQUIRE(merged == AABB({0.0f, -1.0f, 0.0f}, {3.0f, 1.0f, 1.0f}));
+				REQUIRE(merged.encloses(box));
+				REQUIRE(merged.encloses(other));
+				REQUIRE(box.enclosed(merged));
+				REQUIRE_FALSE(box.encloses(merged));
+			}
+		}
+
+		THEN("it collides with overlapping and touching boxes but not with disjoint boxes") {
+			REQUIRE(colliding(box, AABB({0.5f, 0.5f, 0.5f}, {2.0f, 2.0f, 2.0f})));
+			REQUIRE(colliding(box, AABB({1.0f, 0.0f, 0.0f}, {2.0f, 1.0f, 1.0f})));
+			REQUIRE(colliding(box, AABB({0.25f, 0.25f, 0.25f}, {0.75f, 0.75f, 0.75f})));
+			REQUIRE_FALSE(colliding(box, AABB({1.01f, 0.0f, 0.0f}, {2.0f, 1.0f, 1.0f})));
+			REQUIRE_FALSE(colliding(box, AABB({0.0f, 0.0f, 1.5f}, {1.0f, 1.0f, 2.0f})));
+		}
+
+		THEN("signed distance is the gap between disjoint boxes") {
+			REQUIRE(signed_distance(box, AABB({3.0f, 0.0f, 0.0f}, {4.0f, 1.0f, 1.0f})) == Catch::Approx(2.0f));
+			REQUIRE(signed_distance(box, AABB({2.0f, 2.0f, 0.0f}, {3.0f, 3.0f, 1.0f})) == Catch::Approx(std::sqrt(2.0f)));
+			REQUIRE(signed_distance(box, AABB({1.0f, 0.0f, 0.0f}, {2.0f, 1.0f, 1.0f})) == Catch::Approx(0.0f));
+		}
+
+		THEN("signed distance is the negated penetration depth of overlapping boxes") {
+			REQUIRE(signed_distance(box, AABB({0.75f, 0.0f, 0.0f}, {2.0f, 1.0f, 1.0f})) == Catch::Approx(-0.25f));
+			REQUIRE(signed_distance(box, box) == Catch::Approx(-1.0f));
+		}
+
+		WHEN("transformed by a translation") {
+			const glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f, 0.0f, 0.0f));
+
+			THEN("the box is moved but keeps its shape") {
+				REQUIRE(transform(box, translation) == AABB({2.0f, 0.0f, 0.0f}, {3.0f, 1.0f, 1.0f}));
+				REQUIRE_FALSE(colliding(box, box, glm::mat4(1.0f), glm::translate(glm::mat4(1.0f), glm::vec3(1.1f, 0.0f, 0.0f))));
+				REQUIRE(colliding(box, box, glm::mat4(1.0f), glm::translate(glm::mat4(1.0f), glm::vec3(0.9f, 0.0f, 0.0f))));
+				REQUIRE(signed_distance(box, box, glm::mat4(1.0f), translation) == Catch::Approx(1.0f));
+			}
+		}
+
+		WHEN("transformed by a rotation") {
+			const glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+			const AABB rotated = transform(box, rotation);
+
+			THEN("the result encloses every rotated corner of the box") {
+				for(float x : {0.0f, 1.0f}) {
+					for(float y : {0.0f, 1.0f}) {
+						for(float z : {0.0f, 1.0f}) {
+							const glm::vec3 corner = glm::vec3(rotation * glm::vec4(x, y, z, 1.0f));
+							REQUIRE(rotated.contains(corner));
+						}
+					}
+				}
+			}
+
+			THEN("the result is the tightest box around the rotated box") {
+				const float halfdiagonal = std::sqrt(0.5f);
+				REQUIRE(rotated.extents().x == Catch::Approx(halfdiagonal));
+				REQUIRE(rotated.extents().y == Catch::Approx(halfdiagonal));
+				REQUIRE(rotated.extents().z == Catch::Approx(0.5f));
+			}
+		}
+	}
+
+	GIVEN("A triangle") {
+		const Trianglef triangle({-1.0f, 0.0f, 2.0f}, {1.0f, 3.0f, 2.0f}, {0.0f, -1.0f, 4.0f});
+
+		THEN("its box is the smallest box containing all its points") {
+			const AABB box = aabb(triangle);
+			REQUIRE(box == AABB({-1.0f, -1.0f, 2.0f}, {1.0f, 3.0f, 4.0f}));
+			REQUIRE(box.contains(triangle));
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
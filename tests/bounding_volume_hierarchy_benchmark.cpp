@@ -0,0 +1,1128 @@
+#include "bounding_volume_hierarchy.hpp"
+#include "bvh_cache.hpp"
+#include "bvh_statistics.hpp"
+#include "bvtt_front.hpp"
+#include "collision_world.hpp"
+#include "flat_bounding_volume_hierarchy.hpp"
+#include "proximity.hpp"
+#include "quantized_bounding_volume_hierarchy.hpp"
+#include "ray_cast.hpp"
+#include "region_query.hpp"
+#include "scene_bvh.hpp"
+#include "sphere_cast.hpp"
+#include "time_of_impact.hpp"
+#include "wide_bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/soa.hpp"
+#include "geometric_primitives/triangle_batch.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <bit> // std::popcount
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+#include "generators/terraingenerator.hpp"
+
+/* Benchmarks are hidden, run them with: lowpoly3d_test "[benchmark]" */
+
+namespace lowpoly3d {
+
+namespace {
+
+// Number of BV tests and triangle tests that a full BVTT traversal performs
+struct TraversalCount {
+	std::size_t bv_tests = 0;
+	std::size_t triangle_tests = 0;
+};
+
+/* Visits every overlapping pair of BVs without early exit and counts how many
+ * triangle pairs reach the narrow phase, which is what a tighter BV saves */
+template<typename TValue>
+void count_traversal(
+	const TBVHModel<TValue>& a, const TBVHModel<TValue>& b,
+	const glm::mat4& a_world, const glm::mat4& b_world,
+	std::size_t a_idx, std::size_t b_idx, TraversalCount& count) {
+	count.bv_tests++;
+	if(!colliding(a[a_idx], b[b_idx], a_world, b_world)) return;
+
+	if(a[a_idx].is_leaf && b[b_idx].is_leaf) {
+		count.triangle_tests++;
+	} else if(b[b_idx].is_leaf || (!a[a_idx].is_leaf && a[a_idx].size() > b[b_idx].size())) {
+		count_traversal(a, b, a_world, b_world, a[a_idx].left_idx, b_idx, count);
+		count_traversal(a, b, a_world, b_world, a[a_idx].right_idx, b_idx, count);
+	} else {
+		count_traversal(a, b, a_world, b_world, a_idx, b[b_idx].left_idx, count);
+		count_traversal(a, b, a_world, b_world, a_idx, b[b_idx].right_idx, count);
+	}
+}
+
+template<typename TValue>
+TraversalCount count_traversal(
+	const TBVHModel<TValue>& a, const TBVHModel<TValue>& b,
+	const glm::mat4& a_world, const glm::mat4& b_world) {
+	TraversalCount count;
+	count_traversal(a, b, a_world, b_world, a.root_idx(), b.root_idx(), count);
+	return count;
+}
+
+} // End of anonymous namespace
+
+TEST_CASE("BVH of spheres versus BVH of boxes on terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 2.0f));
+
+	const BVHModel terrainSpheres(&terrain), ballSpheres(&ball);
+	const AABBBVHModel terrainBoxes(&terrain), ballBoxes(&ball);
+
+	// Skim the ball along the terrain so that it overlaps many BVs of the terrain
+	const AABB bounds = terrainBoxes.root();
+	std::vector<glm::mat4> placements;
+	for(float t = 0.1f; t < 1.0f; t += 0.1f) {
+		const glm::vec3 position = bounds.lower + t * (bounds.upper - bounds.lower);
+		placements.push_back(glm::translate(glm::mat4(1.0f), position));
+	}
+	const glm::mat4 identity(1.0f);
+
+	TraversalCount sphereCount, boxCount;
+	for(const auto& placement : placements) {
+		const TraversalCount s = count_traversal(terrainSpheres, ballSpheres, identity, placement);
+		const TraversalCount b = count_traversal(terrainBoxes, ballBoxes, identity, placement);
+		sphereCount.bv_tests += s.bv_tests;
+		sphereCount.triangle_tests += s.triangle_tests;
+		boxCount.bv_tests += b.bv_tests;
+		boxCount.triangle_tests += b.triangle_tests;
+	}
+	std::cout << "BVH<Sphere>: " << sphereCount.bv_tests << " BV tests, " << sphereCount.triangle_tests << " triangle tests\n";
+	std::cout << "BVH<AABB>:   " << boxCount.bv_tests << " BV tests, " << boxCount.triangle_tests << " triangle tests\n";
+
+	BENCHMARK("collides with BVH<Sphere>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(terrainSpheres, ballSpheres, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides with BVH<AABB>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(terrainBoxes, ballBoxes, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("building BVH<Sphere>") {
+		return BVH<Sphere>(terrain).size();
+	};
+
+	BENCHMARK("building BVH<AABB>") {
+		return BVH<AABB>(terrain).size();
+	};
+}
+
+TEST_CASE("BVH of spheres merged from children versus fitted to vertices on terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 2.0f));
+
+	const BVHModel merged(&terrain), ballMerged(&ball);
+	const BVHModel fitted(&terrain, BVHBuildStrategy::binned_sah, BVHFitting::vertices);
+	const BVHModel ballFitted(&ball, BVHBuildStrategy::binned_sah, BVHFitting::vertices);
+
+	const AABB bounds = AABBBVHModel(&terrain).root();
+	std::vector<glm::mat4> placements;
+	for(float t = 0.1f; t < 1.0f; t += 0.1f) {
+		placements.push_back(glm::translate(glm::mat4(1.0f), bounds.lower + t * (bounds.upper - bounds.lower)));
+	}
+	const glm::mat4 identity(1.0f);
+
+	TraversalCount mergedCount, fittedCount;
+	for(const auto& placement : placements) {
+		const TraversalCount m = count_traversal(merged, ballMerged, identity, placement);
+		const TraversalCount f = count_traversal(fitted, ballFitted, identity, placement);
+		mergedCount.bv_tests += m.bv_tests;
+		mergedCount.triangle_tests += m.triangle_tests;
+		fittedCount.bv_tests += f.bv_tests;
+		fittedCount.triangle_tests += f.triangle_tests;
+	}
+	std::cout << "root radius merged: " << merged.root().r << ", fitted: " << fitted.root().r << "\n";
+	std::cout << "merged: " << mergedCount.bv_tests << " BV tests, " << mergedCount.triangle_tests << " triangle tests\n";
+	std::cout << "fitted: " << fittedCount.bv_tests << " BV tests, " << fittedCount.triangle_tests << " triangle tests\n";
+
+	BENCHMARK("collides with merged spheres") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(merged, ballMerged, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides with fitted spheres") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(fitted, ballFitted, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("building with merged spheres") {
+		return BVH<Sphere>(terrain).size();
+	};
+
+	BENCHMARK("building with fitted spheres") {
+		return BVH<Sphere>(terrain, BVHBuildStrategy::binned_sah, BVHFitting::vertices).size();
+	};
+
+	BENCHMARK("exact sphere of the vertices of terrain") {
+		return mbs(terrain.vertices).r;
+	};
+
+	BENCHMARK("approximate sphere of the vertices of terrain") {
+		return approximate_mbs(terrain.vertices).r;
+	};
+}
+
+TEST_CASE("BVH versus flattened BVH on terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 2.0f));
+
+	const BVHModel terrainBVH(&terrain), ballBVH(&ball);
+	const FlatBVH<Sphere> terrainFlat(terrain, terrainBVH), ballFlat(ball, ballBVH);
+	const FlatBVH<Sphere> terrainFlat4(terrain, terrainBVH, 4), ballFlat4(ball, ballBVH, 4);
+
+	const AABB bounds = AABBBVHModel(&terrain).root();
+	std::vector<glm::mat4> placements;
+	for(float t = 0.1f; t < 1.0f; t += 0.1f) {
+		const glm::vec3 position = bounds.lower + t * (bounds.upper - bounds.lower);
+		placements.push_back(glm::translate(glm::mat4(1.0f), position));
+	}
+	const glm::mat4 identity(1.0f);
+
+	std::cout << "BVH node: " << sizeof(BVHModel::bv_type) << " bytes, flat node: " << sizeof(FlatBVH<Sphere>::bv_type) << " bytes\n";
+
+	BENCHMARK("collides with BVHModel") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(terrainBVH, ballBVH, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides with FlatBVH") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(terrainFlat, ballFlat, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides with FlatBVH, four triangles per leaf") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(terrainFlat4, ballFlat4, identity, placement);
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("Deep BVTT traversal of terrain against terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const BVHModel bvh(&terrain);
+	const AABBBVHModel boxes(&terrain);
+
+	// Lift, rotate and scale a copy of the terrain so that the BVTT is deep but rarely reaches triangles
+	const glm::mat4 identity(1.0f);
+	std::vector<glm::mat4> placements;
+	for(float angle = 0.0f; angle < 360.0f; angle += 45.0f) {
+		placements.push_back(glm::scale(
+			glm::rotate(glm::translate(identity, glm::vec3(0.0f, 40.0f, 0.0f)), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f)),
+			glm::vec3(1.5f)));
+	}
+
+	std::cout << "Terrain BVH depth: " << bvh.getDepth() << "\n";
+
+	BENCHMARK("collides on BVH<Sphere>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(bvh, bvh, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides on BVH<AABB>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(boxes, boxes, identity, placement);
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("All pairs of intersecting triangles of terrain and a ball", "[.][benchmark]") {
+	// Small enough for brute force to finish
+	TerrainGenerator tg(80);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 2.0f));
+	const BVHModel terrainBVH(&terrain), ballBVH(&ball);
+
+	// Center the ball on a vertex in the middle of the terrain so that it cuts through the surface
+	const glm::mat4 identity(1.0f);
+	const glm::mat4 placement = glm::translate(identity, terrain.vertices[terrain.getNumVertices() / 2 + 40]);
+
+	std::vector<TrianglePair> pairs;
+	const std::size_t count = contacts(terrainBVH, ballBVH, identity, placement, pairs);
+	std::cout << "Contacts: " << count << "\n";
+
+	BENCHMARK("contacts") {
+		return contacts(terrainBVH, ballBVH, identity, placement, pairs);
+	};
+
+	BENCHMARK("contacts, at most 8") {
+		return contacts(terrainBVH, ballBVH, identity, placement, pairs, 8);
+	};
+
+	std::vector<Contact> manifold;
+	std::cout << "Contacts with a segment of intersection: " << contact_manifold(terrainBVH, ballBVH, identity, placement, manifold) << "\n";
+	BENCHMARK("contact_manifold") {
+		return contact_manifold(terrainBVH, ballBVH, identity, placement, manifold);
+	};
+
+	std::vector<TrianglePair> bruteForcePairs;
+	BENCHMARK("brute force") {
+		bruteForcePairs.clear();
+		for(std::size_t i = 0; i < terrain.getNumTriangles(); i++) {
+			const auto a = terrainBVH.getTriangle(i);
+			for(std::size_t j = 0; j < ball.getNumTriangles(); j++) {
+				if(intersects(a, ballBVH.getTriangle(j).transform(placement))) {
+					bruteForcePairs.emplace_back(i, j);
+				}
+			}
+		}
+		return bruteForcePairs.size();
+	};
+}
+
+
+TEST_CASE("Triangles of a ball against nearby triangles of terrain, one at a time versus in batches", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 2.0f));
+	const BVHModel terrainBVH(&terrain), ballBVH(&ball);
+
+	// The triangles of terrain near a ball that cuts through the surface, which a narrow phase would get
+	const Point center = terrain.vertices[terrain.getNumVertices() / 2 + 100];
+	const glm::mat4 placement = glm::translate(glm::mat4(1.0f), center);
+	std::vector<Triangle> nearby, balls;
+	for(std::size_t i = 0; i < terrain.getNumTriangles(); i++) {
+		const Triangle triangle = terrainBVH.getTriangle(i);
+		if(glm::distance(triangle.p1, center) <= 3.0f) nearby.push_back(triangle);
+	}
+	for(std::size_t i = 0; i < ball.getNumTriangles(); i++) {
+		balls.push_back(ballBVH.getTriangle(i).transform(placement));
+	}
+
+	std::vector<TriangleBatch4> batches4;
+	std::vector<TriangleBatch8> batches8;
+	for(std::size_t i = 0; i < nearby.size(); i++) {
+		if(i % 4 == 0) batches4.emplace_back();
+		if(i % 8 == 0) batches8.emplace_back();
+		batches4.back().push_back(nearby[i]);
+		batches8.back().push_back(nearby[i]);
+	}
+	std::cout << balls.size() << " triangles of the ball against " << nearby.size() << " triangles of terrain\n";
+
+	BENCHMARK("triangle against triangle") {
+		std::size_t hits = 0;
+		for(const auto& triangle : balls) {
+			for(const auto& other : nearby) hits += intersects(triangle, other);
+		}
+		return hits;
+	};
+
+	BENCHMARK("triangle against batches of 4") {
+		std::size_t hits = 0;
+		for(const auto& triangle : balls) {
+			for(const auto& batch : batches4) hits += std::popcount(static_cast<unsigned>(intersects(triangle, batch)));
+		}
+		return hits;
+	};
+
+	BENCHMARK("triangle against batches of 8") {
+		std::size_t hits = 0;
+		for(const auto& triangle : balls) {
+			for(const auto& batch : batches8) hits += std::popcount(static_cast<unsigned>(intersects(triangle, batch)));
+		}
+		return hits;
+	};
+
+	BENCHMARK("linesegment against triangle") {
+		std::size_t hits = 0;
+		for(const auto& triangle : balls) {
+			const LineSegment edge(triangle.p1, triangle.p2);
+			for(const auto& other : nearby) hits += intersects(edge, other);
+		}
+		return hits;
+	};
+
+	BENCHMARK("linesegment against batches of 8") {
+		std::size_t hits = 0;
+		for(const auto& triangle : balls) {
+			const LineSegment edge(triangle.p1, triangle.p2);
+			for(const auto& batch : batches8) hits += std::popcount(static_cast<unsigned>(intersects(edge, batch)));
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("Refitting versus rebuilding a BVH of a deforming terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	BVHModel spheres(&terrain);
+	AABBBVHModel boxes(&terrain);
+
+	// A travelling wave, like a water surface
+	const std::vector<Model::vertex_type> rest = terrain.vertices;
+	float time = 0.0f;
+	const auto deform = [&]() {
+		time += 0.1f;
+		for(std::size_t i = 0; i < rest.size(); i++) {
+			terrain.vertices[i] = rest[i] + glm::vec3(0.0f, std::sin(rest[i].x * 0.5f + time), 0.0f);
+		}
+	};
+
+	deform();
+	std::cout << "Degradation after refit, BVH<Sphere>: " << spheres.refit() << ", BVH<AABB>: " << boxes.refit() << "\n";
+
+	BENCHMARK("refit BVH<Sphere>") {
+		return spheres.refit();
+	};
+
+	BENCHMARK("rebuild BVH<Sphere>") {
+		return BVH<Sphere>(terrain).size();
+	};
+
+	BENCHMARK("refit BVH<AABB>") {
+		return boxes.refit();
+	};
+
+	BENCHMARK("rebuild BVH<AABB>") {
+		return BVH<AABB>(terrain).size();
+	};
+}
+
+TEST_CASE("Casting rays against terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const BVHModel spheres(&terrain);
+	const AABBBVHModel boxes(&terrain);
+	const glm::mat4 identity(1.0f);
+
+	// Rays from above the terrain, like picking with a mouse from a tilted camera
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> coordinate(0.0f, 200.0f), component(-1.0f, 1.0f);
+	std::vector<Line> rays;
+	for(int i = 0; i < 1000; i++) {
+		rays.emplace_back(glm::vec3{coordinate(rng), 50.0f, coordinate(rng)}, glm::vec3{component(rng), -1.0f, component(rng)});
+	}
+
+	BENCHMARK("ray_cast with BVH<Sphere>, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(spheres, identity, ray, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with BVH<AABB>, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(boxes, identity, ray, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("every triangle, 10 rays") {
+		std::size_t hits = 0;
+		for(std::size_t i = 0; i < 10; i++) {
+			float best = std::numeric_limits<float>::infinity(), t, u, v;
+			bool hit = false;
+			for(std::size_t j = 0; j < terrain.getNumTriangles(); j++) {
+				if(detail::ray_triangle(rays[i].getPoint(), rays[i].getDirection(), spheres.getTriangle(j), best, t, u, v)) {
+					best = t;
+					hit = true;
+				}
+			}
+			hits += hit;
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("Casting batches of rays against terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const BVHModel spheres(&terrain);
+	const AABBBVHModel boxes(&terrain);
+	const glm::mat4 identity(1.0f);
+
+	// Height probes on a grid, row by row so that adjacent rays are coherent
+	std::vector<Line> probes;
+	for(float z = 0.5f; z < 199.0f; z += 2.0f) {
+		for(float x = 0.5f; x < 199.0f; x += 2.0f) {
+			probes.emplace_back(glm::vec3{x, 50.0f, z}, glm::vec3{0.0f, -1.0f, 0.0f});
+		}
+	}
+
+	// Line of sight from a few observers towards points on the terrain
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> coordinate(0.0f, 199.0f);
+	std::vector<Line> sight;
+	for(int observer = 0; observer < 10; observer++) {
+		const glm::vec3 eye {coordinate(rng), 25.0f, coordinate(rng)};
+		for(int i = 0; i < 1000; i++) {
+			sight.emplace_back(eye, glm::vec3{coordinate(rng), 0.0f, coordinate(rng)} - eye);
+		}
+	}
+
+	std::vector<RayHit> hits;
+	for(const auto* batch : {&probes, &sight}) {
+		const std::string name = batch == &probes ? "height probes" : "line of sight";
+
+		BENCHMARK("single rays, BVH<AABB>, " + name) {
+			std::size_t count = 0;
+			RayHit hit;
+			for(const auto& ray : *batch) {
+				count += ray_cast(boxes, identity, ray, hit);
+			}
+			return count;
+		};
+
+		BENCHMARK("packets, BVH<AABB>, " + name) {
+			return ray_cast(boxes, identity, *batch, hits);
+		};
+
+		BENCHMARK("single rays, BVH<Sphere>, " + name) {
+			std::size_t count = 0;
+			RayHit hit;
+			for(const auto& ray : *batch) {
+				count += ray_cast(spheres, identity, ray, hit);
+			}
+			return count;
+		};
+
+		BENCHMARK("packets, BVH<Sphere>, " + name) {
+			return ray_cast(spheres, identity, *batch, hits);
+		};
+	}
+}
+
+TEST_CASE("Distance queries against terrain", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const BVHModel spheres(&terrain);
+	const AABBBVHModel boxes(&terrain);
+	const glm::mat4 identity(1.0f);
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> coordinate(0.0f, 200.0f), height(0.0f, 40.0f);
+	std::vector<Point> points;
+	for(int i = 0; i < 1000; i++) {
+		points.emplace_back(coordinate(rng), height(rng), coordinate(rng));
+	}
+
+	Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 3.0f));
+	const BVHModel ballSpheres(&ball);
+	const AABBBVHModel ballBoxes(&ball);
+	const glm::mat4 ballWorld = glm::translate(identity, {100.0f, 30.0f, 100.0f});
+
+	BENCHMARK("closest_point with BVH<Sphere>, 1000 points") {
+		float sum = 0.0f;
+		for(const auto& point : points) {
+			ClosestPoint result;
+			if(closest_point(spheres, identity, point, result)) sum += result.distance;
+		}
+		return sum;
+	};
+
+	BENCHMARK("closest_point with BVH<AABB>, 1000 points") {
+		float sum = 0.0f;
+		for(const auto& point : points) {
+			ClosestPoint result;
+			if(closest_point(boxes, identity, point, result)) sum += result.distance;
+		}
+		return sum;
+	};
+
+	BENCHMARK("minimum_distance of ball and terrain with BVH<Sphere>") {
+		ClosestPoints result;
+		return minimum_distance(spheres, ballSpheres, identity, ballWorld, result) ? result.distance : 0.0f;
+	};
+
+	BENCHMARK("minimum_distance of ball and terrain with BVH<AABB>") {
+		ClosestPoints result;
+		return minimum_distance(boxes, ballBoxes, identity, ballWorld, result) ? result.distance : 0.0f;
+	};
+
+	BENCHMARK("minimum_distance of ball and terrain, exit within 20 units") {
+		ClosestPoints result;
+		return minimum_distance(boxes, ballBoxes, identity, ballWorld, result, std::numeric_limits<float>::infinity(), 20.0f) ? result.distance : 0.0f;
+	};
+}
+
+TEST_CASE("Loading a BVH of terrain from the cache versus building it", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	const Model terrain = tg.generate();
+	const BVHCache cache(std::filesystem::temp_directory_path() / "lowpoly3d_bvh_cache_benchmark");
+	cache.store(terrain, BVH<Sphere>(terrain));
+
+	BENCHMARK("content_hash") {
+		return content_hash(terrain);
+	};
+
+	BENCHMARK("load BVH<Sphere>") {
+		BVH<Sphere> bvh;
+		cache.load(terrain, bvh);
+		return bvh.size();
+	};
+
+	BENCHMARK("build BVH<Sphere>") {
+		return BVH<Sphere>(terrain).size();
+	};
+
+	std::filesystem::remove_all(cache.getDirectory());
+}
+
+TEST_CASE("Time of impact of a ball falling through terrain versus substepping", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const BVHModel spheres(&terrain);
+	const AABBBVHModel boxes(&terrain);
+	Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 3.0f));
+	const BVHModel ballSpheres(&ball);
+	const AABBBVHModel ballBoxes(&ball);
+
+	const glm::mat4 identity(1.0f);
+	const glm::mat4 start = glm::translate(identity, {100.0f, 60.0f, 100.0f});
+	const glm::mat4 end = glm::rotate(glm::translate(identity, {104.0f, -40.0f, 102.0f}), 1.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+	const Motion motion(start, end);
+
+	BENCHMARK("time_of_impact with BVH<Sphere>") {
+		Impact impact;
+		return time_of_impact(spheres, ballSpheres, identity, identity, start, end, impact) ? impact.time : 1.0f;
+	};
+
+	BENCHMARK("time_of_impact with BVH<AABB>") {
+		Impact impact;
+		return time_of_impact(boxes, ballBoxes, identity, identity, start, end, impact) ? impact.time : 1.0f;
+	};
+
+	// Substepping finds the impact no more accurately than its step, and misses it if the ball moves farther than its size
+	BENCHMARK("collides at 100 substeps with BVH<AABB>") {
+		for(int i = 0; i <= 100; i++) {
+			if(collides(boxes, ballBoxes, identity, motion.at(i / 100.0f))) return i / 100.0f;
+		}
+		return 1.0f;
+	};
+}
+
+TEST_CASE("Statistics of BVHs of terrain and the work of colliding them", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+
+	std::cout << "BVH<Sphere>, binned SAH: " << to_json(build_statistics<Sphere>(terrain));
+	std::cout << "BVH<AABB>, binned SAH: " << to_json(build_statistics<AABB>(terrain));
+	std::cout << "BVH<AABB>, split: " << to_json(build_statistics<AABB>(terrain, BVHBuildStrategy::split));
+
+	const AABBBVHModel bvh(&terrain);
+	const glm::mat4 identity(1.0f);
+	QueryStatistics stats;
+	{
+		QueryProfiler profiler(stats);
+		collides(bvh, bvh, identity, glm::translate(identity, {0.5f, 0.5f, 0.5f}));
+	}
+	std::cout << "collides" << (query_statistics_enabled ? ": " : " (build with lowpoly3d_BVH_STATISTICS to count): ") << to_json(stats);
+}
+
+TEST_CASE("Self-intersections of terrain and of overlapping balls", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const AABBBVHModel terrainBVH(&terrain);
+	const BVHModel terrainSpheres(&terrain);
+
+	// Models are indexed by 16 bits, so two balls of one more subdivision could not be joined
+	const Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+	const glm::mat4 identity(1.0f);
+	const Model balls = join({ball, ball}, {identity, glm::translate(identity, {1.0f, 0.2f, 0.1f})});
+	const AABBBVHModel ballsBVH(&balls);
+
+	std::vector<TrianglePair> pairs;
+	self_intersections(ballsBVH, pairs);
+	std::cout << terrain.getNumTriangles() << " terrain triangles, " << balls.getNumTriangles() << " ball triangles with " << pairs.size() << " self-intersections\n";
+
+	BENCHMARK("self_intersections of terrain with BVH<AABB>") {
+		return self_intersections(terrainBVH, pairs);
+	};
+
+	BENCHMARK("self_intersections of terrain with BVH<Sphere>") {
+		return self_intersections(terrainSpheres, pairs);
+	};
+
+	BENCHMARK("self_intersections of overlapping balls with BVH<AABB>") {
+		return self_intersections(ballsBVH, pairs);
+	};
+}
+
+TEST_CASE("Triangles of terrain within a frustum versus testing every triangle", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const AABBBVHModel boxes(&terrain);
+	const BVHModel spheres(&terrain);
+
+	const Point center = terrain.vertices[terrain.vertices.size() / 2];
+	const glm::mat4 view = glm::lookAt(center + glm::vec3(0.0f, 30.0f, 30.0f), center, glm::vec3(0.0f, 1.0f, 0.0f));
+	const Frustum region = frustum(glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 200.0f) * view);
+
+	std::vector<TriangleRange> ranges;
+	const std::size_t found = triangles_in(boxes, region, ranges);
+	std::cout << found << " of " << terrain.getNumTriangles() << " triangles in " << ranges.size() << " ranges\n";
+
+	BENCHMARK("triangles_in with BVH<AABB>") {
+		return triangles_in(boxes, region, ranges);
+	};
+
+	BENCHMARK("triangles_in with BVH<Sphere>") {
+		return triangles_in(spheres, region, ranges);
+	};
+
+	BENCHMARK("every triangle") {
+		std::size_t count = 0;
+		for(std::size_t i = 0; i < terrain.getNumTriangles(); i++) {
+			count += detail::overlaps(boxes.getTriangle(i), region);
+		}
+		return count;
+	};
+}
+
+TEST_CASE("Two-level BVH over 10000 instances of a ball", "[.][benchmark]") {
+	Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+	const std::size_t count = 10000;
+	const float extent = 4.0f * std::cbrt(static_cast<float>(count));
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(-extent, extent);
+
+	std::vector<glm::mat4> matrices(count);
+	AABBSceneBVH scene;
+	scene.addModel("ball", ball);
+	for(auto& matrix : matrices) {
+		matrix = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)));
+		scene.add("ball", &matrix);
+	}
+	scene.update();
+	std::cout << count << " instances, top level of depth " << scene.getDepth() << "\n";
+
+	BENCHMARK("update, i.e. refit") {
+		scene.update();
+	};
+
+	BENCHMARK("rebuild") {
+		scene.rebuild();
+	};
+
+	BENCHMARK("1000 ray casts") {
+		std::size_t hits = 0;
+		for(int i = 0; i < 1000; i++) {
+			SceneRayHit hit;
+			hits += scene.ray_cast(Line({position(rng), position(rng), 2.0f * extent}, {0.0f, 0.0f, -1.0f}), hit);
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("Quantized BVHs of terrain versus the BVH", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	const AABBBVHModel boxes(&terrain);
+	const QuantizedBVH<AABB, std::uint8_t> boxes8(&terrain, boxes);
+	const QuantizedBVH<AABB, std::uint16_t> boxes16(&terrain, boxes);
+	const glm::mat4 identity(1.0f);
+
+	std::cout << "BVH<AABB>: " << boxes.size() * sizeof(AABBBVHModel::bv_type) << " bytes, "
+		<< "16-bit: " << boxes16.memory() << " bytes, 8-bit: " << boxes8.memory() << " bytes\n";
+
+	// A ball of radius 10 at points along the diagonal of the bounds of the terrain
+	Model ball = SphereGenerator({255, 0, 255}, 3).generate(Sphere({0.0f, 0.0f, 0.0f}, 10.0f));
+	const AABBBVHModel ballBoxes(&ball);
+	const QuantizedBVH<AABB, std::uint8_t> ball8(&ball, ballBoxes);
+	const QuantizedBVH<AABB, std::uint16_t> ball16(&ball, ballBoxes);
+	std::vector<glm::mat4> placements;
+	for(float t = 0.1f; t < 1.0f; t += 0.1f) {
+		const glm::vec3 position = boxes.root().lower + t * (boxes.root().upper - boxes.root().lower);
+		placements.push_back(glm::translate(identity, position));
+	}
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> coordinate(0.0f, 200.0f), component(-1.0f, 1.0f);
+	std::vector<Line> rays;
+	for(int i = 0; i < 1000; i++) {
+		rays.emplace_back(glm::vec3{coordinate(rng), 50.0f, coordinate(rng)}, glm::vec3{component(rng), -1.0f, component(rng)});
+	}
+
+	BENCHMARK("collides on BVH<AABB>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(boxes, ballBoxes, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides on 16-bit QuantizedBVH") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(boxes16, ball16, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides on 8-bit QuantizedBVH") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(boxes8, ball8, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with BVH<AABB>, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(boxes, identity, ray, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with 16-bit QuantizedBVH, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(boxes16, identity, ray, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with 8-bit QuantizedBVH, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(boxes8, identity, ray, hit);
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("Wide BVHs of terrain versus the BVH", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 3).generate(Sphere({0.0f, 0.0f, 0.0f}, 10.0f));
+	const BVHModel spheres(&terrain), ballSpheres(&ball);
+	const AABBBVHModel boxes(&terrain), ballBoxes(&ball);
+	const WideBVH<Sphere> wideSpheres(&terrain, spheres), wideBallSpheres(&ball, ballSpheres);
+	const WideBVH<AABB> wideBoxes(&terrain, boxes), wideBallBoxes(&ball, ballBoxes);
+	const glm::mat4 identity(1.0f);
+
+	std::cout << "BVH depth: " << spheres.getDepth() << ", wide BVH depth: " << wideSpheres.getDepth() << "\n";
+
+	// A ball of radius 10 at points along the diagonal of the bounds of the terrain
+	std::vector<glm::mat4> placements;
+	for(float t = 0.1f; t < 1.0f; t += 0.1f) {
+		placements.push_back(glm::translate(identity, boxes.root().lower + t * (boxes.root().upper - boxes.root().lower)));
+	}
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> coordinate(0.0f, 200.0f), component(-1.0f, 1.0f);
+	std::vector<Line> rays;
+	for(int i = 0; i < 1000; i++) {
+		rays.emplace_back(glm::vec3{coordinate(rng), 50.0f, coordinate(rng)}, glm::vec3{component(rng), -1.0f, component(rng)});
+	}
+
+	BENCHMARK("collides on BVH<Sphere>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(spheres, ballSpheres, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides on WideBVH<Sphere>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(wideSpheres, wideBallSpheres, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides on BVH<AABB>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(boxes, ballBoxes, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides on WideBVH<AABB>") {
+		std::size_t hits = 0;
+		for(const auto& placement : placements) {
+			hits += collides(wideBoxes, wideBallBoxes, identity, placement);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with BVH<Sphere>, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(spheres, identity, ray, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with WideBVH<Sphere>, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(wideSpheres, identity, ray, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with BVH<AABB>, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(boxes, identity, ray, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("ray_cast with WideBVH<AABB>, 1000 rays") {
+		std::size_t hits = 0;
+		RayHit hit;
+		for(const auto& ray : rays) {
+			hits += ray_cast(wideBoxes, identity, ray, hit);
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("BVTT fronts of a ball moving over terrain versus colliding from the roots", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 3).generate(Sphere({0.0f, 0.0f, 0.0f}, 10.0f));
+	const AABBBVHModel boxes(&terrain), ballBoxes(&ball);
+	const glm::mat4 identity(1.0f);
+	const Point center = terrain.vertices[terrain.vertices.size() / 2];
+
+	// 100 frames of a ball sliding slowly along x, sunk halfway into the terrain or hovering just above it
+	const auto frames = [&](float height) {
+		std::vector<glm::mat4> path;
+		for(int i = 0; i < 100; i++) {
+			path.push_back(glm::translate(identity, center + glm::vec3(0.05f * i, height, 0.0f)));
+		}
+		return path;
+	};
+	const auto touches = [&](const std::vector<glm::mat4>& path) {
+		return std::any_of(path.begin(), path.end(), [&](const glm::mat4& frame) { return collides(boxes, ballBoxes, identity, frame); });
+	};
+	const std::vector<glm::mat4> sunk = frames(0.0f);
+	float height = 10.0f;
+	while(touches(frames(height))) height += 0.25f;
+	const std::vector<glm::mat4> hovering = frames(height);
+
+	AABBBVTTFront front(boxes, ballBoxes);
+	for(const auto& path : {sunk, hovering}) {
+		std::size_t expected = 0, hits = 0;
+		for(const auto& frame : path) {
+			expected += collides(boxes, ballBoxes, identity, frame);
+			hits += front.collides(identity, frame);
+		}
+		std::cout << "collisions: " << expected << ", with the front: " << hits << ", final front size: " << front.size() << "\n";
+	}
+
+	BENCHMARK("collides, sunk ball") {
+		std::size_t hits = 0;
+		for(const auto& frame : sunk) {
+			hits += collides(boxes, ballBoxes, identity, frame);
+		}
+		return hits;
+	};
+
+	BENCHMARK("BVTT front, sunk ball") {
+		std::size_t hits = 0;
+		for(const auto& frame : sunk) {
+			hits += front.collides(identity, frame);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides, hovering ball") {
+		std::size_t hits = 0;
+		for(const auto& frame : hovering) {
+			hits += collides(boxes, ballBoxes, identity, frame);
+		}
+		return hits;
+	};
+
+	BENCHMARK("BVTT front, hovering ball") {
+		std::size_t hits = 0;
+		for(const auto& frame : hovering) {
+			hits += front.collides(identity, frame);
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("Sweeping a sphere over terrain versus substepping a ball model", "[.][benchmark]") {
+	TerrainGenerator tg(200);
+	Model terrain = tg.generate();
+	Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+	const AABBBVHModel boxes(&terrain), ballBoxes(&ball);
+	const glm::mat4 identity(1.0f);
+	constexpr int substeps = 32;
+
+	// 100 moves of a character of radius 1 from above the terrain, down into it
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> coordinate(20.0f, 180.0f), component(-5.0f, 5.0f);
+	std::vector<LineSegment> moves;
+	for(int i = 0; i < 100; i++) {
+		const glm::vec3 start {coordinate(rng), boxes.root().upper.y + 2.0f, coordinate(rng)};
+		moves.emplace_back(start, start + glm::vec3{component(rng), boxes.root().lower.y - boxes.root().upper.y - 4.0f, component(rng)});
+	}
+
+	BENCHMARK("sphere_cast, one per move") {
+		std::size_t hits = 0;
+		SphereHit hit;
+		for(const auto& move : moves) {
+			hits += sphere_cast(boxes, identity, Sphere(move.start, 1.0f), move, hit);
+		}
+		return hits;
+	};
+
+	BENCHMARK("collides, 32 substeps per move") {
+		std::size_t hits = 0;
+		for(const auto& move : moves) {
+			for(int step = 1; step <= substeps; step++) {
+				const glm::vec3 position = move.start + (float(step) / substeps) * (move.end - move.start);
+				if(collides(boxes, ballBoxes, identity, glm::translate(identity, position))) {
+					hits++;
+					break;
+				}
+			}
+		}
+		return hits;
+	};
+}
+
+TEST_CASE("Collision world of moving balls", "[.][benchmark]") {
+	Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+	const BVHModel ballBVH(&ball);
+
+	// Keep the density of balls constant as their number grows
+	for(const std::size_t count : {50, 500, 5000}) {
+		const float extent = 4.0f * std::cbrt(static_cast<float>(count));
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> position(-extent, extent), step(-0.1f, 0.1f);
+
+		std::vector<glm::mat4> matrices(count);
+		std::vector<CollisionData> objects;
+		CollisionWorld world;
+		for(auto& matrix : matrices) {
+			matrix = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)));
+			objects.emplace_back(&ballBVH, &matrix);
+			world.add(objects.back());
+		}
+
+		std::vector<CollisionWorld::pair_type> colliding;
+		world.step(colliding);
+		std::cout << count << " balls: " << world.getCandidatePairs().size() << " candidate pairs, " << colliding.size() << " colliding\n";
+
+		BENCHMARK("step, " + std::to_string(count) + " balls") {
+			for(auto& matrix : matrices) {
+				matrix = glm::translate(matrix, glm::vec3(step(rng), step(rng), step(rng)));
+			}
+			return world.step(colliding);
+		};
+
+		if(count > 500) continue;
+		BENCHMARK("all pairs, " + std::to_string(count) + " balls") {
+			std::size_t hits = 0;
+			for(std::size_t i = 0; i < count; i++) {
+				for(std::size_t j = i + 1; j < count; j++) {
+					hits += collides(objects[i], objects[j]);
+				}
+			}
+			return hits;
+		};
+	}
+}
+
+TEST_CASE("Spheres one at a time versus in arrays of spheres", "[.][benchmark]") {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f), radius(0.5f, 2.0f);
+	std::vector<Sphere> spheres;
+	SphereSoA soa;
+	for(int i = 0; i < 10000; i++) {
+		spheres.emplace_back(glm::vec3(position(rng), position(rng), position(rng)), radius(rng));
+		soa.push_back(spheres.back());
+	}
+	const Sphere query({0.0f, 0.0f, 0.0f}, 20.0f);
+	const glm::mat4 identity(1.0f), m = glm::rotate(glm::translate(identity, glm::vec3(1.0f, 2.0f, 3.0f)), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+	const Plane plane(glm::vec3(0.0f), glm::vec3(1.0f, 1.0f, 0.0f));
+	std::vector<std::size_t> indices;
+	std::vector<std::int8_t> sides;
+	SphereSoA transformed;
+
+	BENCHMARK("colliding, one at a time") {
+		indices.clear();
+		for(std::size_t i = 0; i < spheres.size(); i++) {
+			if(colliding(spheres[i], query, identity, identity)) indices.push_back(i);
+		}
+		return indices.size();
+	};
+
+	BENCHMARK("colliding, array") {
+		return colliding(soa, query, indices);
+	};
+
+	BENCHMARK("transform, one at a time") {
+		float sum = 0.0f;
+		for(const Sphere& sphere : spheres) sum += transform(sphere, m).r;
+		return sum;
+	};
+
+	BENCHMARK("transform, array") {
+		transform(soa, m, transformed);
+		return transformed.size();
+	};
+
+	BENCHMARK("classify against a plane, one at a time") {
+		sides.resize(spheres.size());
+		for(std::size_t i = 0; i < spheres.size(); i++) {
+			const float distance = glm::dot(spheres[i].p - plane.getPoint(), plane.getNormal());
+			sides[i] = static_cast<std::int8_t>((distance > spheres[i].r) - (distance < -spheres[i].r));
+		}
+		return sides.size();
+	};
+
+	BENCHMARK("classify against a plane, array") {
+		classify(soa, plane, sides);
+		return sides.size();
+	};
+}
+
+} // End of namespace lowpoly3d
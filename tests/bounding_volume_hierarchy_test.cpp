@@ -1,6 +1,7 @@
 #include "bounding_volume_hierarchy.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <functional>
+#include <random>
 #include <catch2/catch_all.hpp>
 
 #include "generators/terraingenerator.hpp"
@@ -84,6 +85,137 @@ SCENARIO("BVH building") {
 	}
 }
 
+SCENARIO("BVH building with binned SAH") {
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrainModel = tg.generate();
+
+		WHEN("Building the topology with binned SAH") {
+			const BVHTopology topology = build_binned_sah(terrainModel);
+
+			THEN("There are 2n-1 nodes for n triangles") {
+				REQUIRE(topology.nodes.size() == 2 * terrainModel.getNumTriangles() - 1);
+			}
+
+			THEN("The triangle order is a permutation of all triangle indices") {
+				std::vector<std::size_t> sorted = topology.order;
+				std::sort(sorted.begin(), sorted.end());
+				std::vector<std::size_t> expected(terrainModel.getNumTriangles());
+				std::iota(expected.begin(), expected.end(), 0);
+				REQUIRE(sorted == expected);
+			}
+
+			THEN("The leaves, visited in post-order, follow the triangle order") {
+				std::vector<std::size_t> leaves;
+				for(const auto& node : topology.nodes) {
+					if(node.is_leaf) leaves.push_back(node.left_idx);
+				}
+				REQUIRE(leaves == topology.order);
+			}
+
+			THEN("Every child is stored before its parent") {
+				for(std::size_t i = 0; i < topology.nodes.size(); i++) {
+					const auto& node = topology.nodes[i];
+					if(node.is_leaf) continue;
+					REQUIRE(node.left_idx < i);
+					REQUIRE(node.right_idx < i);
+				}
+			}
+		}
+
+		WHEN("Building a BVH with each build strategy") {
+			BVH<Sphere> splitBVH(terrainModel, BVHBuildStrategy::split);
+			BVH<Sphere> sahBVH(terrainModel, BVHBuildStrategy::binned_sah);
+
+			THEN("Both BVHs have one leaf per triangle") {
+				REQUIRE(splitBVH.size() == sahBVH.size());
+			}
+
+			THEN("Each parent BV encloses its child BV") {
+				auto enclosesChildren = [](const BVH<Sphere>& bvh, const std::size_t& idx) {
+					auto const& current = bvh[idx];
+					REQUIRE(current.encloses(bvh.left(current)));
+					REQUIRE(current.encloses(bvh.right(current)));
+				};
+				sahBVH.depthfirstExceptLeaves(enclosesChildren, sahBVH.root_idx());
+			}
+
+			THEN("The SAH BVH has no higher surface area heuristic cost than the split BVH") {
+				// The SAH minimizes the cost of boxes, which is what it is compared by
+				const BVH<AABB> splitBoxes(terrainModel, BVHBuildStrategy::split);
+				const BVH<AABB> sahBoxes(terrainModel, BVHBuildStrategy::binned_sah);
+				REQUIRE(sahBoxes.cost() <= splitBoxes.cost());
+			}
+		}
+	}
+}
+
+SCENARIO("BVH building with BVs fitted to vertices") {
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrainModel = tg.generate();
+		const BVHModel merged(&terrainModel);
+		BVHModel fitted(&terrainModel, BVHBuildStrategy::binned_sah, BVHFitting::vertices);
+
+		// Leaves are fitted to their triangle alone, so only internal nodes are checked
+		const auto enclosesTriangles = [&](const BVHModel& bvh) {
+			bool ok = true;
+			bvh.depthfirstExceptLeaves([&](const BVH<Sphere>& tree, const std::size_t& idx) {
+				std::vector<std::size_t> stack {idx};
+				while(!stack.empty()) {
+					const auto& node = tree[stack.back()];
+					stack.pop_back();
+					if(node.is_leaf) {
+						const auto triangle = bvh.getTriangle(node.left_idx);
+						for(const Point& vertex : {triangle.p1, triangle.p2, triangle.p3}) {
+							ok = ok && glm::distance(tree[idx].p, vertex) <= tree[idx].r;
+						}
+					} else {
+						stack.insert(stack.end(), {node.left_idx, node.right_idx});
+					}
+				}
+			}, bvh.root_idx());
+			return ok;
+		};
+
+		THEN("it has the topology of the merged BVH") {
+			REQUIRE(fitted.size() == merged.size());
+			REQUIRE(fitted.getDepth() == merged.getDepth());
+		}
+
+		THEN("every BV encloses the triangles of its subtree") {
+			REQUIRE(enclosesTriangles(fitted));
+		}
+
+		THEN("every BV is at most as large as the merged BV, and the root is much tighter") {
+			bool tighter = true;
+			float fittedArea = 0.0f, mergedArea = 0.0f;
+			for(std::size_t i = 0; i < fitted.size(); i++) {
+				tighter = tighter && fitted[i].r <= merged[i].r * (1.0f + 1e-4f);
+				fittedArea += fitted[i].r * fitted[i].r;
+				mergedArea += merged[i].r * merged[i].r;
+			}
+			REQUIRE(tighter);
+			REQUIRE(fitted.root().r < 0.8f * merged.root().r);
+			REQUIRE(fittedArea < mergedArea);
+		}
+
+		WHEN("the terrain is deformed and the BVH is refitted") {
+			std::mt19937 rng(1234);
+			std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+			for(auto& vertex : terrainModel.vertices) {
+				vertex.y += offset(rng);
+			}
+			fitted.refit();
+
+			THEN("its BVs are fitted to the vertices again") {
+				REQUIRE(enclosesTriangles(fitted));
+				REQUIRE(fitted.root().r < BVHModel(&terrainModel).root().r);
+			}
+		}
+	}
+}
+
 SCENARIO("BVH inclusiveness") {
 
 	GIVEN("A sphere") {
@@ -270,6 +402,421 @@ SCENARIO("BVH collision") {
 	}
 }
 
+SCENARIO("BVH collision with rotated and scaled models") {
+
+	GIVEN("A BVH over a single triangle") {
+		Model model = getSingleTriangleModel();
+		BVHModel bvh(&model);
+		AABBBVHModel boxes(&model);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		WHEN("the other triangle is scaled up so that it reaches the first triangle") {
+			// Stand the other triangle up so that it pierces the plane of the first triangle once it is large enough
+			const glm::mat4 world = glm::scale(
+				glm::rotate(glm::translate(identity, glm::vec3(0.2f, 0.2f, -1.5f)), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
+				glm::vec3(4.0f));
+
+			THEN("intersection is detected") {
+				REQUIRE(collides(bvh, bvh, identity, world));
+				REQUIRE(collides(boxes, boxes, identity, world));
+			}
+		}
+
+		WHEN("the other triangle is too small to reach the first triangle") {
+			const glm::mat4 world = glm::scale(
+				glm::rotate(glm::translate(identity, glm::vec3(0.2f, 0.2f, -1.5f)), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
+				glm::vec3(0.25f));
+
+			THEN("intersection is not detected") {
+				REQUIRE_FALSE(collides(bvh, bvh, identity, world));
+				REQUIRE_FALSE(collides(boxes, boxes, identity, world));
+			}
+		}
+
+		WHEN("both triangles are moved by the same rotation and translation") {
+			const glm::mat4 world = glm::rotate(
+				glm::translate(identity, glm::vec3(10.0f, 0.0f, 0.0f)),
+				glm::radians(60.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			const glm::mat4 offset = glm::translate(world, glm::vec3(0.0f, 0.0f, 0.5f));
+
+			THEN("collision only depends on their relative placement") {
+				REQUIRE(collides(bvh, bvh, world, world));
+				REQUIRE_FALSE(collides(bvh, bvh, world, offset));
+				REQUIRE(collides(boxes, boxes, world, world));
+				REQUIRE_FALSE(collides(boxes, boxes, world, offset));
+			}
+		}
+	}
+}
+
+SCENARIO("Finding all pairs of intersecting triangles") {
+
+	GIVEN("A BVH over two disjoint triangles") {
+		Model model = getTwoTriangleModel();
+		BVHModel bvh(&model);
+		AABBBVHModel boxes(&model);
+		const glm::mat4 identity = glm::mat4(1.0f);
+		std::vector<TrianglePair> pairs;
+
+		WHEN("finding contacts of the BVH with itself") {
+			const std::size_t count = contacts(bvh, bvh, identity, identity, pairs);
+			std::sort(pairs.begin(), pairs.end());
+
+			THEN("each triangle intersects only itself") {
+				REQUIRE(count == 2);
+				REQUIRE(pairs == std::vector<TrianglePair>{{0, 0}, {1, 1}});
+			}
+
+			THEN("a BVH of boxes finds the same pairs") {
+				std::vector<TrianglePair> boxPairs;
+				contacts(boxes, boxes, identity, identity, boxPairs);
+				std::sort(boxPairs.begin(), boxPairs.end());
+				REQUIRE(boxPairs == pairs);
+			}
+		}
+
+		WHEN("finding contacts with the other triangle moved onto the first triangle") {
+			const glm::mat4 translation = glm::translate(identity, glm::vec3(-2.0f, 0.0f, 0.0f));
+			contacts(bvh, bvh, identity, translation, pairs);
+
+			THEN("the first triangle intersects the second triangle") {
+				REQUIRE(std::find(pairs.begin(), pairs.end(), TrianglePair{0, 1}) != pairs.end());
+				REQUIRE(std::find(pairs.begin(), pairs.end(), TrianglePair{1, 0}) == pairs.end());
+			}
+		}
+
+		WHEN("finding at most one contact") {
+			const std::size_t count = contacts(bvh, bvh, identity, identity, pairs, 1);
+
+			THEN("the traversal stops after the first pair") {
+				REQUIRE(count == 1);
+				REQUIRE(pairs.size() == 1);
+				REQUIRE(pairs.front().first == pairs.front().second);
+			}
+		}
+
+		WHEN("reusing the buffer for a query without contacts") {
+			contacts(bvh, bvh, identity, identity, pairs);
+			const std::size_t capacity = pairs.capacity();
+			const glm::mat4 translation = glm::translate(identity, glm::vec3(0.0f, 0.0f, 5.0f));
+			const std::size_t count = contacts(bvh, bvh, identity, translation, pairs);
+
+			THEN("the buffer is emptied but keeps its capacity") {
+				REQUIRE(count == 0);
+				REQUIRE(pairs.empty());
+				REQUIRE(pairs.capacity() == capacity);
+			}
+		}
+	}
+}
+
+SCENARIO("Contact manifolds of intersecting BVHModels") {
+	GIVEN("A single triangle model and a copy of it stood up through it") {
+		Model model = getSingleTriangleModel();
+		const BVHModel spheres(&model);
+		const AABBBVHModel boxes(&model);
+		const glm::mat4 identity(1.0f);
+		const glm::mat4 standing = glm::rotate(glm::translate(identity, {0.25f, 0.25f, -0.25f}), glm::half_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f));
+		std::vector<Contact> contacts;
+
+		WHEN("finding their contact manifold") {
+			const std::size_t count = contact_manifold(spheres, spheres, identity, standing, contacts);
+
+			THEN("the triangles intersect along a segment and the standing one is pushed up out of the other") {
+				REQUIRE(count == 1);
+				const Contact& contact = contacts.front();
+				REQUIRE(contact.a_triangle_idx == 0);
+				REQUIRE(contact.b_triangle_idx == 0);
+				const Point lo = contact.start.x < contact.end.x ? contact.start : contact.end;
+				const Point hi = contact.start.x < contact.end.x ? contact.end : contact.start;
+				REQUIRE(almostEqual(lo, Point{0.25f, 0.25f, 0.0f}, 1e-5f));
+				REQUIRE(almostEqual(hi, Point{0.75f, 0.25f, 0.0f}, 1e-5f));
+				REQUIRE(almostEqual(contact.normal, glm::vec3{0.0f, 0.0f, 1.0f}, 1e-5f));
+				REQUIRE(contact.penetration == Catch::Approx(0.25f));
+			}
+
+			THEN("a BVH of boxes finds the same contact") {
+				std::vector<Contact> boxContacts;
+				REQUIRE(contact_manifold(boxes, boxes, identity, standing, boxContacts) == 1);
+				REQUIRE(boxContacts.front().penetration == Catch::Approx(contacts.front().penetration));
+			}
+		}
+
+		WHEN("both are scaled up in world-space") {
+			const glm::mat4 scale = glm::scale(identity, glm::vec3(2.0f));
+			contact_manifold(spheres, spheres, scale, scale * standing, contacts);
+
+			THEN("the contact is in world-space") {
+				REQUIRE(contacts.size() == 1);
+				REQUIRE(glm::distance(contacts.front().start, contacts.front().end) == Catch::Approx(1.0f));
+				REQUIRE(contacts.front().penetration == Catch::Approx(0.5f));
+			}
+		}
+
+		WHEN("the copy lies flat on the triangle") {
+			THEN("coplanar triangles have no contact") {
+				REQUIRE(contact_manifold(spheres, spheres, identity, identity, contacts) == 0);
+			}
+		}
+	}
+
+	GIVEN("A ball sunk into a procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const AABBBVHModel terrainBoxes(&terrain);
+		Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 5.0f));
+		const AABBBVHModel ballBoxes(&ball);
+		const glm::mat4 identity(1.0f);
+		const glm::mat4 placement = glm::translate(identity, glm::vec3(terrain.vertices[terrain.vertices.size() / 2]));
+		std::vector<Contact> contacts;
+		contact_manifold(terrainBoxes, ballBoxes, identity, placement, contacts);
+
+		THEN("every contact segment lies on both of its triangles") {
+			REQUIRE(!contacts.empty());
+			bool onBoth = true;
+			for(const Contact& contact : contacts) {
+				const Triangle a = terrainBoxes.getTriangle(contact.a_triangle_idx);
+				const Triangle b = ballBoxes.getTriangle(contact.b_triangle_idx).transform(placement);
+				for(const Point& point : {contact.start, contact.end}) {
+					onBoth = onBoth &&
+						glm::distance(closest_point(a, point), point) <= 1e-3f &&
+						glm::distance(closest_point(b, point), point) <= 1e-3f;
+				}
+				onBoth = onBoth && contact.penetration >= 0.0f;
+			}
+			REQUIRE(onBoth);
+		}
+	}
+}
+
+SCENARIO("Finding self-intersections of a BVHModel") {
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const AABBBVHModel bvh(&terrain);
+		std::vector<TrianglePair> pairs;
+
+		THEN("no triangles intersect, even though neighbouring triangles touch") {
+			REQUIRE(self_intersections(bvh, pairs) == 0);
+			REQUIRE(pairs.empty());
+		}
+	}
+
+	GIVEN("Two balls that overlap, joined into one model") {
+		const Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+		const glm::mat4 identity(1.0f);
+		const Model balls = join({ball, ball}, {identity, glm::translate(identity, {1.0f, 0.2f, 0.1f})});
+		const BVHModel spheres(&balls);
+		const AABBBVHModel boxes(&balls);
+		std::vector<TrianglePair> pairs;
+
+		WHEN("finding self-intersections") {
+			const std::size_t count = self_intersections(spheres, pairs);
+			std::sort(pairs.begin(), pairs.end());
+
+			THEN("they are the pairs found by testing every pair of non-adjacent triangles") {
+				std::vector<TrianglePair> expected;
+				const std::size_t n = balls.getNumTriangles();
+				for(std::size_t i = 0; i < n; i++) {
+					for(std::size_t j = i + 1; j < n; j++) {
+						const Triangle a = spheres.getTriangle(i), b = spheres.getTriangle(j);
+						if(!detail::share_vertex(a, b) && intersects(a, b)) {
+							expected.emplace_back(i, j);
+						}
+					}
+				}
+				REQUIRE(count > 0);
+				REQUIRE(pairs == expected);
+			}
+
+			THEN("every pair has one triangle of each ball") {
+				const std::size_t half = ball.getNumTriangles();
+				for(const TrianglePair& pair : pairs) {
+					REQUIRE(pair.first < half);
+					REQUIRE(pair.second >= half);
+				}
+			}
+
+			THEN("a BVH of boxes finds the same pairs") {
+				std::vector<TrianglePair> boxPairs;
+				self_intersections(boxes, boxPairs);
+				std::sort(boxPairs.begin(), boxPairs.end());
+				REQUIRE(boxPairs == pairs);
+			}
+		}
+
+		WHEN("finding at most one self-intersection") {
+			THEN("the traversal stops after the first pair") {
+				REQUIRE(self_intersections(spheres, pairs, 1) == 1);
+				REQUIRE(pairs.size() == 1);
+			}
+		}
+	}
+
+	GIVEN("Two coplanar triangles that overlap but share no vertex, like a duplicated face") {
+		const Model triangle = getSingleTriangleModel();
+		const glm::mat4 identity(1.0f);
+		const Model faces = join({triangle, triangle}, {identity, glm::translate(identity, {0.25f, 0.25f, 0.0f})});
+		const BVHModel spheres(&faces);
+		const AABBBVHModel boxes(&faces);
+		std::vector<TrianglePair> pairs;
+
+		THEN("they are reported, although they do not intersect along a segment") {
+			REQUIRE(self_intersections(spheres, pairs) == 1);
+			REQUIRE(pairs.front() == TrianglePair(0, 1));
+			REQUIRE(self_intersections(boxes, pairs) == 1);
+		}
+	}
+}
+
+SCENARIO("Refitting a BVH to a deformed model") {
+	GIVEN("BVHs over a procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		BVHModel spheres(&terrain);
+		AABBBVHModel boxes(&terrain);
+
+		const auto fits = [&]() {
+			const bool spheresFit = spheres.all_of([&spheres](const BVH<Sphere>::bv_type& bv) {
+				return !bv.is_leaf || bv.contains(spheres.getTriangle(bv.left_idx));
+			});
+			const bool boxesFit = boxes.all_of([&boxes](const BVH<AABB>::bv_type& bv) {
+				return bv.is_leaf ?
+					bv.contains(boxes.getTriangle(bv.left_idx)) :
+					bv.encloses(boxes.left(bv)) && bv.encloses(boxes.right(bv));
+			});
+			return spheresFit && boxesFit;
+		};
+
+		THEN("they are not degraded") {
+			REQUIRE(spheres.degradation() == Catch::Approx(1.0f));
+			REQUIRE(boxes.degradation() == Catch::Approx(1.0f));
+		}
+
+		WHEN("the terrain is moved and scaled, and the BVHs are refitted") {
+			terrain.translate({10.0f, -5.0f, 3.0f});
+			terrain.scale(2.0f);
+			const float sphereDegradation = spheres.refit();
+			const float boxDegradation = boxes.refit();
+
+			THEN("every BV fits the moved triangles") {
+				REQUIRE(fits());
+			}
+
+			THEN("they are not degraded") {
+				REQUIRE(sphereDegradation == Catch::Approx(1.0f).epsilon(0.01f));
+				REQUIRE(boxDegradation == Catch::Approx(1.0f).epsilon(0.01f));
+			}
+		}
+
+		WHEN("the vertices of the terrain are shuffled, and the BVHs are refitted") {
+			std::shuffle(terrain.vertices.begin(), terrain.vertices.end(), std::mt19937(1234));
+			const float sphereDegradation = spheres.refit();
+			const float boxDegradation = boxes.refit();
+
+			THEN("every BV fits the shuffled triangles") {
+				REQUIRE(fits());
+			}
+
+			THEN("they are degraded") {
+				REQUIRE(sphereDegradation > 2.0f);
+				REQUIRE(boxDegradation > 2.0f);
+			}
+
+			THEN("rebuilding gives a cheaper BVH") {
+				REQUIRE(BVH<AABB>(terrain).cost() < boxes.cost());
+			}
+		}
+	}
+}
+
+SCENARIO("BVH over axis-aligned bounding boxes") {
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+
+		WHEN("a BVH of boxes is built over the terrain") {
+			BVH<AABB> bvh(terrain);
+
+			THEN("it has the same shape as a BVH of spheres") {
+				REQUIRE(bvh.size() == BVH<Sphere>(terrain).size());
+			}
+
+			THEN("all parents enclose their children") {
+				REQUIRE(bvh.all_of([&bvh](const BVH<AABB>::bv_type& bv) {
+					return bv.is_leaf || (bv.encloses(bvh.left(bv)) && bv.encloses(bvh.right(bv)));
+				}));
+			}
+
+			THEN("every leaf contains its triangle") {
+				AABBBVHModel bvhmodel(&terrain);
+				REQUIRE(bvhmodel.all_of([&bvhmodel](const BVH<AABB>::bv_type& bv) {
+					return !bv.is_leaf || bv.contains(bvhmodel.getTriangle(bv.left_idx));
+				}));
+			}
+		}
+	}
+
+	GIVEN("A BVH of boxes over a single triangle") {
+		Model model = getSingleTriangleModel();
+		AABBBVHModel bvh(&model);
+
+		WHEN("testing self-intersection with identity transformation") {
+			const glm::mat4 identity = glm::mat4(1.0f);
+			const bool intersecting = collides(bvh, bvh, identity, identity);
+			THEN("intersection is detected") {
+				REQUIRE(intersecting);
+			}
+		}
+
+		WHEN("testing intersection between non-intersecting translated bvh and bvh at identity") {
+			const glm::mat4 identity = glm::mat4(1.0f);
+			const glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 0.0f));
+			const bool intersecting = collides(bvh, bvh, identity, translation);
+
+			THEN("intersection is not detected") {
+				REQUIRE_FALSE(intersecting);
+			}
+		}
+	}
+
+	GIVEN("A BVH of boxes over a single sphere") {
+		Sphere sphere = {glm::vec3(0.0f, 0.0f, 0.0f), 1.0f};
+		SphereGenerator generator;
+		Model sphereModel = generator.generate(sphere);
+		AABBBVHModel bvh(&sphereModel);
+
+		WHEN("testing intersection between non-intersecting translated bvh and bvh at identity") {
+			const glm::mat4 identity = glm::mat4(1.0f);
+			const glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 0.0f));
+
+			THEN("intersection is not detected") {
+				REQUIRE_FALSE(collides(bvh, bvh, identity, translation));
+			}
+		}
+
+		WHEN("testing intersection between intersecting translated bvh and bvh at identity") {
+			const glm::mat4 identity = glm::mat4(1.0f);
+			const glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+			THEN("intersection is detected, just like with a BVH of spheres") {
+				BVHModel spherebvh(&sphereModel);
+				REQUIRE(collides(bvh, bvh, identity, translation));
+				REQUIRE(collides(spherebvh, spherebvh, identity, translation));
+			}
+		}
+
+		WHEN("triangulating the BVH") {
+			const Model triangulated = bvh.triangulate();
+
+			THEN("there is one cube per box") {
+				REQUIRE(triangulated.getNumTriangles() == 12 * bvh.size());
+			}
+		}
+	}
+}
+
 SCENARIO("Plotting to dotfile") {
 
 	GIVEN("A BVH over a single triangle") {
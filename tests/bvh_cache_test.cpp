@@ -0,0 +1,137 @@
+#include "bvh_cache.hpp"
+#include <catch2/catch_all.hpp>
+
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// Returns true if a and b have the same nodes
+template<typename TValue>
+bool same_nodes(const BVH<TValue>& a, const BVH<TValue>& b) {
+	if(a.size() != b.size() || a.getDepth() != b.getDepth()) return false;
+	for(std::size_t i = 0; i < a.size(); i++) {
+		const TValue& bva = a[i];
+		const TValue& bvb = b[i];
+		if(!(bva == bvb) || a[i].left_idx != b[i].left_idx || a[i].right_idx != b[i].right_idx || a[i].is_leaf != b[i].is_leaf) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Caching BVHs on disk") {
+	GIVEN("A procedurally generated terrain and an empty cache") {
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "lowpoly3d_bvh_cache_test";
+		std::filesystem::remove_all(directory);
+		const BVHCache cache(directory);
+
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVH<Sphere> built(terrain);
+		BVH<Sphere> loaded;
+
+		THEN("there is no BVH to load") {
+			REQUIRE(!cache.load(terrain, loaded));
+		}
+
+		WHEN("the BVH is stored") {
+			REQUIRE(cache.store(terrain, built));
+
+			THEN("loading it views the same nodes in the mapped file") {
+				REQUIRE(cache.load(terrain, loaded));
+				REQUIRE(loaded.is_view());
+				REQUIRE(same_nodes(loaded, built));
+				REQUIRE(loaded.getBuiltCost() == built.getBuiltCost());
+			}
+
+			THEN("reading it through a non-const BVH keeps viewing the file") {
+				REQUIRE(cache.load(terrain, loaded));
+				REQUIRE(loaded[loaded.root_idx()].left_idx == loaded.root().left_idx);
+				REQUIRE(!loaded.left(loaded.root()).is_leaf);
+				REQUIRE(loaded.is_view());
+			}
+
+			THEN("the same terrain generated again loads it") {
+				Model again = TerrainGenerator(80).generate();
+				REQUIRE(cache.load(again, loaded));
+			}
+
+			THEN("a moved terrain does not load it") {
+				terrain.translate({0.0f, 1.0f, 0.0f});
+				REQUIRE(!cache.load(terrain, loaded));
+			}
+
+			THEN("a BVH of boxes or one built by another strategy does not load it") {
+				BVH<AABB> boxes;
+				REQUIRE(!cache.load(terrain, boxes));
+				REQUIRE(!cache.load(terrain, loaded, BVHBuildStrategy::split));
+			}
+
+			THEN("a BVH fitted to vertices does not load it, but is cached and loaded with its fitting") {
+				REQUIRE(!cache.load(terrain, loaded, BVHBuildStrategy::binned_sah, BVHFitting::vertices));
+				const BVH<Sphere> fitted(terrain, BVHBuildStrategy::binned_sah, BVHFitting::vertices);
+				REQUIRE(cache.store(terrain, fitted));
+				REQUIRE(cache.load(terrain, loaded, BVHBuildStrategy::binned_sah, BVHFitting::vertices));
+				REQUIRE(loaded.getFitting() == BVHFitting::vertices);
+				REQUIRE(same_nodes(loaded, fitted));
+
+				// Refitting the loaded BVH to the same vertices fits it as it was built
+				loaded.refit(terrain);
+				REQUIRE(same_nodes(loaded, fitted));
+			}
+
+			THEN("a truncated file does not load") {
+				const auto path = cache.path(BVHCache::key<Sphere>(terrain));
+				std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+				REQUIRE(!cache.load(terrain, loaded));
+			}
+
+			THEN("a file whose nodes refer to missing triangles does not load") {
+				Model fewer = terrain;
+				fewer.triangleIndices.pop_back();
+				std::filesystem::copy_file(
+					cache.path(BVHCache::key<Sphere>(terrain)),
+					cache.path(BVHCache::key<Sphere>(fewer)));
+				REQUIRE(!cache.load(fewer, loaded));
+			}
+
+			THEN("refitting a loaded BVH copies its nodes and leaves the file as it was") {
+				REQUIRE(cache.load(terrain, loaded));
+				Model moved = terrain;
+				moved.translate({0.0f, 1.0f, 0.0f});
+				loaded.refit(moved);
+				REQUIRE(!loaded.is_view());
+				REQUIRE(!same_nodes(loaded, built));
+
+				BVH<Sphere> reloaded;
+				REQUIRE(cache.load(terrain, reloaded));
+				REQUIRE(same_nodes(reloaded, built));
+			}
+		}
+
+		WHEN("BVHs are requested from the cache") {
+			const BVH<AABB> first = cache.get<AABB>(terrain);
+			const BVH<AABB> second = cache.get<AABB>(terrain);
+
+			THEN("the first is built and the second is loaded") {
+				REQUIRE(!first.is_view());
+				REQUIRE(second.is_view());
+				REQUIRE(same_nodes(first, second));
+			}
+
+			THEN("a BVHModel collides with itself the same way") {
+				const AABBBVHModel a(&terrain, first), b(&terrain, second);
+				const glm::mat4 identity(1.0f);
+				REQUIRE(collides(a, b, identity, identity) == collides(a, a, identity, identity));
+			}
+		}
+
+		std::filesystem::remove_all(directory);
+	}
+}
+
+} // End of namespace lowpoly3d
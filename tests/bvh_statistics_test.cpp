@@ -0,0 +1,104 @@
+#include "bvh_statistics.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <numeric>
+#include <catch2/catch_all.hpp>
+
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+SCENARIO("Measuring the quality of BVHs") {
+	GIVEN("A BVH over two disjoint triangles") {
+		Model model = getTwoTriangleModel();
+		const BVH<AABB> bvh(model);
+		const BVHStatistics stats = statistics(bvh);
+
+		THEN("both triangles are leaves just below the root and their boxes do not overlap") {
+			REQUIRE(stats.bv_name == "aabb");
+			REQUIRE(stats.num_nodes == 3);
+			REQUIRE(stats.num_leaves == 2);
+			REQUIRE(stats.leaves_per_depth == std::vector<std::size_t>{0, 2});
+			REQUIRE(stats.sibling_overlap == 0.0);
+			REQUIRE(stats.build_seconds == 0.0);
+		}
+	}
+
+	GIVEN("BVHs built over a procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHStatistics spheres = build_statistics<Sphere>(terrain);
+		const BVHStatistics boxes = build_statistics<AABB>(terrain);
+		const BVHStatistics split = build_statistics<AABB>(terrain, BVHBuildStrategy::split);
+
+		THEN("every triangle is a leaf at some depth") {
+			for(const BVHStatistics* stats : {&spheres, &boxes, &split}) {
+				REQUIRE(stats->num_leaves == terrain.getNumTriangles());
+				REQUIRE(stats->num_nodes == 2 * stats->num_leaves - 1);
+				REQUIRE(std::accumulate(stats->leaves_per_depth.begin(), stats->leaves_per_depth.end(), std::size_t(0)) == stats->num_leaves);
+				REQUIRE(stats->build_seconds > 0.0);
+			}
+		}
+
+		THEN("the cost is the cost of the BVH") {
+			REQUIRE(boxes.sah_cost == Catch::Approx(BVH<AABB>(terrain).cost()));
+		}
+
+		THEN("siblings overlap, spheres more so than boxes") {
+			REQUIRE(boxes.sibling_overlap > 0.0);
+			REQUIRE(spheres.sibling_overlap > boxes.sibling_overlap);
+		}
+
+		THEN("the statistics of a moved terrain are the same, apart from build time") {
+			Model moved = terrain;
+			moved.translate({100.0f, 0.0f, 0.0f});
+			const BVHStatistics other = statistics(BVH<AABB>(moved));
+			REQUIRE(other.sah_cost == Catch::Approx(boxes.sah_cost));
+			REQUIRE(other.sibling_overlap == Catch::Approx(boxes.sibling_overlap));
+			REQUIRE(other.leaves_per_depth == boxes.leaves_per_depth);
+		}
+
+		THEN("they can be written as JSON") {
+			const std::string json = to_json(boxes);
+			REQUIRE(json.front() == '{');
+			REQUIRE(json.find("\"bv\": \"aabb\"") != std::string::npos);
+			REQUIRE(json.find("\"sah_cost\": ") != std::string::npos);
+			REQUIRE(json.find("\"leaves_per_depth\": [0, ") != std::string::npos);
+		}
+	}
+}
+
+SCENARIO("Profiling BVH queries") {
+	GIVEN("A BVH over a procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const AABBBVHModel bvh(&terrain);
+		const glm::mat4 identity(1.0f);
+		const glm::mat4 above = glm::translate(identity, {0.0f, 1000.0f, 0.0f});
+
+		WHEN("the terrain collides with itself and with a copy far above it") {
+			QueryStatistics stats;
+			{
+				QueryProfiler profiler(stats);
+				collides(bvh, bvh, identity, identity);
+				collides(bvh, bvh, identity, above);
+			}
+			collides(bvh, bvh, identity, identity);
+
+			THEN("the work within the scope of the profiler is counted if enabled") {
+				if constexpr(query_statistics_enabled) {
+					REQUIRE(stats.queries == 2);
+					REQUIRE(stats.bv_tests > 2);
+					REQUIRE(stats.triangle_tests > 0);
+					REQUIRE(stats.max_stack_depth > 0);
+					REQUIRE(stats.max_stack_depth <= 2 * bvh.getDepth());
+				} else {
+					REQUIRE(stats.queries == 0);
+					REQUIRE(stats.bv_tests == 0);
+				}
+				REQUIRE(to_json(stats).find("\"bv_tests\": ") != std::string::npos);
+			}
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
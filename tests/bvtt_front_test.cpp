@@ -0,0 +1,93 @@
+#include "bvtt_front.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+#include "utils/query_statistics.hpp"
+
+namespace lowpoly3d {
+
+SCENARIO("Colliding BVHModels frame after frame with a BVTT front") {
+
+	GIVEN("A front between a single triangle and itself") {
+		Model model = getSingleTriangleModel();
+		const BVHModel bvhModel(&model);
+		BVTTFront front(bvhModel, bvhModel);
+		const glm::mat4 identity = glm::mat4(1.0f);
+		const glm::mat4 away = glm::translate(identity, glm::vec3(5.0f, 0.0f, 0.0f));
+
+		THEN("it collides with itself, but not with itself moved away, and back again") {
+			REQUIRE(front.collides(identity, identity));
+			REQUIRE_FALSE(front.collides(identity, away));
+			REQUIRE(front.collides(identity, identity));
+			REQUIRE(front.size() == 1);
+		}
+	}
+
+	GIVEN("Two balls and a front between them for either BV type") {
+		Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+		const BVHModel spheres(&ball);
+		const AABBBVHModel boxes(&ball);
+		BVTTFront sphereFront(spheres, spheres);
+		AABBBVTTFront boxFront(boxes, boxes);
+		const glm::mat4 identity = glm::mat4(1.0f);
+		const auto translation = [&](float x) { return glm::translate(identity, glm::vec3(x, 0.2f, 0.0f)); };
+
+		WHEN("one ball moves into the other and back out again") {
+			std::vector<bool> sphereHits, boxHits, expectedSphereHits, expectedBoxHits;
+			std::vector<std::size_t> sizes;
+			for(float x : {3.0f, 2.5f, 2.1f, 1.5f, 1.2f, 1.2f, 1.2f, 1.5f, 2.1f, 2.5f, 3.0f}) {
+				expectedSphereHits.push_back(collides(spheres, spheres, identity, translation(x)));
+				expectedBoxHits.push_back(collides(boxes, boxes, identity, translation(x)));
+				sphereHits.push_back(sphereFront.collides(identity, translation(x)));
+				boxHits.push_back(boxFront.collides(identity, translation(x)));
+				sizes.push_back(boxFront.size());
+			}
+
+			THEN("the fronts collide where collides() on the BVHModels says they do") {
+				REQUIRE(sphereHits == expectedSphereHits);
+				REQUIRE(boxHits == expectedBoxHits);
+				REQUIRE(std::count(boxHits.begin(), boxHits.end(), true) == 5);
+			}
+
+			THEN("the front grows while the balls overlap and shrinks back once they are apart") {
+				REQUIRE(sizes.front() == 1);
+				REQUIRE(sizes[4] > sizes[3]);
+				REQUIRE(sizes.back() == 1);
+			}
+		}
+
+		WHEN("the balls rest against each other") {
+			REQUIRE(boxFront.collides(identity, translation(1.2f)));
+			QueryStatistics stats;
+			bool resting = true;
+			{
+				QueryProfiler profiler(stats);
+				for(int i = 0; i < 10; i++) {
+					resting = resting && boxFront.collides(identity, translation(1.2f));
+				}
+			}
+
+			THEN("they keep colliding, and each query tests one pair of BVs and one pair of triangles if counted") {
+				REQUIRE(resting);
+				if constexpr(query_statistics_enabled) {
+					REQUIRE(stats.queries == 10);
+					REQUIRE(stats.bv_tests == 10);
+					REQUIRE(stats.triangle_tests == 10);
+				}
+			}
+		}
+
+		WHEN("the front is reset") {
+			REQUIRE(sphereFront.collides(identity, translation(1.2f)));
+			sphereFront.reset();
+
+			THEN("the next query starts from the roots") {
+				REQUIRE(sphereFront.size() == 1);
+				REQUIRE_FALSE(sphereFront.collides(identity, translation(3.0f)));
+			}
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
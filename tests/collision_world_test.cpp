@@ -0,0 +1,111 @@
+#include "collision_world.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// All pairs of objects whose bounds overlap, found by testing every pair
+std::vector<CollisionWorld::pair_type> brute_force_pairs(const CollisionWorld& world, std::size_t count) {
+	std::vector<CollisionWorld::pair_type> pairs;
+	for(CollisionWorld::handle_type a = 0; a < count; a++) {
+		for(CollisionWorld::handle_type b = a + 1; b < count; b++) {
+			if(colliding(world.getBounds(a), world.getBounds(b))) {
+				pairs.emplace_back(a, b);
+			}
+		}
+	}
+	return pairs;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Finding colliding objects in a collision world") {
+	GIVEN("A world of three single-triangle objects, two of which coincide") {
+		Model model = getSingleTriangleModel();
+		const BVHModel bvhModel(&model);
+		glm::mat4 matrices[3] = {
+			glm::mat4(1.0f),
+			glm::mat4(1.0f),
+			glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f))};
+
+		CollisionWorld world;
+		const auto a = world.add({&bvhModel, &matrices[0]});
+		const auto b = world.add({&bvhModel, &matrices[1]});
+		const auto c = world.add({&bvhModel, &matrices[2]});
+		std::vector<CollisionWorld::pair_type> colliding;
+
+		THEN("the coinciding objects collide") {
+			REQUIRE(world.step(colliding) == 1);
+			REQUIRE(colliding.front() == CollisionWorld::pair_type(a, b));
+			REQUIRE(world.getCandidatePairs().size() == 1);
+		}
+
+		WHEN("the distant object moves onto the others") {
+			matrices[2] = glm::mat4(1.0f);
+
+			THEN("all three objects collide") {
+				REQUIRE(world.step(colliding) == 3);
+			}
+		}
+
+		WHEN("one of the coinciding objects moves away") {
+			matrices[1] = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 10.0f));
+
+			THEN("no objects collide") {
+				REQUIRE(world.step(colliding) == 0);
+				REQUIRE(world.getCandidatePairs().empty());
+			}
+		}
+
+		WHEN("one of the coinciding objects is removed") {
+			world.remove(b);
+
+			THEN("no objects collide") {
+				REQUIRE(world.size() == 2);
+				REQUIRE(world.step(colliding) == 0);
+			}
+
+			THEN("its handle is reused by the next object") {
+				REQUIRE(world.add({&bvhModel, &matrices[0]}) == b);
+				REQUIRE(world.step(colliding) == 1);
+			}
+		}
+		(void)c;
+	}
+
+	GIVEN("A world of many moving balls") {
+		Model ball = SphereGenerator({255, 0, 255}, 0).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+		const BVHModel ballBVH(&ball);
+
+		constexpr std::size_t count = 200;
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> position(-20.0f, 20.0f), step(-0.5f, 0.5f);
+
+		std::vector<glm::mat4> matrices(count);
+		CollisionWorld world;
+		for(auto& matrix : matrices) {
+			matrix = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)));
+			world.add({&ballBVH, &matrix});
+		}
+
+		THEN("the candidate pairs are the pairs of overlapping bounds as the balls move") {
+			bool equal = true;
+			for(int frame = 0; frame < 20; frame++) {
+				for(auto& matrix : matrices) {
+					matrix = glm::translate(matrix, glm::vec3(step(rng), step(rng), step(rng)));
+				}
+				world.update();
+				equal = equal && world.getCandidatePairs() == brute_force_pairs(world, count);
+			}
+			REQUIRE(equal);
+			REQUIRE(!world.getCandidatePairs().empty());
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,149 @@
+#include "flat_bounding_volume_hierarchy.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+SCENARIO("Flattening a BVH") {
+
+	THEN("nodes are smaller than BVH nodes") {
+		REQUIRE(sizeof(FlatBVH<Sphere>::bv_type) == sizeof(Sphere) + 2 * sizeof(std::uint32_t));
+		REQUIRE(sizeof(FlatBVH<Sphere>::bv_type) < sizeof(BVH<Sphere>::bv_type));
+		REQUIRE(sizeof(FlatBVH<AABB>::bv_type) < sizeof(BVH<AABB>::bv_type));
+	}
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		BVH<Sphere> bvh(terrain);
+
+		WHEN("flattening its BVH") {
+			FlatBVH<Sphere> flat(terrain, bvh);
+
+			THEN("it has as many nodes as the BVH") {
+				REQUIRE(flat.size() == bvh.size());
+			}
+
+			THEN("the root is first and is the root of the BVH") {
+				REQUIRE(static_cast<const Sphere&>(flat.root()) == static_cast<const Sphere&>(bvh.root()));
+			}
+
+			THEN("nodes are in depth-first order") {
+				bool depthfirst = true;
+				for(std::size_t i = 0; i < flat.size(); i++) {
+					if(flat[i].is_leaf()) continue;
+					depthfirst = depthfirst && flat.left_idx(i) == i + 1 && flat.right_idx(i) > i + 1 && flat.right_idx(i) < flat.size();
+				}
+				REQUIRE(depthfirst);
+			}
+
+			THEN("every triangle of the model occurs exactly once") {
+				std::vector<std::size_t> indices;
+				for(std::size_t i = 0; i < flat.getTriangles().size(); i++) {
+					indices.push_back(flat.getTriangleIndex(i));
+				}
+				std::sort(indices.begin(), indices.end());
+				std::vector<std::size_t> expected(terrain.getNumTriangles());
+				std::iota(expected.begin(), expected.end(), 0);
+				REQUIRE(indices == expected);
+			}
+
+			THEN("every leaf refers to a single triangle that it contains") {
+				bool ok = true;
+				for(const auto& bv : flat.getBVs()) {
+					if(!bv.is_leaf()) continue;
+					ok = ok && bv.count == 1 && bv.contains(flat.getTriangles()[bv.offset]);
+				}
+				REQUIRE(ok);
+			}
+
+			THEN("reordered triangles are the triangles of the model") {
+				const auto& triangles = flat.getTriangles();
+				bool ok = true;
+				for(std::size_t i = 0; i < triangles.size(); i++) {
+					const auto indices = terrain.getTriangleIndices(flat.getTriangleIndex(i));
+					ok = ok &&
+						triangles[i][0] == terrain.vertices[indices[0]] &&
+						triangles[i][1] == terrain.vertices[indices[1]] &&
+						triangles[i][2] == terrain.vertices[indices[2]];
+				}
+				REQUIRE(ok);
+			}
+		}
+
+		WHEN("flattening a BVH of boxes with up to four triangles per leaf") {
+			FlatBVH<AABB> flat(terrain, 4);
+
+			THEN("there are fewer nodes than in the BVH") {
+				REQUIRE(flat.size() < bvh.size());
+			}
+
+			THEN("leaves hold between one and four triangles and cover all triangles in order") {
+				std::uint32_t next = 0;
+				bool ok = true;
+				for(const auto& bv : flat.getBVs()) {
+					if(!bv.is_leaf()) continue;
+					ok = ok && bv.count >= 1 && bv.count <= 4 && bv.offset == next;
+					for(std::uint32_t i = bv.offset; i < bv.offset + bv.count; i++) {
+						ok = ok && bv.contains(flat.getTriangles()[i]);
+					}
+					next += bv.count;
+				}
+				REQUIRE(ok);
+				REQUIRE(next == terrain.getNumTriangles());
+			}
+
+			THEN("all parents enclose their children") {
+				bool ok = true;
+				for(std::size_t i = 0; i < flat.size(); i++) {
+					if(flat[i].is_leaf()) continue;
+					ok = ok && flat[i].encloses(flat[flat.left_idx(i)]) && flat[i].encloses(flat[flat.right_idx(i)]);
+				}
+				REQUIRE(ok);
+			}
+		}
+	}
+}
+
+SCENARIO("Flat BVH collision") {
+
+	GIVEN("A flat BVH over a single triangle") {
+		Model model = getSingleTriangleModel();
+		FlatBVH<Sphere> flat(model);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		THEN("it collides with itself") {
+			REQUIRE(collides(flat, flat, identity, identity));
+		}
+
+		THEN("it does not collide with itself when translated away") {
+			REQUIRE_FALSE(collides(flat, flat, identity, glm::translate(identity, glm::vec3(5.0f, 0.0f, 0.0f))));
+		}
+	}
+
+	GIVEN("A flat BVH over a single sphere") {
+		Model sphereModel = SphereGenerator().generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+		BVHModel bvh(&sphereModel);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		THEN("it collides with itself") {
+			REQUIRE(collides(FlatBVH<Sphere>(sphereModel, bvh), FlatBVH<Sphere>(sphereModel, bvh), identity, identity));
+		}
+
+		THEN("it agrees with collides() on the BVH it was flattened from") {
+			for(std::size_t max_leaf_size : {1, 2, 8}) {
+				FlatBVH<Sphere> flat(sphereModel, bvh, max_leaf_size);
+				for(float x : {5.0f, 10.0f}) {
+					const glm::mat4 translation = glm::translate(identity, glm::vec3(x, 0.0f, 0.0f));
+					REQUIRE(collides(flat, flat, identity, translation) == collides(bvh, bvh, identity, translation));
+				}
+			}
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
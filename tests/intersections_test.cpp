@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 #include <iostream>
+#include <random>
 #include <sstream>
 
 #include "geometric_primitives/intersections.hpp"
@@ -599,6 +600,19 @@ SCENARIO("Plane-LineSegment intersection tests") {
 			}
 		}
 	}
+
+	GIVEN("The XY-plane and LineSegments above it, below it and through it") {
+		auto const plane = Plane(Point(0.0f, 0.0f, 0.0f), Point(0.0f, 0.0f, 1.0f));
+		auto const above = LineSegment {{0,0,1},{1,0,2}};
+		auto const below = LineSegment {{0,0,-1},{1,0,-2}};
+		auto const through = LineSegment {{0,0,-1},{1,0,2}};
+
+		THEN("Only the LineSegment through the plane is reported as intersecting") {
+			REQUIRE_FALSE(intersects(above, plane));
+			REQUIRE_FALSE(intersects(below, plane));
+			REQUIRE(intersects(through, plane));
+		}
+	}
 }
 
 SCENARIO("Triangle-LineSegment intersection tests") {
@@ -801,4 +815,94 @@ SCENARIO("Triangle-LineSegment intersection tests") {
 			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+SCENARIO("Triangle-Triangle intersection tests") {
+	using namespace lowpoly3d;
+
+	// Returns true if point lies on the closed triangle
+	auto const onTriangle = [](Triangle const& triangle, Point const& point) {
+		return glm::distance(closest_point(triangle, point), point) <= 1e-4f;
+	};
+
+	GIVEN("A triangle in the XY-plane and a triangle in the XZ-plane that pierces it") {
+		auto const t1 = Triangle {{-1,-1,0},{3,-1,0},{-1,3,0}};
+		auto const t2 = Triangle {{0,0,-1},{2,0,-1},{1,0,1}};
+		WHEN("Computing their linesegment of intersection") {
+			auto const segment = intersection(t1, t2);
+			THEN("It is where the second triangle crosses the XY-plane") {
+				auto const lo = segment.p1.x < segment.p2.x ? segment.p1 : segment.p2;
+				auto const hi = segment.p1.x < segment.p2.x ? segment.p2 : segment.p1;
+				REQUIRE(almostEqual(lo, Point{0.5f, 0.0f, 0.0f}, 1e-5f));
+				REQUIRE(almostEqual(hi, Point{1.5f, 0.0f, 0.0f}, 1e-5f));
+			}
+			THEN("It is the same in either order") {
+				auto const commuted = intersection(t2, t1);
+				REQUIRE(segment.length() == Catch::Approx(commuted.length()));
+			}
+		}
+	}
+
+	GIVEN("Two triangles whose planes intersect but whose intervals on that line do not overlap") {
+		auto const t1 = Triangle {{0,0,0},{1,0,0},{0,1,0}};
+		auto const t2 = Triangle {{2,0,-1},{3,0,-1},{2.5f,0,1}};
+		THEN("There is no linesegment of intersection") {
+			Point start, end;
+			REQUIRE_FALSE(intersection(t1, t2, start, end));
+			auto const segment = intersection(t1, t2);
+			REQUIRE(std::isnan(segment.p1.x));
+			REQUIRE(std::isnan(segment.p2.x));
+		}
+	}
+
+	GIVEN("Two triangles that touch at a vertex") {
+		auto const t1 = Triangle {{0,0,0},{1,0,0},{0,1,0}};
+		auto const t2 = Triangle {{0.25f,0.25f,0},{1,0.25f,1},{0.25f,1,1}};
+		THEN("The intersection is that vertex") {
+			Point start, end;
+			REQUIRE(intersection(t1, t2, start, end));
+			REQUIRE(almostEqual(start, Point{0.25f, 0.25f, 0.0f}, 1e-6f));
+			REQUIRE(almostEqual(end, Point{0.25f, 0.25f, 0.0f}, 1e-6f));
+		}
+	}
+
+	GIVEN("Two coplanar overlapping triangles") {
+		auto const t1 = Triangle {{0,0,0},{1,0,0},{0,1,0}};
+		auto const t2 = Triangle {{0.25f,0.25f,0},{2,0.25f,0},{0.25f,2,0}};
+		THEN("There is no linesegment of intersection") {
+			Point start, end;
+			REQUIRE_FALSE(intersection(t1, t2, start, end));
+		}
+	}
+
+	GIVEN("A bulk of random pairs of triangles") {
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+		auto const randomTriangle = [&]() {
+			return Triangle {
+				{coordinate(rng), coordinate(rng), coordinate(rng)},
+				{coordinate(rng), coordinate(rng), coordinate(rng)},
+				{coordinate(rng), coordinate(rng), coordinate(rng)}};
+		};
+
+		THEN("They have a linesegment of intersection exactly when they are at distance zero, and it lies on both") {
+			bool consistent = true;
+			for(int i = 0; i < 1000; i++) {
+				auto const t1 = randomTriangle();
+				auto const t2 = randomTriangle();
+				Point start, end, on1, on2;
+				auto const intersecting = intersection(t1, t2, start, end);
+				auto const distance = closest_points(t1, t2, on1, on2);
+				if(intersecting) {
+					consistent = consistent &&
+						distance <= 1e-5f &&
+						onTriangle(t1, start) && onTriangle(t1, end) &&
+						onTriangle(t2, start) && onTriangle(t2, end);
+				} else {
+					consistent = consistent && distance > 0.0f;
+				}
+			}
+			REQUIRE(consistent);
+		}
+	}
+}
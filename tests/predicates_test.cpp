@@ -0,0 +1,73 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath> // std::ldexp
+
+#include "utils/predicates.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// The spacing of floats in [0.5, 1)
+float const ulp = std::ldexp(1.0f, -24);
+
+int sign(int x) {
+	return (x > 0) - (x < 0);
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Orientation predicates") {
+
+	/* Points (0.5 + i*ulp, 0.5 + j*ulp) are left of the line through (12, 12) and (24, 24) iff j > i,
+	 * which evaluating the determinant in float gets wrong for many of them, see Shewchuk */
+	GIVEN("A grid of points that are a few floats away from the line y = x") {
+		Point2f const b {12.0f, 12.0f}, c {24.0f, 24.0f};
+
+		THEN("orient2d has the sign of the exact determinant, in float and in double") {
+			bool exact = true;
+			for(int i = 0; i < 64; i++) {
+				for(int j = 0; j < 64; j++) {
+					Point2f const p {0.5f + i * ulp, 0.5f + j * ulp};
+					exact = exact &&
+						orient2d(p, b, c) == sign(j - i) &&
+						orient2d(b, c, p) == sign(j - i) &&
+						orient2d(Point2d(p), Point2d(b), Point2d(c)) == sign(j - i);
+				}
+			}
+			REQUIRE(exact);
+		}
+
+		THEN("orient3d and side have the sign of the exact determinant against the plane x = y") {
+			Pointf const a {12.0f, 12.0f, 0.0f}, b3 {24.0f, 24.0f, 0.0f}, c3 {12.0f, 12.0f, 1.0f};
+			Orient3d const plane(a, b3, c3);
+			bool exact = true;
+			for(int i = 0; i < 64; i++) {
+				for(int j = 0; j < 64; j++) {
+					Pointf const p {0.5f + i * ulp, 0.5f + j * ulp, 0.25f};
+					exact = exact &&
+						plane(p) == sign(i - j) &&
+						orient3d(a, b3, c3, p) == sign(i - j) &&
+						side(Pointf(1.0f, -1.0f, 0.0f), Pointf(0.0f), p) == sign(i - j);
+				}
+			}
+			REQUIRE(exact);
+		}
+	}
+
+	GIVEN("Three points on a line, and the same points with one of them a float off the line") {
+		Pointf const a {0.5f, 0.5f, 0.5f}, b {1.5f, 1.5f, 1.5f}, c {24.0f, 24.0f, 24.0f};
+		Pointf const off {0.5f, 0.5f + ulp, 0.5f};
+
+		THEN("only the points on the line are collinear, and every point is in their plane") {
+			REQUIRE(collinear(a, b, c));
+			REQUIRE(collinear(a, a, c));
+			REQUIRE_FALSE(collinear(off, b, c));
+			REQUIRE(Orient3d(a, b, c).degenerate());
+			REQUIRE(orient3d(a, b, c, Pointf(3.0f, -7.0f, 1.0f)) == 0);
+			REQUIRE(orient3d(off, b, c, Pointf(3.0f, -7.0f, 1.0f)) != 0);
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
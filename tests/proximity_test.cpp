@@ -0,0 +1,165 @@
+#include "proximity.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// Finds the distance from point to the closest triangle of the model by testing every triangle
+float brute_force_distance(const Model& model, const Point& point) {
+	float best = std::numeric_limits<float>::infinity();
+	for(std::size_t i = 0; i < model.getNumTriangles(); i++) {
+		const auto indices = model.getTriangleIndices(i);
+		const Triangle triangle(model.vertices[indices[0]], model.vertices[indices[1]], model.vertices[indices[2]]);
+		best = std::min(best, glm::distance(closest_point(triangle, point), point));
+	}
+	return best;
+}
+
+// Finds the distance between the closest triangles of a and b by testing every pair of triangles
+float brute_force_distance(const Model& a, const Model& b, const glm::mat4& b_to_a) {
+	float best = std::numeric_limits<float>::infinity();
+	for(std::size_t i = 0; i < a.getNumTriangles(); i++) {
+		const auto ai = a.getTriangleIndices(i);
+		const Triangle ta(a.vertices[ai[0]], a.vertices[ai[1]], a.vertices[ai[2]]);
+		for(std::size_t j = 0; j < b.getNumTriangles(); j++) {
+			const auto bj = b.getTriangleIndices(j);
+			const Triangle tb = Triangle(b.vertices[bj[0]], b.vertices[bj[1]], b.vertices[bj[2]]).transform(b_to_a);
+			Point on_a, on_b;
+			best = std::min(best, closest_points(ta, tb, on_a, on_b));
+		}
+	}
+	return best;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Distance queries against BVHModels") {
+	GIVEN("A single triangle model") {
+		Model model = getSingleTriangleModel();
+		const BVHModel spheres(&model);
+		const AABBBVHModel boxes(&model);
+		const glm::mat4 identity(1.0f);
+
+		WHEN("the closest point to a point above the triangle is queried") {
+			const Point point {0.25f, 0.25f, 2.0f};
+			ClosestPoint sphereResult, boxResult;
+
+			THEN("it is straight below the point") {
+				REQUIRE(closest_point(spheres, identity, point, sphereResult));
+				REQUIRE(closest_point(boxes, identity, point, boxResult));
+				REQUIRE(sphereResult.triangle_idx == 0);
+				REQUIRE(sphereResult.distance == Catch::Approx(2.0f));
+				REQUIRE(boxResult.distance == Catch::Approx(2.0f));
+				REQUIRE(almostEqual(sphereResult.point, Point{0.25f, 0.25f, 0.0f}));
+			}
+
+			THEN("nothing is found within a shorter distance") {
+				REQUIRE(!closest_point(spheres, identity, point, sphereResult, 1.5f));
+				REQUIRE(!closest_point(boxes, identity, point, boxResult, 1.5f));
+			}
+		}
+
+		WHEN("the triangle is scaled and moved in world-space") {
+			const glm::mat4 world = glm::scale(glm::translate(identity, {0.0f, 0.0f, -3.0f}), glm::vec3(2.0f));
+			ClosestPoint result;
+
+			THEN("the closest point and its distance are in world-space") {
+				REQUIRE(closest_point(spheres, world, Point{0.5f, 0.5f, 2.0f}, result));
+				REQUIRE(result.distance == Catch::Approx(5.0f));
+				REQUIRE(almostEqual(result.point, Point{0.5f, 0.5f, -3.0f}));
+			}
+		}
+
+		WHEN("the distance to a copy of the triangle above it is queried") {
+			const glm::mat4 above = glm::translate(identity, {0.0f, 0.0f, 3.0f});
+			ClosestPoints result;
+
+			THEN("it is the distance between them") {
+				REQUIRE(minimum_distance(spheres, spheres, identity, above, result));
+				REQUIRE(result.distance == Catch::Approx(3.0f));
+				REQUIRE(glm::distance(result.a_point, result.b_point) == Catch::Approx(3.0f));
+				REQUIRE(result.a_point.z == Catch::Approx(0.0f).margin(1e-6f));
+				REQUIRE(result.b_point.z == Catch::Approx(3.0f));
+				REQUIRE(minimum_distance(boxes, boxes, identity, above, result));
+				REQUIRE(result.distance == Catch::Approx(3.0f));
+			}
+
+			THEN("nothing is found within a shorter distance") {
+				REQUIRE(!minimum_distance(spheres, spheres, identity, above, result, 2.0f));
+			}
+		}
+
+		WHEN("the distance to a copy of the triangle rotated through it is queried") {
+			const glm::mat4 rotated = glm::rotate(glm::translate(identity, {0.25f, 0.0f, 0.0f}), 1.5f, glm::vec3(1.0f, 0.0f, 0.0f));
+			ClosestPoints result;
+
+			THEN("it is zero") {
+				REQUIRE(minimum_distance(spheres, spheres, identity, rotated, result));
+				REQUIRE(result.distance == 0.0f);
+			}
+		}
+	}
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel spheres(&terrain);
+		const AABBBVHModel boxes(&terrain);
+		const glm::mat4 identity(1.0f);
+
+		WHEN("the closest points to random points around the terrain are queried") {
+			std::mt19937 rng(1234);
+			std::uniform_real_distribution<float> coordinate(-10.0f, 90.0f), height(-10.0f, 40.0f);
+
+			THEN("they are as close as the closest point of any triangle") {
+				bool same = true;
+				for(int i = 0; i < 100; i++) {
+					const Point point {coordinate(rng), height(rng), coordinate(rng)};
+					const float expected = brute_force_distance(terrain, point);
+					ClosestPoint sphereResult, boxResult;
+					same = same &&
+						closest_point(spheres, identity, point, sphereResult) &&
+						closest_point(boxes, identity, point, boxResult) &&
+						sphereResult.distance == Catch::Approx(expected) &&
+						boxResult.distance == Catch::Approx(expected) &&
+						glm::distance(sphereResult.point, point) == Catch::Approx(expected);
+				}
+				REQUIRE(same);
+			}
+		}
+
+		WHEN("the distance to a ball above the terrain is queried") {
+			Model ball = SphereGenerator({255, 0, 255}, 0).generate(Sphere({0.0f, 0.0f, 0.0f}, 3.0f));
+			const BVHModel ballSpheres(&ball);
+			const AABBBVHModel ballBoxes(&ball);
+			const glm::mat4 ballWorld = glm::translate(identity, {40.0f, 30.0f, 40.0f});
+			const float expected = brute_force_distance(terrain, ball, ballWorld);
+
+			THEN("it is the distance between the closest pair of triangles") {
+				ClosestPoints sphereResult, boxResult;
+				REQUIRE(minimum_distance(spheres, ballSpheres, identity, ballWorld, sphereResult));
+				REQUIRE(minimum_distance(boxes, ballBoxes, identity, ballWorld, boxResult));
+				REQUIRE(sphereResult.distance == Catch::Approx(expected));
+				REQUIRE(boxResult.distance == Catch::Approx(expected));
+				REQUIRE(glm::distance(sphereResult.a_point, sphereResult.b_point) == Catch::Approx(expected));
+			}
+
+			THEN("an early exit finds a pair within the threshold") {
+				ClosestPoints result;
+				const float threshold = expected + 5.0f;
+				REQUIRE(minimum_distance(spheres, ballSpheres, identity, ballWorld, result,
+					std::numeric_limits<float>::infinity(), threshold));
+				REQUIRE(result.distance <= threshold);
+				REQUIRE(result.distance >= Catch::Approx(expected));
+			}
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,183 @@
+#include "quantized_bounding_volume_hierarchy.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+/* Calls f(idx, bv) for every node of qbvh along with its decoded BV, and returns true if
+ * f returns true for every node */
+template<typename TValue, typename TQuantized, typename F>
+bool all_decoded(const QuantizedBVH<TValue, TQuantized>& qbvh, std::size_t idx, const TValue& parent, F f) {
+	const TValue bv = qbvh.decode(idx, parent);
+	if(!f(idx, bv)) return false;
+	if(qbvh[idx].is_leaf()) return true;
+	return all_decoded(qbvh, qbvh.left_idx(idx), bv, f) && all_decoded(qbvh, qbvh.right_idx(idx), bv, f);
+}
+
+// Returns the sum of the sizes of the decoded BVs of all nodes of qbvh
+template<typename TValue, typename TQuantized>
+double decoded_size(const QuantizedBVH<TValue, TQuantized>& qbvh) {
+	double sum = 0.0;
+	all_decoded(qbvh, qbvh.root_idx(), qbvh.root(), [&](std::size_t, const TValue& bv) {
+		sum += bv.size();
+		return true;
+	});
+	return sum;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Quantizing a BVH") {
+
+	THEN("nodes are smaller than BVH nodes, and 8-bit nodes are smaller than 16-bit nodes") {
+		REQUIRE(sizeof(QuantizedBVH<AABB, std::uint8_t>::bv_type) == 3 * sizeof(std::uint32_t));
+		REQUIRE(sizeof(QuantizedBVH<AABB, std::uint8_t>::bv_type) < sizeof(QuantizedBVH<AABB, std::uint16_t>::bv_type));
+		REQUIRE(sizeof(QuantizedBVH<AABB, std::uint16_t>::bv_type) < sizeof(BVH<AABB>::bv_type));
+		REQUIRE(sizeof(QuantizedBVH<Sphere, std::uint8_t>::bv_type) == 2 * sizeof(std::uint32_t));
+		REQUIRE(sizeof(QuantizedBVH<Sphere, std::uint16_t>::bv_type) < sizeof(BVH<Sphere>::bv_type));
+	}
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVH<AABB> boxes(terrain);
+		const BVH<Sphere> spheres(terrain);
+
+		WHEN("quantizing its BVHs to 8 and 16 bits") {
+			const QuantizedBVH<AABB, std::uint8_t> boxes8(&terrain, boxes);
+			const QuantizedBVH<AABB, std::uint16_t> boxes16(&terrain, boxes);
+			const QuantizedBVH<Sphere, std::uint8_t> spheres8(&terrain, spheres);
+			const QuantizedBVH<Sphere, std::uint16_t> spheres16(&terrain, spheres);
+
+			THEN("they have as many nodes as the BVH, in depth-first order") {
+				REQUIRE(boxes8.size() == boxes.size());
+				REQUIRE(spheres16.size() == spheres.size());
+				bool depthfirst = true;
+				for(std::size_t i = 0; i < boxes8.size(); i++) {
+					if(boxes8[i].is_leaf()) continue;
+					depthfirst = depthfirst && boxes8.left_idx(i) == i + 1 && boxes8.right_idx(i) > i + 1 && boxes8.right_idx(i) < boxes8.size();
+				}
+				REQUIRE(depthfirst);
+			}
+
+			THEN("they take less memory than the BVH") {
+				const std::size_t memory = boxes.size() * sizeof(BVH<AABB>::bv_type);
+				REQUIRE(boxes16.memory() < memory);
+				REQUIRE(boxes8.memory() < boxes16.memory());
+			}
+
+			THEN("decoded leaves contain their triangle") {
+				const auto contains = [](const auto& qbvh) {
+					return all_decoded(qbvh, qbvh.root_idx(), qbvh.root(), [&](std::size_t idx, const auto& bv) {
+						return !qbvh[idx].is_leaf() || bv.contains(qbvh.getTriangle(qbvh[idx].index()));
+					});
+				};
+				REQUIRE(contains(boxes8));
+				REQUIRE(contains(boxes16));
+				REQUIRE(contains(spheres8));
+				REQUIRE(contains(spheres16));
+			}
+
+			THEN("every triangle of the model is in exactly one leaf") {
+				std::vector<std::size_t> count(terrain.getNumTriangles(), 0);
+				for(std::size_t i = 0; i < spheres8.size(); i++) {
+					if(spheres8[i].is_leaf()) count[spheres8[i].index()]++;
+				}
+				REQUIRE(std::all_of(count.begin(), count.end(), [](std::size_t c) { return c == 1; }));
+			}
+
+			THEN("16-bit BVs are tighter than 8-bit BVs") {
+				REQUIRE(decoded_size(boxes16) < decoded_size(boxes8));
+				REQUIRE(decoded_size(spheres16) < decoded_size(spheres8));
+			}
+		}
+	}
+}
+
+SCENARIO("Queries on quantized BVHs") {
+
+	GIVEN("A quantized BVH over a single triangle") {
+		Model model = getSingleTriangleModel();
+		const QuantizedBVH<Sphere, std::uint8_t> qbvh(&model);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		THEN("it collides with itself, but not with itself moved away") {
+			REQUIRE(collides(qbvh, qbvh, identity, identity));
+			REQUIRE(!collides(qbvh, qbvh, identity, glm::translate(identity, glm::vec3(0.0f, 0.0f, 1.0f))));
+		}
+
+		THEN("a ray through the triangle hits it") {
+			RayHit hit;
+			REQUIRE(ray_cast(qbvh, identity, Line({0.25f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+			REQUIRE(hit.triangle_idx == 0);
+			REQUIRE(hit.distance == Catch::Approx(5.0f));
+			REQUIRE(!ray_cast(qbvh, identity, Line({0.25f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit, 4.0f));
+		}
+	}
+
+	GIVEN("A model without triangles") {
+		Model model;
+		const QuantizedBVH<AABB, std::uint8_t> boxes8(&model);
+		const QuantizedBVH<Sphere, std::uint16_t> spheres16(&model);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		THEN("the quantized BVHs are empty, collide with nothing and are missed by every ray") {
+			REQUIRE(boxes8.size() == 0);
+			REQUIRE(spheres16.size() == 0);
+			REQUIRE(!collides(boxes8, boxes8, identity, identity));
+			REQUIRE(!collides(spheres16, spheres16, identity, identity));
+			RayHit hit;
+			REQUIRE(!ray_cast(boxes8, identity, Line({0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+			REQUIRE(!ray_cast(spheres16, identity, Line({0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+		}
+	}
+
+	GIVEN("A procedurally generated terrain and a ball") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+		const AABBBVHModel terrainBVH(&terrain), ballBVH(&ball);
+		const QuantizedBVH<AABB, std::uint8_t> terrain8(&terrain), ball8(&ball);
+		const QuantizedBVH<AABB, std::uint16_t> terrain16(&terrain), ball16(&ball);
+		const glm::mat4 identity = glm::mat4(1.0f);
+		const Point center = terrain.vertices[terrain.vertices.size() / 2];
+
+		THEN("collisions of two balls are the collisions of the BVHModels") {
+			std::size_t collisions = 0;
+			for(float x : {0.5f, 1.5f, 1.9f, 2.1f, 3.0f}) {
+				const glm::mat4 translation = glm::translate(identity, glm::vec3(x, 0.0f, 0.0f));
+				const bool expected = collides(ballBVH, ballBVH, identity, translation);
+				collisions += expected;
+				REQUIRE(collides(ball8, ball8, identity, translation) == expected);
+				REQUIRE(collides(ball16, ball16, identity, translation) == expected);
+			}
+			REQUIRE(collisions == 3);
+		}
+
+		THEN("rays hit what they hit on the BVHModel") {
+			std::mt19937 rng(5678);
+			std::uniform_real_distribution<float> offset(-30.0f, 30.0f);
+			bool same = true;
+			for(int i = 0; i < 100; i++) {
+				const Line ray(center + glm::vec3(offset(rng), 50.0f, offset(rng)), {offset(rng) / 100.0f, -1.0f, offset(rng) / 100.0f});
+				RayHit expected, hit8, hit16;
+				const bool found = ray_cast(terrainBVH, identity, ray, expected);
+				same = same && ray_cast(terrain8, identity, ray, hit8) == found;
+				same = same && ray_cast(terrain16, identity, ray, hit16) == found;
+				if(found) {
+					same = same && hit8.triangle_idx == expected.triangle_idx && hit8.distance == expected.distance;
+					same = same && hit16.triangle_idx == expected.triangle_idx && hit16.distance == expected.distance;
+				}
+			}
+			REQUIRE(same);
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,244 @@
+#include "ray_cast.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// Finds the closest hit by testing every triangle of the model
+template<typename TValue>
+bool brute_force_ray_cast(const TBVHModel<TValue>& bvh, std::size_t num_triangles, const Line& ray, RayHit& hit) {
+	bool found = false;
+	float best = std::numeric_limits<float>::infinity();
+	for(std::size_t i = 0; i < num_triangles; i++) {
+		float t, u, v;
+		if(detail::ray_triangle(ray.getPoint(), ray.getDirection(), bvh.getTriangle(i), best, t, u, v)) {
+			best = t;
+			hit = RayHit{i, t, u, v};
+			found = true;
+		}
+	}
+	return found;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Casting rays against a BVHModel") {
+	GIVEN("A single triangle model") {
+		Model model = getSingleTriangleModel();
+		const BVHModel spheres(&model);
+		const AABBBVHModel boxes(&model);
+		const glm::mat4 identity(1.0f);
+		RayHit hit;
+
+		WHEN("a ray is cast straight at the triangle") {
+			const Line ray({0.25f, 0.5f, 5.0f}, {0.0f, 0.0f, -1.0f});
+
+			THEN("it hits the triangle at the distance and barycentric coordinates of the hit point") {
+				REQUIRE(ray_cast(spheres, identity, ray, hit));
+				REQUIRE(hit.triangle_idx == 0);
+				REQUIRE(hit.distance == Catch::Approx(5.0f));
+				REQUIRE(hit.u == Catch::Approx(0.25f));
+				REQUIRE(hit.v == Catch::Approx(0.5f));
+				REQUIRE(ray_cast(boxes, identity, ray, hit));
+				REQUIRE(hit.distance == Catch::Approx(5.0f));
+			}
+
+			THEN("it does not hit the triangle if the triangle is beyond the maximum distance") {
+				REQUIRE(!ray_cast(spheres, identity, ray, hit, 4.0f));
+				REQUIRE(!ray_cast(boxes, identity, ray, hit, 4.0f));
+			}
+		}
+
+		WHEN("a ray is cast away from the triangle") {
+			const Line ray({0.25f, 0.5f, 5.0f}, {0.0f, 0.0f, 1.0f});
+
+			THEN("it misses") {
+				REQUIRE(!ray_cast(spheres, identity, ray, hit));
+				REQUIRE(!ray_cast(boxes, identity, ray, hit));
+			}
+		}
+
+		WHEN("a ray is cast past the triangle") {
+			const Line ray({0.75f, 0.75f, 5.0f}, {0.0f, 0.0f, -1.0f});
+
+			THEN("it misses") {
+				REQUIRE(!ray_cast(spheres, identity, ray, hit));
+				REQUIRE(!ray_cast(boxes, identity, ray, hit));
+			}
+		}
+
+		WHEN("the triangle is scaled and moved in world-space") {
+			const glm::mat4 world = glm::scale(glm::translate(identity, {0.0f, 0.0f, -3.0f}), glm::vec3(2.0f));
+			const Line ray({0.5f, 1.0f, 5.0f}, {0.0f, 0.0f, -1.0f});
+
+			THEN("the distance of the hit is in world-space") {
+				REQUIRE(ray_cast(spheres, world, ray, hit));
+				REQUIRE(hit.distance == Catch::Approx(8.0f));
+				REQUIRE(hit.u == Catch::Approx(0.25f));
+				REQUIRE(hit.v == Catch::Approx(0.5f));
+			}
+		}
+
+		WHEN("a linesegment crosses the triangle") {
+			const LineSegment segment({0.25f, 0.25f, 1.0f}, {0.25f, 0.25f, -1.0f});
+
+			THEN("it hits the triangle") {
+				REQUIRE(ray_cast(spheres, identity, segment, hit));
+				REQUIRE(hit.distance == Catch::Approx(1.0f));
+				REQUIRE(ray_cast(boxes, identity, segment, hit));
+				REQUIRE(hit.distance == Catch::Approx(1.0f));
+			}
+		}
+
+		WHEN("a linesegment ends before the triangle") {
+			const LineSegment segment({0.25f, 0.25f, 1.0f}, {0.25f, 0.25f, 0.5f});
+
+			THEN("it misses") {
+				REQUIRE(!ray_cast(spheres, identity, segment, hit));
+				REQUIRE(!ray_cast(boxes, identity, segment, hit));
+			}
+		}
+	}
+
+	GIVEN("A box") {
+		const AABB box({0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f});
+		const glm::vec3 direction(0.0f, 0.0f, 1.0f);
+		const float infinity = std::numeric_limits<float>::infinity();
+		float t;
+
+		WHEN("a ray starts in the plane of a face and runs along it") {
+			// The slab test multiplies the zero distance to the face by the infinite inverse direction
+			THEN("it enters the box from either face") {
+				REQUIRE(detail::ray_entry(box, glm::vec3(0.0f, 0.5f, -1.0f), direction, 1.0f / direction, infinity, t));
+				REQUIRE(t == 1.0f);
+				REQUIRE(detail::ray_entry(box, glm::vec3(1.0f, 1.0f, -1.0f), direction, 1.0f / direction, infinity, t));
+				REQUIRE(t == 1.0f);
+				REQUIRE(detail::ray_entry(box, glm::vec3(0.5f, 0.0f, 0.5f), direction, 1.0f / direction, infinity, t));
+				REQUIRE(t == 0.0f);
+			}
+
+			THEN("it enters the box from either face as a lane of a packet") {
+				// The third lane runs along a face just outside of it
+				detail::RayPacket<4> packet;
+				packet.ox[0] = simd::float4(0.0f, 1.0f, -0.01f, 0.5f);
+				packet.oy[0] = simd::float4(0.5f, 1.0f, 0.5f, 0.0f);
+				packet.oz[0] = -1.0f;
+				packet.dx[0] = packet.dy[0] = 0.0f;
+				packet.dz[0] = 1.0f;
+				packet.ix[0] = packet.iy[0] = infinity;
+				packet.iz[0] = 1.0f;
+				for(std::size_t lane = 0; lane < 4; lane++) {
+					// Lanes with a negative t_max are left out
+					std::array<float, 4> t_max;
+					t_max.fill(-1.0f);
+					t_max[lane] = infinity;
+					packet.t_max[0] = simd::float4::load(t_max.data());
+					REQUIRE(detail::packet_entry(box, packet, t) == (lane != 2));
+					REQUIRE((lane == 2 || t == 1.0f));
+				}
+			}
+		}
+
+		WHEN("a ray runs along a face just outside of it") {
+			THEN("it misses") {
+				REQUIRE(!detail::ray_entry(box, glm::vec3(-0.01f, 0.5f, -1.0f), direction, 1.0f / direction, infinity, t));
+				REQUIRE(!detail::ray_entry(box, glm::vec3(0.5f, 1.01f, -1.0f), direction, 1.0f / direction, infinity, t));
+			}
+		}
+	}
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel spheres(&terrain);
+		const AABBBVHModel boxes(&terrain);
+		const glm::mat4 identity(1.0f);
+
+		WHEN("rays are cast from above the terrain in random directions") {
+			std::mt19937 rng(1234);
+			std::uniform_real_distribution<float> coordinate(0.0f, 80.0f), component(-1.0f, 1.0f);
+
+			THEN("they hit the same triangles as when testing every triangle") {
+				bool same = true;
+				std::size_t hits = 0;
+				for(int i = 0; i < 200; i++) {
+					const glm::vec3 direction {component(rng), -1.0f, component(rng)};
+					const Line ray({coordinate(rng), 30.0f, coordinate(rng)}, direction);
+
+					RayHit expected, sphereHit, boxHit;
+					const bool hit = brute_force_ray_cast(spheres, terrain.getNumTriangles(), ray, expected);
+					same = same &&
+						ray_cast(spheres, identity, ray, sphereHit) == hit &&
+						ray_cast(boxes, identity, ray, boxHit) == hit;
+					if(hit) {
+						hits++;
+						same = same &&
+							sphereHit.distance == Catch::Approx(expected.distance) &&
+							boxHit.distance == Catch::Approx(expected.distance);
+					}
+				}
+				REQUIRE(same);
+				REQUIRE(hits > 0);
+			}
+		}
+
+		WHEN("a batch of rays is cast") {
+			std::mt19937 rng(4321);
+			std::uniform_real_distribution<float> coordinate(0.0f, 80.0f), component(-1.0f, 1.0f);
+			std::vector<Line> rays;
+			for(int i = 0; i < 203; i++) {
+				rays.emplace_back(glm::vec3{coordinate(rng), 30.0f, coordinate(rng)}, glm::vec3{component(rng), -1.0f, component(rng)});
+			}
+
+			const auto agrees = [&](const auto& bvh, const std::vector<RayHit>& hits, float max_distance) {
+				bool same = hits.size() == rays.size();
+				for(std::size_t i = 0; same && i < rays.size(); i++) {
+					RayHit expected;
+					const bool hit = ray_cast(bvh, identity, rays[i], expected, max_distance);
+					same = hits[i].hit() == hit && (!hit || (
+						hits[i].triangle_idx == expected.triangle_idx &&
+						hits[i].distance == Catch::Approx(expected.distance) &&
+						hits[i].u == Catch::Approx(expected.u).margin(1e-4f) &&
+						hits[i].v == Catch::Approx(expected.v).margin(1e-4f)));
+				}
+				return same;
+			};
+
+			THEN("every ray hits what it hits when cast on its own") {
+				std::vector<RayHit> hits;
+				const std::size_t sphereHits = ray_cast(spheres, identity, rays, hits);
+				REQUIRE(agrees(spheres, hits, std::numeric_limits<float>::infinity()));
+				REQUIRE(ray_cast(boxes, identity, rays, hits) == sphereHits);
+				REQUIRE(agrees(boxes, hits, std::numeric_limits<float>::infinity()));
+				REQUIRE(sphereHits > 0);
+			}
+
+			THEN("no ray hits beyond the maximum distance") {
+				std::vector<RayHit> hits;
+				ray_cast(boxes, identity, rays, hits, 25.0f);
+				REQUIRE(agrees(boxes, hits, 25.0f));
+			}
+
+			THEN("packets of four rays hit what packets of eight rays do") {
+				std::vector<RayHit> hits(rays.size()), expected;
+				ray_cast(spheres, identity, rays, expected);
+				for(std::size_t i = 0; i < rays.size(); i += 4) {
+					detail::ray_cast_packet<4>(spheres, identity, rays.data() + i, std::min<std::size_t>(4, rays.size() - i),
+						std::numeric_limits<float>::infinity(), hits.data() + i);
+				}
+				bool same = true;
+				for(std::size_t i = 0; i < rays.size(); i++) {
+					same = same && hits[i].triangle_idx == expected[i].triangle_idx;
+				}
+				REQUIRE(same);
+			}
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,155 @@
+#include "region_query.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <catch2/catch_all.hpp>
+
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// Finds the ranges of triangles of bvh that overlap region by testing every triangle
+template<typename TValue, typename Region>
+std::vector<TriangleRange> brute_force_ranges(const TBVHModel<TValue>& bvh, const Model& model, const Region& region) {
+	std::vector<TriangleRange> ranges;
+	for(std::size_t i = 0; i < model.getNumTriangles(); i++) {
+		if(!detail::overlaps(bvh.getTriangle(i), region)) continue;
+		if(!ranges.empty() && ranges.back().second == i) {
+			ranges.back().second++;
+		} else {
+			ranges.emplace_back(i, i + 1);
+		}
+	}
+	return ranges;
+}
+
+std::size_t count(const std::vector<TriangleRange>& ranges) {
+	std::size_t result = 0;
+	for(const TriangleRange& range : ranges) result += range.second - range.first;
+	return result;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Frustums of cameras") {
+	GIVEN("The frustum of a camera at the origin looking down the negative z-axis") {
+		const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, 100.0f);
+		const Frustum f = frustum(projection);
+
+		THEN("points in front of the camera, between the near and far planes, are inside every plane") {
+			for(const Point& point : {Point{0.0f, 0.0f, -2.0f}, Point{0.9f, -0.9f, -1.0f}, Point{40.0f, 40.0f, -99.0f}}) {
+				for(const auto& plane : f) {
+					REQUIRE(detail::plane_distance(plane, point) >= 0.0f);
+				}
+			}
+		}
+
+		THEN("points behind, beyond or beside the camera are outside some plane") {
+			for(const Point& point : {Point{0.0f, 0.0f, 2.0f}, Point{0.0f, 0.0f, -0.5f}, Point{0.0f, 0.0f, -101.0f}, Point{3.0f, 0.0f, -2.0f}}) {
+				bool outside = false;
+				for(const auto& plane : f) {
+					outside = outside || detail::plane_distance(plane, point) < 0.0f;
+				}
+				REQUIRE(outside);
+			}
+		}
+
+		THEN("the near plane is one unit in front of the camera") {
+			REQUIRE(detail::plane_distance(f[4], Point{0.0f, 0.0f, -1.0f}) == Catch::Approx(0.0f).margin(1e-5f));
+		}
+	}
+}
+
+SCENARIO("Finding the triangles of a BVHModel within a region") {
+	GIVEN("A single triangle model") {
+		Model model = getSingleTriangleModel();
+		const AABBBVHModel bvh(&model);
+		std::vector<TriangleRange> ranges;
+
+		THEN("a box that no vertex of the triangle is within, but that the triangle passes through, finds it") {
+			REQUIRE(triangles_in(bvh, AABB({0.3f, 0.3f, -1.0f}, {0.4f, 0.4f, 1.0f}), ranges) == 1);
+			REQUIRE(ranges == std::vector<TriangleRange>{{0, 1}});
+		}
+
+		THEN("a box beyond the hypotenuse of the triangle but within its bounds does not find it") {
+			REQUIRE(triangles_in(bvh, AABB({0.8f, 0.8f, -1.0f}, {0.9f, 0.9f, 1.0f}), ranges) == 0);
+			REQUIRE(ranges.empty());
+		}
+
+		THEN("a sphere that touches the triangle finds it") {
+			REQUIRE(triangles_in(bvh, Sphere({0.25f, 0.25f, 1.0f}, 1.0f), ranges) == 1);
+		}
+	}
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel spheres(&terrain);
+		const AABBBVHModel boxes(&terrain);
+		const Point center = terrain.vertices[terrain.vertices.size() / 2];
+		std::vector<TriangleRange> sphereRanges, boxRanges;
+
+		WHEN("finding the triangles within a sphere") {
+			const Sphere region(center, 10.0f);
+			const std::size_t found = triangles_in(spheres, region, sphereRanges);
+			triangles_in(boxes, region, boxRanges);
+
+			THEN("they are the triangles found by testing every triangle") {
+				REQUIRE(found > 0);
+				REQUIRE(found == count(sphereRanges));
+				REQUIRE(sphereRanges == brute_force_ranges(spheres, terrain, region));
+				REQUIRE(boxRanges == sphereRanges);
+			}
+		}
+
+		WHEN("finding the triangles within a box") {
+			const AABB region(center - glm::vec3(15.0f, 5.0f, 10.0f), center + glm::vec3(15.0f, 5.0f, 10.0f));
+			triangles_in(spheres, region, sphereRanges);
+			triangles_in(boxes, region, boxRanges);
+
+			THEN("they are the triangles found by testing every triangle") {
+				REQUIRE(!boxRanges.empty());
+				REQUIRE(boxRanges == brute_force_ranges(boxes, terrain, region));
+				REQUIRE(sphereRanges == boxRanges);
+			}
+		}
+
+		WHEN("finding the triangles within the frustum of a camera looking down at the terrain") {
+			const glm::mat4 view = glm::lookAt(center + glm::vec3(0.0f, 30.0f, 30.0f), center, glm::vec3(0.0f, 1.0f, 0.0f));
+			const Frustum region = frustum(glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 100.0f) * view);
+			const std::size_t found = triangles_in(boxes, region, boxRanges);
+			triangles_in(spheres, region, sphereRanges);
+
+			THEN("they are the triangles found by testing every triangle, but not all of them") {
+				REQUIRE(found > 0);
+				REQUIRE(found < terrain.getNumTriangles());
+				REQUIRE(boxRanges == brute_force_ranges(boxes, terrain, region));
+				REQUIRE(sphereRanges == boxRanges);
+			}
+		}
+
+		WHEN("finding the triangles within a box around the whole terrain") {
+			const AABB& bounds = boxes.root();
+			const AABB region(bounds.lower - glm::vec3(1.0f), bounds.upper + glm::vec3(1.0f));
+
+			THEN("every triangle is found as a single range") {
+				REQUIRE(triangles_in(boxes, region, boxRanges) == terrain.getNumTriangles());
+				REQUIRE(boxRanges == std::vector<TriangleRange>{{0, terrain.getNumTriangles()}});
+			}
+		}
+
+		WHEN("finding the triangles within a sphere far away from the terrain") {
+			triangles_in(boxes, Sphere({0.0f, 0.0f, 0.0f}, 1.0f), boxRanges);
+			const std::size_t capacity = boxRanges.capacity();
+			const std::size_t found = triangles_in(boxes, Sphere(center + glm::vec3(0.0f, 1000.0f, 0.0f), 1.0f), boxRanges);
+
+			THEN("none are found and the buffer keeps its capacity") {
+				REQUIRE(found == 0);
+				REQUIRE(boxRanges.empty());
+				REQUIRE(boxRanges.capacity() == capacity);
+			}
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
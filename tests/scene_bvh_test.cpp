@@ -0,0 +1,178 @@
+#include "scene_bvh.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+/* A scene of "count" balls and cubes placed at random within a cube of side 2 * extent.
+ * The RenderDatas are stored up front, since instances refer to their matrices. */
+struct RandomScene {
+	Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+	Model cube = CubeGenerator({255, 0, 255}).generate(AABB({-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}));
+	std::vector<RenderData> renderDatas;
+	AABBSceneBVH scene;
+
+	RandomScene(std::size_t count, float extent) {
+		scene.addModel("ball", ball);
+		scene.addModel("cube", cube);
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> position(-extent, extent), angle(0.0f, glm::two_pi<float>());
+		for(std::size_t i = 0; i < count; i++) {
+			const glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)));
+			renderDatas.emplace_back(glm::rotate(translation, angle(rng), glm::vec3(1.0f, 1.0f, 0.0f)), i % 2 == 0 ? "ball" : "cube");
+		}
+		for(const RenderData& renderData : renderDatas) {
+			scene.add(renderData);
+		}
+		scene.update();
+	}
+};
+
+} // End of anonymous namespace
+
+SCENARIO("Two-level BVHs over the instances of a scene") {
+	GIVEN("A scene of three instances of a single triangle model, two of which coincide") {
+		Model model = getSingleTriangleModel();
+		glm::mat4 matrices[3] = {
+			glm::mat4(1.0f),
+			glm::mat4(1.0f),
+			glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f))};
+
+		SceneBVH scene;
+		const auto& bvh = scene.addModel("triangle", model);
+		const auto a = scene.add("triangle", &matrices[0]);
+		const auto b = scene.add("triangle", &matrices[1]);
+		const auto c = scene.add("triangle", &matrices[2]);
+		scene.update();
+		std::vector<SceneBVH::handle_type> handles;
+
+		THEN("the instances share a single model") {
+			REQUIRE(scene.size() == 3);
+			REQUIRE(scene.getNumModels() == 1);
+			REQUIRE(&scene.getInstanceModel(a) == &bvh);
+			REQUIRE(&scene.getInstanceModel(c) == &bvh);
+			REQUIRE(scene.addModel("triangle", model).size() == bvh.size());
+			REQUIRE(scene.getNumModels() == 1);
+		}
+
+		THEN("adding an instance of a model that was never added throws") {
+			REQUIRE_THROWS_AS(scene.add("missing", &matrices[0]), std::out_of_range);
+		}
+
+		THEN("a ray hits the translated instance in world-space") {
+			SceneRayHit hit;
+			REQUIRE(scene.ray_cast(Line({10.25f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+			REQUIRE(hit.instance == c);
+			REQUIRE(hit.hit.distance == Catch::Approx(5.0f));
+			REQUIRE(!scene.ray_cast(Line({5.0f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+			REQUIRE(!scene.ray_cast(Line({10.25f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit, 4.0f));
+		}
+
+		THEN("a box finds the instances whose bounds it overlaps") {
+			REQUIRE(scene.instances_in(AABB({-1.0f, -1.0f, -1.0f}, {2.0f, 2.0f, 1.0f}), handles) == 2);
+			std::sort(handles.begin(), handles.end());
+			REQUIRE(handles == std::vector<SceneBVH::handle_type>{a, b});
+		}
+
+		THEN("a model that collides with the coinciding instances finds both of them") {
+			REQUIRE(scene.colliding(bvh, glm::mat4(1.0f), handles) == 2);
+			const glm::mat4 away = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 5.0f));
+			REQUIRE(scene.colliding(bvh, away, handles) == 0);
+		}
+
+		WHEN("an instance moves and the scene is updated") {
+			matrices[2] = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.0f));
+			scene.update();
+
+			THEN("it is found where it moved to") {
+				SceneRayHit hit;
+				REQUIRE(scene.ray_cast(Line({0.25f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+				REQUIRE(hit.hit.distance == Catch::Approx(5.0f));
+				REQUIRE(scene.instances_in(Sphere({0.0f, 0.0f, -2.0f}, 0.5f), handles) == 1);
+				REQUIRE(handles.front() == c);
+			}
+		}
+
+		WHEN("an instance is removed and another one added") {
+			scene.remove(a);
+			glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 10.0f, 0.0f));
+			const auto d = scene.add("triangle", &matrix);
+			scene.update();
+
+			THEN("the handle of the removed instance is reused") {
+				REQUIRE(d == a);
+				REQUIRE(scene.size() == 3);
+				REQUIRE(scene.instances_in(AABB({-1.0f, -1.0f, -1.0f}, {2.0f, 2.0f, 1.0f}), handles) == 1);
+				REQUIRE(handles.front() == b);
+			}
+		}
+	}
+
+	GIVEN("A scene of many randomly placed balls and cubes") {
+		RandomScene random(1000, 40.0f);
+		AABBSceneBVH& scene = random.scene;
+		std::vector<AABBSceneBVH::handle_type> handles;
+
+		THEN("the top level is balanced") {
+			REQUIRE(scene.getDepth() == 11);
+		}
+
+		THEN("rays hit what a ray cast against every instance hits") {
+			std::mt19937 rng(5678);
+			std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+			bool same = true;
+			for(int i = 0; i < 100; i++) {
+				const Line ray({position(rng), position(rng), 50.0f}, {position(rng) / 100.0f, position(rng) / 100.0f, -1.0f});
+				SceneRayHit hit;
+				const bool found = scene.ray_cast(ray, hit);
+
+				float best = std::numeric_limits<float>::infinity();
+				for(std::size_t j = 0; j < random.renderDatas.size(); j++) {
+					RayHit instanceHit;
+					if(ray_cast(scene.getInstanceModel(j), random.renderDatas[j].modelMatrix, ray, instanceHit)) {
+						best = std::min(best, instanceHit.distance);
+					}
+				}
+				same = same && found == std::isfinite(best) && (!found || hit.hit.distance == Catch::Approx(best));
+			}
+			REQUIRE(same);
+		}
+
+		THEN("a frustum finds the instances whose bounds are outside none of its planes") {
+			const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			const Frustum f = frustum(glm::perspective(glm::radians(30.0f), 1.0f, 1.0f, 100.0f) * view);
+			const std::size_t found = scene.instances_in(f, handles);
+
+			std::size_t expected = 0;
+			for(AABBSceneBVH::handle_type i = 0; i < scene.size(); i++) {
+				expected += detail::classify(scene.getBounds(i), f) != detail::RegionOverlap::outside;
+			}
+			REQUIRE(found > 0);
+			REQUIRE(found < scene.size());
+			REQUIRE(found == expected);
+		}
+
+		THEN("a ball finds the instances it collides with") {
+			const glm::mat4 world = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.3f, 0.2f, 0.1f)), glm::vec3(10.0f));
+			scene.colliding(*scene.getModel("ball"), world, handles);
+			std::sort(handles.begin(), handles.end());
+
+			std::vector<AABBSceneBVH::handle_type> expected;
+			for(AABBSceneBVH::handle_type i = 0; i < scene.size(); i++) {
+				if(collides(*scene.getModel("ball"), scene.getInstanceModel(i), world, random.renderDatas[i].modelMatrix)) {
+					expected.push_back(i);
+				}
+			}
+			REQUIRE(!expected.empty());
+			REQUIRE(handles == expected);
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
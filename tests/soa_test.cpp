@@ -0,0 +1,203 @@
+#include "geometric_primitives/soa.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+bool approximately(const Point& a, const Point& b) {
+	return
+		a.x == Catch::Approx(b.x).margin(1e-4) &&
+		a.y == Catch::Approx(b.y).margin(1e-4) &&
+		a.z == Catch::Approx(b.z).margin(1e-4);
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Processing arrays of spheres, planes and triangles at once") {
+
+	// A count that is not a multiple of the width, such that the last group is partially padding
+	std::mt19937 rng(1357);
+	std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f), radius(0.1f, 3.0f);
+	const auto random_point = [&]() { return Point(coordinate(rng), coordinate(rng), coordinate(rng)); };
+
+	GIVEN("37 random spheres and a sphere among them") {
+		SphereSoA spheres;
+		for(int i = 0; i < 37; i++) spheres.push_back(Sphere(random_point(), radius(rng)));
+		const Sphere sphere({1.0f, -2.0f, 0.5f}, 4.0f);
+		std::vector<std::size_t> indices;
+
+		THEN("they hold the spheres that were pushed") {
+			REQUIRE(spheres.size() == 37);
+			REQUIRE(spheres.center[0].size() % SphereSoA::width == 0);
+			spheres.push_back(sphere);
+			REQUIRE(spheres[37] == sphere);
+		}
+
+		THEN("the spheres that collide are those whose centers are closer than their radii") {
+			std::vector<std::size_t> expected;
+			for(std::size_t i = 0; i < spheres.size(); i++) {
+				if(colliding(spheres[i], sphere, glm::mat4(1.0f), glm::mat4(1.0f))) expected.push_back(i);
+			}
+			REQUIRE(colliding(spheres, sphere, indices) == expected.size());
+			REQUIRE(indices == expected);
+			REQUIRE(!expected.empty());
+		}
+
+		THEN("the spheres that contain a point are those that contain it one at a time") {
+			bool same = true;
+			for(int i = 0; i < 50; i++) {
+				const Point point = random_point();
+				std::vector<std::size_t> expected;
+				for(std::size_t j = 0; j < spheres.size(); j++) {
+					if(spheres[j].contains(point)) expected.push_back(j);
+				}
+				contains(spheres, point, indices);
+				same = same && indices == expected;
+			}
+			REQUIRE(same);
+		}
+
+		THEN("the signed distances are those of the scalar functions") {
+			std::vector<float> to_sphere, to_point;
+			signed_distance(spheres, sphere, to_sphere);
+			signed_distance(spheres, sphere.p, to_point);
+			REQUIRE(to_sphere.size() == spheres.size());
+			for(std::size_t i = 0; i < spheres.size(); i++) {
+				REQUIRE(to_sphere[i] == Catch::Approx(signed_distance(spheres[i], sphere)));
+				REQUIRE(to_point[i] == Catch::Approx(signed_distance(spheres[i], sphere.p)));
+			}
+		}
+
+		THEN("transforming them transforms every sphere") {
+			const glm::mat4 m = glm::scale(
+				glm::rotate(glm::translate(glm::mat4(1.0f), Point(3.0f, -1.0f, 2.0f)), 0.7f, Point(1.0f, 2.0f, 3.0f)),
+				Point(2.0f, 0.5f, 1.0f));
+			SphereSoA transformed;
+			transform(spheres, m, transformed);
+			REQUIRE(transformed.size() == spheres.size());
+			for(std::size_t i = 0; i < spheres.size(); i++) {
+				const Sphere expected = transform(spheres[i], m);
+				REQUIRE(approximately(transformed[i].p, expected.p));
+				REQUIRE(transformed[i].r == Catch::Approx(expected.r));
+			}
+		}
+
+		THEN("they are classified against a plane by whether they cross it") {
+			SphereSoA few;
+			few.push_back(Sphere({0.0f, 0.0f, 2.0f}, 1.0f));
+			few.push_back(Sphere({0.0f, 0.0f, -2.0f}, 1.0f));
+			few.push_back(Sphere({5.0f, 5.0f, 0.5f}, 1.0f));
+			std::vector<std::int8_t> sides;
+			classify(few, Plane(Point(0.0f), Point(0.0f, 0.0f, 1.0f)), sides);
+			REQUIRE(sides == std::vector<std::int8_t>{1, -1, 0});
+		}
+	}
+
+	GIVEN("The planes of the triangles of a terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel terrainBVH(&terrain);
+		// Reserved since copying a Plane normalizes its normal again, which may change which side a point is on
+		std::vector<Plane> pushed;
+		pushed.reserve(terrain.getNumTriangles());
+		PlaneSoA planes;
+		for(std::size_t i = 0; i < terrain.getNumTriangles(); i++) {
+			const Triangle triangle = terrainBVH.getTriangle(i);
+			if(collinear(triangle.p1, triangle.p2, triangle.p3)) continue;
+			pushed.emplace_back(triangle.p1, normal(triangle));
+			planes.push_back(pushed.back());
+		}
+
+		THEN("points are on the same side of every plane as above() and below() say") {
+			bool same = true;
+			std::size_t in_plane = 0;
+			std::vector<std::int8_t> sides;
+			for(std::size_t j = 0; j < pushed.size(); j += 499) {
+				// The points of the planes are in some of the planes, and on either side of others
+				const Point point = pushed[j].getPoint();
+				classify(planes, point, sides);
+				for(std::size_t i = 0; i < planes.size(); i++) {
+					const Plane& plane = pushed[i];
+					same = same && sides[i] == int(plane.above(point)) - int(plane.below(point));
+					in_plane += sides[i] == 0;
+				}
+			}
+			REQUIRE(same);
+			REQUIRE(in_plane > 0);
+		}
+
+		THEN("the signed distance to a point is its distance along the normal") {
+			const Point point(1.0f, 2.0f, 3.0f);
+			std::vector<float> distances;
+			signed_distance(planes, point, distances);
+			for(std::size_t i = 0; i < planes.size(); i++) {
+				REQUIRE(distances[i] == Catch::Approx(glm::dot(point - planes[i].getPoint(), planes[i].getNormal())).margin(1e-5));
+			}
+		}
+
+		THEN("transforming them keeps transformed points in the planes") {
+			const glm::mat4 m = glm::scale(glm::rotate(glm::mat4(1.0f), 1.2f, Point(0.0f, 1.0f, 0.0f)), Point(1.0f, 3.0f, 1.0f));
+			PlaneSoA transformed;
+			transform(planes, m, transformed);
+			for(std::size_t i = 0; i < planes.size(); i++) {
+				const Plane plane = planes[i];
+				const Point n = plane.getNormal(), u = glm::normalize(glm::cross(n, Point(n.y, n.z, -n.x)));
+				const Point moved = Point(m * glm::vec4(plane.getPoint() + u, 1.0f));
+				REQUIRE(glm::dot(moved - transformed[i].getPoint(), transformed[i].getNormal()) == Catch::Approx(0.0f).margin(1e-4));
+				REQUIRE(glm::length(transformed[i].getNormal()) == Catch::Approx(1.0f));
+			}
+		}
+	}
+
+	GIVEN("The triangles of a terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel terrainBVH(&terrain);
+		TriangleSoA triangles;
+		for(std::size_t i = 0; i < terrain.getNumTriangles(); i++) triangles.push_back(terrainBVH.getTriangle(i));
+
+		THEN("the triangles that contain a point are those that contain it one at a time") {
+			bool same = true;
+			std::size_t hits = 0;
+			std::vector<std::size_t> indices;
+			for(std::size_t i = 0; i < triangles.size(); i += 97) {
+				// Corners and midpoints of edges are contained by their triangle and by its neighbours
+				const Triangle triangle = triangles[i];
+				for(const Point& point : {triangle.p1, midpoint<float, 3>(triangle.p2, triangle.p3), random_point()}) {
+					std::vector<std::size_t> expected;
+					for(std::size_t j = 0; j < triangles.size(); j++) {
+						if(triangles[j].contains(point)) expected.push_back(j);
+					}
+					contains(triangles, point, indices);
+					same = same && indices == expected;
+					hits += indices.size();
+				}
+			}
+			REQUIRE(same);
+			REQUIRE(hits > 0);
+		}
+
+		THEN("transforming them transforms every triangle") {
+			const glm::mat4 m = glm::rotate(glm::translate(glm::mat4(1.0f), Point(-4.0f, 2.0f, 1.0f)), 0.3f, Point(0.0f, 0.0f, 1.0f));
+			TriangleSoA transformed;
+			transform(triangles, m, transformed);
+			bool same = transformed.size() == triangles.size();
+			for(std::size_t i = 0; i < triangles.size(); i++) {
+				const Triangle expected = triangles[i].transform(m);
+				same = same &&
+					approximately(transformed[i].p1, expected.p1) &&
+					approximately(transformed[i].p2, expected.p2) &&
+					approximately(transformed[i].p3, expected.p3);
+			}
+			REQUIRE(same);
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
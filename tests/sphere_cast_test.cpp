@@ -0,0 +1,175 @@
+#include "sphere_cast.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// Finds the first contact by sweeping the sphere against every triangle of the model
+template<typename TValue>
+bool brute_force_sphere_cast(const TBVHModel<TValue>& bvh, std::size_t num_triangles, float radius, const LineSegment& segment, SphereHit& hit) {
+	bool found = false;
+	float best = 1.0f;
+	for(std::size_t i = 0; i < num_triangles; i++) {
+		float t;
+		Point point;
+		glm::vec3 normal;
+		if(detail::sphere_triangle(segment.start, segment.end - segment.start, radius, bvh.getTriangle(i), best, t, point, normal)) {
+			best = t;
+			hit = SphereHit{i, t, point, normal};
+			found = true;
+		}
+	}
+	return found;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Sweeping spheres against a BVHModel") {
+	GIVEN("A single triangle model") {
+		Model model = getSingleTriangleModel();
+		const BVHModel spheres(&model);
+		const AABBBVHModel boxes(&model);
+		const glm::mat4 identity(1.0f);
+		const Sphere sphere({0.0f, 0.0f, 0.0f}, 0.5f);
+		SphereHit hit;
+
+		WHEN("a sphere is swept straight down onto the face of the triangle") {
+			const LineSegment segment({0.25f, 0.25f, 5.0f}, {0.25f, 0.25f, -5.0f});
+
+			THEN("it touches the face when its center is a radius above it") {
+				REQUIRE(sphere_cast(spheres, identity, sphere, segment, hit));
+				REQUIRE(hit.triangle_idx == 0);
+				REQUIRE(hit.time == Catch::Approx(0.45f));
+				REQUIRE(hit.point.x == Catch::Approx(0.25f));
+				REQUIRE(hit.point.y == Catch::Approx(0.25f));
+				REQUIRE(hit.point.z == Catch::Approx(0.0f).margin(1e-6f));
+				REQUIRE(hit.normal.z == Catch::Approx(1.0f));
+				REQUIRE(sphere_cast(boxes, identity, sphere, segment, hit));
+				REQUIRE(hit.time == Catch::Approx(0.45f));
+			}
+		}
+
+		WHEN("a sphere is swept up onto the back of the triangle") {
+			const LineSegment segment({0.25f, 0.25f, -5.0f}, {0.25f, 0.25f, 5.0f});
+
+			THEN("the normal faces the sphere") {
+				REQUIRE(sphere_cast(spheres, identity, sphere, segment, hit));
+				REQUIRE(hit.time == Catch::Approx(0.45f));
+				REQUIRE(hit.normal.z == Catch::Approx(-1.0f));
+			}
+		}
+
+		WHEN("a sphere is swept down past the triangle, within its radius of an edge") {
+			const LineSegment segment({0.5f, -0.3f, 5.0f}, {0.5f, -0.3f, -5.0f});
+
+			THEN("it touches the edge rather than the face") {
+				REQUIRE(sphere_cast(boxes, identity, sphere, segment, hit));
+				REQUIRE(hit.point.x == Catch::Approx(0.5f));
+				REQUIRE(hit.point.y == Catch::Approx(0.0f).margin(1e-6f));
+				REQUIRE(hit.point.z == Catch::Approx(0.0f).margin(1e-6f));
+				// The center is 0.3 from the edge when it touches, so 0.4 above the plane of the triangle
+				REQUIRE(hit.time == Catch::Approx(0.46f));
+			}
+		}
+
+		WHEN("a sphere is swept down past the triangle, farther than its radius from it") {
+			const LineSegment segment({0.5f, -0.6f, 5.0f}, {0.5f, -0.6f, -5.0f});
+
+			THEN("it misses") {
+				REQUIRE_FALSE(sphere_cast(spheres, identity, sphere, segment, hit));
+				REQUIRE_FALSE(sphere_cast(boxes, identity, sphere, segment, hit));
+			}
+		}
+
+		WHEN("a sphere is swept towards the triangle but stops short of it") {
+			const LineSegment segment({0.25f, 0.25f, 5.0f}, {0.25f, 0.25f, 0.6f});
+
+			THEN("it misses") {
+				REQUIRE_FALSE(sphere_cast(spheres, identity, sphere, segment, hit));
+			}
+		}
+
+		WHEN("a sphere starts out touching the triangle") {
+			const LineSegment segment({0.25f, 0.25f, 0.25f}, {0.25f, 0.25f, 5.0f});
+
+			THEN("it touches the triangle at the start of the sweep") {
+				REQUIRE(sphere_cast(spheres, identity, sphere, segment, hit));
+				REQUIRE(hit.time == 0.0f);
+				REQUIRE(hit.point.z == Catch::Approx(0.0f).margin(1e-6f));
+			}
+		}
+
+		WHEN("the triangle is scaled and moved in world-space") {
+			const glm::mat4 world = glm::scale(glm::translate(identity, {0.0f, 0.0f, -3.0f}), glm::vec3(2.0f));
+			const LineSegment segment({0.5f, 0.5f, 5.0f}, {0.5f, 0.5f, -5.0f});
+
+			THEN("the contact is in world-space and the radius is not scaled") {
+				REQUIRE(sphere_cast(spheres, world, sphere, segment, hit));
+				REQUIRE(hit.time == Catch::Approx(0.75f));
+				REQUIRE(hit.point.z == Catch::Approx(-3.0f));
+				REQUIRE(hit.normal.z == Catch::Approx(1.0f));
+			}
+		}
+	}
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel spheres(&terrain);
+		const AABBBVHModel boxes(&terrain);
+		const glm::mat4 identity(1.0f);
+
+		WHEN("spheres are swept from above the terrain in random directions") {
+			std::mt19937 rng(1234);
+			std::uniform_real_distribution<float> coordinate(0.0f, 80.0f), component(-20.0f, 20.0f), radius(0.1f, 3.0f);
+
+			THEN("they touch the same triangles at the same time as when sweeping against every triangle") {
+				bool same = true;
+				std::size_t hits = 0;
+				for(int i = 0; i < 200; i++) {
+					const glm::vec3 start {coordinate(rng), 30.0f, coordinate(rng)};
+					const LineSegment segment(start, start + glm::vec3{component(rng), -60.0f, component(rng)});
+					const Sphere sphere(start, radius(rng));
+
+					SphereHit expected, sphereHit, boxHit;
+					const bool hit = brute_force_sphere_cast(spheres, terrain.getNumTriangles(), sphere.r, segment, expected);
+					same = same &&
+						sphere_cast(spheres, identity, sphere, segment, sphereHit) == hit &&
+						sphere_cast(boxes, identity, sphere, segment, boxHit) == hit;
+					if(hit) {
+						hits++;
+						same = same &&
+							sphereHit.time == Catch::Approx(expected.time) &&
+							boxHit.time == Catch::Approx(expected.time) &&
+							glm::distance(boxHit.point, expected.point) < 1e-3f;
+					}
+				}
+				REQUIRE(same);
+				REQUIRE(hits > 0);
+			}
+
+			THEN("a sweep of a tiny sphere touches where a linesegment hits") {
+				bool same = true;
+				for(int i = 0; i < 50; i++) {
+					const glm::vec3 start {coordinate(rng), 30.0f, coordinate(rng)};
+					const LineSegment segment(start, start + glm::vec3{component(rng), -60.0f, component(rng)});
+					RayHit rayHit;
+					SphereHit sphereHit;
+					const bool hit = ray_cast(boxes, identity, segment, rayHit);
+					same = same && sphere_cast(boxes, identity, Sphere(start, 1e-4f), segment, sphereHit) == hit;
+					if(hit) {
+						same = same && sphereHit.time * segment.length() == Catch::Approx(rayHit.distance).margin(1e-2f);
+					}
+				}
+				REQUIRE(same);
+			}
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
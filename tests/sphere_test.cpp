@@ -2,12 +2,16 @@
 
 #include <glm/gtc/epsilon.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <random>
 
+#include "geometric_primitives/point.hpp"
 #include "geometric_primitives/sphere.hpp"
 #include "geometric_primitives/triangle.hpp"
 
 #include "minimum_bounding_sphere.hpp"
 
+#include "generators/spheregenerator.hpp"
+
 namespace lowpoly3d {
 
 SCENARIO("Lots of sphere tests (todo: TDD:ify or BDD:ify these)") {
@@ -155,7 +159,156 @@ SCENARIO("Lots of sphere tests (todo: TDD:ify or BDD:ify these)") {
 			}
 		}
 	}
+	}
+
+SCENARIO("Transforming spheres") {
+	GIVEN("A unit sphere away from the origin") {
+		const Sphere sphere {{1.0f, 0.0f, 0.0f}, 1.0f};
+
+		WHEN("it is translated and rotated") {
+			const glm::mat4 m = glm::rotate(
+				glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f, 0.0f)),
+				glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+			const Sphere transformed = transform(sphere, m);
+
+			THEN("its center is transformed and its radius is unchanged") {
+				REQUIRE(glm::all(glm::epsilonEqual(transformed.p, glm::vec3(0.0f, 3.0f, 0.0f), 1e-5f)));
+				REQUIRE(transformed.r == Catch::Approx(1.0f));
+			}
+		}
 
+		WHEN("it is scaled uniformly") {
+			const Sphere transformed = transform(sphere, glm::scale(glm::mat4(1.0f), glm::vec3(3.0f)));
 
+			THEN("its center and radius are scaled") {
+				REQUIRE(transformed.p == glm::vec3(3.0f, 0.0f, 0.0f));
+				REQUIRE(transformed.r == Catch::Approx(3.0f));
+			}
+		}
+
+		WHEN("it is scaled non-uniformly and rotated") {
+			const glm::mat4 m = glm::scale(
+				glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(1.0f, 1.0f, 0.0f)),
+				glm::vec3(1.0f, 2.0f, 0.5f));
+			const Sphere transformed = transform(sphere, m);
+
+			THEN("its radius is scaled by the largest scale factor") {
+				REQUIRE(transformed.r == Catch::Approx(2.0f));
+			}
+		}
+
+		WHEN("it is rotated and then scaled non-uniformly") {
+			const glm::mat4 m = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 1.0f, 1.0f)) *
+				glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+			const Sphere transformed = transform(sphere, m);
+
+			THEN("it encloses the transformed sphere, though its radius may be larger than the largest scale factor") {
+				bool encloses = true;
+				for(int i = 0; i < 12; i++) {
+					for(int j = 0; j <= 6; j++) {
+						const float azimuth = glm::radians(30.0f * i), polar = glm::radians(30.0f * j);
+						const glm::vec3 direction(std::sin(polar) * std::cos(azimuth), std::sin(polar) * std::sin(azimuth), std::cos(polar));
+						const glm::vec3 point = glm::vec3(m * glm::vec4(sphere.p + sphere.r * direction, 1.0f));
+						encloses = encloses && glm::distance(transformed.p, point) <= transformed.r + 1e-5f;
+					}
+				}
+				REQUIRE(encloses);
+				REQUIRE(transformed.r >= 2.0f);
+			}
+		}
+	}
+}
+
+SCENARIO("Minimum bounding spheres of point sets") {
+	const auto encloses = [](const Sphere& sphere, const std::vector<Point>& points) {
+		return std::all_of(points.begin(), points.end(), [&](const Point& point) {
+			return glm::distance(sphere.p, point) <= sphere.r;
+		});
+	};
+
+	GIVEN("A single point") {
+		const std::vector<Point> points {{1.0f, 2.0f, 3.0f}};
+
+		THEN("its minimum bounding sphere is the point itself") {
+			REQUIRE(mbs(points) == Sphere({1.0f, 2.0f, 3.0f}, 0.0f));
+			REQUIRE(approximate_mbs(points) == Sphere({1.0f, 2.0f, 3.0f}, 0.0f));
+		}
 	}
-} // End of namespace lowpoly3d
\ No newline at end of file
+
+	GIVEN("The vertices of a triangle") {
+		const Triangle triangle({0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {0.5f, 1.5f, 0.0f});
+		const std::vector<Point> points {triangle.p1, triangle.p2, triangle.p3};
+
+		THEN("their minimum bounding sphere is that of the triangle") {
+			const Sphere expected = mbs(triangle);
+			const Sphere sphere = mbs(points);
+			REQUIRE(glm::all(glm::epsilonEqual(sphere.p, expected.p, 1e-5f)));
+			REQUIRE(sphere.r == Catch::Approx(expected.r));
+		}
+	}
+
+	GIVEN("The corners of a cube and points within it") {
+		std::vector<Point> points;
+		for(float x : {-1.0f, 1.0f}) for(float y : {-1.0f, 1.0f}) for(float z : {-1.0f, 1.0f}) {
+			points.emplace_back(x + 5.0f, y, z);
+		}
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+		for(int i = 0; i < 100; i++) {
+			points.emplace_back(coordinate(rng) + 5.0f, coordinate(rng), coordinate(rng));
+		}
+
+		THEN("their minimum bounding sphere is the circumscribed sphere of the cube") {
+			const Sphere sphere = mbs(points);
+			REQUIRE(glm::all(glm::epsilonEqual(sphere.p, glm::vec3(5.0f, 0.0f, 0.0f), 1e-5f)));
+			REQUIRE(sphere.r == Catch::Approx(std::sqrt(3.0f)));
+			REQUIRE(encloses(sphere, points));
+		}
+
+		THEN("the approximate bounding sphere is as tight, since the corners are extreme points") {
+			REQUIRE(approximate_mbs(points).r == Catch::Approx(std::sqrt(3.0f)));
+		}
+	}
+
+	GIVEN("Random points in a stretched box") {
+		std::mt19937 rng(4321);
+		std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+		std::vector<Point> points;
+		for(int i = 0; i < 1000; i++) {
+			points.emplace_back(10.0f * coordinate(rng), 3.0f * coordinate(rng), coordinate(rng));
+		}
+		const Sphere exact = mbs(points);
+		const Sphere approximate = approximate_mbs(points);
+
+		THEN("both spheres enclose every point") {
+			REQUIRE(encloses(exact, points));
+			REQUIRE(encloses(approximate, points));
+		}
+
+		THEN("the minimum bounding sphere is touched by at least two points, and is no larger than the approximate sphere") {
+			const auto touching = std::count_if(points.begin(), points.end(), [&](const Point& point) {
+				return glm::distance(exact.p, point) >= exact.r * (1.0f - 1e-5f);
+			});
+			REQUIRE(touching >= 2);
+			REQUIRE(exact.r <= approximate.r);
+			REQUIRE(approximate.r <= 1.1f * exact.r);
+		}
+
+		THEN("the order of the points does not change the minimum bounding sphere") {
+			std::vector<Point> reversed(points.rbegin(), points.rend());
+			REQUIRE(mbs(reversed).r == Catch::Approx(exact.r));
+		}
+	}
+
+	GIVEN("The vertices of a ball") {
+		const Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({1.0f, 2.0f, 3.0f}, 4.0f));
+
+		THEN("their minimum bounding sphere is the ball") {
+			const Sphere sphere = mbs(ball.vertices);
+			REQUIRE(glm::all(glm::epsilonEqual(sphere.p, glm::vec3(1.0f, 2.0f, 3.0f), 1e-4f)));
+			REQUIRE(sphere.r == Catch::Approx(4.0f));
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,173 @@
+#include "time_of_impact.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+#include "generators/terraingenerator.hpp"
+#include "proximity.hpp"
+
+namespace lowpoly3d {
+
+SCENARIO("Moving transformations") {
+	GIVEN("A motion that translates, rotates half a turn and scales uniformly") {
+		const glm::mat4 start = glm::scale(glm::translate(glm::mat4(1.0f), {1.0f, 2.0f, 3.0f}), glm::vec3(2.0f));
+		const glm::mat4 end = glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), {-1.0f, 0.0f, 5.0f}), 3.14159265f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(2.0f));
+		const Motion motion(start, end);
+
+		THEN("it starts at the start and ends at the end") {
+			for(int column = 0; column < 4; column++) {
+				REQUIRE(almostEqual(glm::vec3(motion.at(0.0f)[column]), glm::vec3(start[column]), 1e-4f));
+				REQUIRE(almostEqual(glm::vec3(motion.at(1.0f)[column]), glm::vec3(end[column]), 1e-4f));
+			}
+		}
+
+		THEN("it stays rigid halfway") {
+			const glm::mat4 halfway = motion.at(0.5f);
+			REQUIRE(glm::length(glm::vec3(halfway[0])) == Catch::Approx(2.0f));
+			REQUIRE(glm::dot(glm::vec3(halfway[0]), glm::vec3(halfway[2])) == Catch::Approx(0.0f).margin(1e-4f));
+			REQUIRE(almostEqual(glm::vec3(halfway[3]), glm::vec3(0.0f, 1.0f, 4.0f)));
+		}
+
+		THEN("no point near the origin moves farther than the bound") {
+			const glm::vec4 point(0.5f, -0.5f, 0.5f, 1.0f);
+			const float radius = glm::length(glm::vec3(point));
+			for(int i = 0; i < 10; i++) {
+				const float t0 = i * 0.1f, t1 = t0 + 0.1f;
+				const float moved = glm::distance(glm::vec3(motion.at(t0) * point), glm::vec3(motion.at(t1) * point));
+				REQUIRE(moved <= motion.bound(radius) * 0.1f + 1e-5f);
+			}
+		}
+	}
+}
+
+SCENARIO("Time of impact of moving BVHModels") {
+	GIVEN("Two single triangle models") {
+		Model model = getSingleTriangleModel();
+		const BVHModel spheres(&model);
+		const AABBBVHModel boxes(&model);
+		const glm::mat4 identity(1.0f);
+		Impact impact;
+
+		WHEN("one passes straight through the other between two frames") {
+			const glm::mat4 start = glm::translate(identity, {0.0f, 0.0f, 5.0f});
+			const glm::mat4 end = glm::translate(identity, {0.0f, 0.0f, -5.0f});
+
+			THEN("they touch halfway") {
+				REQUIRE(!collides(spheres, spheres, identity, start));
+				REQUIRE(!collides(spheres, spheres, identity, end));
+				REQUIRE(time_of_impact(spheres, spheres, identity, identity, start, end, impact));
+				REQUIRE(impact.time == Catch::Approx(0.5f).margin(1e-3f));
+				REQUIRE(impact.a_triangle_idx == 0);
+				REQUIRE(impact.b_triangle_idx == 0);
+				REQUIRE(impact.point.z == Catch::Approx(0.0f).margin(1e-3f));
+				REQUIRE(time_of_impact(boxes, boxes, identity, identity, start, end, impact));
+				REQUIRE(impact.time == Catch::Approx(0.5f).margin(1e-3f));
+			}
+
+			THEN("they touch at the same time if the other moves the other way") {
+				REQUIRE(time_of_impact(spheres, spheres, start, end, identity, identity, impact));
+				REQUIRE(impact.time == Catch::Approx(0.5f).margin(1e-3f));
+			}
+		}
+
+		WHEN("one moves past the other") {
+			const glm::mat4 start = glm::translate(identity, {-5.0f, 0.0f, 1.0f});
+			const glm::mat4 end = glm::translate(identity, {5.0f, 0.0f, 1.0f});
+
+			THEN("they never touch") {
+				REQUIRE(!time_of_impact(spheres, spheres, identity, identity, start, end, impact));
+				REQUIRE(!time_of_impact(boxes, boxes, identity, identity, start, end, impact));
+			}
+		}
+
+		WHEN("one spins past the other just above its plane") {
+			// The spin makes every advancement short, such that the gap is never closed within the budget
+			const glm::mat4 start = glm::translate(identity, {-2.0f, 0.0f, 0.01f});
+			const glm::mat4 end = glm::rotate(glm::translate(identity, {2.0f, 0.0f, 0.01f}), 3.0f, glm::vec3(0.0f, 0.0f, 1.0f));
+
+			THEN("they never touch") {
+				REQUIRE(!time_of_impact(spheres, spheres, identity, identity, start, end, impact));
+				REQUIRE(!time_of_impact(boxes, boxes, identity, identity, start, end, impact));
+			}
+		}
+
+		WHEN("one tips over onto the other") {
+			// Rotating a third of a turn about the x-axis, the vertex (0, 1, 0) reaches z = 0 after a twelfth of a turn
+			const glm::mat4 start = glm::translate(identity, {0.0f, 0.0f, 0.5f});
+			const glm::mat4 end = glm::rotate(start, -2.0f * 3.14159265f / 3.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+
+			THEN("they touch once the vertex reaches the other triangle") {
+				REQUIRE(time_of_impact(spheres, spheres, identity, identity, start, end, impact));
+				REQUIRE(impact.time == Catch::Approx(0.25f).margin(2e-3f));
+				REQUIRE(almostEqual(impact.point, glm::vec3(0.0f, std::sqrt(3.0f) / 2.0f, 0.0f), 1e-2f));
+			}
+		}
+
+		WHEN("they overlap from the start") {
+			THEN("they touch at time zero") {
+				REQUIRE(time_of_impact(spheres, spheres, identity, identity, identity, identity, impact));
+				REQUIRE(impact.time == 0.0f);
+			}
+		}
+	}
+
+	GIVEN("A triangle far from its origin spinning in its plane and a large triangle passing through that plane") {
+		// The spin bounds how fast the triangles approach far above how fast they do, so every advancement is short
+		Model spinning = getSingleTriangleModel();
+		spinning.translate({100.0f, 0.0f, 0.0f});
+		Model large = getSingleTriangleModel();
+		large.scale(2000.0f);
+		large.translate({-500.0f, -500.0f, 0.0f});
+		const BVHModel spinningSpheres(&spinning), largeSpheres(&large);
+		const AABBBVHModel spinningBoxes(&spinning), largeBoxes(&large);
+
+		const glm::mat4 identity(1.0f);
+		const glm::mat4 start = glm::translate(identity, {0.0f, 0.0f, 1.0f});
+		const glm::mat4 end = glm::translate(identity, {0.0f, 0.0f, -1.0f});
+		const glm::mat4 spun = glm::rotate(identity, 0.5f, glm::vec3(0.0f, 0.0f, 1.0f));
+		Impact impact;
+
+		THEN("they touch halfway, when the large triangle reaches the plane") {
+			REQUIRE(time_of_impact(spinningSpheres, largeSpheres, identity, spun, start, end, impact));
+			REQUIRE(impact.time == Catch::Approx(0.5f).margin(1e-3f));
+			REQUIRE(impact.point.z == Catch::Approx(0.0f).margin(1e-3f));
+			REQUIRE(time_of_impact(spinningBoxes, largeBoxes, identity, spun, start, end, impact));
+			REQUIRE(impact.time == Catch::Approx(0.5f).margin(1e-3f));
+		}
+	}
+
+	GIVEN("A ball falling through a procedurally generated terrain within a single frame") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel terrainSpheres(&terrain);
+		const AABBBVHModel terrainBoxes(&terrain);
+		Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+		const BVHModel ballSpheres(&ball);
+		const AABBBVHModel ballBoxes(&ball);
+
+		const glm::mat4 identity(1.0f);
+		const glm::mat4 start = glm::translate(identity, {40.0f, 60.0f, 40.0f});
+		const glm::mat4 end = glm::translate(identity, {42.0f, -40.0f, 41.0f});
+		const Motion motion(start, end);
+
+		THEN("the ball touches the terrain at the earliest time that they are in contact") {
+			Impact sphereImpact, boxImpact;
+			REQUIRE(time_of_impact(terrainSpheres, ballSpheres, identity, identity, start, end, sphereImpact));
+			REQUIRE(time_of_impact(terrainBoxes, ballBoxes, identity, identity, start, end, boxImpact));
+			REQUIRE(sphereImpact.time == Catch::Approx(boxImpact.time).margin(1e-4f));
+
+			ClosestPoints closest;
+			REQUIRE(minimum_distance(terrainSpheres, ballSpheres, identity, motion.at(sphereImpact.time), closest));
+			REQUIRE(closest.distance <= 1e-3f);
+
+			bool apart = true;
+			for(int i = 0; i < 20; i++) {
+				const float t = sphereImpact.time * float(i) / 20.0f;
+				apart = apart && minimum_distance(terrainSpheres, ballSpheres, identity, motion.at(t), closest) && closest.distance > 0.0f;
+			}
+			REQUIRE(apart);
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
@@ -0,0 +1,108 @@
+#include "geometric_primitives/triangle_batch.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "bounding_volume_hierarchy.hpp"
+#include "geometric_primitives/intersects.hpp"
+#include "generators/spheregenerator.hpp"
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+namespace {
+
+// Returns the mask of the triangles of batch that primitive intersects according to the scalar test
+template<std::size_t N, typename Primitive>
+int scalar_intersects(Primitive const& primitive, TTriangleBatch<N> const& batch) {
+	int hits = 0;
+	for(std::size_t i = 0; i < batch.size(); i++) {
+		hits |= intersects(primitive, batch[i]) << i;
+	}
+	return hits;
+}
+
+} // End of anonymous namespace
+
+SCENARIO("Testing linesegments and triangles against batches of triangles") {
+
+	GIVEN("A batch of the triangles of the triangle intersection tests") {
+		TriangleBatch8 batch;
+		batch.push_back({{2,0,0},{3,0,0},{3,1,0}});   // Beside
+		batch.push_back({{1,0,0},{2,0,0},{2,1,0}});   // Touching at a point
+		batch.push_back({{1,0,0},{2,0,0},{1,1,0}});   // Touching along an edge
+		batch.push_back({{0,0,1},{1,0,1},{1,1,1}});   // Above
+		batch.push_back({{0,0,0},{1,0,0},{0,1,0}});   // Sharing an edge
+		batch.push_back({{0.5f,0.2f,-1},{0.5f,0.2f,1},{0.5f,2,1}}); // Piercing
+		batch.push_back({{0.5f,0.2f,0},{0.8f,0.2f,0},{0.8f,0.5f,0}}); // Contained
+		const Triangle triangle({0,0,0},{1,0,0},{1,1,0});
+
+		THEN("The triangle intersects the triangles that it intersects one at a time") {
+			REQUIRE(intersects(triangle, batch) == 0b1110110);
+			REQUIRE(intersects(triangle, batch) == scalar_intersects(triangle, batch));
+		}
+
+		THEN("A batch of four tests the first four triangles") {
+			TriangleBatch4 first;
+			for(std::size_t i = 0; i < 4; i++) first.push_back(batch[i]);
+			REQUIRE(intersects(triangle, first) == 0b0110);
+		}
+
+		THEN("A linesegment along the x-axis intersects the triangles it touches") {
+			const LineSegment segment({-1,0,0}, {1.5f,0,0});
+			REQUIRE(intersects(segment, batch) == scalar_intersects(segment, batch));
+			REQUIRE(intersects(segment, batch) == 0b0010110);
+		}
+
+		THEN("An empty batch intersects nothing") {
+			REQUIRE(intersects(triangle, TriangleBatch8()) == 0);
+		}
+	}
+
+	GIVEN("The triangles of a terrain and of a ball resting on it") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		Model ball = SphereGenerator({255, 0, 255}, 1).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.5f));
+		const BVHModel terrainBVH(&terrain), ballBVH(&ball);
+		std::mt19937 rng(2468);
+		std::uniform_int_distribution<std::size_t> vertex(0, terrain.vertices.size() - 1);
+
+		THEN("batches of terrain triangles give the same results as the scalar tests") {
+			bool same = true;
+			std::size_t hits = 0;
+			for(int placement = 0; placement < 20; placement++) {
+				const Point center = terrain.vertices[vertex(rng)];
+				const glm::mat4 world = glm::translate(glm::mat4(1.0f), center);
+				std::vector<Triangle> nearby;
+				for(std::size_t j = 0; j < terrain.getNumTriangles(); j++) {
+					const Triangle candidate = terrainBVH.getTriangle(j);
+					if(glm::distance(candidate.p1, center) <= 4.0f) nearby.push_back(candidate);
+				}
+
+				for(std::size_t i = 0; i < ball.getNumTriangles(); i++) {
+					const Triangle triangle = ballBVH.getTriangle(i).transform(world);
+					const LineSegment edge(triangle.p1, triangle.p2);
+					for(std::size_t j = 0; j < nearby.size(); j += TriangleBatch8::width) {
+						TriangleBatch4 batch4;
+						TriangleBatch8 batch8;
+						for(std::size_t k = j; k < std::min(j + TriangleBatch8::width, nearby.size()); k++) {
+							batch8.push_back(nearby[k]);
+							if(!batch4.full()) batch4.push_back(nearby[k]);
+						}
+						const int expected = scalar_intersects(triangle, batch8);
+						hits += expected != 0;
+						same = same &&
+							intersects(triangle, batch8) == expected &&
+							intersects(triangle, batch4) == scalar_intersects(triangle, batch4) &&
+							intersects(edge, batch8) == scalar_intersects(edge, batch8);
+					}
+				}
+			}
+			REQUIRE(same);
+			REQUIRE(hits > 0);
+		}
+	}
+}
+
+} // End of namespace lowpoly3d
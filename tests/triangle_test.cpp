@@ -10,6 +10,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/random.hpp> // glm::sphericalRand
 
+#include <limits>
 #include <sstream>
 #include <string_view>
 
@@ -109,6 +110,24 @@ SCENARIO("Interior points of triangles (3D)") {
 		}
 	}
 
+	GIVEN("A triangle {(0, 0, 0), (3, 0, 0), (0, 3, 0)} and a point (1.5, 1.5, 0) on its hypotenuse") {
+		Triangle const triangle {
+			{0.0f, 0.0f, 0.0f},
+			{3.0f, 0.0f, 0.0f},
+			{0.0f, 3.0f, 0.0f}
+		};
+
+		WHEN("Checking if the point, and the point moved off the plane of the triangle by the smallest normal float, are contained by the triangle") {
+			bool const isContained = triangle.contains({1.5f, 1.5f, 0.0f});
+			bool const isOffPlaneContained = triangle.contains({1.5f, 1.5f, std::numeric_limits<float>::min()});
+
+			THEN("Only the point on the hypotenuse is reportedly contained by the triangle") {
+				REQUIRE(isContained);
+				REQUIRE_FALSE(isOffPlaneContained);
+			}
+		}
+	}
+
 	GIVEN("A degenerate triangle {(0, 0, 0), (1, 1, 0), (-1, -1, 0) and a point within the degenerate triangle (0, 0, 0)") {
 		Triangle const triangle {
 				{0.0f, 0.0f, 0.0f},
@@ -476,6 +495,44 @@ SCENARIO("Triangle intersection") {
 		intersectsCommutativityCheck(large, small);
 	}
 
+	GIVEN("Two coplanar triangles that overlap, but neither contains a vertex of the other") {
+		Triangle const
+			t1{{0,0,0},{6,0,0},{3,6,0}},
+			t2{{0,4,0},{6,4,0},{3,-3,0}};
+
+		THEN("They are reported as intersecting") {
+			REQUIRE(intersects(t1, t2));
+		}
+
+		intersectsCommutativityCheck(t1, t2);
+	}
+
+	GIVEN("Two triangles whose planes cross within both triangles' extents, but which pass each other") {
+		// The line where the planes meet is the x-axis, which t1 covers for x in [0, 0.5] and t2 for x in [2, 2.5]
+		Triangle const
+			t1{{0,-1,0},{1,-1,0},{0,1,0}},
+			t2{{2,0,-1},{3,0,-1},{2,0,1}};
+
+		THEN("They are reported as non-intersecting") {
+			REQUIRE_FALSE(intersects(t1, t2));
+		}
+
+		intersectsCommutativityCheck(t1, t2);
+	}
+
+	GIVEN("A degenerate triangle, which is a linesegment, that pierces another triangle") {
+		Triangle const
+			t1{{0,0,0},{4,0,0},{0,4,0}},
+			degenerate{{1,1,-1},{1,1,1},{1,1,0}};
+
+		THEN("They are reported as intersecting, unless the degenerate triangle is moved beside the other") {
+			REQUIRE(intersects(t1, degenerate));
+			REQUIRE_FALSE(intersects(t1, Triangle{{3,3,-1},{3,3,1},{3,3,0}}));
+		}
+
+		intersectsCommutativityCheck(t1, degenerate);
+	}
+
 	GIVEN("A triangle {(0,0,0),(1,0,0),(0,1,0)} and another non-intersecting triangle {(5,0,0),(6,0,0),(5,1,0)}") {
 		Triangle const
 			t1{{0,0,0},{1,0,0},{0,1,0}},
@@ -490,4 +547,56 @@ SCENARIO("Triangle intersection") {
 	}
 }
 
+SCENARIO("Closest points of triangles") {
+	GIVEN("The triangle {(0,0,0),(1,0,0),(0,1,0)}") {
+		Triangle const triangle{{0,0,0},{1,0,0},{0,1,0}};
+
+		THEN("The closest point to a point above the triangle is straight below it") {
+			REQUIRE(almostEqual(closest_point(triangle, Point{0.25f, 0.25f, 2.0f}), Point{0.25f, 0.25f, 0.0f}));
+		}
+
+		THEN("The closest point to a point beyond a vertex is that vertex") {
+			REQUIRE(almostEqual(closest_point(triangle, Point{-1.0f, -1.0f, 1.0f}), Point{0.0f, 0.0f, 0.0f}));
+		}
+
+		THEN("The closest point to a point beyond the hypotenuse lies on the hypotenuse") {
+			REQUIRE(almostEqual(closest_point(triangle, Point{1.0f, 1.0f, 0.0f}), Point{0.5f, 0.5f, 0.0f}));
+		}
+
+		WHEN("Finding the closest points to the same triangle moved along z") {
+			Point on_a, on_b;
+			const float distance = closest_points(triangle, triangle.transform(glm::translate(glm::mat4(1.0f), {0.0f, 0.0f, 3.0f})), on_a, on_b);
+
+			THEN("They are as far apart as the triangle was moved") {
+				REQUIRE(distance == Catch::Approx(3.0f));
+				REQUIRE(glm::distance(on_a, on_b) == Catch::Approx(3.0f));
+			}
+		}
+
+		WHEN("Finding the closest points to a triangle whose edge is parallel to and above the hypotenuse") {
+			Triangle const other{{1.0f, 1.0f, 1.0f}, {2.0f, 0.0f, 1.0f}, {2.0f, 2.0f, 1.0f}};
+			Point on_a, on_b;
+			const float distance = closest_points(triangle, other, on_a, on_b);
+
+			THEN("The closest points are on the hypotenuse and that edge") {
+				REQUIRE(distance == Catch::Approx(std::sqrt(1.5f)));
+				REQUIRE(on_a.x + on_a.y == Catch::Approx(1.0f));
+				REQUIRE(on_b.z == Catch::Approx(1.0f));
+			}
+		}
+
+		WHEN("Finding the closest points to a triangle that pierces it") {
+			Triangle const other{{0.25f, 0.25f, -1.0f}, {0.25f, 0.25f, 1.0f}, {5.0f, 5.0f, 0.0f}};
+			Point on_a, on_b;
+			const float distance = closest_points(triangle, other, on_a, on_b);
+
+			THEN("They are at distance zero at a common point") {
+				REQUIRE(distance == 0.0f);
+				REQUIRE(on_a == on_b);
+				REQUIRE(on_a.z == Catch::Approx(0.0f).margin(1e-6f));
+			}
+		}
+	}
+}
+
 }
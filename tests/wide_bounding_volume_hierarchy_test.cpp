@@ -0,0 +1,187 @@
+#include "wide_bounding_volume_hierarchy.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+#include <catch2/catch_all.hpp>
+
+#include "generators/spheregenerator.hpp"
+#include "generators/terraingenerator.hpp"
+
+namespace lowpoly3d {
+
+SCENARIO("Widening a BVH") {
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVH<Sphere> spheres(terrain);
+		const BVH<AABB> boxes(terrain);
+
+		WHEN("widening its BVHs") {
+			const WideBVH<Sphere> wideSpheres(&terrain, spheres);
+			const WideBVH<AABB> wideBoxes(&terrain, boxes);
+
+			THEN("they are about half as deep as the BVHs, with less than half as many nodes") {
+				REQUIRE(wideSpheres.getDepth() < spheres.getDepth());
+				REQUIRE(wideSpheres.getDepth() >= spheres.getDepth() / 2);
+				REQUIRE(wideBoxes.getDepth() < boxes.getDepth());
+				REQUIRE(2 * wideSpheres.size() < spheres.size());
+			}
+
+			THEN("nodes are in depth-first order and every triangle is the child of exactly one node") {
+				bool depthfirst = true;
+				std::vector<std::size_t> count(terrain.getNumTriangles(), 0);
+				for(std::size_t i = 0; i < wideBoxes.size(); i++) {
+					const auto& bv = wideBoxes[i];
+					depthfirst = depthfirst && bv.count >= 1 && bv.count <= 4;
+					for(std::size_t j = 0; j < bv.count; j++) {
+						if(bv.is_leaf(j)) {
+							count[bv.index(j)]++;
+						} else {
+							depthfirst = depthfirst && bv.index(j) > i && bv.index(j) < wideBoxes.size();
+						}
+					}
+				}
+				REQUIRE(depthfirst);
+				REQUIRE(std::all_of(count.begin(), count.end(), [](std::size_t c) { return c == 1; }));
+			}
+
+			THEN("the BVs of triangles contain them") {
+				bool ok = true;
+				for(std::size_t i = 0; i < wideSpheres.size(); i++) {
+					const auto& bv = wideSpheres[i];
+					for(std::size_t j = 0; j < bv.count; j++) {
+						ok = ok && (!bv.is_leaf(j) || bv.bounds.get(j).contains(wideSpheres.getTriangle(bv.index(j))));
+					}
+				}
+				REQUIRE(ok);
+			}
+
+			THEN("the root uses all four slots") {
+				REQUIRE(wideBoxes[wideBoxes.root_idx()].count == 4);
+			}
+		}
+	}
+
+	GIVEN("A model of a single triangle") {
+		Model model = getSingleTriangleModel();
+		const WideBVH<Sphere> wide(&model);
+
+		THEN("the root holds the triangle as its only child") {
+			REQUIRE(wide.size() == 1);
+			REQUIRE(wide[0].count == 1);
+			REQUIRE(wide[0].is_leaf(0));
+			REQUIRE(wide[0].index(0) == 0);
+		}
+	}
+
+	GIVEN("A model without triangles") {
+		Model model;
+		const WideBVH<Sphere> wideSpheres(&model);
+		const WideBVH<AABB> wideBoxes(&model);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		THEN("the wide BVHs are empty, collide with nothing and are missed by every ray") {
+			REQUIRE(wideSpheres.size() == 0);
+			REQUIRE(wideBoxes.size() == 0);
+			REQUIRE_FALSE(collides(wideSpheres, wideSpheres, identity, identity));
+			REQUIRE_FALSE(collides(wideBoxes, wideBoxes, identity, identity));
+			RayHit hit;
+			REQUIRE_FALSE(ray_cast(wideSpheres, identity, Line({0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+			REQUIRE_FALSE(ray_cast(wideBoxes, identity, Line({0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+		}
+	}
+}
+
+SCENARIO("Queries on wide BVHs") {
+
+	GIVEN("A wide BVH over a single triangle") {
+		Model model = getSingleTriangleModel();
+		const WideBVH<Sphere> wide(&model);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		THEN("it collides with itself, but not with itself moved away") {
+			REQUIRE(collides(wide, wide, identity, identity));
+			REQUIRE_FALSE(collides(wide, wide, identity, glm::translate(identity, glm::vec3(5.0f, 0.0f, 0.0f))));
+		}
+
+		THEN("a ray through the triangle hits it") {
+			RayHit hit;
+			REQUIRE(ray_cast(wide, identity, Line({0.25f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit));
+			REQUIRE(hit.triangle_idx == 0);
+			REQUIRE(hit.distance == Catch::Approx(5.0f));
+			REQUIRE_FALSE(ray_cast(wide, identity, Line({0.25f, 0.25f, 5.0f}, {0.0f, 0.0f, -1.0f}), hit, 4.0f));
+		}
+	}
+
+	GIVEN("Two balls") {
+		Model ball = SphereGenerator({255, 0, 255}, 2).generate(Sphere({0.0f, 0.0f, 0.0f}, 1.0f));
+		const BVHModel spheres(&ball);
+		const AABBBVHModel boxes(&ball);
+		const WideBVH<Sphere> wideSpheres(&ball);
+		const WideBVH<AABB> wideBoxes(&ball);
+		const glm::mat4 identity = glm::mat4(1.0f);
+
+		THEN("they collide where collides() on the BVHModels says they do") {
+			std::size_t collisions = 0;
+			for(float x : {0.7f, 1.2f, 1.5f, 1.9f, 2.1f, 3.0f}) {
+				const glm::mat4 translation = glm::translate(identity, glm::vec3(x, 0.0f, 0.0f));
+				const bool expected = collides(spheres, spheres, identity, translation);
+				collisions += expected;
+				REQUIRE(collides(boxes, boxes, identity, translation) == expected);
+				REQUIRE(collides(wideSpheres, wideSpheres, identity, translation) == expected);
+				REQUIRE(collides(wideBoxes, wideBoxes, identity, translation) == expected);
+			}
+			REQUIRE(collisions == 4);
+		}
+
+		THEN("a ball scaled up and away from the origin collides like the BVHModels say it does") {
+			for(float x : {2.5f, 3.5f}) {
+				const glm::mat4 world = glm::scale(glm::translate(identity, glm::vec3(x, 0.0f, 0.0f)), glm::vec3(2.0f));
+				const bool expected = collides(spheres, spheres, identity, world);
+				REQUIRE(collides(wideSpheres, wideSpheres, identity, world) == expected);
+				REQUIRE(collides(wideBoxes, wideBoxes, world, identity) == expected);
+			}
+		}
+	}
+
+	GIVEN("A procedurally generated terrain") {
+		TerrainGenerator tg(80);
+		Model terrain = tg.generate();
+		const BVHModel spheres(&terrain);
+		const WideBVH<Sphere> wideSpheres(&terrain);
+		const WideBVH<AABB> wideBoxes(&terrain);
+		const glm::mat4 identity = glm::mat4(1.0f);
+		const Point center = terrain.vertices[terrain.vertices.size() / 2];
+
+		THEN("a copy of it lifted above it does not collide with it") {
+			const glm::mat4 lifted = glm::translate(identity, glm::vec3(0.0f, 100.0f, 0.0f));
+			REQUIRE_FALSE(collides(spheres, spheres, identity, lifted));
+			REQUIRE_FALSE(collides(wideSpheres, wideSpheres, identity, lifted));
+			REQUIRE_FALSE(collides(wideBoxes, wideBoxes, identity, lifted));
+		}
+
+		THEN("rays hit what they hit on the BVHModel") {
+			std::mt19937 rng(5678);
+			std::uniform_real_distribution<float> offset(-30.0f, 30.0f);
+			bool same = true;
+			std::size_t hits = 0;
+			for(int i = 0; i < 100; i++) {
+				const Line ray(center + glm::vec3(offset(rng), 50.0f, offset(rng)), {offset(rng) / 100.0f, -1.0f, offset(rng) / 100.0f});
+				RayHit expected, sphereHit, boxHit;
+				const bool found = ray_cast(spheres, identity, ray, expected);
+				hits += found;
+				same = same && ray_cast(wideSpheres, identity, ray, sphereHit) == found;
+				same = same && ray_cast(wideBoxes, identity, ray, boxHit) == found;
+				if(found) {
+					same = same && sphereHit.triangle_idx == expected.triangle_idx && sphereHit.distance == expected.distance;
+					same = same && boxHit.triangle_idx == expected.triangle_idx && boxHit.distance == expected.distance;
+				}
+			}
+			REQUIRE(hits > 0);
+			REQUIRE(same);
+		}
+	}
+}
+
+} // End of namespace lowpoly3d